@@ -1748,6 +1748,9 @@ void CApplication::UnloadSkin(bool forReload /* = false */)
   else if (!m_saveSkinOnUnloading)
     m_saveSkinOnUnloading = true;
 
+  if (g_SkinInfo != nullptr)
+    g_SkinInfo->SaveCache();
+
   g_audioManager.Enable(false);
 
   g_windowManager.DeInitialize();
@@ -1921,10 +1924,10 @@ void CApplication::Render()
 
   g_Windowing.EndRender();
 
-  // reset our info cache - we do this at the end of Render so that it is
+  // invalidate our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.UpdateCache();
 
   if (hasRendered)
   {
@@ -2759,6 +2762,7 @@ void CApplication::FrameMove(bool processEvents, bool processGUI)
         g_windowManager.Process(CTimeUtils::GetFrameTime());
     }
     g_windowManager.FrameMove();
+    g_TextureManager.FrameMove();
   }
 
   m_pPlayer->FrameMove();
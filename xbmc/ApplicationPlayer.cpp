@@ -22,6 +22,7 @@
 #include "cores/IPlayer.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "Application.h"
+#include "guilib/GUITexture.h"
 #include "PlayListPlayer.h"
 #include "settings/MediaSettings.h"
 
@@ -775,7 +776,11 @@ void CApplicationPlayer::Render(bool clear, uint32_t alpha, bool gui)
 {
   std::shared_ptr<IPlayer> player = GetInternal();
   if (player)
+  {
+    // video goes on top of the textures and text queued so far
+    CGUITexture::Flush();
     player->Render(clear, alpha, gui);
+  }
 }
 
 void CApplicationPlayer::FlushRenderer()
@@ -150,6 +150,11 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowTime = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  m_dirtySources = INFO_DEPENDS_ALL;
+  m_cachePlayerActive = false;
+  m_cacheTime = 0;
+  m_boolsEvaluated = 0;
+  m_boolsSkipped = 0;
   ResetLibraryBools();
 }
 
@@ -6633,13 +6638,6 @@ bool CGUIInfoManager::GetInt(int &value, int info, int contextWindow, const CGUI
 }
 
 // functor for comparison InfoPtr's
-struct InfoBoolFinder
-{
-  InfoBoolFinder(const std::string &expression, int context) : m_bool(expression, context) {};
-  bool operator() (const InfoPtr &right) const { return m_bool == *right; };
-  InfoBool m_bool;
-};
-
 INFO::InfoPtr CGUIInfoManager::Register(const std::string &expression, int context)
 {
   std::string condition(CGUIInfoLabel::ReplaceLocalize(expression));
@@ -6650,18 +6648,28 @@ INFO::InfoPtr CGUIInfoManager::Register(const std::string &expression, int conte
 
   CSingleLock lock(m_critInfo);
   // do we have the boolean expression already registered?
-  std::vector<InfoPtr>::const_iterator i = std::find_if(m_bools.begin(), m_bools.end(), InfoBoolFinder(condition, context));
-  if (i != m_bools.end())
-    return *i;
+  std::weak_ptr<InfoBool> &registered = m_boolIndex[GetBoolKey(condition, context)];
+  InfoPtr info = registered.lock();
+  if (info)
+    return info;
 
   if (condition.find_first_of("|+[]!") != condition.npos)
     m_bools.push_back(std::make_shared<InfoExpression>(condition, context));
   else
     m_bools.push_back(std::make_shared<InfoSingle>(condition, context));
 
+  registered = m_bools.back();
   return m_bools.back();
 }
 
+std::string CGUIInfoManager::GetBoolKey(const std::string &expression, int context)
+{
+  // info bools compare their expressions in lower case
+  std::string key = StringUtils::Format("%i:%s", context, expression.c_str());
+  StringUtils::ToLower(key);
+  return key;
+}
+
 bool CGUIInfoManager::EvaluateBool(const std::string &expression, int contextWindow /* = 0 */, const CGUIListItemPtr &item /* = NULL */)
 {
   bool result = false;
@@ -9229,6 +9237,7 @@ bool CGUIInfoManager::GetDisplayAfterSeek()
 void CGUIInfoManager::SetShowInfo(bool showinfo)
 {
   m_playerShowInfo = showinfo;
+  InvalidateCache(INFO_DEPENDS_PLAYER);
 
   if (!showinfo)
     m_isPvrChannelPreview = false;
@@ -9256,6 +9265,9 @@ void CGUIInfoManager::Clear()
     m_bools.erase(i, m_bools.end());
     i = std::remove_if(m_bools.begin(), m_bools.end(), std::mem_fun_ref(&InfoPtr::unique));
   }
+  m_boolIndex.clear();
+  for (std::vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+    m_boolIndex[GetBoolKey((*i)->GetExpression(), (*i)->GetContext())] = *i;
   // log which ones are used - they should all be gone by now
   for (std::vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
     CLog::Log(LOGDEBUG, "Infobool '%s' still used by %u instances", (*i)->GetExpression().c_str(), (unsigned int) i->use_count());
@@ -10635,6 +10647,177 @@ void CGUIInfoManager::ResetCache()
     (*i)->SetDirty();
 }
 
+void CGUIInfoManager::UpdateCache()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+
+  InfoBool::GetAndResetCounters(m_boolsEvaluated, m_boolsSkipped);
+
+  // sources without change notifications are invalidated every frame. Player
+  // state is polled: it changes continuously while playing, and once more
+  // when playback ends.
+  unsigned int dirty = m_dirtySources.exchange(INFO_DEPENDS_NONE) | INFO_DEPENDS_OTHER;
+  bool playerActive = g_application.m_pPlayer->IsPlaying();
+  if (playerActive || m_cachePlayerActive)
+    dirty |= INFO_DEPENDS_PLAYER;
+  m_cachePlayerActive = playerActive;
+  time_t now = time(NULL);
+  if (now != m_cacheTime)
+    dirty |= INFO_DEPENDS_TIME;
+  m_cacheTime = now;
+
+  SetBoolsDirty(dirty);
+}
+
+void CGUIInfoManager::ApplyCacheInvalidation()
+{
+  unsigned int dirty = m_dirtySources.exchange(INFO_DEPENDS_NONE);
+  if (dirty != INFO_DEPENDS_NONE)
+    SetBoolsDirty(dirty);
+}
+
+void CGUIInfoManager::SetBoolsDirty(unsigned int sources)
+{
+  CSingleLock lock(m_critInfo);
+  for (std::vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->GetDependencies() & sources)
+      (*i)->SetDirty();
+  }
+}
+
+void CGUIInfoManager::GetBoolCacheStats(unsigned int &evaluated, unsigned int &skipped) const
+{
+  evaluated = m_boolsEvaluated;
+  skipped = m_boolsSkipped;
+}
+
+unsigned int CGUIInfoManager::GetConditionDependencies(int condition) const
+{
+  condition = abs(condition);
+
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    if (condition - MULTI_INFO_START >= (int)m_multiInfo.size())
+      return INFO_DEPENDS_OTHER;
+    const GUIInfo &info = m_multiInfo[condition - MULTI_INFO_START];
+    switch (info.m_info)
+    {
+    case SYSTEM_TIME:
+    case SYSTEM_DATE:
+      return INFO_DEPENDS_TIME;
+    case SKIN_BOOL:
+    case SKIN_STRING:
+    case SKIN_HAS_THEME:
+      return INFO_DEPENDS_SKIN;
+    case STRING_COMPARE:
+    case STRING_IS_EQUAL:
+      // info labels are stored with negative numbers, anything else is a constant string
+      if (info.GetData2() < 0)
+        return GetConditionDependencies(info.GetData1()) | GetConditionDependencies(-info.GetData2());
+      return GetConditionDependencies(info.GetData1());
+    case STRING_IS_EMPTY:
+    case STRING_STR:
+    case STRING_STR_LEFT:
+    case STRING_STR_RIGHT:
+    case STRING_STARTS_WITH:
+    case STRING_ENDS_WITH:
+    case STRING_CONTAINS:
+    case INTEGER_IS_EQUAL:
+    case INTEGER_GREATER_THAN:
+    case INTEGER_GREATER_OR_EQUAL:
+    case INTEGER_LESS_THAN:
+    case INTEGER_LESS_OR_EQUAL:
+      // comparisons change with the label they compare
+      return GetConditionDependencies(info.GetData1());
+    default:
+      // the parameters don't change what the info depends on
+      return GetConditionDependencies(info.m_info);
+    }
+  }
+
+  if (condition >= LISTITEM_START && condition < LISTITEM_END)
+    return INFO_DEPENDS_LISTITEM;
+
+  switch (condition)
+  {
+  case SYSTEM_ALWAYS_TRUE:
+  case SYSTEM_ALWAYS_FALSE:
+  case SYSTEM_ETHERNET_LINK_ACTIVE:
+  case SYSTEM_PLATFORM_LINUX:
+  case SYSTEM_PLATFORM_WINDOWS:
+  case SYSTEM_PLATFORM_DARWIN:
+  case SYSTEM_PLATFORM_DARWIN_OSX:
+  case SYSTEM_PLATFORM_DARWIN_IOS:
+  case SYSTEM_PLATFORM_ANDROID:
+  case SYSTEM_PLATFORM_LINUX_RASPBERRY_PI:
+  case SYSTEM_BUILD_VERSION:
+  case SYSTEM_BUILD_VERSION_SHORT:
+  case SYSTEM_BUILD_DATE:
+    return INFO_DEPENDS_NONE;
+  case PLAYER_VOLUME:
+  case PLAYER_MUTED:
+    // application volume, changes without playback
+    return INFO_DEPENDS_OTHER;
+  case VIDEOPLAYER_ISFULLSCREEN:
+    return INFO_DEPENDS_PLAYER | INFO_DEPENDS_WINDOW;
+  case WINDOW_PROPERTY:
+  case WINDOW_IS_TOPMOST:
+  case WINDOW_IS_VISIBLE:
+  case WINDOW_NEXT:
+  case WINDOW_PREVIOUS:
+  case WINDOW_IS_MEDIA:
+  case WINDOW_IS_ACTIVE:
+  case WINDOW_IS:
+  case SYSTEM_HAS_MODAL_DIALOG:
+  case SYSTEM_CURRENT_WINDOW:
+    return INFO_DEPENDS_WINDOW;
+  case CONTROL_HAS_FOCUS:
+  case CONTROL_GROUP_HAS_FOCUS:
+  case SYSTEM_CURRENT_CONTROL_ID:
+    return INFO_DEPENDS_FOCUS;
+  case CONTAINER_HAS_FOCUS:
+    // the focused item of a container
+    return INFO_DEPENDS_FOCUS | INFO_DEPENDS_LISTITEM;
+  case CONTAINER_SCROLL_PREVIOUS:
+  case CONTAINER_MOVE_PREVIOUS:
+  case CONTAINER_STATIC:
+  case CONTAINER_MOVE_NEXT:
+  case CONTAINER_SCROLL_NEXT:
+  case CONTAINER_SCROLLING:
+  case CONTAINER_ISUPDATING:
+    // timed by the scroller and the directory fetch, not by item changes
+    return INFO_DEPENDS_OTHER;
+  case LIBRARY_HAS_ROLE:
+    return INFO_DEPENDS_LIBRARY;
+  case SYSTEM_TIME:
+  case SYSTEM_DATE:
+    return INFO_DEPENDS_TIME;
+  case VISUALISATION_LOCKED:
+  case VISUALISATION_PRESET:
+  case VISUALISATION_NAME:
+  case VISUALISATION_HAS_PRESETS:
+    return INFO_DEPENDS_PLAYER;
+  default:
+    break;
+  }
+
+  if ((condition >= PLAYER_HAS_MEDIA && condition <= PLAYER_PLAYSPEED) ||
+      (condition >= MUSICPLAYER_TITLE && condition <= MUSICPLAYER_CONTRIBUTOR_AND_ROLE) ||
+      (condition >= VIDEOPLAYER_TITLE && condition <= VIDEOPLAYER_USER_RATING) ||
+      (condition >= PLAYER_PROCESS_VIDEODECODER && condition <= PLAYER_PROCESS_AUDIOBITSPERSAMPLE) ||
+      (condition >= RDS_DATA_START && condition <= RDS_DATA_END))
+    return INFO_DEPENDS_PLAYER;
+  if (condition >= CONTAINER_HAS_PARENT_ITEM && condition <= CONTAINER_PLUGINCATEGORY)
+    return INFO_DEPENDS_LISTITEM;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_COMPILATIONS)
+    return INFO_DEPENDS_LIBRARY;
+  if (condition >= SKIN_BOOL && condition <= SKIN_ASPECT_RATIO)
+    return INFO_DEPENDS_SKIN;
+  return INFO_DEPENDS_OTHER;
+}
+
 std::string CGUIInfoManager::GetPictureLabel(int info)
 {
   if (info == SLIDE_FILE_NAME)
@@ -10802,6 +10985,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  InvalidateCache(INFO_DEPENDS_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -10814,6 +10998,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasSingles = -1;
   m_libraryHasCompilations = -1;
   m_libraryRoleCounts.clear();
+  InvalidateCache(INFO_DEPENDS_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
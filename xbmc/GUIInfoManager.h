@@ -41,6 +41,7 @@
 #include <memory>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace MUSIC_INFO
@@ -108,6 +109,7 @@ class CGUIInfoManager : public IMsgTargetCallback, public Observable,
                         public KODI::MESSAGING::IMessageTarget
 {
 friend CSetCurrentItemJob;
+friend class TestGUIInfoManager;
 
 public:
   CGUIInfoManager(void);
@@ -197,7 +199,7 @@ public:
 
   bool GetDisplayAfterSeek();
   void SetDisplayAfterSeek(unsigned int timeOut = 2500, int seekOffset = 0);
-  void SetShowTime(bool showtime) { m_playerShowTime = showtime; };
+  void SetShowTime(bool showtime) { m_playerShowTime = showtime; InvalidateCache(INFO::INFO_DEPENDS_PLAYER); };
   void SetShowInfo(bool showinfo);
   bool GetShowInfo() const { return m_playerShowInfo; }
   bool ToggleShowInfo();
@@ -210,10 +212,39 @@ public:
   void UpdateAVInfo();
   inline float GetFPS() const { return m_fps; };
 
-  void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
-  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+  void SetNextWindow(int windowID) { m_nextWindowID = windowID; InvalidateCache(INFO::INFO_DEPENDS_WINDOW); };
+  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; InvalidateCache(INFO::INFO_DEPENDS_WINDOW); };
 
+  /*! \brief Mark all registered info bools dirty, regardless of their dependencies
+   */
   void ResetCache();
+  /*! \brief Mark the info bools whose state sources changed since the last call dirty
+   Called once per frame after rendering. Untracked and polled sources (player,
+   time) are checked here. Info bools that only depend on unchanged sources keep
+   their cached value.
+   */
+  void UpdateCache();
+  /*! \brief Signal that state sources have changed
+   May be called from any thread. The info bools depending on the sources are
+   marked dirty by the next ApplyCacheInvalidation() or UpdateCache().
+   \param sources a combination of INFO::InfoDependency flags
+   */
+  void InvalidateCache(unsigned int sources) { m_dirtySources |= sources; };
+  /*! \brief Mark the info bools whose state sources were signalled through
+   InvalidateCache() dirty. Called before the windows are processed, so changes
+   made while handling input and messages are seen in the same frame.
+   */
+  void ApplyCacheInvalidation();
+  /*! \brief Get the number of info bool evaluations during the last frame
+   \param evaluated [out] number of conditions that were re-evaluated
+   \param skipped [out] number of conditions that used their cached value
+   */
+  void GetBoolCacheStats(unsigned int &evaluated, unsigned int &skipped) const;
+  /*! \brief Get the state sources a condition depends on
+   \param condition the condition, as returned by TranslateSingleString
+   \return a combination of INFO::InfoDependency flags
+   */
+  unsigned int GetConditionDependencies(int condition) const;
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   std::string GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   std::string GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -252,6 +283,8 @@ protected:
   bool CheckWindowCondition(CGUIWindow *window, int condition) const;
   CGUIWindow *GetWindowWithCondition(int contextWindow, int condition) const;
 
+  static std::string GetBoolKey(const std::string &expression, int context);
+
   /*! \brief class for holding information on properties
    */
   class Property
@@ -337,8 +370,17 @@ protected:
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+  std::unordered_map<std::string, std::weak_ptr<INFO::InfoBool> > m_boolIndex; // context and lower case expression -> info bool
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
+  // info bool invalidation
+  void SetBoolsDirty(unsigned int sources);
+  std::atomic<unsigned int> m_dirtySources;  // INFO::InfoDependency flags changed since the last UpdateCache()
+  bool m_cachePlayerActive;                  // player was active during the last UpdateCache()
+  time_t m_cacheTime;                        // system time during the last UpdateCache()
+  unsigned int m_boolsEvaluated;             // info bools evaluated during the last frame
+  unsigned int m_boolsSkipped;               // info bools taken from the cache during the last frame
+
   int m_libraryHasMusic;
   int m_libraryHasMovies;
   int m_libraryHasTVShows;
@@ -38,7 +38,7 @@ CTextureCache &CTextureCache::GetInstance()
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE), m_decodeQueue(*this)
 {
 }
 
@@ -48,6 +48,9 @@ CTextureCache::~CTextureCache()
 
 void CTextureCache::Initialize()
 {
+  SetJobsAtOnce(g_advancedSettings.m_textureCacheFetchJobs);
+  m_decodeQueue.SetJobsAtOnce(g_advancedSettings.m_textureCacheDecodeJobs);
+
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
@@ -56,7 +59,13 @@ void CTextureCache::Initialize()
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+  m_decodeQueue.CancelJobs();
+  {
+    CSingleLock lock(m_processingSection);
+    m_processinglist.clear();
+  }
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   m_database.Close();
 }
 
@@ -90,7 +99,7 @@ std::string CTextureCache::GetCachedImage(const std::string &image, CTextureDeta
   // lookup the item in the database
   if (GetCachedTexture(url, details))
   {
-    if (trackUsage)
+    if (trackUsage && details.id >= 0) // not yet written to the database otherwise
       IncrementUseCount(details);
     return GetCachedPath(details.file);
   }
@@ -119,8 +128,15 @@ void CTextureCache::BackgroundCacheImage(const std::string &url)
   if (!path.empty() && details.hash.empty())
     return; // image is already cached and doesn't need to be checked further
 
+  std::string image = CTextureUtils::UnwrapImageURL(url);
+  {
+    CSingleLock lock(m_processingSection);
+    if (m_processinglist.find(image) != m_processinglist.end())
+      return; // image is already being cached
+  }
+
   // needs (re)caching
-  AddJob(new CTextureCacheJob(CTextureUtils::UnwrapImageURL(url), details.hash));
+  AddJob(new CTextureCacheJob(image, details.hash, CTextureCacheJob::STAGE_FETCH));
 }
 
 std::string CTextureCache::CacheImage(const std::string &image, CBaseTexture **texture /* = NULL */, CTextureDetails *details /* = NULL */)
@@ -199,13 +215,39 @@ bool CTextureCache::ClearCachedImage(int id)
 bool CTextureCache::GetCachedTexture(const std::string &url, CTextureDetails &details)
 {
   CSingleLock lock(m_databaseSection);
+  std::map<std::string, CTextureDetails>::const_iterator i = m_pendingTextures.find(url);
+  if (i != m_pendingTextures.end())
+  {
+    details = i->second;
+    details.hash.clear(); // just cached, so doesn't need checking
+    return true;
+  }
   return m_database.GetCachedTexture(url, details);
 }
 
 bool CTextureCache::AddCachedTexture(const std::string &url, const CTextureDetails &details)
 {
+  static const size_t count_before_update = 50;
+  // batch up the writes only while there are more images waiting to be cached
+  bool idle = QueueEmpty() && m_decodeQueue.QueueEmpty();
   CSingleLock lock(m_databaseSection);
-  return m_database.AddCachedTexture(url, details);
+  m_pendingTextures[url] = details;
+  if (idle || m_pendingTextures.size() >= count_before_update)
+    FlushCachedTextures();
+  return true;
+}
+
+void CTextureCache::FlushCachedTextures()
+{
+  if (m_pendingTextures.empty())
+    return;
+
+  m_database.BeginTransaction();
+  for (std::map<std::string, CTextureDetails>::const_iterator i = m_pendingTextures.begin(); i != m_pendingTextures.end(); ++i)
+    m_database.AddCachedTexture(i->first, i->second);
+  if (!m_database.CommitTransaction())
+    CLog::Log(LOGERROR, "%s failed adding %u textures", __FUNCTION__, (unsigned int)m_pendingTextures.size());
+  m_pendingTextures.clear();
 }
 
 void CTextureCache::IncrementUseCount(const CTextureDetails &details)
@@ -224,18 +266,21 @@ void CTextureCache::IncrementUseCount(const CTextureDetails &details)
 bool CTextureCache::SetCachedTextureValid(const std::string &url, bool updateable)
 {
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   return m_database.SetCachedTextureValid(url, updateable);
 }
 
 bool CTextureCache::ClearCachedTexture(const std::string &url, std::string &cachedURL)
 {
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   return m_database.ClearCachedTexture(url, cachedURL);
 }
 
 bool CTextureCache::ClearCachedTexture(int id, std::string &cachedURL)
 {
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   return m_database.ClearCachedTexture(id, cachedURL);
 }
 
@@ -269,13 +314,30 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
       m_processinglist.erase(i);
   }
 
+  // write out the batch of new textures once there is nothing left to cache
+  if (QueueEmpty() && m_decodeQueue.QueueEmpty())
+  {
+    CSingleLock lock(m_databaseSection);
+    FlushCachedTextures();
+  }
+
   m_completeEvent.Set();
 }
 
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   if (strcmp(job->GetType(), kJobTypeCacheImage) == 0)
-    OnCachingComplete(success, (CTextureCacheJob *)job);
+  {
+    CTextureCacheJob *cacheJob = (CTextureCacheJob *)job;
+    // hand fetched images over to the decode stage, keeping them in our processing list
+    if (success && cacheJob->GetStage() == CTextureCacheJob::STAGE_FETCH && cacheJob->NeedsDecode())
+    {
+      if (!m_decodeQueue.AddJob(cacheJob->CreateDecodeJob()))
+        OnCachingComplete(false, cacheJob);
+    }
+    else
+      OnCachingComplete(success, cacheJob);
+  }
   return CJobQueue::OnJobComplete(jobID, success, job);
 }
 
@@ -299,6 +361,18 @@ void CTextureCache::OnJobProgress(unsigned int jobID, unsigned int progress, uns
     CJobQueue::OnJobProgress(jobID, progress, total, job);
 }
 
+CTextureCache::CDecodeQueue::CDecodeQueue(CTextureCache &cache) :
+  CJobQueue(false, 1, CJob::PRIORITY_LOW),
+  m_cache(cache)
+{
+}
+
+void CTextureCache::CDecodeQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  m_cache.OnCachingComplete(success, (CTextureCacheJob *)job);
+  CJobQueue::OnJobComplete(jobID, success, job);
+}
+
 bool CTextureCache::Export(const std::string &image, const std::string &destination, bool overwrite)
 {
   CTextureDetails details;
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -39,6 +40,11 @@ class CBaseTexture;
  may be periodically checked for updates and may be purged from the cache if
  unused for a set period of time.
 
+ Background caching runs in two job queues: images are fetched (hashed and
+ read into memory) by this queue and then handed to a second queue that
+ decodes, scales and encodes them, so that slow I/O and CPU bound work overlap.
+ New textures are written to the database in batches.
+
  */
 class CTextureCache : public CJobQueue
 {
@@ -140,7 +146,8 @@ public:
   static bool CanCacheImageURL(const CURL &url);
 
   /*! \brief Add this image to the database
-   Thread-safe wrapper of CTextureDatabase::AddCachedTexture
+   Thread-safe wrapper of CTextureDatabase::AddCachedTexture. The image is added as part of a batch,
+   but is reported as cached straight away.
    \param image url of the original image
    \param details the texture details to add
    \return true if we successfully added to the database, false otherwise.
@@ -208,6 +215,12 @@ private:
    */
   bool SetCachedTextureValid(const std::string &url, bool updateable);
 
+  /*! \brief Write the textures added since the last flush to the database in a single transaction
+   Must be called with m_databaseSection held.
+   \sa AddCachedTexture
+   */
+  void FlushCachedTextures();
+
   virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
   virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
 
@@ -219,8 +232,23 @@ private:
    */
   void OnCachingComplete(bool success, CTextureCacheJob *job);
 
+  /*! \brief Job queue for the decode stage of caching
+   Passes completed jobs back to the texture cache.
+   */
+  class CDecodeQueue : public CJobQueue
+  {
+  public:
+    CDecodeQueue(CTextureCache &cache);
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+    using CJobQueue::QueueEmpty;
+  private:
+    CTextureCache &m_cache;
+  };
+
+  CDecodeQueue     m_decodeQueue;
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
+  std::map<std::string, CTextureDetails> m_pendingTextures; ///< textures not yet written to the database
   std::set<std::string> m_processinglist; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
@@ -36,10 +36,15 @@
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
-CTextureCacheJob::CTextureCacheJob(const std::string &url, const std::string &oldHash):
+CTextureCacheJob::CTextureCacheJob(const std::string &url, const std::string &oldHash, STAGE stage):
   m_url(url),
   m_oldHash(oldHash),
-  m_cachePath(CTextureCache::GetCacheFile(m_url))
+  m_cachePath(CTextureCache::GetCacheFile(m_url)),
+  m_stage(stage),
+  m_needsDecode(false),
+  m_width(0),
+  m_height(0),
+  m_scalingAlgorithm(CPictureScalingAlgorithm::NoAlgorithm)
 {
 }
 
@@ -60,6 +65,10 @@ bool CTextureCacheJob::operator==(const CJob* job) const
 
 bool CTextureCacheJob::DoWork()
 {
+  // the decode stage follows a fetch that has already been checked against the processing list
+  if (m_stage == STAGE_DECODE)
+    return DecodeTexture();
+
   if (ShouldCancel(0, 0))
     return false;
   if (ShouldCancel(1, 0)) // HACK: second check is because we cancel the job in the first callback, but we don't detect it
@@ -70,39 +79,99 @@ bool CTextureCacheJob::DoWork()
   std::string path(CTextureCache::GetInstance().CheckCachedImage(m_url, needsRecaching));
   if (!path.empty() && !needsRecaching)
     return false;
+  if (m_stage == STAGE_FETCH)
+    return FetchTexture();
   return CacheTexture();
 }
 
 bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
+{
+  if (!FetchTexture())
+    return false;
+  if (!m_needsDecode)
+    return true;
+  return DecodeTexture(out_texture);
+}
+
+bool CTextureCacheJob::FetchTexture()
 {
   // unwrap the URL as required
-  std::string additional_info;
-  unsigned int width, height;
-  CPictureScalingAlgorithm::Algorithm scalingAlgorithm;
-  std::string image = DecodeImageURL(m_url, width, height, scalingAlgorithm, additional_info);
+  m_image = DecodeImageURL(m_url, m_width, m_height, m_scalingAlgorithm, m_additionalInfo);
 
-  m_details.updateable = additional_info != "music" && UpdateableURL(image);
+  m_details.updateable = m_additionalInfo != "music" && UpdateableURL(m_image);
 
   // generate the hash
-  m_details.hash = GetImageHash(image);
+  m_details.hash = GetImageHash(m_image);
   if (m_details.hash.empty())
     return false;
-  else if (m_details.hash == m_oldHash)
+  m_needsDecode = m_details.hash != m_oldHash;
+  if (!m_needsDecode)
     return true;
 
+#if !defined(HAS_OMXPLAYER)
+  // read the image into memory so that the decode stage isn't waiting on I/O
+  if (m_additionalInfo == "music")
+  { // special case for embedded music images
+    MUSIC_INFO::EmbeddedArt art;
+    if (CMusicThumbLoader::GetEmbeddedThumb(m_image, art) && art.size)
+    {
+      m_data.allocate(art.size);
+      memcpy(m_data.get(), &art.data[0], art.size);
+      m_mimeType = art.mime;
+      return true;
+    }
+  }
+
+  // images that are loaded by path, rather than by mime type, are read by the decode stage
+  if (URIUtils::HasExtension(m_image, ".dds") ||
+      URIUtils::IsProtocol(m_image, "xbt") ||
+      URIUtils::IsProtocol(m_image, "resource"))
+    return true;
+
+  CFileItem file(m_image, false);
+  file.FillInMimeType();
+  if (!IsImage(file))
+    return false;
+  if (!file.GetMimeType().empty())
+  {
+    XFILE::CFile reader;
+    if (reader.LoadFile(m_image, m_data) > 0)
+      m_mimeType = file.GetMimeType();
+    else
+      m_data.clear();
+  }
+#endif
+  return true;
+}
+
+bool CTextureCacheJob::DecodeTexture(CBaseTexture **out_texture)
+{
+  unsigned int width = m_width;
+  unsigned int height = m_height;
+
 #if defined(HAS_OMXPLAYER)
-  if (COMXImage::CreateThumb(image, width, height, additional_info, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
+  if (COMXImage::CreateThumb(m_image, width, height, m_additionalInfo, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
   {
     m_details.width = width;
     m_details.height = height;
     m_details.file = m_cachePath + ".jpg";
     if (out_texture)
       *out_texture = LoadImage(CTextureCache::GetCachedPath(m_details.file), width, height, "" /* already flipped */);
-    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s': %p", m_oldHash.empty() ? "Caching" : "Recaching", CURL::GetRedacted(image).c_str(), m_details.file.c_str(), out_texture);
+    CLog::Log(LOGDEBUG, "Fast %s image '%s' to '%s': %p", m_oldHash.empty() ? "Caching" : "Recaching", CURL::GetRedacted(m_image).c_str(), m_details.file.c_str(), out_texture);
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
+  CBaseTexture *texture = NULL;
+  if (m_data.size())
+  {
+    texture = CBaseTexture::LoadFromFileInMemory((unsigned char *)m_data.get(), m_data.size(), m_mimeType, width, height);
+    m_data.clear();
+    // as in LoadImage(), embedded music images are never flipped
+    if (texture && m_additionalInfo == "flipped")
+      texture->SetOrientation(texture->GetOrientation() ^ 1);
+  }
+  else
+    texture = LoadImage(m_image, width, height, m_additionalInfo, true);
   if (texture)
   {
     if (texture->HasAlpha())
@@ -110,9 +179,9 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     else
       m_details.file = m_cachePath + ".jpg";
 
-    CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", CURL::GetRedacted(image).c_str(), m_details.file.c_str());
+    CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", CURL::GetRedacted(m_image).c_str(), m_details.file.c_str());
 
-    if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file), scalingAlgorithm))
+    if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file), m_scalingAlgorithm))
     {
       m_details.width = width;
       m_details.height = height;
@@ -127,6 +196,22 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
   return false;
 }
 
+CTextureCacheJob *CTextureCacheJob::CreateDecodeJob()
+{
+  CTextureCacheJob *job = new CTextureCacheJob(m_url, m_oldHash, STAGE_DECODE);
+  job->m_details = m_details;
+  job->m_needsDecode = m_needsDecode;
+  job->m_image = m_image;
+  job->m_additionalInfo = m_additionalInfo;
+  job->m_width = m_width;
+  job->m_height = m_height;
+  job->m_scalingAlgorithm = m_scalingAlgorithm;
+  job->m_mimeType = m_mimeType;
+  size_t size = m_data.size();
+  job->m_data.attach(m_data.detach(), size);
+  return job;
+}
+
 bool CTextureCacheJob::ResizeTexture(const std::string &url, uint8_t* &result, size_t &result_size)
 {
   result = NULL;
@@ -203,8 +288,7 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
   // Validate file URL to see if it is an image
   CFileItem file(image, false);
   file.FillInMimeType();
-  if (!(file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ() ))
-      && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
+  if (!IsImage(file)) // ignore non-pictures
     return NULL;
 
   CBaseTexture *texture = CBaseTexture::LoadFromFile(image, width, height, requirePixels, file.GetMimeType());
@@ -220,6 +304,13 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
   return texture;
 }
 
+bool CTextureCacheJob::IsImage(const CFileItem &file)
+{
+  return (file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ())) ||
+         StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") ||
+         StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream");
+}
+
 bool CTextureCacheJob::UpdateableURL(const std::string &url) const
 {
   // we don't constantly check online images
@@ -25,9 +25,11 @@
 #include <vector>
 
 #include "pictures/PictureScalingAlgorithm.h"
+#include "utils/auto_buffer.h"
 #include "utils/Job.h"
 
 class CBaseTexture;
+class CFileItem;
 
 /*!
  \ingroup textures
@@ -60,12 +62,22 @@ public:
  \ingroup textures
  \brief Job class for caching textures
  
- Handles loading and caching of textures.
+ Handles loading and caching of textures.  Caching may be split into two
+ stages so that they can be run in separate job queues: an I/O bound fetch
+ stage that hashes the image and reads it into memory, and a CPU bound
+ decode stage that decodes, scales and encodes the fetched image.
  */
 class CTextureCacheJob : public CJob
 {
 public:
-  CTextureCacheJob(const std::string &url, const std::string &oldHash = "");
+  enum STAGE
+  {
+    STAGE_FETCH  = 1,                       ///< hash the image and read it into memory
+    STAGE_DECODE = 2,                       ///< decode, scale and encode the fetched image
+    STAGE_ALL    = STAGE_FETCH | STAGE_DECODE
+  };
+
+  CTextureCacheJob(const std::string &url, const std::string &oldHash = "", STAGE stage = STAGE_ALL);
   virtual ~CTextureCacheJob();
 
   virtual const char* GetType() const { return kJobTypeCacheImage; };
@@ -79,6 +91,33 @@ public:
    */
   bool CacheTexture(CBaseTexture **texture = NULL);
 
+  /*! \brief Fetch the image to be cached without decoding it
+   Generates the hash of the image and, where possible, reads the image into memory.
+   \return true if the image was fetched or is unchanged, false otherwise.
+   \sa NeedsDecode, CreateDecodeJob
+   */
+  bool FetchTexture();
+
+  /*! \brief Decode, scale and encode a previously fetched image to the cache
+   \param texture [out] the loaded image, if the caller wants it.
+   \return true if the image was cached, false otherwise.
+   \sa FetchTexture
+   */
+  bool DecodeTexture(CBaseTexture **texture = NULL);
+
+  /*! \brief Whether a fetched image still has to be decoded
+   \return true if the image changed since it was last cached, false otherwise.
+   */
+  bool NeedsDecode() const { return m_needsDecode; };
+
+  /*! \brief Create the decode stage job for this fetched image
+   The new job takes over the fetched image data.
+   \return the decode job.
+   */
+  CTextureCacheJob *CreateDecodeJob();
+
+  STAGE GetStage() const { return m_stage; };
+
   static bool ResizeTexture(const std::string &url, uint8_t* &result, size_t &result_size);
 
   std::string m_url;
@@ -124,7 +163,24 @@ private:
    */
   static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
 
+  /*! \brief Check whether a given file can be loaded as an image
+   \param file the file to check, with its mime type filled in.
+   \return true if the file is an image, false otherwise.
+   */
+  static bool IsImage(const CFileItem &file);
+
   std::string    m_cachePath;
+  STAGE          m_stage;
+  bool           m_needsDecode;
+
+  // state handed from the fetch stage to the decode stage
+  std::string    m_image;
+  std::string    m_additionalInfo;
+  unsigned int   m_width;
+  unsigned int   m_height;
+  CPictureScalingAlgorithm::Algorithm m_scalingAlgorithm;
+  XUTILS::auto_buffer m_data;              ///< the image file, if it was read into memory
+  std::string    m_mimeType;               ///< mime type of m_data
 };
 
 /* \brief Job class for storing the use count of textures
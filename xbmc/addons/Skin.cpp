@@ -20,6 +20,7 @@
 
 #include "Skin.h"
 #include "AddonManager.h"
+#include "GUIInfoManager.h"
 #include "Util.h"
 #include "dialogs/GUIDialogKaiToast.h"
 // fallback for new skin resolution code
@@ -277,6 +278,37 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.ClearIncludes();
   m_includes.LoadIncludes(includesPath);
+
+  // windows resolved before can be reused as long as neither the skin nor
+  // any of the include files changed
+  std::string key = StringUtils::Format("%s-%s", ID().c_str(), Version().asString().c_str());
+  for (std::vector<std::string>::const_iterator it = m_includes.GetFiles().begin(); it != m_includes.GetFiles().end(); ++it)
+  {
+    struct __stat64 buffer;
+    if (CFile::Stat(*it, &buffer) == 0)
+      key += StringUtils::Format("|%s:%" PRId64, it->c_str(), (int64_t)buffer.st_mtime);
+  }
+  m_cache.Load(GetCacheFile(), key);
+}
+
+TiXmlElement* CSkinInfo::GetCachedWindow(const std::string &path, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  return m_cache.Get(path, xmlIncludeConditions);
+}
+
+void CSkinInfo::CacheWindow(const std::string &path, const std::string &file, const TiXmlElement &root, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  m_cache.Add(path, file, root, xmlIncludeConditions);
+}
+
+void CSkinInfo::SaveCache()
+{
+  m_cache.Save(GetCacheFile());
+}
+
+std::string CSkinInfo::GetCacheFile() const
+{
+  return URIUtils::AddFileToFolder("special://temp/", ID() + ".skincache");
 }
 
 void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions /* = NULL */)
@@ -574,6 +606,7 @@ void CSkinInfo::SetString(int setting, const std::string &label)
   if (it != m_strings.end())
   {
     it->second->value = label;
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_SKIN);
     return;
   }
 
@@ -616,6 +649,7 @@ void CSkinInfo::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second->value = set;
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_SKIN);
     return;
   }
 
@@ -631,6 +665,7 @@ void CSkinInfo::Reset(const std::string &setting)
     if (StringUtils::EqualsNoCase(setting, it.second->name))
     {
       it.second->value.clear();
+      g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_SKIN);
       return;
     }
   }
@@ -641,6 +676,7 @@ void CSkinInfo::Reset(const std::string &setting)
     if (StringUtils::EqualsNoCase(setting, it.second->name))
     {
       it.second->value = false;
+      g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_SKIN);
       return;
     }
   }
@@ -654,6 +690,8 @@ void CSkinInfo::Reset()
 
   for (auto& it : m_strings)
     it.second->value.clear();
+
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_SKIN);
 }
 
 std::set<CSkinSettingPtr> CSkinInfo::ParseSettings(const TiXmlElement* rootElement)
@@ -28,6 +28,7 @@
 #include "addons/Addon.h"
 #include "guilib/GraphicContext.h" // needed for the RESOLUTION members
 #include "guilib/GUIIncludes.h"    // needed for the GUIInclude member
+#include "guilib/GUISkinCache.h"   // needed for the GUISkinCache member
 
 #define CREDIT_LINE_LENGTH 50
 
@@ -164,6 +165,19 @@ public:
 
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
 
+  /*! \brief Get a window with its includes resolved from the skin cache
+   \sa CGUISkinCache::Get
+   */
+  TiXmlElement* GetCachedWindow(const std::string &path, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+  /*! \brief Store a window with its includes resolved in the skin cache
+   \sa CGUISkinCache::Add
+   */
+  void CacheWindow(const std::string &path, const std::string &file, const TiXmlElement &root, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+  /*! \brief Write the skin cache to disk, to be used the next time the skin is loaded */
+  void SaveCache();
+
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
   const std::vector<CStartupWindow> &GetStartupWindows() const { return m_startupWindows; };
@@ -223,6 +237,9 @@ protected:
 
   bool LoadStartupWindows(const cp_extension_t *ext);
 
+  /*! \brief Location of the skin cache */
+  std::string GetCacheFile() const;
+
   static CSkinSettingPtr ParseSetting(const TiXmlElement* element);
 
   virtual bool HasSettingsDefinition() const { return false; }
@@ -235,6 +252,7 @@ protected:
 
   float m_effectsSlowDown;
   CGUIIncludes m_includes;
+  CGUISkinCache m_cache;
   std::string m_currentAspect;
 
   std::vector<CStartupWindow> m_startupWindows;
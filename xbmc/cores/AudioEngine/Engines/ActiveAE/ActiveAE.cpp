@@ -25,6 +25,7 @@ using namespace ActiveAE;
 #include "ActiveAEStream.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -2003,6 +2004,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume for stream, one gain per frame while running per sample
+            float *gains = GetMixGains(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2018,23 +2021,18 @@ bool CActiveAE::RunStages()
                 }
               }
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
+              gains[i] = (*it)->m_volume * (*it)->m_rgain;
+            }
+            if(nb_loops > 1)
+              (*it)->m_limiter.RunFrames((float**)out->pkt->data, out->pkt->config.channels, nb_loops, out->pkt->planes > 1, gains);
 
-              for(int j=0; j<out->pkt->planes; j++)
-              {
-#ifdef __SSE__
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
+            for(int j=0; j<out->pkt->planes; j++)
+            {
+              float* fbuffer = (float*) out->pkt->data[j];
+              if(nb_loops > 1)
+                CAEMixKernels::MulFrames(fbuffer, gains, nb_floats, nb_loops);
+              else
+                CAEMixKernels::Mul(fbuffer, gains[0], nb_floats);
             }
           }
           else
@@ -2070,6 +2068,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume for stream, one gain per frame while running per sample
+            float *gains = GetMixGains(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2085,34 +2085,22 @@ bool CActiveAE::RunStages()
                 }
               }
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
+              gains[i] = (*it)->m_volume * (*it)->m_rgain;
+            }
+            if(nb_loops > 1)
+              (*it)->m_limiter.RunFrames((float**)mix->pkt->data, mix->pkt->config.channels, nb_loops, mix->pkt->planes > 1, gains);
 
-              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
-              {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#ifdef __SSE__
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
-              }
+            for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
+            {
+              float *dst = (float*)out->pkt->data[j];
+              float *src = (float*)mix->pkt->data[j];
+              float peak;
+              if(nb_loops > 1)
+                peak = CAEMixKernels::MulAddFrames(dst, src, gains, nb_floats, nb_loops);
+              else
+                peak = CAEMixKernels::MulAdd(dst, src, gains[0], nb_floats);
+              if (peak > 1.0f)
+                needClamp = true;
             }
             mix->Return();
           }
@@ -2486,12 +2474,7 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
       out = (float*)dstSample.data[j];
       sample_buffer = (float*)(it->sound->GetSound(false)->data[j]+start);
       int nb_floats = mix_samples * dstSample.config.channels / dstSample.planes;
-#ifdef __SSE__
-      CAEUtil::SSEMulAddArray(out, sample_buffer, volume, nb_floats);
-#else
-      for (int k = 0; k < nb_floats; ++k)
-        *out++ += *sample_buffer++ * volume;
-#endif
+      CAEMixKernels::MulAdd(out, sample_buffer, volume, nb_floats);
     }
 
     it->samples_played += mix_samples;
@@ -2506,6 +2489,14 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
   }
 }
 
+float* CActiveAE::GetMixGains(int frames)
+{
+  // only grows, mixing runs for every period
+  if ((int)m_mixGains.size() < std::max(frames, 1))
+    m_mixGains.resize(std::max(frames, 1));
+  return &m_mixGains[0];
+}
+
 void CActiveAE::Deamplify(CSoundPacket &dstSample)
 {
   if (m_volumeScaled < 1.0 || m_muted)
@@ -2517,13 +2508,7 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
     for(int j=0; j<dstSample.planes; j++)
     {
       buffer = (float*)dstSample.data[j];
-#ifdef __SSE__
-      CAEUtil::SSEMulArray(buffer, volume, nb_floats);
-#else
-      float *fbuffer = buffer;
-      for (int i = 0; i < nb_floats; i++)
-        *fbuffer++ *= volume;
-#endif
+      CAEMixKernels::Mul(buffer, volume, nb_floats);
     }
   }
 }
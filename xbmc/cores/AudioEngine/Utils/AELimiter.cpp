@@ -20,6 +20,7 @@
 
 #include "system.h"
 #include "AELimiter.h"
+#include "AEMixKernels.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/MathUtils.h"
 #include <algorithm>
@@ -52,6 +53,31 @@ float CAELimiter::Run(float* frame[AE_CH_MAX], int channels, int offset /*= 0*/,
     }
   }
 
+  return Envelope(highest);
+}
+
+void CAELimiter::RunFrames(float* frame[AE_CH_MAX], int channels, int frames, bool planar, float* gains)
+{
+  if (frames <= 0)
+    return;
+
+  // the peaks are independent of the envelope and are collected in one go
+  if ((int)m_peaks.size() < frames)
+    m_peaks.resize(frames);
+  if (!planar)
+    CAEMixKernels::PeakFrames(frame[0], channels, frames, &m_peaks[0], false);
+  else
+  {
+    for (int i = 0; i < channels; i++)
+      CAEMixKernels::PeakFrames(frame[i], 1, frames, &m_peaks[0], i > 0);
+  }
+
+  for (int i = 0; i < frames; i++)
+    gains[i] *= Envelope(m_peaks[i]);
+}
+
+float CAELimiter::Envelope(float highest)
+{
   float sample = highest * m_amplify;
   if (sample * m_attenuation > 1.0f)
   {
@@ -20,6 +20,7 @@
  */
 
 #include <algorithm>
+#include <vector>
 #include "AEAudioFormat.h"
 
 class CAELimiter
@@ -30,6 +31,9 @@ class CAELimiter
     float m_samplerate;
     int   m_holdcounter;
     float m_increase;
+    std::vector<float> m_peaks;
+
+    float Envelope(float highest);
 
   public:
     CAELimiter();
@@ -50,4 +54,11 @@ class CAELimiter
     }
 
     float Run(float* frame[AE_CH_MAX], int channels, int offset = 0, bool planar = false);
+
+    /*!
+     \brief Run the limiter over a block of frames.
+     Same as calling Run() for every frame, gains[i] is multiplied by the
+     result for frame i.
+     */
+    void RunFrames(float* frame[AE_CH_MAX], int channels, int frames, bool planar, float* gains);
 };
@@ -0,0 +1,719 @@
+/*
+ *      Copyright (C) 2010-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEMixKernels.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(HAS_SIMD_SSE)
+#include <immintrin.h>
+#endif
+#if defined(HAS_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+typedef void (*MulFunc)(float *data, float mul, unsigned int count);
+typedef float (*MulAddFunc)(float *dst, const float *src, float mul, unsigned int count);
+typedef void (*ClampFunc)(float *data, unsigned int count);
+typedef void (*MulFramesFunc)(float *data, const float *gains, int channels, unsigned int frames);
+typedef float (*MulAddFramesFunc)(float *dst, const float *src, const float *gains, int channels, unsigned int frames);
+typedef void (*PeakFramesFunc)(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate);
+
+struct SMixKernels
+{
+  MulFunc mul;
+  MulAddFunc mulAdd;
+  ClampFunc clamp;
+  MulFramesFunc mulFrames;
+  MulAddFramesFunc mulAddFrames;
+  PeakFramesFunc peakFrames;
+};
+
+//-----------------------------------------------------------------------------
+// C reference
+//-----------------------------------------------------------------------------
+
+void Mul_C(float *data, float mul, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    data[i] *= mul;
+}
+
+float MulAdd_C(float *dst, const float *src, float mul, unsigned int count)
+{
+  float peak = 0.0f;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    dst[i] += src[i] * mul;
+    peak = std::max(peak, fabsf(dst[i]));
+  }
+  return peak;
+}
+
+// rational approximation of tanh, reaches exactly 1 at 3
+inline float SoftClampSample(float x)
+{
+  if (x < -3.0f)
+    return -1.0f;
+  else if (x > 3.0f)
+    return 1.0f;
+  float y = x * x;
+  return x * (27.0f + y) / (27.0f + 9.0f * y);
+}
+
+void Clamp_C(float *data, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    data[i] = SoftClampSample(data[i]);
+}
+
+void MulFrames_C(float *data, const float *gains, int channels, unsigned int frames)
+{
+  for (unsigned int f = 0; f < frames; f++, data += channels)
+  {
+    float gain = gains[f];
+    for (int c = 0; c < channels; c++)
+      data[c] *= gain;
+  }
+}
+
+float MulAddFrames_C(float *dst, const float *src, const float *gains, int channels, unsigned int frames)
+{
+  float peak = 0.0f;
+  for (unsigned int f = 0; f < frames; f++, dst += channels, src += channels)
+  {
+    float gain = gains[f];
+    for (int c = 0; c < channels; c++)
+    {
+      dst[c] += src[c] * gain;
+      peak = std::max(peak, fabsf(dst[c]));
+    }
+  }
+  return peak;
+}
+
+void PeakFrames_C(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate)
+{
+  for (unsigned int f = 0; f < frames; f++, data += channels)
+  {
+    float peak = accumulate ? peaks[f] : 0.0f;
+    for (int c = 0; c < channels; c++)
+      peak = std::max(peak, fabsf(data[c]));
+    peaks[f] = peak;
+  }
+}
+
+const SMixKernels g_kernels_C = { Mul_C, MulAdd_C, Clamp_C, MulFrames_C, MulAddFrames_C, PeakFrames_C };
+
+//-----------------------------------------------------------------------------
+// SSE
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_SSE)
+SIMD_TARGET("sse")
+inline __m128 Abs_SSE(__m128 v)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+SIMD_TARGET("sse")
+inline float HMax_SSE(__m128 v)
+{
+  v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(v);
+}
+
+SIMD_TARGET("sse")
+inline __m128 SoftClamp_SSE(__m128 x)
+{
+  x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-3.0f)), _mm_set1_ps(3.0f));
+  __m128 y = _mm_mul_ps(x, x);
+  return _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(27.0f), y)),
+                    _mm_add_ps(_mm_set1_ps(27.0f), _mm_mul_ps(_mm_set1_ps(9.0f), y)));
+}
+
+SIMD_TARGET("sse")
+void Mul_SSE(float *data, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+    _mm_storeu_ps(data + i + 4, _mm_mul_ps(_mm_loadu_ps(data + i + 4), m));
+  }
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  Mul_C(data + i, mul, count - i);
+}
+
+SIMD_TARGET("sse")
+float MulAdd_SSE(float *dst, const float *src, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  __m128 peak = _mm_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 r = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), m));
+    _mm_storeu_ps(dst + i, r);
+    peak = _mm_max_ps(peak, Abs_SSE(r));
+  }
+  return std::max(HMax_SSE(peak), MulAdd_C(dst + i, src + i, mul, count - i));
+}
+
+SIMD_TARGET("sse")
+void Clamp_SSE(float *data, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, SoftClamp_SSE(_mm_loadu_ps(data + i)));
+  Clamp_C(data + i, count - i);
+}
+
+SIMD_TARGET("sse")
+void MulFrames_SSE(float *data, const float *gains, int channels, unsigned int frames)
+{
+  unsigned int f = 0;
+  if (channels == 1)
+  {
+    for (; f + 4 <= frames; f += 4)
+      _mm_storeu_ps(data + f, _mm_mul_ps(_mm_loadu_ps(data + f), _mm_loadu_ps(gains + f)));
+  }
+  else if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 g = _mm_loadu_ps(gains + f);
+      float *d = data + 2 * f;
+      _mm_storeu_ps(d, _mm_mul_ps(_mm_loadu_ps(d), _mm_unpacklo_ps(g, g)));
+      _mm_storeu_ps(d + 4, _mm_mul_ps(_mm_loadu_ps(d + 4), _mm_unpackhi_ps(g, g)));
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      __m128 g = _mm_set1_ps(gains[f]);
+      float *d = data + f * channels;
+      for (int c = 0; c < channels; c += 4)
+        _mm_storeu_ps(d + c, _mm_mul_ps(_mm_loadu_ps(d + c), g));
+    }
+  }
+  MulFrames_C(data + f * channels, gains + f, channels, frames - f);
+}
+
+SIMD_TARGET("sse")
+float MulAddFrames_SSE(float *dst, const float *src, const float *gains, int channels, unsigned int frames)
+{
+  __m128 peak = _mm_setzero_ps();
+  unsigned int f = 0;
+  if (channels == 1)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 r = _mm_add_ps(_mm_loadu_ps(dst + f), _mm_mul_ps(_mm_loadu_ps(src + f), _mm_loadu_ps(gains + f)));
+      _mm_storeu_ps(dst + f, r);
+      peak = _mm_max_ps(peak, Abs_SSE(r));
+    }
+  }
+  else if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 g = _mm_loadu_ps(gains + f);
+      float *d = dst + 2 * f;
+      const float *s = src + 2 * f;
+      __m128 r0 = _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(_mm_loadu_ps(s), _mm_unpacklo_ps(g, g)));
+      __m128 r1 = _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(_mm_loadu_ps(s + 4), _mm_unpackhi_ps(g, g)));
+      _mm_storeu_ps(d, r0);
+      _mm_storeu_ps(d + 4, r1);
+      peak = _mm_max_ps(peak, _mm_max_ps(Abs_SSE(r0), Abs_SSE(r1)));
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      __m128 g = _mm_set1_ps(gains[f]);
+      float *d = dst + f * channels;
+      const float *s = src + f * channels;
+      for (int c = 0; c < channels; c += 4)
+      {
+        __m128 r = _mm_add_ps(_mm_loadu_ps(d + c), _mm_mul_ps(_mm_loadu_ps(s + c), g));
+        _mm_storeu_ps(d + c, r);
+        peak = _mm_max_ps(peak, Abs_SSE(r));
+      }
+    }
+  }
+  return std::max(HMax_SSE(peak), MulAddFrames_C(dst + f * channels, src + f * channels,
+                                                 gains + f, channels, frames - f));
+}
+
+SIMD_TARGET("sse")
+void PeakFrames_SSE(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate)
+{
+  unsigned int f = 0;
+  if (channels == 1 || channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 p;
+      if (channels == 1)
+        p = Abs_SSE(_mm_loadu_ps(data + f));
+      else
+      {
+        // two frames per register, separate the channels and compare them
+        __m128 a = Abs_SSE(_mm_loadu_ps(data + 2 * f));
+        __m128 b = Abs_SSE(_mm_loadu_ps(data + 2 * f + 4));
+        p = _mm_max_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                       _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+      if (accumulate)
+        p = _mm_max_ps(p, _mm_loadu_ps(peaks + f));
+      _mm_storeu_ps(peaks + f, p);
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      const float *d = data + f * channels;
+      __m128 p = _mm_setzero_ps();
+      for (int c = 0; c < channels; c += 4)
+        p = _mm_max_ps(p, Abs_SSE(_mm_loadu_ps(d + c)));
+      float peak = HMax_SSE(p);
+      peaks[f] = accumulate ? std::max(peaks[f], peak) : peak;
+    }
+  }
+  PeakFrames_C(data + f * channels, channels, frames - f, peaks + f, accumulate);
+}
+
+const SMixKernels g_kernels_SSE = { Mul_SSE, MulAdd_SSE, Clamp_SSE, MulFrames_SSE, MulAddFrames_SSE, PeakFrames_SSE };
+#endif
+
+//-----------------------------------------------------------------------------
+// AVX2
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_AVX2)
+SIMD_TARGET("avx2")
+inline __m256 Abs_AVX2(__m256 v)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+SIMD_TARGET("avx2")
+inline float HMax_AVX2(__m256 v)
+{
+  return HMax_SSE(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+SIMD_TARGET("avx2")
+void Mul_AVX2(float *data, float mul, unsigned int count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+    _mm256_storeu_ps(data + i + 8, _mm256_mul_ps(_mm256_loadu_ps(data + i + 8), m));
+  }
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  Mul_C(data + i, mul, count - i);
+}
+
+SIMD_TARGET("avx2")
+float MulAdd_AVX2(float *dst, const float *src, float mul, unsigned int count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  __m256 peak = _mm256_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 r = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), m));
+    _mm256_storeu_ps(dst + i, r);
+    peak = _mm256_max_ps(peak, Abs_AVX2(r));
+  }
+  return std::max(HMax_AVX2(peak), MulAdd_C(dst + i, src + i, mul, count - i));
+}
+
+SIMD_TARGET("avx2")
+void Clamp_AVX2(float *data, unsigned int count)
+{
+  const __m256 lo = _mm256_set1_ps(-3.0f);
+  const __m256 hi = _mm256_set1_ps(3.0f);
+  const __m256 c27 = _mm256_set1_ps(27.0f);
+  const __m256 c9 = _mm256_set1_ps(9.0f);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), lo), hi);
+    __m256 y = _mm256_mul_ps(x, x);
+    _mm256_storeu_ps(data + i, _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c27, y)),
+                                             _mm256_add_ps(c27, _mm256_mul_ps(c9, y))));
+  }
+  Clamp_C(data + i, count - i);
+}
+
+SIMD_TARGET("avx2")
+void MulFrames_AVX2(float *data, const float *gains, int channels, unsigned int frames)
+{
+  if (channels == 1)
+  {
+    unsigned int f = 0;
+    for (; f + 8 <= frames; f += 8)
+      _mm256_storeu_ps(data + f, _mm256_mul_ps(_mm256_loadu_ps(data + f), _mm256_loadu_ps(gains + f)));
+    MulFrames_C(data + f, gains + f, 1, frames - f);
+  }
+  else if ((channels & 7) == 0)
+  {
+    for (unsigned int f = 0; f < frames; f++)
+    {
+      __m256 g = _mm256_set1_ps(gains[f]);
+      float *d = data + f * channels;
+      for (int c = 0; c < channels; c += 8)
+        _mm256_storeu_ps(d + c, _mm256_mul_ps(_mm256_loadu_ps(d + c), g));
+    }
+  }
+  else
+    MulFrames_SSE(data, gains, channels, frames);
+}
+
+SIMD_TARGET("avx2")
+float MulAddFrames_AVX2(float *dst, const float *src, const float *gains, int channels, unsigned int frames)
+{
+  __m256 peak = _mm256_setzero_ps();
+  if (channels == 1)
+  {
+    unsigned int f = 0;
+    for (; f + 8 <= frames; f += 8)
+    {
+      __m256 r = _mm256_add_ps(_mm256_loadu_ps(dst + f),
+                               _mm256_mul_ps(_mm256_loadu_ps(src + f), _mm256_loadu_ps(gains + f)));
+      _mm256_storeu_ps(dst + f, r);
+      peak = _mm256_max_ps(peak, Abs_AVX2(r));
+    }
+    return std::max(HMax_AVX2(peak), MulAddFrames_C(dst + f, src + f, gains + f, 1, frames - f));
+  }
+  else if ((channels & 7) == 0)
+  {
+    for (unsigned int f = 0; f < frames; f++)
+    {
+      __m256 g = _mm256_set1_ps(gains[f]);
+      float *d = dst + f * channels;
+      const float *s = src + f * channels;
+      for (int c = 0; c < channels; c += 8)
+      {
+        __m256 r = _mm256_add_ps(_mm256_loadu_ps(d + c), _mm256_mul_ps(_mm256_loadu_ps(s + c), g));
+        _mm256_storeu_ps(d + c, r);
+        peak = _mm256_max_ps(peak, Abs_AVX2(r));
+      }
+    }
+    return HMax_AVX2(peak);
+  }
+  return MulAddFrames_SSE(dst, src, gains, channels, frames);
+}
+
+SIMD_TARGET("avx2")
+void PeakFrames_AVX2(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate)
+{
+  if (channels != 1)
+  {
+    PeakFrames_SSE(data, channels, frames, peaks, accumulate);
+    return;
+  }
+
+  unsigned int f = 0;
+  for (; f + 8 <= frames; f += 8)
+  {
+    __m256 p = Abs_AVX2(_mm256_loadu_ps(data + f));
+    if (accumulate)
+      p = _mm256_max_ps(p, _mm256_loadu_ps(peaks + f));
+    _mm256_storeu_ps(peaks + f, p);
+  }
+  PeakFrames_C(data + f, 1, frames - f, peaks + f, accumulate);
+}
+
+const SMixKernels g_kernels_AVX2 = { Mul_AVX2, MulAdd_AVX2, Clamp_AVX2, MulFrames_AVX2, MulAddFrames_AVX2, PeakFrames_AVX2 };
+#endif
+
+//-----------------------------------------------------------------------------
+// NEON
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_NEON)
+inline float HMax_NEON(float32x4_t v)
+{
+#if defined(__aarch64__)
+  return vmaxvq_f32(v);
+#else
+  float32x2_t m = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpmax_f32(m, m), 0);
+#endif
+}
+
+inline float32x4_t Div_NEON(float32x4_t a, float32x4_t b)
+{
+#if defined(__aarch64__)
+  return vdivq_f32(a, b);
+#else
+  // no divide on armv7, refine the reciprocal estimate twice
+  float32x4_t r = vrecpeq_f32(b);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  return vmulq_f32(a, r);
+#endif
+}
+
+void Mul_NEON(float *data, float mul, unsigned int count)
+{
+  const float32x4_t m = vdupq_n_f32(mul);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), m));
+    vst1q_f32(data + i + 4, vmulq_f32(vld1q_f32(data + i + 4), m));
+  }
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), m));
+  Mul_C(data + i, mul, count - i);
+}
+
+float MulAdd_NEON(float *dst, const float *src, float mul, unsigned int count)
+{
+  const float32x4_t m = vdupq_n_f32(mul);
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t r = vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), m));
+    vst1q_f32(dst + i, r);
+    peak = vmaxq_f32(peak, vabsq_f32(r));
+  }
+  return std::max(HMax_NEON(peak), MulAdd_C(dst + i, src + i, mul, count - i));
+}
+
+void Clamp_NEON(float *data, unsigned int count)
+{
+  const float32x4_t lo = vdupq_n_f32(-3.0f);
+  const float32x4_t hi = vdupq_n_f32(3.0f);
+  const float32x4_t c27 = vdupq_n_f32(27.0f);
+  const float32x4_t c9 = vdupq_n_f32(9.0f);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(data + i), lo), hi);
+    float32x4_t y = vmulq_f32(x, x);
+    vst1q_f32(data + i, Div_NEON(vmulq_f32(x, vaddq_f32(c27, y)), vaddq_f32(c27, vmulq_f32(c9, y))));
+  }
+  Clamp_C(data + i, count - i);
+}
+
+void MulFrames_NEON(float *data, const float *gains, int channels, unsigned int frames)
+{
+  unsigned int f = 0;
+  if (channels == 1)
+  {
+    for (; f + 4 <= frames; f += 4)
+      vst1q_f32(data + f, vmulq_f32(vld1q_f32(data + f), vld1q_f32(gains + f)));
+  }
+  else if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      float32x4_t g = vld1q_f32(gains + f);
+      float32x4x2_t d = vld2q_f32(data + 2 * f);
+      d.val[0] = vmulq_f32(d.val[0], g);
+      d.val[1] = vmulq_f32(d.val[1], g);
+      vst2q_f32(data + 2 * f, d);
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      float32x4_t g = vdupq_n_f32(gains[f]);
+      float *d = data + f * channels;
+      for (int c = 0; c < channels; c += 4)
+        vst1q_f32(d + c, vmulq_f32(vld1q_f32(d + c), g));
+    }
+  }
+  MulFrames_C(data + f * channels, gains + f, channels, frames - f);
+}
+
+float MulAddFrames_NEON(float *dst, const float *src, const float *gains, int channels, unsigned int frames)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  unsigned int f = 0;
+  if (channels == 1)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      float32x4_t r = vaddq_f32(vld1q_f32(dst + f), vmulq_f32(vld1q_f32(src + f), vld1q_f32(gains + f)));
+      vst1q_f32(dst + f, r);
+      peak = vmaxq_f32(peak, vabsq_f32(r));
+    }
+  }
+  else if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      float32x4_t g = vld1q_f32(gains + f);
+      float32x4x2_t d = vld2q_f32(dst + 2 * f);
+      float32x4x2_t s = vld2q_f32(src + 2 * f);
+      d.val[0] = vaddq_f32(d.val[0], vmulq_f32(s.val[0], g));
+      d.val[1] = vaddq_f32(d.val[1], vmulq_f32(s.val[1], g));
+      vst2q_f32(dst + 2 * f, d);
+      peak = vmaxq_f32(peak, vmaxq_f32(vabsq_f32(d.val[0]), vabsq_f32(d.val[1])));
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      float32x4_t g = vdupq_n_f32(gains[f]);
+      float *d = dst + f * channels;
+      const float *s = src + f * channels;
+      for (int c = 0; c < channels; c += 4)
+      {
+        float32x4_t r = vaddq_f32(vld1q_f32(d + c), vmulq_f32(vld1q_f32(s + c), g));
+        vst1q_f32(d + c, r);
+        peak = vmaxq_f32(peak, vabsq_f32(r));
+      }
+    }
+  }
+  return std::max(HMax_NEON(peak), MulAddFrames_C(dst + f * channels, src + f * channels,
+                                                  gains + f, channels, frames - f));
+}
+
+void PeakFrames_NEON(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate)
+{
+  unsigned int f = 0;
+  if (channels == 1 || channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4)
+    {
+      float32x4_t p;
+      if (channels == 1)
+        p = vabsq_f32(vld1q_f32(data + f));
+      else
+      {
+        float32x4x2_t d = vld2q_f32(data + 2 * f);
+        p = vmaxq_f32(vabsq_f32(d.val[0]), vabsq_f32(d.val[1]));
+      }
+      if (accumulate)
+        p = vmaxq_f32(p, vld1q_f32(peaks + f));
+      vst1q_f32(peaks + f, p);
+    }
+  }
+  else if ((channels & 3) == 0)
+  {
+    for (; f < frames; f++)
+    {
+      const float *d = data + f * channels;
+      float32x4_t p = vdupq_n_f32(0.0f);
+      for (int c = 0; c < channels; c += 4)
+        p = vmaxq_f32(p, vabsq_f32(vld1q_f32(d + c)));
+      float peak = HMax_NEON(p);
+      peaks[f] = accumulate ? std::max(peaks[f], peak) : peak;
+    }
+  }
+  PeakFrames_C(data + f * channels, channels, frames - f, peaks + f, accumulate);
+}
+
+const SMixKernels g_kernels_NEON = { Mul_NEON, MulAdd_NEON, Clamp_NEON, MulFrames_NEON, MulAddFrames_NEON, PeakFrames_NEON };
+#endif
+
+CSIMDDispatch g_dispatch(CSIMDKernels::IMPL_SSE);
+
+const SMixKernels& GetKernels()
+{
+  switch (g_dispatch.Get())
+  {
+#if defined(HAS_SIMD_SSE)
+  case CAEMixKernels::IMPL_SSE:
+    return g_kernels_SSE;
+#endif
+#if defined(HAS_SIMD_AVX2)
+  case CAEMixKernels::IMPL_AVX2:
+    return g_kernels_AVX2;
+#endif
+#if defined(HAS_SIMD_NEON)
+  case CAEMixKernels::IMPL_NEON:
+    return g_kernels_NEON;
+#endif
+  default:
+    return g_kernels_C;
+  }
+}
+
+}
+
+void CAEMixKernels::Mul(float *data, float mul, unsigned int count)
+{
+  GetKernels().mul(data, mul, count);
+}
+
+float CAEMixKernels::MulAdd(float *dst, const float *src, float mul, unsigned int count)
+{
+  return GetKernels().mulAdd(dst, src, mul, count);
+}
+
+void CAEMixKernels::SoftClamp(float *data, unsigned int count)
+{
+  GetKernels().clamp(data, count);
+}
+
+void CAEMixKernels::MulFrames(float *data, const float *gains, int channels, unsigned int frames)
+{
+  GetKernels().mulFrames(data, gains, channels, frames);
+}
+
+float CAEMixKernels::MulAddFrames(float *dst, const float *src, const float *gains, int channels, unsigned int frames)
+{
+  return GetKernels().mulAddFrames(dst, src, gains, channels, frames);
+}
+
+void CAEMixKernels::PeakFrames(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate)
+{
+  GetKernels().peakFrames(data, channels, frames, peaks, accumulate);
+}
+
+CAEMixKernels::Implementation CAEMixKernels::GetImplementation()
+{
+  return g_dispatch.Get();
+}
+
+bool CAEMixKernels::SetImplementation(Implementation impl)
+{
+  return g_dispatch.Set(impl);
+}
+
+CAEMixKernels::Implementation CAEMixKernels::GetBestImplementation()
+{
+  return g_dispatch.GetBest();
+}
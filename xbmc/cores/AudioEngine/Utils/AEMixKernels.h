@@ -0,0 +1,78 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/SIMDKernels.h"
+
+/*!
+ \brief Float sample kernels for mixing, volume and clamping in ActiveAE.
+
+ Every kernel has a plain C implementation which serves as the reference,
+ and vectorised versions which are picked at runtime from the features
+ reported by CCPUInfo. Buffers need no particular alignment.
+
+ The frame kernels take one gain per frame of interleaved samples, for
+ planar buffers they are called per plane with channels = 1.
+ */
+class CAEMixKernels : public CSIMDKernels
+{
+public:
+
+  /*! \brief data[i] *= mul */
+  static void Mul(float *data, float mul, unsigned int count);
+
+  /*!
+   \brief dst[i] += src[i] * mul
+   \return the highest absolute value in dst afterwards
+   */
+  static float MulAdd(float *dst, const float *src, float mul, unsigned int count);
+
+  /*! \brief Soft clip samples to [-1, 1], see CAEUtil::SoftClamp */
+  static void SoftClamp(float *data, unsigned int count);
+
+  /*! \brief Multiply every sample of frame i by gains[i] */
+  static void MulFrames(float *data, const float *gains, int channels, unsigned int frames);
+
+  /*!
+   \brief Add every sample of frame i of src multiplied by gains[i] to dst.
+   \return the highest absolute value in dst afterwards
+   */
+  static float MulAddFrames(float *dst, const float *src, const float *gains, int channels, unsigned int frames);
+
+  /*!
+   \brief Highest absolute sample of every frame.
+   \param data interleaved samples, or a single plane with channels = 1
+   \param accumulate combine with the values already in peaks, used to
+                     collect the peaks of several planes
+   */
+  static void PeakFrames(const float *data, int channels, unsigned int frames, float *peaks, bool accumulate);
+
+  /*! \brief The implementation currently used by the kernels */
+  static Implementation GetImplementation();
+
+  /*!
+   \brief Force an implementation, for testing and benchmarking.
+   \return false if the cpu or the build does not support it
+   */
+  static bool SetImplementation(Implementation impl);
+
+  /*! \brief Best implementation supported by this cpu */
+  static Implementation GetBestImplementation();
+};
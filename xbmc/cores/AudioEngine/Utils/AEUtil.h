@@ -142,8 +142,6 @@ private:
     static __m128i m_sseSeed;
   #endif
 
-  static float SoftClamp(const float x);
-
 public:
   static CAEChannelInfo          GuessChLayout     (const unsigned int channels);
   static const char*             GetStdChLayoutName(const enum AEStdChLayout layout);
@@ -211,10 +209,7 @@ public:
     return 20*log10(scale);
   }
 
-  #ifdef __SSE__
-  static void SSEMulArray     (float *data, const float mul, uint32_t count);
-  static void SSEMulAddArray  (float *data, float *add, const float mul, uint32_t count);
-  #endif
+  /*! \brief soft clip samples to [-1, 1], see CAEMixKernels for the multiply and mix kernels */
   static void ClampArray(float *data, uint32_t count);
 
   /*
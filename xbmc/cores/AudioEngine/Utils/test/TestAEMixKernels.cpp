@@ -0,0 +1,278 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEMixKernels.h"
+#include "cores/AudioEngine/Utils/AELimiter.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const CAEMixKernels::Implementation implementations[] =
+{
+  CAEMixKernels::IMPL_SSE,
+  CAEMixKernels::IMPL_AVX2,
+  CAEMixKernels::IMPL_NEON
+};
+
+void Fill(std::vector<float> &buf, unsigned int seed, float range)
+{
+  srand(seed);
+  for (size_t i = 0; i < buf.size(); i++)
+    buf[i] = range * ((float)rand() / RAND_MAX * 2.0f - 1.0f);
+}
+
+::testing::AssertionResult Near(const std::vector<float> &ref, const std::vector<float> &res)
+{
+  for (size_t i = 0; i < ref.size(); i++)
+  {
+    // armv7 has no vector divide, the clamp uses a refined reciprocal
+    if (fabsf(ref[i] - res[i]) > 1e-6f * std::max(1.0f, fabsf(ref[i])))
+      return ::testing::AssertionFailure() << "sample " << i << ": " << ref[i] << " != " << res[i];
+  }
+  return ::testing::AssertionSuccess();
+}
+
+struct SResult
+{
+  std::vector<float> mul, mulAdd, clamp, mulFrames, mulAddFrames, peaks;
+  float mulAddPeak;
+  float mulAddFramesPeak;
+};
+
+void RunKernels(int channels, unsigned int frames, SResult &r)
+{
+  unsigned int count = channels * frames;
+  std::vector<float> src(count), gains(frames);
+  Fill(src, count, 1.0f);
+  Fill(gains, frames, 2.0f);
+
+  r.mul.resize(count);
+  Fill(r.mul, count + 1, 1.0f);
+  CAEMixKernels::Mul(&r.mul[0], 0.7f, count);
+
+  r.mulAdd.resize(count);
+  Fill(r.mulAdd, count + 2, 1.0f);
+  r.mulAddPeak = CAEMixKernels::MulAdd(&r.mulAdd[0], &src[0], 0.9f, count);
+
+  r.clamp.resize(count);
+  Fill(r.clamp, count + 3, 4.0f);
+  CAEMixKernels::SoftClamp(&r.clamp[0], count);
+
+  r.mulFrames.resize(count);
+  Fill(r.mulFrames, count + 4, 1.0f);
+  CAEMixKernels::MulFrames(&r.mulFrames[0], &gains[0], channels, frames);
+
+  r.mulAddFrames.resize(count);
+  Fill(r.mulAddFrames, count + 5, 1.0f);
+  r.mulAddFramesPeak = CAEMixKernels::MulAddFrames(&r.mulAddFrames[0], &src[0], &gains[0], channels, frames);
+
+  // a second pass accumulates like the planes of a planar buffer
+  r.peaks.resize(frames);
+  CAEMixKernels::PeakFrames(&src[0], channels, frames, &r.peaks[0], false);
+  CAEMixKernels::PeakFrames(&r.mulFrames[0], channels, frames, &r.peaks[0], true);
+}
+
+void RunMixPath(int seconds)
+{
+  // the per sample mixing path of ActiveAE: two streams with fading or
+  // limiter gains, a gui sound and the master volume, in 10ms periods
+  const int layouts[] = { 2, 6, 8 };
+  const int rates[] = { 48000, 192000 };
+
+  for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++)
+  {
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+      for (int planar = 0; planar < 2; planar++)
+      {
+        int channels = layouts[l];
+        int frames = rates[r] / 100;
+        int planes = planar ? channels : 1;
+        int width = planar ? 1 : channels;
+
+        // buffers laid out like a CSoundPacket
+        std::vector<float> out(channels * frames), mix(channels * frames), sound(channels * frames);
+        std::vector<float> outSrc(channels * frames), mixSrc(channels * frames);
+        Fill(outSrc, 1, 0.8f);
+        Fill(mixSrc, 2, 0.8f);
+        Fill(sound, 3, 0.5f);
+        std::vector<float*> outPlanes(AE_CH_MAX), mixPlanes(AE_CH_MAX);
+        for (int p = 0; p < planes; p++)
+        {
+          outPlanes[p] = &out[p * frames];
+          mixPlanes[p] = &mix[p * frames];
+        }
+        std::vector<float> gains(frames);
+        CAELimiter limiter;
+        limiter.SetSamplerate(rates[r]);
+
+        for (int period = 0; period < seconds * 100; period++)
+        {
+          out = outSrc;
+          mix = mixSrc;
+
+          for (int f = 0; f < frames; f++)
+            gains[f] = 0.9f;
+          limiter.RunFrames(&outPlanes[0], channels, frames, planar != 0, &gains[0]);
+          for (int p = 0; p < planes; p++)
+            CAEMixKernels::MulFrames(outPlanes[p], &gains[0], width, frames);
+
+          for (int f = 0; f < frames; f++)
+            gains[f] = 0.5f + (float)f / frames;
+          limiter.RunFrames(&mixPlanes[0], channels, frames, planar != 0, &gains[0]);
+          float peak = 0.0f;
+          for (int p = 0; p < planes; p++)
+            peak = std::max(peak, CAEMixKernels::MulAddFrames(outPlanes[p], mixPlanes[p], &gains[0], width, frames));
+          if (peak > 1.0f)
+          {
+            for (int p = 0; p < planes; p++)
+              CAEMixKernels::SoftClamp(outPlanes[p], frames * width);
+          }
+
+          for (int p = 0; p < planes; p++)
+          {
+            CAEMixKernels::MulAdd(outPlanes[p], &sound[p * frames], 0.3f, frames * width);
+            CAEMixKernels::Mul(outPlanes[p], 0.8f, frames * width);
+          }
+        }
+      }
+    }
+  }
+}
+
+}
+
+class TestAEMixKernels : public testing::Test
+{
+protected:
+  TestAEMixKernels()
+  {
+    m_default = CAEMixKernels::GetImplementation();
+  }
+
+  ~TestAEMixKernels()
+  {
+    CAEMixKernels::SetImplementation(m_default);
+  }
+
+  CAEMixKernels::Implementation m_default;
+};
+
+TEST_F(TestAEMixKernels, Reference)
+{
+  ASSERT_TRUE(CAEMixKernels::SetImplementation(CAEMixKernels::IMPL_C));
+
+  float data[4] = { 0.5f, -4.0f, 3.0f, 1.0f };
+  CAEMixKernels::SoftClamp(data, 4);
+  EXPECT_FLOAT_EQ(0.5f * 27.25f / 29.25f, data[0]);
+  EXPECT_EQ(-1.0f, data[1]);
+  EXPECT_EQ(1.0f, data[2]);
+  EXPECT_FLOAT_EQ(28.0f / 36.0f, data[3]);
+
+  // stereo frames, one gain each
+  float frames[4] = { 1.0f, -1.0f, 0.5f, 0.25f };
+  const float gains[2] = { 2.0f, -4.0f };
+  float add[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  EXPECT_EQ(2.0f, CAEMixKernels::MulAddFrames(add, frames, gains, 2, 2));
+  EXPECT_EQ(-2.0f, add[1]);
+  EXPECT_EQ(-2.0f, add[2]);
+  EXPECT_EQ(-1.0f, add[3]);
+
+  float peaks[2];
+  CAEMixKernels::PeakFrames(frames, 2, 2, peaks, false);
+  EXPECT_EQ(1.0f, peaks[0]);
+  EXPECT_EQ(0.5f, peaks[1]);
+}
+
+TEST_F(TestAEMixKernels, MatchesReference)
+{
+  // mono covers planar buffers, the others interleaved layouts incl. 5.1 and 7.1
+  const int channels[] = { 1, 2, 3, 4, 6, 8 };
+  const unsigned int frames[] = { 1, 3, 7, 33, 1024 };
+
+  for (size_t c = 0; c < sizeof(channels) / sizeof(channels[0]); c++)
+  {
+    for (size_t f = 0; f < sizeof(frames) / sizeof(frames[0]); f++)
+    {
+      SResult ref;
+      CAEMixKernels::SetImplementation(CAEMixKernels::IMPL_C);
+      RunKernels(channels[c], frames[f], ref);
+
+      for (size_t i = 0; i < sizeof(implementations) / sizeof(implementations[0]); i++)
+      {
+        if (!CAEMixKernels::SetImplementation(implementations[i]))
+          continue;
+
+        SCOPED_TRACE(CAEMixKernels::GetImplementationName(implementations[i]));
+        SCOPED_TRACE(::testing::Message() << channels[c] << " channels, " << frames[f] << " frames");
+        SResult res;
+        RunKernels(channels[c], frames[f], res);
+        EXPECT_TRUE(Near(ref.mul, res.mul));
+        EXPECT_TRUE(Near(ref.mulAdd, res.mulAdd));
+        EXPECT_TRUE(Near(ref.clamp, res.clamp));
+        EXPECT_TRUE(Near(ref.mulFrames, res.mulFrames));
+        EXPECT_TRUE(Near(ref.mulAddFrames, res.mulAddFrames));
+        EXPECT_TRUE(Near(ref.peaks, res.peaks));
+        EXPECT_FLOAT_EQ(ref.mulAddPeak, res.mulAddPeak);
+        EXPECT_FLOAT_EQ(ref.mulAddFramesPeak, res.mulAddFramesPeak);
+      }
+    }
+  }
+}
+
+TEST_F(TestAEMixKernels, Limiter)
+{
+  // the block version must follow the same envelope as the per frame one
+  const int channels = 6;
+  const int frames = 4800;
+  std::vector<float> data(channels * frames);
+  Fill(data, 1, 1.5f);
+
+  CAELimiter single, block;
+  single.SetAmplification(2.0f);
+  block.SetAmplification(2.0f);
+
+  std::vector<float> gains(frames, 0.5f);
+  float *planes[AE_CH_MAX] = { &data[0] };
+  block.RunFrames(planes, channels, frames, false, &gains[0]);
+  for (int i = 0; i < frames; i++)
+    EXPECT_FLOAT_EQ(0.5f * single.Run(planes, channels, i * channels, false), gains[i]) << "frame " << i;
+}
+
+// ten seconds of the ActiveAE mixing path in 2.0, 5.1 and 7.1 at 48 and 192 kHz,
+// with the C kernels and with the best ones for this cpu
+TEST_F(TestAEMixKernels, DISABLED_BenchmarkC)
+{
+  CAEMixKernels::SetImplementation(CAEMixKernels::IMPL_C);
+  RunMixPath(10);
+}
+
+TEST_F(TestAEMixKernels, DISABLED_BenchmarkBest)
+{
+  CAEMixKernels::SetImplementation(CAEMixKernels::GetBestImplementation());
+  RunMixPath(10);
+}
@@ -0,0 +1,563 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDPictureKernels.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/CPUInfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string.h>
+#include <vector>
+
+#if defined(HAS_SIMD_SSE)
+#include <immintrin.h>
+#endif
+#if defined(HAS_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+typedef void (*InterleaveRowFunc)(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width);
+typedef void (*PackRowFunc)(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width, bool uyvy);
+typedef void (*ShiftRowFunc)(uint16_t *dst, const uint16_t *src, int width, int shift);
+
+struct SPictureKernels
+{
+  InterleaveRowFunc interleave;
+  PackRowFunc pack;
+  ShiftRowFunc shift;
+};
+
+//-----------------------------------------------------------------------------
+// C reference
+//-----------------------------------------------------------------------------
+
+void InterleaveRow_C(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  for (int x = 0; x < width; x++)
+  {
+    *dst++ = u[x];
+    *dst++ = v[x];
+  }
+}
+
+void PackRow_C(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width, bool uyvy)
+{
+  int x = 0;
+  if (uyvy)
+  {
+    for (; x + 1 < width; x += 2)
+    {
+      *dst++ = u[x >> 1];
+      *dst++ = y[x];
+      *dst++ = v[x >> 1];
+      *dst++ = y[x + 1];
+    }
+    // odd width, there is only room for half a macropixel
+    if (x < width)
+    {
+      *dst++ = u[x >> 1];
+      *dst++ = y[x];
+    }
+  }
+  else
+  {
+    for (; x + 1 < width; x += 2)
+    {
+      *dst++ = y[x];
+      *dst++ = u[x >> 1];
+      *dst++ = y[x + 1];
+      *dst++ = v[x >> 1];
+    }
+    if (x < width)
+    {
+      *dst++ = y[x];
+      *dst++ = u[x >> 1];
+    }
+  }
+}
+
+void ShiftRow_C(uint16_t *dst, const uint16_t *src, int width, int shift)
+{
+  for (int x = 0; x < width; x++)
+    dst[x] = (uint16_t)(src[x] << shift);
+}
+
+const SPictureKernels g_kernels_C = { InterleaveRow_C, PackRow_C, ShiftRow_C };
+
+//-----------------------------------------------------------------------------
+// SSE2
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_SSE2)
+SIMD_TARGET("sse2")
+void InterleaveRow_SSE2(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i mu = _mm_loadu_si128((const __m128i*)(u + x));
+    __m128i mv = _mm_loadu_si128((const __m128i*)(v + x));
+    _mm_storeu_si128((__m128i*)(dst + 2 * x), _mm_unpacklo_epi8(mu, mv));
+    _mm_storeu_si128((__m128i*)(dst + 2 * x + 16), _mm_unpackhi_epi8(mu, mv));
+  }
+  InterleaveRow_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+SIMD_TARGET("sse2")
+void PackRow_SSE2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width, bool uyvy)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i my = _mm_loadu_si128((const __m128i*)(y + x));
+    __m128i mu = _mm_loadl_epi64((const __m128i*)(u + (x >> 1)));
+    __m128i mv = _mm_loadl_epi64((const __m128i*)(v + (x >> 1)));
+    __m128i muv = _mm_unpacklo_epi8(mu, mv);
+    __m128i lo, hi;
+    if (uyvy)
+    {
+      lo = _mm_unpacklo_epi8(muv, my);
+      hi = _mm_unpackhi_epi8(muv, my);
+    }
+    else
+    {
+      lo = _mm_unpacklo_epi8(my, muv);
+      hi = _mm_unpackhi_epi8(my, muv);
+    }
+    _mm_storeu_si128((__m128i*)(dst + 2 * x), lo);
+    _mm_storeu_si128((__m128i*)(dst + 2 * x + 16), hi);
+  }
+  PackRow_C(dst + 2 * x, y + x, u + (x >> 1), v + (x >> 1), width - x, uyvy);
+}
+
+SIMD_TARGET("sse2")
+void ShiftRow_SSE2(uint16_t *dst, const uint16_t *src, int width, int shift)
+{
+  __m128i count = _mm_cvtsi32_si128(shift);
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i*)(src + x));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src + x + 8));
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_sll_epi16(a, count));
+    _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_sll_epi16(b, count));
+  }
+  ShiftRow_C(dst + x, src + x, width - x, shift);
+}
+
+const SPictureKernels g_kernels_SSE2 = { InterleaveRow_SSE2, PackRow_SSE2, ShiftRow_SSE2 };
+#endif
+
+//-----------------------------------------------------------------------------
+// AVX2
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_AVX2)
+SIMD_TARGET("avx2")
+void InterleaveRow_AVX2(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m256i mu = _mm256_loadu_si256((const __m256i*)(u + x));
+    __m256i mv = _mm256_loadu_si256((const __m256i*)(v + x));
+    // unpack works per 128 bit lane, put the lanes back in order
+    __m256i lo = _mm256_unpacklo_epi8(mu, mv);
+    __m256i hi = _mm256_unpackhi_epi8(mu, mv);
+    _mm256_storeu_si256((__m256i*)(dst + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  InterleaveRow_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+SIMD_TARGET("avx2")
+void PackRow_AVX2(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width, bool uyvy)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m256i my = _mm256_loadu_si256((const __m256i*)(y + x));
+    __m128i mu = _mm_loadu_si128((const __m128i*)(u + (x >> 1)));
+    __m128i mv = _mm_loadu_si128((const __m128i*)(v + (x >> 1)));
+    __m256i muv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(mu, mv)),
+                                          _mm_unpackhi_epi8(mu, mv), 1);
+    __m256i lo, hi;
+    if (uyvy)
+    {
+      lo = _mm256_unpacklo_epi8(muv, my);
+      hi = _mm256_unpackhi_epi8(muv, my);
+    }
+    else
+    {
+      lo = _mm256_unpacklo_epi8(my, muv);
+      hi = _mm256_unpackhi_epi8(my, muv);
+    }
+    _mm256_storeu_si256((__m256i*)(dst + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  PackRow_C(dst + 2 * x, y + x, u + (x >> 1), v + (x >> 1), width - x, uyvy);
+}
+
+SIMD_TARGET("avx2")
+void ShiftRow_AVX2(uint16_t *dst, const uint16_t *src, int width, int shift)
+{
+  __m128i count = _mm_cvtsi32_si128(shift);
+  int x = 0;
+  for (; x + 32 <= width; x += 32)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src + x));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src + x + 16));
+    _mm256_storeu_si256((__m256i*)(dst + x), _mm256_sll_epi16(a, count));
+    _mm256_storeu_si256((__m256i*)(dst + x + 16), _mm256_sll_epi16(b, count));
+  }
+  ShiftRow_C(dst + x, src + x, width - x, shift);
+}
+
+const SPictureKernels g_kernels_AVX2 = { InterleaveRow_AVX2, PackRow_AVX2, ShiftRow_AVX2 };
+#endif
+
+//-----------------------------------------------------------------------------
+// NEON
+//-----------------------------------------------------------------------------
+
+#if defined(HAS_SIMD_NEON)
+void InterleaveRow_NEON(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    uint8x16x2_t uv;
+    uv.val[0] = vld1q_u8(u + x);
+    uv.val[1] = vld1q_u8(v + x);
+    vst2q_u8(dst + 2 * x, uv);
+  }
+  InterleaveRow_C(dst + 2 * x, u + x, v + x, width - x);
+}
+
+void PackRow_NEON(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width, bool uyvy)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    // val[0] holds the even, val[1] the odd luma samples
+    uint8x8x2_t my = vld2_u8(y + x);
+    uint8x8_t mu = vld1_u8(u + (x >> 1));
+    uint8x8_t mv = vld1_u8(v + (x >> 1));
+    uint8x8x4_t out;
+    if (uyvy)
+    {
+      out.val[0] = mu;
+      out.val[1] = my.val[0];
+      out.val[2] = mv;
+      out.val[3] = my.val[1];
+    }
+    else
+    {
+      out.val[0] = my.val[0];
+      out.val[1] = mu;
+      out.val[2] = my.val[1];
+      out.val[3] = mv;
+    }
+    vst4_u8(dst + 2 * x, out);
+  }
+  PackRow_C(dst + 2 * x, y + x, u + (x >> 1), v + (x >> 1), width - x, uyvy);
+}
+
+void ShiftRow_NEON(uint16_t *dst, const uint16_t *src, int width, int shift)
+{
+  int16x8_t count = vdupq_n_s16((int16_t)shift);
+  int x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    vst1q_u16(dst + x, vshlq_u16(vld1q_u16(src + x), count));
+    vst1q_u16(dst + x + 8, vshlq_u16(vld1q_u16(src + x + 8), count));
+  }
+  ShiftRow_C(dst + x, src + x, width - x, shift);
+}
+
+const SPictureKernels g_kernels_NEON = { InterleaveRow_NEON, PackRow_NEON, ShiftRow_NEON };
+#endif
+
+CSIMDDispatch g_dispatch(CSIMDKernels::IMPL_SSE2);
+std::atomic<bool> g_slicing(true);
+
+const SPictureKernels& GetKernels()
+{
+  switch (g_dispatch.Get())
+  {
+#if defined(HAS_SIMD_SSE2)
+  case CDVDPictureKernels::IMPL_SSE2:
+    return g_kernels_SSE2;
+#endif
+#if defined(HAS_SIMD_AVX2)
+  case CDVDPictureKernels::IMPL_AVX2:
+    return g_kernels_AVX2;
+#endif
+#if defined(HAS_SIMD_NEON)
+  case CDVDPictureKernels::IMPL_NEON:
+    return g_kernels_NEON;
+#endif
+  default:
+    return g_kernels_C;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// slices
+//-----------------------------------------------------------------------------
+
+typedef std::function<void(int, int)> SliceFunc;
+
+class CPictureSlicePool;
+
+class CPictureSliceWorker : public CThread
+{
+public:
+  CPictureSliceWorker(CPictureSlicePool &pool)
+    : CThread("PictureSlice")
+    , m_pool(pool)
+    , m_begin(0)
+    , m_end(0)
+  {
+  }
+
+  void Start(int begin, int end)
+  {
+    m_begin = begin;
+    m_end = end;
+    m_start.Set();
+  }
+
+protected:
+  void Process() override;
+
+  CPictureSlicePool &m_pool;
+  CEvent m_start;
+  int m_begin;
+  int m_end;
+};
+
+class CPictureSlicePool
+{
+public:
+  static CPictureSlicePool& Get()
+  {
+    static CPictureSlicePool pool;
+    return pool;
+  }
+
+  ~CPictureSlicePool()
+  {
+    for (std::vector<CPictureSliceWorker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+      (*it)->StopThread();
+      delete *it;
+    }
+  }
+
+  /*!
+   \brief Run func over [0, rows) split into slices, one per worker and one
+   on the calling thread. Slice boundaries are multiples of align.
+   Falls back to running the whole range on the calling thread when the pool
+   is already busy with another picture.
+   */
+  void Run(int rows, int align, const SliceFunc &func)
+  {
+    CSingleTryLock lock(m_section);
+    int count = std::min((int)m_workers.size() + 1, rows / (align * 16));
+    if (!lock.IsOwner() || count < 2)
+    {
+      func(0, rows);
+      return;
+    }
+
+    int slice = (rows / count + align - 1) / align * align;
+    m_func = &func;
+
+    int workers = 0;
+    for (int begin = slice; begin < rows; begin += slice)
+      workers++;
+    if (workers == 0)
+    {
+      func(0, rows);
+      return;
+    }
+    m_pending = workers;
+
+    int begin = slice;
+    for (int i = 0; i < workers; i++, begin += slice)
+      m_workers[i]->Start(begin, std::min(begin + slice, rows));
+
+    func(0, slice);
+
+    m_done.Wait();
+    m_func = NULL;
+  }
+
+  void RunSlice(int begin, int end)
+  {
+    (*m_func)(begin, end);
+    if (--m_pending == 0)
+      m_done.Set();
+  }
+
+private:
+  CPictureSlicePool()
+    : m_func(NULL)
+    , m_pending(0)
+  {
+    int threads = std::min(g_cpuInfo.getCPUCount(), 4) - 1;
+    for (int i = 0; i < threads; i++)
+    {
+      CPictureSliceWorker *worker = new CPictureSliceWorker(*this);
+      worker->Create();
+      m_workers.push_back(worker);
+    }
+  }
+
+  CCriticalSection m_section;
+  std::vector<CPictureSliceWorker*> m_workers;
+  const SliceFunc *m_func;
+  std::atomic<int> m_pending;
+  CEvent m_done;
+};
+
+void CPictureSliceWorker::Process()
+{
+  while (!m_bStop)
+  {
+    if (AbortableWait(m_start) != WAIT_SIGNALED)
+      break;
+    m_pool.RunSlice(m_begin, m_end);
+  }
+}
+
+void RunSliced(int width, int height, int align, const SliceFunc &func)
+{
+  if (g_slicing && width * height >= CDVDPictureKernels::SLICE_THRESHOLD)
+    CPictureSlicePool::Get().Run(height, align, func);
+  else
+    func(0, height);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+// CDVDPictureKernels
+//-----------------------------------------------------------------------------
+
+void CDVDPictureKernels::CopyPlane(uint8_t *dst, int dstStride,
+                                   const uint8_t *src, int srcStride,
+                                   int width, int height)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  // memcpy is already vectorised and dispatched at runtime by the c library,
+  // so the gain here comes from splitting large planes across cores
+  RunSliced(width, height, 1, [=](int begin, int end)
+  {
+    if (width == srcStride && width == dstStride)
+    {
+      memcpy(dst + begin * dstStride, src + begin * srcStride, (size_t)width * (end - begin));
+      return;
+    }
+    for (int y = begin; y < end; y++)
+      memcpy(dst + y * dstStride, src + y * srcStride, width);
+  });
+}
+
+void CDVDPictureKernels::InterleaveUV(uint8_t *dst, int dstStride,
+                                      const uint8_t *srcU, int strideU,
+                                      const uint8_t *srcV, int strideV,
+                                      int width, int height)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  InterleaveRowFunc row = GetKernels().interleave;
+  // chroma planes are a quarter of the frame
+  RunSliced(width * 4, height, 1, [=](int begin, int end)
+  {
+    for (int y = begin; y < end; y++)
+      row(dst + y * dstStride, srcU + y * strideU, srcV + y * strideV, width);
+  });
+}
+
+void CDVDPictureKernels::PackYUV422(uint8_t *dst, int dstStride,
+                                    const uint8_t *srcY, int strideY,
+                                    const uint8_t *srcU, int strideU,
+                                    const uint8_t *srcV, int strideV,
+                                    int width, int height, bool uyvy)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  PackRowFunc row = GetKernels().pack;
+  // slices start on even rows so each chroma row is used by one slice only
+  RunSliced(width, height, 2, [=](int begin, int end)
+  {
+    for (int y = begin; y < end; y++)
+      row(dst + y * dstStride, srcY + y * strideY,
+          srcU + (y >> 1) * strideU, srcV + (y >> 1) * strideV, width, uyvy);
+  });
+}
+
+void CDVDPictureKernels::ShiftPlane16(uint8_t *dst, int dstStride,
+                                      const uint8_t *src, int srcStride,
+                                      int width, int height, int shift)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  ShiftRowFunc row = GetKernels().shift;
+  RunSliced(width, height, 1, [=](int begin, int end)
+  {
+    for (int y = begin; y < end; y++)
+      row((uint16_t*)(dst + y * dstStride), (const uint16_t*)(src + y * srcStride), width, shift);
+  });
+}
+
+CDVDPictureKernels::Implementation CDVDPictureKernels::GetImplementation()
+{
+  return g_dispatch.Get();
+}
+
+bool CDVDPictureKernels::SetImplementation(Implementation impl)
+{
+  return g_dispatch.Set(impl);
+}
+
+CDVDPictureKernels::Implementation CDVDPictureKernels::GetBestImplementation()
+{
+  return g_dispatch.GetBest();
+}
+
+void CDVDPictureKernels::SetSlicing(bool enable)
+{
+  g_slicing = enable;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/SIMDKernels.h"
+
+#include <stdint.h>
+
+/*!
+ \brief Plane copy and pixel format conversion kernels used by CDVDCodecUtils.
+
+ Every kernel has a plain C implementation which serves as the reference,
+ and vectorised versions which are picked at runtime from the features
+ reported by CCPUInfo. Strides are in bytes. Frames larger than
+ SLICE_THRESHOLD pixels are split into row slices and processed on a small
+ pool of worker threads.
+ */
+class CDVDPictureKernels : public CSIMDKernels
+{
+public:
+  /*! \brief Minimum number of pixels in a frame before it is split into slices */
+  static const int SLICE_THRESHOLD = 1920 * 1088;
+
+  /*!
+   \brief Copy width bytes of height rows.
+   */
+  static void CopyPlane(uint8_t *dst, int dstStride,
+                        const uint8_t *src, int srcStride,
+                        int width, int height);
+
+  /*!
+   \brief Interleave separate U and V planes into a NV12 UV plane.
+   \param width number of chroma samples per row (half the luma width)
+   \param height number of chroma rows
+   */
+  static void InterleaveUV(uint8_t *dst, int dstStride,
+                           const uint8_t *srcU, int strideU,
+                           const uint8_t *srcV, int strideV,
+                           int width, int height);
+
+  /*!
+   \brief Pack a 4:2:0 planar picture into YUY2 or UYVY.
+   Each chroma row is used for the two luma rows it covers.
+   \param width luma width in pixels
+   \param height luma height in rows
+   \param uyvy true for UYVY, false for YUY2
+   */
+  static void PackYUV422(uint8_t *dst, int dstStride,
+                         const uint8_t *srcY, int strideY,
+                         const uint8_t *srcU, int strideU,
+                         const uint8_t *srcV, int strideV,
+                         int width, int height, bool uyvy);
+
+  /*!
+   \brief Shift 16 bit samples left, e.g. by 6 to expand 10 bit video to 16 bit.
+   \param width number of samples per row
+   */
+  static void ShiftPlane16(uint8_t *dst, int dstStride,
+                           const uint8_t *src, int srcStride,
+                           int width, int height, int shift);
+
+  /*! \brief The implementation currently used by the kernels */
+  static Implementation GetImplementation();
+
+  /*!
+   \brief Force an implementation, for testing and benchmarking.
+   \return false if the cpu or the build does not support it
+   */
+  static bool SetImplementation(Implementation impl);
+
+  /*! \brief Best implementation supported by this cpu */
+  static Implementation GetBestImplementation();
+
+  /*!
+   \brief Enable or disable splitting large frames into slices.
+   */
+  static void SetSlicing(bool enable);
+};
@@ -0,0 +1,231 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDCodecs/DVDPictureKernels.h"
+
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const CDVDPictureKernels::Implementation implementations[] =
+{
+  CDVDPictureKernels::IMPL_SSE2,
+  CDVDPictureKernels::IMPL_AVX2,
+  CDVDPictureKernels::IMPL_NEON
+};
+
+void Fill(std::vector<uint8_t> &buf, unsigned int seed)
+{
+  srand(seed);
+  for (size_t i = 0; i < buf.size(); i++)
+    buf[i] = (uint8_t)(rand() & 0xff);
+}
+
+// a 4:2:0 planar test picture with padded strides
+struct SPlanes
+{
+  SPlanes(int width, int height)
+    : w(width)
+    , h(height)
+    , strideY(width + 37)
+    , strideC((width + 1) / 2 + 19)
+    , y(strideY * height)
+    , u(strideC * ((height + 1) / 2))
+    , v(strideC * ((height + 1) / 2))
+  {
+    Fill(y, width);
+    Fill(u, height);
+    Fill(v, width + height);
+  }
+
+  int w, h, strideY, strideC;
+  std::vector<uint8_t> y, u, v;
+};
+
+struct SResult
+{
+  std::vector<uint8_t> interleaved;
+  std::vector<uint8_t> yuy2;
+  std::vector<uint8_t> uyvy;
+  std::vector<uint8_t> shifted;
+  std::vector<uint8_t> copy;
+};
+
+void RunKernels(const SPlanes &p, SResult &r)
+{
+  int cw = (p.w + 1) / 2;
+  int ch = (p.h + 1) / 2;
+  int dstStrideUV = cw * 2 + 5;
+  r.interleaved.assign(dstStrideUV * ch, 0);
+  CDVDPictureKernels::InterleaveUV(&r.interleaved[0], dstStrideUV,
+                                   &p.u[0], p.strideC, &p.v[0], p.strideC, cw, ch);
+
+  int dstStride422 = p.w * 2 + 3;
+  r.yuy2.assign(dstStride422 * p.h, 0);
+  r.uyvy.assign(dstStride422 * p.h, 0);
+  CDVDPictureKernels::PackYUV422(&r.yuy2[0], dstStride422, &p.y[0], p.strideY,
+                                 &p.u[0], p.strideC, &p.v[0], p.strideC, p.w, p.h, false);
+  CDVDPictureKernels::PackYUV422(&r.uyvy[0], dstStride422, &p.y[0], p.strideY,
+                                 &p.u[0], p.strideC, &p.v[0], p.strideC, p.w, p.h, true);
+
+  // treat the luma plane as 16 bit samples, masked to 10 bit
+  int samples = p.strideY / 2;
+  std::vector<uint8_t> src10(p.y);
+  for (size_t i = 1; i < src10.size(); i += 2)
+    src10[i] &= 0x03;
+  r.shifted.assign(samples * 2 * p.h, 0);
+  CDVDPictureKernels::ShiftPlane16(&r.shifted[0], samples * 2, &src10[0], p.strideY,
+                                   samples - 1, p.h, 6);
+
+  r.copy.assign(p.w * p.h, 0);
+  CDVDPictureKernels::CopyPlane(&r.copy[0], p.w, &p.y[0], p.strideY, p.w, p.h);
+}
+
+void RunFrames(int frames)
+{
+  SPlanes p(3840, 2160);
+  SResult r;
+  for (int i = 0; i < frames; i++)
+    RunKernels(p, r);
+}
+
+}
+
+class TestDVDPictureKernels : public testing::Test
+{
+protected:
+  TestDVDPictureKernels()
+  {
+    m_default = CDVDPictureKernels::GetImplementation();
+  }
+
+  ~TestDVDPictureKernels()
+  {
+    CDVDPictureKernels::SetImplementation(m_default);
+    CDVDPictureKernels::SetSlicing(true);
+  }
+
+  CDVDPictureKernels::Implementation m_default;
+};
+
+TEST_F(TestDVDPictureKernels, Reference)
+{
+  ASSERT_TRUE(CDVDPictureKernels::SetImplementation(CDVDPictureKernels::IMPL_C));
+
+  SPlanes p(5, 3);
+  SResult r;
+  RunKernels(p, r);
+
+  int strideUV = 3 * 2 + 5;
+  EXPECT_EQ(p.u[0], r.interleaved[0]);
+  EXPECT_EQ(p.v[0], r.interleaved[1]);
+  EXPECT_EQ(p.u[p.strideC + 2], r.interleaved[strideUV + 4]);
+  EXPECT_EQ(p.v[p.strideC + 2], r.interleaved[strideUV + 5]);
+
+  // row 1 uses chroma row 0, odd width ends with half a macropixel
+  int stride422 = 5 * 2 + 3;
+  const uint8_t *row = &r.yuy2[stride422];
+  EXPECT_EQ(p.y[p.strideY + 0], row[0]);
+  EXPECT_EQ(p.u[0], row[1]);
+  EXPECT_EQ(p.y[p.strideY + 1], row[2]);
+  EXPECT_EQ(p.v[0], row[3]);
+  EXPECT_EQ(p.y[p.strideY + 4], row[8]);
+  EXPECT_EQ(p.u[2], row[9]);
+  EXPECT_EQ(0, row[10]);
+
+  row = &r.uyvy[2 * stride422];
+  EXPECT_EQ(p.u[p.strideC], row[0]);
+  EXPECT_EQ(p.y[2 * p.strideY], row[1]);
+  EXPECT_EQ(p.v[p.strideC], row[2]);
+  EXPECT_EQ(p.y[2 * p.strideY + 1], row[3]);
+
+  // 10 bit samples expanded to 16 bit
+  const uint16_t *shifted = (const uint16_t*)&r.shifted[p.strideY / 2 * 2];
+  EXPECT_EQ((p.y[p.strideY] | (p.y[p.strideY + 1] & 0x03) << 8) << 6, shifted[0]);
+
+  EXPECT_EQ(p.y[p.strideY + 3], r.copy[5 + 3]);
+}
+
+TEST_F(TestDVDPictureKernels, MatchesReference)
+{
+  // odd sizes exercise the scalar tails, the large one the slices
+  const int sizes[][2] = { { 1, 1 }, { 17, 9 }, { 63, 31 }, { 720, 576 }, { 1921, 1081 } };
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    SPlanes p(sizes[s][0], sizes[s][1]);
+
+    SResult ref;
+    CDVDPictureKernels::SetImplementation(CDVDPictureKernels::IMPL_C);
+    CDVDPictureKernels::SetSlicing(false);
+    RunKernels(p, ref);
+    CDVDPictureKernels::SetSlicing(true);
+
+    SResult sliced;
+    RunKernels(p, sliced);
+    EXPECT_TRUE(ref.interleaved == sliced.interleaved);
+    EXPECT_TRUE(ref.yuy2 == sliced.yuy2);
+    EXPECT_TRUE(ref.uyvy == sliced.uyvy);
+    EXPECT_TRUE(ref.shifted == sliced.shifted);
+    EXPECT_TRUE(ref.copy == sliced.copy);
+
+    for (size_t i = 0; i < sizeof(implementations) / sizeof(implementations[0]); i++)
+    {
+      if (!CDVDPictureKernels::SetImplementation(implementations[i]))
+        continue;
+
+      SCOPED_TRACE(CDVDPictureKernels::GetImplementationName(implementations[i]));
+      SResult res;
+      RunKernels(p, res);
+      EXPECT_TRUE(ref.interleaved == res.interleaved) << sizes[s][0] << "x" << sizes[s][1];
+      EXPECT_TRUE(ref.yuy2 == res.yuy2) << sizes[s][0] << "x" << sizes[s][1];
+      EXPECT_TRUE(ref.uyvy == res.uyvy) << sizes[s][0] << "x" << sizes[s][1];
+      EXPECT_TRUE(ref.shifted == res.shifted) << sizes[s][0] << "x" << sizes[s][1];
+      EXPECT_TRUE(ref.copy == res.copy) << sizes[s][0] << "x" << sizes[s][1];
+    }
+  }
+}
+
+// 20 2160p frames through all kernels: the C reference, the best vector
+// kernels on one thread, and the best vector kernels sliced across threads
+TEST_F(TestDVDPictureKernels, DISABLED_BenchmarkC)
+{
+  CDVDPictureKernels::SetImplementation(CDVDPictureKernels::IMPL_C);
+  CDVDPictureKernels::SetSlicing(false);
+  RunFrames(20);
+}
+
+TEST_F(TestDVDPictureKernels, DISABLED_BenchmarkBest)
+{
+  CDVDPictureKernels::SetImplementation(CDVDPictureKernels::GetBestImplementation());
+  CDVDPictureKernels::SetSlicing(false);
+  RunFrames(20);
+}
+
+TEST_F(TestDVDPictureKernels, DISABLED_BenchmarkBestSliced)
+{
+  CDVDPictureKernels::SetImplementation(CDVDPictureKernels::GetBestImplementation());
+  CDVDPictureKernels::SetSlicing(true);
+  RunFrames(20);
+}
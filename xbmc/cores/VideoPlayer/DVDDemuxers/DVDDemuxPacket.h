@@ -38,4 +38,6 @@ typedef struct DemuxPacket
   double duration; // duration in DVD_TIME_BASE if available
 
   int dispTime;
+
+  void* pBuffer; // reference counted buffer holding pData, NULL if pData is allocated by the packet itself
 } DemuxPacket;
@@ -39,7 +39,13 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
+      if (pPacket->pBuffer)
+      {
+        AVBufferRef *buf = static_cast<AVBufferRef*>(pPacket->pBuffer);
+        av_buffer_unref(&buf);
+      }
+      else if (pPacket->pData)
+        _aligned_free(pPacket->pData);
       delete pPacket;
     }
     catch(...) {
@@ -93,3 +99,43 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
   }
   return pPacket;
 }
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket &pkt)
+{
+  AVBufferRef *buf = pkt.buf;
+
+  // a buffer can only be handed to the decoder if nobody else writes to it,
+  // it has the padding behind the data and isn't much larger than the
+  // payload, the packet queues only account for iSize
+  if (buf && pkt.data && pkt.size > 0 && av_buffer_is_writable(buf) &&
+      pkt.data >= buf->data &&
+      pkt.data + pkt.size + FF_INPUT_BUFFER_PADDING_SIZE <= buf->data + buf->size &&
+      buf->size <= 2 * (pkt.size + FF_INPUT_BUFFER_PADDING_SIZE) + 4096)
+  {
+    uint8_t *padding = pkt.data + pkt.size;
+    bool zeroed = true;
+    for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE && zeroed; i++)
+      zeroed = padding[i] == 0;
+
+    if (zeroed)
+    {
+      DemuxPacket* pPacket = AllocateDemuxPacket(0);
+      if (!pPacket)
+        return NULL;
+
+      pPacket->pData = pkt.data;
+      pPacket->iSize = pkt.size;
+      pPacket->pBuffer = buf;
+      pkt.buf = NULL;
+      return pPacket;
+    }
+  }
+
+  DemuxPacket* pPacket = AllocateDemuxPacket(pkt.size);
+  if (pPacket && pkt.data)
+  {
+    pPacket->iSize = pkt.size;
+    memcpy(pPacket->pData, pkt.data, pkt.size);
+  }
+  return pPacket;
+}
@@ -22,10 +22,20 @@
 
 #include "DVDDemuxPacket.h"
 
+struct AVPacket;
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /*!
+   \brief Allocate a packet for the payload of an AVPacket.
+   The reference to the payload is moved into the packet if it is the only
+   one and the buffer carries the zeroed padding decoders read past the end,
+   otherwise the payload is copied. Timestamps and stream id are left to the caller.
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket &pkt);
 };
 
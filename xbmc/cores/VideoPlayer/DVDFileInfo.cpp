@@ -52,6 +52,8 @@
 #include "TextureCache.h"
 #include "Util.h"
 #include "utils/LangCodeExpander.h"
+#include "utils/Job.h"
+#include "threads/SingleLock.h"
 
 #include <cstdlib>
 #include <memory>
@@ -95,10 +97,103 @@ int DegreeToOrientation(int degrees)
   }
 }
 
+CDVDThumbCodecCache::CDVDThumbCodecCache(unsigned int maxIdle)
+  : m_maxIdle(maxIdle)
+{
+}
+
+CDVDThumbCodecCache::~CDVDThumbCodecCache()
+{
+  for (std::vector<Codec>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+    Close(*it);
+}
+
+CDVDVideoCodec* CDVDThumbCodecCache::Acquire(const CDVDStreamInfo &hint, CProcessInfo *&processInfo)
+{
+  {
+    CSingleLock lock(m_section);
+    for (std::vector<Codec>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+    {
+      if (it->hint->Equal(hint, true))
+      {
+        CDVDVideoCodec *codec = it->codec;
+        processInfo = it->processInfo;
+        delete it->hint;
+        m_idle.erase(it);
+        return codec;
+      }
+    }
+  }
+
+  CDVDStreamInfo codecHint(hint);
+  processInfo = CProcessInfo::CreateInstance();
+
+  CDVDVideoCodec *codec;
+  if (codecHint.codec == AV_CODEC_ID_MPEG2VIDEO || codecHint.codec == AV_CODEC_ID_MPEG1VIDEO)
+  {
+    // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
+    CDVDCodecOptions dvdOptions;
+    codec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(*processInfo), codecHint, dvdOptions);
+  }
+  else
+  {
+    codec = CDVDFactoryCodec::CreateVideoCodec(codecHint, *processInfo);
+  }
+
+  if (!codec)
+  {
+    delete processInfo;
+    processInfo = NULL;
+  }
+  return codec;
+}
+
+void CDVDThumbCodecCache::Release(const CDVDStreamInfo &hint, CDVDVideoCodec *codec, CProcessInfo *processInfo)
+{
+  Codec entry = { new CDVDStreamInfo(hint), codec, processInfo };
+  codec->Reset();
+
+  CSingleLock lock(m_section);
+  if (m_idle.size() >= m_maxIdle)
+  {
+    if (m_idle.empty())
+    {
+      lock.Leave();
+      Close(entry);
+      return;
+    }
+    // keep the format of the latest file
+    Codec oldest = m_idle.front();
+    m_idle.erase(m_idle.begin());
+    m_idle.push_back(entry);
+    lock.Leave();
+    Close(oldest);
+    return;
+  }
+  m_idle.push_back(entry);
+}
+
+void CDVDThumbCodecCache::Close(Codec &codec)
+{
+  delete codec.codec;
+  delete codec.processInfo;
+  delete codec.hint;
+}
+
+static bool IsCancelled(const CJob *pJob)
+{
+  return pJob && pJob->ShouldCancel(0, 0);
+}
+
 bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
                                 CTextureDetails &details,
-                                CStreamDetails *pStreamDetails, int pos)
+                                CStreamDetails *pStreamDetails, int pos,
+                                CDVDThumbCodecCache *pCodecs,
+                                const CJob *pJob, bool *pCancelled)
 {
+  if (pCancelled)
+    *pCancelled = false;
+
   std::string redactPath = CURL::GetRedacted(strPath);
   unsigned int nTime = XbmcThreads::SystemClockMillis();
   CFileItem item(strPath, false);
@@ -177,6 +272,15 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
     }
   }
 
+  if (IsCancelled(pJob))
+  {
+    delete pDemuxer;
+    delete pInputStream;
+    if (pCancelled)
+      *pCancelled = true;
+    return false;
+  }
+
   int nVideoStream = -1;
   int64_t demuxerId = -1;
   for (CDemuxStream* pStream : pDemuxer->GetStreams())
@@ -195,26 +299,20 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
   }
 
   bool bOk = false;
+  bool bCancelled = false;
   int packetsTried = 0;
 
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
-    std::unique_ptr<CProcessInfo> pProcessInfo(CProcessInfo::CreateInstance());
+    CDVDThumbCodecCache codecs(0);
+    if (!pCodecs)
+      pCodecs = &codecs;
 
     CDVDStreamInfo hint(*pDemuxer->GetStream(demuxerId, nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == AV_CODEC_ID_MPEG2VIDEO || hint.codec == AV_CODEC_ID_MPEG1VIDEO)
-    {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(*pProcessInfo), hint, dvdOptions);
-    }
-    else
-    {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec(hint, *pProcessInfo);
-    }
+    CProcessInfo *pProcessInfo = NULL;
+    CDVDVideoCodec *pVideoCodec = pCodecs->Acquire(hint, pProcessInfo);
 
     if (pVideoCodec)
     {
@@ -233,6 +331,12 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
         int abort_index = pDemuxer->GetNrOfStreams() * 160;
         do
         {
+          if (IsCancelled(pJob))
+          {
+            bCancelled = true;
+            break;
+          }
+
           DemuxPacket* pPacket = pDemuxer->Read();
           packetsTried++;
 
@@ -294,12 +398,12 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
             av_free(pOutBuf);
           }
         }
-        else
+        else if (!bCancelled)
         {
           CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, redactPath.c_str(), packetsTried);
         }
       }
-      delete pVideoCodec;
+      pCodecs->Release(hint, pVideoCodec, pProcessInfo);
     }
   }
 
@@ -308,6 +412,15 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
 
   delete pInputStream;
 
+  if (bCancelled)
+  {
+    // the thumb is tried again the next time the item is shown
+    CLog::Log(LOGDEBUG,"%s - cancelled extracting thumb from %s", __FUNCTION__, redactPath.c_str());
+    if (pCancelled)
+      *pCancelled = true;
+    return false;
+  }
+
   if(!bOk)
   {
     XFILE::CFile file;
@@ -23,20 +23,83 @@
 #include <string>
 #include <vector>
 
+#include "threads/CriticalSection.h"
+
 class CFileItem;
 class CDVDDemux;
+class CDVDStreamInfo;
+class CDVDVideoCodec;
+class CJob;
+class CProcessInfo;
 class CStreamDetails;
 class CStreamDetailSubtitle;
 class CDVDInputStream;
 class CTextureDetails;
 
+/*!
+ \brief Video decoders kept open between thumb extractions.
+
+ Opening a decoder can take longer than decoding the frame for the thumb and
+ the files of a folder mostly share a format, so decoders are reset and kept
+ for the next file instead of being closed. Safe to share between jobs.
+ */
+class CDVDThumbCodecCache
+{
+public:
+  /*!
+   \param maxIdle maximum number of decoders kept open while not in use
+   */
+  explicit CDVDThumbCodecCache(unsigned int maxIdle);
+  ~CDVDThumbCodecCache();
+
+  /*!
+   \brief Get a software decoder for a stream, reusing an idle one opened with the same hints.
+   \param hint the stream to decode
+   \param processInfo [out] the process info the decoder is using
+   \return the decoder, NULL if none could be opened. Hand it back with Release().
+   */
+  CDVDVideoCodec* Acquire(const CDVDStreamInfo &hint, CProcessInfo *&processInfo);
+
+  /*! \brief Hand back a decoder from Acquire(), it's closed if enough decoders are kept already */
+  void Release(const CDVDStreamInfo &hint, CDVDVideoCodec *codec, CProcessInfo *processInfo);
+
+private:
+  friend class TestDVDThumbCodecCache;
+
+  struct Codec
+  {
+    CDVDStreamInfo *hint;
+    CDVDVideoCodec *codec;
+    CProcessInfo *processInfo;
+  };
+
+  static void Close(Codec &codec);
+
+  CCriticalSection m_section;
+  std::vector<Codec> m_idle;
+  unsigned int m_maxIdle;
+};
+
 class CDVDFileInfo
 {
 public:
-  // Extract a thumbnail immage from the media at strPath, optionally populating a streamdetails class with the data
+  /*!
+   \brief Extract a thumbnail image from the media at strPath, optionally populating a streamdetails class with the data.
+   The file is opened and probed only once for both.
+   \param strPath the media file
+   \param details the thumb to write
+   \param pStreamDetails stream details (including the duration) to fill, NULL to skip them
+   \param pos position of the thumb in ms, -1 for a third into the file
+   \param pCodecs decoders to reuse, NULL to open a new one
+   \param pJob job to check for cancellation, NULL if the extraction can't be cancelled
+   \param pCancelled [out] set if the extraction was cancelled, no placeholder thumb is written then
+   \return true if the thumb was extracted
+   */
   static bool ExtractThumb(const std::string &strPath,
                            CTextureDetails &details,
-                           CStreamDetails *pStreamDetails, int pos=-1);
+                           CStreamDetails *pStreamDetails, int pos=-1,
+                           CDVDThumbCodecCache *pCodecs = NULL,
+                           const CJob *pJob = NULL, bool *pCancelled = NULL);
 
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
@@ -24,6 +24,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "threads/CriticalSection.h"
 #include "threads/Condition.h"
+#include "threads/BoundedQueue.h"
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 
@@ -119,6 +120,36 @@ CDVDMsgDemuxerPacket::~CDVDMsgDemuxerPacket()
     CDVDDemuxUtils::FreeDemuxPacket(m_packet);
 }
 
+namespace
+{
+// enough blocks to cover full demuxer queues of all streams
+const size_t DEMUXER_PACKET_POOL_SIZE = 4096;
+
+XbmcThreads::BoundedQueue<void*>& GetDemuxerPacketPool()
+{
+  // never destroyed, messages may still be released during static destruction
+  static XbmcThreads::BoundedQueue<void*>* pool = new XbmcThreads::BoundedQueue<void*>(DEMUXER_PACKET_POOL_SIZE);
+  return *pool;
+}
+}
+
+void* CDVDMsgDemuxerPacket::operator new(size_t size)
+{
+  void* ptr;
+  if (size == sizeof(CDVDMsgDemuxerPacket) && GetDemuxerPacketPool().Pop(ptr))
+    return ptr;
+  return ::operator new(size);
+}
+
+void CDVDMsgDemuxerPacket::operator delete(void* ptr, size_t size)
+{
+  if (!ptr)
+    return;
+  if (size == sizeof(CDVDMsgDemuxerPacket) && GetDemuxerPacketPool().Push(ptr))
+    return;
+  ::operator delete(ptr);
+}
+
 unsigned int CDVDMsgDemuxerPacket::GetPacketSize()
 {
   if (m_packet)
@@ -269,6 +269,12 @@ class CDVDMsgDemuxerPacket : public CDVDMsg
 public:
   CDVDMsgDemuxerPacket(DemuxPacket* packet, bool drop = false);
   virtual ~CDVDMsgDemuxerPacket();
+
+  // demuxer packets are the bulk of the message traffic, their memory is
+  // recycled through a lock-free free list instead of the heap
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   DemuxPacket* GetPacket()      { return m_packet; }
   unsigned int GetPacketSize();
   bool         GetPacketDrop()  { return m_drop; }
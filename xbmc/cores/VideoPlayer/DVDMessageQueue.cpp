@@ -25,11 +25,19 @@
 #include "DVDClock.h"
 #include "math.h"
 
-CDVDMessageQueue::CDVDMessageQueue(const std::string &owner) : m_hEvent(true), m_owner(owner)
+#include <atomic>
+
+CDVDMessageQueue::CDVDMessageQueue(const std::string &owner)
+  : m_hEvent(true)
+  , m_owner(owner)
+  , m_messages(RING_SIZE)
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bInitialized = false;
+  m_bWaiting = false;
+  m_overflowCount = 0;
+  m_prioCount = 0;
 
   m_TimeBack = DVD_NOPTS_VALUE;
   m_TimeFront = DVD_NOPTS_VALUE;
@@ -54,19 +62,35 @@ void CDVDMessageQueue::Init()
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
+  CSingleLock consumer(m_consumerSection);
   CSingleLock lock(m_section);
 
-  m_messages.remove_if([type](const DVDMessageListItem &item){
-    return type == CDVDMsg::NONE || item.message->IsType(type);
-  });
-
-  m_prioMessages.remove_if([type](const DVDMessageListItem &item){
-    return type == CDVDMsg::NONE || item.message->IsType(type);
+  auto match = [this, type](const DVDMessageListItem &item){
+    if (type != CDVDMsg::NONE && !item.message->IsType(type))
+      return false;
+    if (item.priority == 0)
+      AccountFlush(item.message);
+    return true;
+  };
+
+  m_overflow.remove_if(match);
+  m_overflowCount = m_overflow.size();
+  m_prioMessages.remove_if(match);
+  m_prioCount = m_prioMessages.size();
+
+  // the ring can't be compacted, matching messages are replaced with NULL
+  // and skipped by Get
+  m_messages.ForEach([this, type](CDVDMsg* &msg){
+    if (msg && (type == CDVDMsg::NONE || msg->IsType(type)))
+    {
+      AccountFlush(msg);
+      msg->Release();
+      msg = NULL;
+    }
   });
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
-    m_iDataSize = 0;
     m_TimeBack = DVD_NOPTS_VALUE;
     m_TimeFront = DVD_NOPTS_VALUE;
   }
@@ -84,19 +108,62 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
-  CSingleLock lock(m_section);
-
   Flush(CDVDMsg::NONE);
 
+  CSingleLock lock(m_section);
+
   m_bInitialized = false;
   m_iDataSize = 0;
   m_bAbortRequest = false;
 }
 
-MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front)
+void CDVDMessageQueue::AccountPut(CDVDMsg* pMsg)
 {
-  CSingleLock lock(m_section);
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if (packet)
+  {
+    m_iDataSize += packet->iSize;
+    if (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->dts;
+    else if (packet->pts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->pts;
+
+    double back = DVD_NOPTS_VALUE;
+    m_TimeBack.compare_exchange_strong(back, m_TimeFront.load());
+  }
+}
+
+void CDVDMessageQueue::AccountGet(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if (packet)
+  {
+    m_iDataSize -= packet->iSize;
+    if (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->dts;
+    else if (packet->pts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->pts;
+  }
+}
 
+void CDVDMessageQueue::AccountFlush(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if (packet)
+    m_iDataSize -= packet->iSize;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front)
+{
   if (!m_bInitialized)
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Put MSGQ_NOT_INITIALIZED", m_owner.c_str());
@@ -109,54 +176,101 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
     return MSGQ_INVALID_MSG;
   }
 
-  if (priority > 0)
+  // account before publishing, the consumer may take the message right away
+  if (priority == 0)
+    AccountPut(pMsg);
+
+  if (priority > 0 || !front)
   {
+    // messages put back with front = false are retrieved before the normal
+    // ones, they sort in as priority 0 behind any other priority 0 message
     int prio = priority;
     if (!front)
       prio++;
 
+    CSingleLock lock(m_section);
     auto it = std::find_if(m_prioMessages.begin(), m_prioMessages.end(),
                            [prio](const DVDMessageListItem &item){
                              return prio <= item.priority;
                            });
     m_prioMessages.emplace(it, pMsg, priority);
+    m_prioCount++;
+    pMsg->Release();
   }
-  else
+  else if (m_overflowCount > 0 || !m_messages.Push(pMsg))
   {
-    if (front)
-      m_messages.emplace_front(pMsg, priority);
-    else
-      m_messages.emplace_back(pMsg, priority);
+    // once the ring filled up, keep the order by queueing behind it until
+    // the consumer caught up
+    CSingleLock lock(m_section);
+    m_overflow.emplace_front(pMsg, priority);
+    m_overflowCount++;
+    pMsg->Release();
   }
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
+  // inform waiter for new packet, pairs with the fence in Get
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_bWaiting)
+    m_hEvent.Set();
+
+  return MSGQ_OK;
+}
+
+bool CDVDMessageQueue::TryGet(CDVDMsg** pMsg, int &priority)
+{
+  if (priority > 0 || m_prioCount > 0)
   {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if (packet)
+    CSingleLock lock(m_section);
+    if (!m_prioMessages.empty())
     {
-      m_iDataSize += packet->iSize;
-      if (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if (packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-
-      if (m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
+      DVDMessageListItem& item(m_prioMessages.back());
+      if (item.priority < priority)
+        return false;
+
+      priority = item.priority;
+      if (item.priority == 0)
+        AccountGet(item.message);
+
+      *pMsg = item.message->Acquire();
+      m_prioMessages.pop_back();
+      m_prioCount--;
+      return true;
     }
+    else if (priority > 0)
+      return false;
   }
 
-  pMsg->Release();
+  CDVDMsg* msg;
+  while (m_messages.Pop(msg))
+  {
+    if (!msg)
+      continue;
 
-  // inform waiter for new packet
-  m_hEvent.Set();
+    AccountGet(msg);
+    priority = 0;
+    *pMsg = msg;
+    return true;
+  }
 
-  return MSGQ_OK;
+  if (m_overflowCount > 0)
+  {
+    CSingleLock lock(m_section);
+    if (!m_overflow.empty())
+    {
+      DVDMessageListItem& item(m_overflow.back());
+      AccountGet(item.message);
+      priority = 0;
+      *pMsg = item.message->Acquire();
+      m_overflow.pop_back();
+      m_overflowCount--;
+      return true;
+    }
+  }
+
+  return false;
 }
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
-  CSingleLock lock(m_section);
-
   *pMsg = NULL;
 
   int ret = 0;
@@ -167,31 +281,12 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
+  CSingleLock lock(m_consumerSection);
+
   while (!m_bAbortRequest)
   {
-    std::list<DVDMessageListItem> &msgs = (priority > 0 || !m_prioMessages.empty()) ? m_prioMessages : m_messages;
-
-    if (!msgs.empty() && msgs.back().priority >= priority)
+    if (TryGet(pMsg, priority))
     {
-      DVDMessageListItem& item(msgs.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if (packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if (packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-      }
-
-      *pMsg = item.message->Acquire();
-      msgs.pop_back();
-
       ret = MSGQ_OK;
       break;
     }
@@ -202,11 +297,23 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     }
     else
     {
+      // announce the wait before checking again, a producer either sees
+      // the flag and sets the event or its message is visible to us
       m_hEvent.Reset();
+      m_bWaiting = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (TryGet(pMsg, priority))
+      {
+        m_bWaiting = false;
+        ret = MSGQ_OK;
+        break;
+      }
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      m_bWaiting = false;
+      if (!signaled)
         return MSGQ_TIMEOUT;
 
       lock.Enter();
@@ -214,20 +321,33 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
   }
 
   if (m_bAbortRequest)
+  {
+    // don't leak a message taken just before the abort
+    if (*pMsg)
+    {
+      (*pMsg)->Release();
+      *pMsg = NULL;
+    }
     return MSGQ_ABORT;
+  }
 
   return (MsgQueueReturnCode)ret;
 }
 
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
-  CSingleLock lock(m_section);
-
   if (!m_bInitialized)
     return 0;
 
+  CSingleLock consumer(m_consumerSection);
+  CSingleLock lock(m_section);
+
   unsigned count = 0;
-  for (const auto &item : m_messages)
+  m_messages.ForEach([&count, type](CDVDMsg* &msg){
+    if (msg && msg->IsType(type))
+      count++;
+  });
+  for (const auto &item : m_overflow)
   {
     if(item.message->IsType(type))
       count++;
@@ -252,20 +372,22 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  CSingleLock lock(m_section);
-
-  if (m_iDataSize > m_iMaxDataSize)
+  // lock free, the counters are updated atomically by Put and Get
+  int dataSize = m_iDataSize;
+  if (dataSize > m_iMaxDataSize)
     return 100;
-  if (m_iDataSize == 0)
+  if (dataSize <= 0)
     return 0;
 
-  if (IsDataBased())
-    return std::min(100, 100 * m_iDataSize / m_iMaxDataSize);
+  double front = m_TimeFront;
+  double back = m_TimeBack;
+  if (IsDataBased(front, back))
+    return std::min(100, 100 * dataSize / m_iMaxDataSize);
 
-  int level = std::min(100.0, ceil(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
+  int level = std::min(100.0, ceil(100.0 * m_TimeSize * (front - back) / DVD_TIME_BASE ));
 
   // if we added lots of packets with NOPTS, make sure that the queue is not signalled empty
-  if (level == 0 && m_iDataSize != 0)
+  if (level == 0 && dataSize != 0)
   {
     CLog::Log(LOGDEBUG, "CDVDMessageQueue::GetLevel() - can't determine level");
     return 1;
@@ -276,17 +398,22 @@ int CDVDMessageQueue::GetLevel() const
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  CSingleLock lock(m_section);
-
-  if (IsDataBased())
+  double front = m_TimeFront;
+  double back = m_TimeBack;
+  if (IsDataBased(front, back))
     return 0;
   else
-    return (int)((m_TimeFront - m_TimeBack) / DVD_TIME_BASE);
+    return (int)((front - back) / DVD_TIME_BASE);
 }
 
 bool CDVDMessageQueue::IsDataBased() const
 {
-  return (m_TimeBack == DVD_NOPTS_VALUE  ||
-          m_TimeFront == DVD_NOPTS_VALUE ||
-          m_TimeFront <= m_TimeBack);
+  return IsDataBased(m_TimeFront, m_TimeBack);
+}
+
+bool CDVDMessageQueue::IsDataBased(double front, double back)
+{
+  return (back == DVD_NOPTS_VALUE  ||
+          front == DVD_NOPTS_VALUE ||
+          front <= back);
 }
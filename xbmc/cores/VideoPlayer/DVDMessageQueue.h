@@ -25,6 +25,7 @@
 #include <string>
 #include <list>
 #include <algorithm>
+#include "threads/BoundedQueue.h"
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
@@ -108,22 +109,38 @@ public:
   bool IsDataBased() const;
 
 private:
+  bool TryGet(CDVDMsg** pMsg, int &priority);
+  void AccountPut(CDVDMsg* pMsg);
+  void AccountGet(CDVDMsg* pMsg);
+  void AccountFlush(CDVDMsg* pMsg);
+  static bool IsDataBased(double front, double back);
+
+  // normal priority messages pass through a fixed size lock-free ring so
+  // producers never take a lock and messages need no list nodes
+  static const size_t RING_SIZE = 4096;
 
   CEvent m_hEvent;
-  mutable CCriticalSection m_section;
+  mutable CCriticalSection m_section;   // guards the priority and overflow lists
+  CCriticalSection m_consumerSection;   // serialises Get, Flush and GetPacketCount
 
   std::atomic<bool> m_bAbortRequest;
-  bool m_bInitialized;
+  std::atomic<bool> m_bInitialized;
+  std::atomic<bool> m_bWaiting;
 
-  int m_iDataSize;
-  double m_TimeFront;
-  double m_TimeBack;
+  std::atomic<int> m_iDataSize;
+  std::atomic<double> m_TimeFront;
+  std::atomic<double> m_TimeBack;
   double m_TimeSize;
 
   int m_iMaxDataSize;
   std::string m_owner;
 
-  std::list<DVDMessageListItem> m_messages;
+  // NULL entries are messages removed by Flush
+  XbmcThreads::BoundedQueue<CDVDMsg*> m_messages;
+  // normal priority messages that didn't fit into the ring, they queue behind it
+  std::list<DVDMessageListItem> m_overflow;
+  std::atomic<int> m_overflowCount;
+  // priority lanes, and messages put back at the front with front = false
   std::list<DVDMessageListItem> m_prioMessages;
+  std::atomic<int> m_prioCount;
 };
-
@@ -18,16 +18,24 @@
  *
  */
 
+#include <algorithm>
 #include <math.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
 #include "system.h"
 #include "ColorManager.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderFlags.h"
+#include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "settings/Settings.h"
+#include "threads/Thread.h"
+#include "utils/auto_buffer.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
 #include "utils/TimeUtils.h"
 
 using namespace XFILE;
@@ -108,6 +116,18 @@ bool CColorManager::GetVideo3dLut(int videoFlags, int *cmsToken, int *clutSize,
         m_hProfile = LoadIccDisplayProfile(CSettings::GetInstance().GetString("videoscreen.displayprofile"));
         if (!m_hProfile)
           return false;
+        // hash the profile contents to identify cached 3D LUTs
+        m_curIccProfileHash.clear();
+        {
+          CFile profileFile;
+          auto_buffer profileData;
+          if (profileFile.LoadFile(CSettings::GetInstance().GetString("videoscreen.displayprofile"), profileData) > 0)
+          {
+            XBMC::XBMC_MD5 md5;
+            md5.append(profileData.get(), profileData.size());
+            m_curIccProfileHash = md5.getDigest();
+          }
+        }
         // detect blackpoint
         if (cmsDetectBlackPoint(&m_blackPoint, m_hProfile, INTENT_PERCEPTUAL, 0))
         {
@@ -115,38 +135,48 @@ bool CColorManager::GetVideo3dLut(int videoFlags, int *cmsToken, int *clutSize,
         }
         m_curIccProfile = CSettings::GetInstance().GetString("videoscreen.displayprofile");
       }
-      // create gamma curve
-      cmsToneCurve* gammaCurve;
+      // read configuration
       m_m_curIccGammaMode = (CMS_TRC_TYPE)CSettings::GetInstance().GetInt("videoscreen.cmsgammamode");
       m_curIccGamma = CSettings::GetInstance().GetInt("videoscreen.cmsgamma");
-      gammaCurve =
-        CreateToneCurve(m_m_curIccGammaMode, m_curIccGamma/100.0f, m_blackPoint);
-
-      // create source profile
       m_curIccWhitePoint = (CMS_WHITEPOINT)CSettings::GetInstance().GetInt("videoscreen.cmswhitepoint");
       m_curIccPrimaries = (CMS_PRIMARIES)CSettings::GetInstance().GetInt("videoscreen.cmsprimaries");
       CLog::Log(LOGDEBUG, "primaries setting: %d\n", (int)m_curIccPrimaries);
       if (m_curIccPrimaries == CMS_PRIMARIES_AUTO) m_curIccPrimaries = videoPrimaries;
       CLog::Log(LOGDEBUG, "source profile primaries: %d\n", (int)m_curIccPrimaries);
-      cmsHPROFILE sourceProfile =
-        CreateSourceProfile(m_curIccPrimaries, gammaCurve, m_curIccWhitePoint);
-
-      // link profiles
-      // TODO: intent selection, switch output to 16 bits?
-      cmsSetAdaptationState(0.0);
-      cmsHTRANSFORM deviceLink =
-        cmsCreateTransform(sourceProfile, TYPE_RGB_FLT,
-            m_hProfile, TYPE_RGB_FLT,
-            INTENT_ABSOLUTE_COLORIMETRIC, 0);
-
-      // sample the transformation
       *clutSize = 1 << CSettings::GetInstance().GetInt("videoscreen.cmslutsize");
-      Create3dLut(deviceLink, clutData, clutSize);
 
-      // free gamma curve, source profile and transformation
-      cmsDeleteTransform(deviceLink);
-      cmsCloseProfile(sourceProfile);
-      cmsFreeToneCurve(gammaCurve);
+      // try the 3D LUT cache first
+      std::string cacheFile = Get3dLutCacheFile(*clutSize);
+      if (cacheFile.empty() || !LoadCached3dLut(cacheFile, clutData, *clutSize))
+      {
+        // create gamma curve
+        cmsToneCurve* gammaCurve =
+          CreateToneCurve(m_m_curIccGammaMode, m_curIccGamma/100.0f, m_blackPoint);
+
+        // create source profile
+        cmsHPROFILE sourceProfile =
+          CreateSourceProfile(m_curIccPrimaries, gammaCurve, m_curIccWhitePoint);
+
+        // link profiles and sample the transformation
+        // TODO: intent selection, switch output to 16 bits?
+        cmsSetAdaptationState(0.0);
+        int64_t start = CurrentHostCounter();
+        bool created = Create3dLut(sourceProfile, clutData, clutSize);
+
+        // free gamma curve and source profile
+        cmsCloseProfile(sourceProfile);
+        cmsFreeToneCurve(gammaCurve);
+
+        if (!created)
+          return false;
+
+        CLog::Log(LOGDEBUG, "ColorManager: created %dx%dx%d 3D LUT in %.1f ms\n",
+            *clutSize, *clutSize, *clutSize,
+            (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency());
+
+        if (!cacheFile.empty())
+          SaveCached3dLut(cacheFile, *clutData, *clutSize);
+      }
     }
 
     m_curCmsMode = CMS_MODE_PROFILE;
@@ -476,35 +506,105 @@ cmsHPROFILE CColorManager::CreateSourceProfile(CMS_PRIMARIES primaries, cmsToneC
 }
 
 
-void CColorManager::Create3dLut(cmsHTRANSFORM transform, uint16_t **clutData, int *clutSize)
-{
-  const int lutResolution = *clutSize;
-  int lutsamples = lutResolution * lutResolution * lutResolution * 3;
-  *clutData = (uint16_t*)malloc(lutsamples * sizeof(uint16_t));
-
-  cmsFloat32Number input[3*lutResolution];
-  cmsFloat32Number output[3*lutResolution];
-
 #define clamp(x, l, h) ( ((x) < (l)) ? (l) : ( ((x) > (h)) ? (h) : (x) ) )
 #define videoToPC(x) ( clamp((((x)*255)-16)/219,0,1) )
 #define PCToVideo(x) ( (((x)*219)+16)/255 )
 // #define videoToPC(x) ( x )
 // #define PCToVideo(x) ( x )
-  for (int bIndex=0; bIndex<lutResolution; bIndex++) {
-    for (int gIndex=0; gIndex<lutResolution; gIndex++) {
-      for (int rIndex=0; rIndex<lutResolution; rIndex++) {
-        input[rIndex*3+0] = videoToPC(rIndex / (lutResolution-1.0));
-        input[rIndex*3+1] = videoToPC(gIndex / (lutResolution-1.0));
-        input[rIndex*3+2] = videoToPC(bIndex / (lutResolution-1.0));
-      }
-      int index = (bIndex*lutResolution*lutResolution + gIndex*lutResolution)*3;
-      cmsDoTransform(transform, input, output, lutResolution);
-      for (int i=0; i<lutResolution*3; i++) {
-        (*clutData)[index+i] = PCToVideo(output[i]) * 65535;
+
+// samples a range of blue planes of the 3D LUT with its own transform
+class C3dLutSlice : public IRunnable
+{
+public:
+  C3dLutSlice(cmsHTRANSFORM transform, uint16_t *clutData, int lutResolution, int bStart, int bEnd)
+    : m_transform(transform), m_clutData(clutData), m_lutResolution(lutResolution),
+      m_bStart(bStart), m_bEnd(bEnd) {}
+
+  virtual void Run()
+  {
+    const int lutResolution = m_lutResolution;
+    std::vector<cmsFloat32Number> input(3*lutResolution);
+    std::vector<cmsFloat32Number> output(3*lutResolution);
+
+    for (int bIndex=m_bStart; bIndex<m_bEnd; bIndex++) {
+      for (int gIndex=0; gIndex<lutResolution; gIndex++) {
+        for (int rIndex=0; rIndex<lutResolution; rIndex++) {
+          input[rIndex*3+0] = videoToPC(rIndex / (lutResolution-1.0));
+          input[rIndex*3+1] = videoToPC(gIndex / (lutResolution-1.0));
+          input[rIndex*3+2] = videoToPC(bIndex / (lutResolution-1.0));
+        }
+        int index = (bIndex*lutResolution*lutResolution + gIndex*lutResolution)*3;
+        cmsDoTransform(m_transform, input.data(), output.data(), lutResolution);
+        for (int i=0; i<lutResolution*3; i++) {
+          m_clutData[index+i] = PCToVideo(output[i]) * 65535;
+        }
       }
     }
   }
 
+private:
+  cmsHTRANSFORM m_transform;
+  uint16_t *m_clutData;
+  int m_lutResolution;
+  int m_bStart;
+  int m_bEnd;
+};
+
+bool CColorManager::Create3dLut(cmsHPROFILE sourceProfile, uint16_t **clutData, int *clutSize)
+{
+  const int lutResolution = *clutSize;
+  int lutsamples = lutResolution * lutResolution * lutResolution * 3;
+
+  // lcms transforms keep a cache of the last sample, so every slice gets
+  // its own transform instead of sharing one between threads
+  int sliceCount = std::max(1, std::min(g_cpuInfo.getCPUCount(), lutResolution));
+  std::vector<cmsHTRANSFORM> transforms;
+  for (int i=0; i<sliceCount; i++)
+  {
+    cmsHTRANSFORM transform =
+      cmsCreateTransform(sourceProfile, TYPE_RGB_FLT,
+          m_hProfile, TYPE_RGB_FLT,
+          INTENT_ABSOLUTE_COLORIMETRIC, 0);
+    if (!transform)
+      break;
+    transforms.push_back(transform);
+  }
+  sliceCount = transforms.size();
+  if (sliceCount == 0)
+  {
+    CLog::Log(LOGERROR, "%s: could not create transform", __FUNCTION__);
+    *clutData = NULL;
+    return false;
+  }
+
+  *clutData = (uint16_t*)malloc(lutsamples * sizeof(uint16_t));
+
+  std::vector<C3dLutSlice*> slices;
+  std::vector<CThread*> threads;
+  for (int i=0; i<sliceCount; i++)
+  {
+    int bStart = lutResolution * i / sliceCount;
+    int bEnd = lutResolution * (i+1) / sliceCount;
+    slices.push_back(new C3dLutSlice(transforms[i], *clutData, lutResolution, bStart, bEnd));
+  }
+  // sample the first slice on the calling thread
+  for (int i=1; i<sliceCount; i++)
+  {
+    threads.push_back(new CThread(slices[i], "CMS3dLut"));
+    threads.back()->Create();
+  }
+  slices[0]->Run();
+  for (std::vector<CThread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+  for (int i=0; i<sliceCount; i++)
+  {
+    delete slices[i];
+    cmsDeleteTransform(transforms[i]);
+  }
+
   for (int y=0; y<lutResolution; y+=1)
   {
     int index = 3*(y*lutResolution*lutResolution + y*lutResolution + y);
@@ -514,6 +614,90 @@ void CColorManager::Create3dLut(cmsHTRANSFORM transform, uint16_t **clutData, in
         (int)round((*clutData)[index+1]),
         (int)round((*clutData)[index+2]));
   }
+  return true;
+}
+
+
+// 3D LUT cache
+#define CMS_3DLUT_CACHE_PATH "special://temp/cms3dlut/"
+#define CMS_3DLUT_CACHE_VERSION 1
+
+struct C3dLutCacheHeader
+{
+  char signature[4];            // file signature; must be: 'KLUT'
+  uint32_t version;             // cache format version (CMS_3DLUT_CACHE_VERSION)
+  uint32_t clutSize;            // resolution of the cube
+  uint32_t dataSize;            // size in bytes of the LUT data following the header
+};
+
+std::string CColorManager::Get3dLutCacheFile(int clutSize)
+{
+  if (m_curIccProfileHash.empty())
+    return "";
+
+  return StringUtils::Format(CMS_3DLUT_CACHE_PATH "%s-p%d-t%d-g%d-w%d-s%d.bin",
+      m_curIccProfileHash.c_str(),
+      (int)m_curIccPrimaries,
+      (int)m_m_curIccGammaMode,
+      m_curIccGamma,
+      (int)m_curIccWhitePoint,
+      clutSize);
+}
+
+bool CColorManager::LoadCached3dLut(const std::string &filename, uint16_t **clutData, int clutSize)
+{
+  CFile cacheFile;
+  if (!CFile::Exists(filename) || !cacheFile.Open(filename))
+    return false;
+
+  C3dLutCacheHeader header;
+  uint32_t dataSize = clutSize * clutSize * clutSize * 3 * sizeof(uint16_t);
+  if (cacheFile.Read(&header, sizeof(header)) != sizeof(header)
+      || memcmp(header.signature, "KLUT", 4) != 0
+      || header.version != CMS_3DLUT_CACHE_VERSION
+      || header.clutSize != (uint32_t)clutSize
+      || header.dataSize != dataSize)
+  {
+    CLog::Log(LOGWARNING, "%s: invalid 3D LUT cache file: %s", __FUNCTION__, filename.c_str());
+    return false;
+  }
+
+  uint16_t *data = (uint16_t*)malloc(dataSize);
+  if (cacheFile.Read(data, dataSize) != (ssize_t)dataSize)
+  {
+    CLog::Log(LOGWARNING, "%s: truncated 3D LUT cache file: %s", __FUNCTION__, filename.c_str());
+    free(data);
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "ColorManager: loaded cached 3D LUT %s\n", filename.c_str());
+  *clutData = data;
+  return true;
+}
+
+void CColorManager::SaveCached3dLut(const std::string &filename, const uint16_t *clutData, int clutSize)
+{
+  if (!CDirectory::Exists(CMS_3DLUT_CACHE_PATH) && !CDirectory::Create(CMS_3DLUT_CACHE_PATH))
+  {
+    CLog::Log(LOGERROR, "%s: could not create 3D LUT cache directory", __FUNCTION__);
+    return;
+  }
+
+  C3dLutCacheHeader header;
+  memcpy(header.signature, "KLUT", 4);
+  header.version = CMS_3DLUT_CACHE_VERSION;
+  header.clutSize = clutSize;
+  header.dataSize = clutSize * clutSize * clutSize * 3 * sizeof(uint16_t);
+
+  CFile cacheFile;
+  if (!cacheFile.OpenForWrite(filename, true)
+      || cacheFile.Write(&header, sizeof(header)) != sizeof(header)
+      || cacheFile.Write(clutData, header.dataSize) != (ssize_t)header.dataSize)
+  {
+    CLog::Log(LOGERROR, "%s: could not write 3D LUT cache file: %s", __FUNCTION__, filename.c_str());
+    cacheFile.Close();
+    CFile::Delete(filename);
+  }
 }
 
 
@@ -62,6 +62,8 @@ enum CMS_TRC_TYPE
 
 class CColorManager
 {
+  friend class TestColorManager;
+
 public:
   CColorManager();
   virtual ~CColorManager();
@@ -133,15 +135,41 @@ private:
 
 
   /* \brief Create 3D LUT
-   Samples a cmsHTRANSFORM object to create a 3D LUT of specified resolution
-   \param transform cmsHTRANSFORM object to sample
-   \param resolution size of the 3D LUT to create
-   \param clut pointer to LUT data
+   Samples the transformation from sourceProfile to the display profile to
+   create a 3D LUT of specified resolution. The LUT is split into slices of
+   blue planes that are sampled in parallel, each worker using its own
+   cmsHTRANSFORM object.
+   \param sourceProfile source profile of the transformation
+   \param clutData pointer to LUT data
+   \param clutSize size of the 3D LUT to create
+   \return true on success, false if the transformation could not be created
+   */
+  bool Create3dLut(cmsHPROFILE sourceProfile, uint16_t **clutData, int *clutSize);
+
+  /* \brief Get the cache file name of a 3D LUT for the current ICC configuration
+   \param clutSize size of the 3D LUT
+   \return full path and filename in the 3D LUT cache
+   */
+  std::string Get3dLutCacheFile(int clutSize);
+
+  /* \brief Load a 3D LUT from the cache
+   \param filename full path and filename in the 3D LUT cache
+   \param clutData pointer to LUT data
+   \param clutSize size of the 3D LUT to load
+   \return true on success, false if the LUT is not cached or invalid
+   */
+  bool LoadCached3dLut(const std::string &filename, uint16_t **clutData, int clutSize);
+
+  /* \brief Store a 3D LUT in the cache
+   \param filename full path and filename in the 3D LUT cache
+   \param clutData LUT data
+   \param clutSize size of the 3D LUT
    */
-  void Create3dLut(cmsHTRANSFORM transform, uint16_t **clutData, int *clutSize);
+  void SaveCached3dLut(const std::string &filename, const uint16_t *clutData, int clutSize);
 
   // keep current display profile loaded here
   cmsHPROFILE m_hProfile;
+  std::string m_curIccProfileHash;  // md5 of the display profile file
   cmsCIEXYZ   m_blackPoint = { 0, 0, 0 };
 
   // display parameters (gamma, input/output offset, primaries, whitepoint, intent?)
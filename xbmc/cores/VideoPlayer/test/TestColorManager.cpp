@@ -0,0 +1,176 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#if defined(HAVE_LCMS2)
+
+#include "cores/VideoPlayer/VideoRenderers/ColorManager.h"
+#include "filesystem/File.h"
+
+#include <stdlib.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class TestColorManager : public testing::Test
+{
+protected:
+  TestColorManager()
+  {
+    Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D65);
+  }
+
+  ~TestColorManager()
+  {
+    for (std::vector<std::string>::const_iterator it = m_files.begin(); it != m_files.end(); ++it)
+      XFILE::CFile::Delete(*it);
+  }
+
+  void Configure(CMS_PRIMARIES primaries, CMS_TRC_TYPE gammaMode, int gamma, CMS_WHITEPOINT whitepoint,
+                 const std::string &profileHash = "0123456789abcdef0123456789abcdef")
+  {
+    m_manager.m_curIccProfileHash = profileHash;
+    m_manager.m_curIccPrimaries = primaries;
+    m_manager.m_m_curIccGammaMode = gammaMode;
+    m_manager.m_curIccGamma = gamma;
+    m_manager.m_curIccWhitePoint = whitepoint;
+  }
+
+  std::string GetCacheFile(int clutSize)
+  {
+    std::string file = m_manager.Get3dLutCacheFile(clutSize);
+    if (!file.empty())
+      m_files.push_back(file);
+    return file;
+  }
+
+  void Save(const std::string &file, const std::vector<uint16_t> &data, int clutSize)
+  {
+    m_manager.SaveCached3dLut(file, data.data(), clutSize);
+  }
+
+  bool Load(const std::string &file, std::vector<uint16_t> &data, int clutSize)
+  {
+    uint16_t *clutData = NULL;
+    if (!m_manager.LoadCached3dLut(file, &clutData, clutSize))
+      return false;
+    data.assign(clutData, clutData + clutSize * clutSize * clutSize * 3);
+    free(clutData);
+    return true;
+  }
+
+  bool Create(cmsHPROFILE displayProfile, cmsHPROFILE sourceProfile, uint16_t **clutData, int clutSize)
+  {
+    m_manager.m_hProfile = displayProfile;
+    return m_manager.Create3dLut(sourceProfile, clutData, &clutSize);
+  }
+
+  static std::vector<uint16_t> GetLut(int clutSize)
+  {
+    std::vector<uint16_t> data(clutSize * clutSize * clutSize * 3);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = (uint16_t)(i * 7919);
+    return data;
+  }
+
+  CColorManager m_manager;
+  std::vector<std::string> m_files;
+};
+
+TEST_F(TestColorManager, CacheKey)
+{
+  std::string file = GetCacheFile(64);
+  EXPECT_EQ("special://temp/cms3dlut/0123456789abcdef0123456789abcdef-p1-t0-g240-w0-s64.bin", file);
+  EXPECT_NE(file, GetCacheFile(32));
+
+  // every part of the configuration that changes the LUT changes the key
+  Configure(CMS_PRIMARIES_170M, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D65);
+  EXPECT_NE(file, GetCacheFile(64));
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_ABSOLUTE, 240, CMS_WHITEPOINT_D65);
+  EXPECT_NE(file, GetCacheFile(64));
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 220, CMS_WHITEPOINT_D65);
+  EXPECT_NE(file, GetCacheFile(64));
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D93);
+  EXPECT_NE(file, GetCacheFile(64));
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D65, "fedcba9876543210fedcba9876543210");
+  EXPECT_NE(file, GetCacheFile(64));
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D65);
+  EXPECT_EQ(file, GetCacheFile(64));
+
+  // without a profile hash nothing is cached
+  Configure(CMS_PRIMARIES_BT709, CMS_TRC_BT1886, 240, CMS_WHITEPOINT_D65, "");
+  EXPECT_TRUE(GetCacheFile(64).empty());
+}
+
+TEST_F(TestColorManager, CacheRoundTrip)
+{
+  const std::string file = GetCacheFile(16);
+  const std::vector<uint16_t> lut = GetLut(16);
+  Save(file, lut, 16);
+
+  std::vector<uint16_t> loaded;
+  ASSERT_TRUE(Load(file, loaded, 16));
+  EXPECT_TRUE(lut == loaded);
+
+  // a cached LUT of another size is not used
+  EXPECT_FALSE(Load(file, loaded, 32));
+}
+
+TEST_F(TestColorManager, CacheMissingOrTruncated)
+{
+  const std::string file = GetCacheFile(16);
+  std::vector<uint16_t> loaded;
+  EXPECT_FALSE(Load(file, loaded, 16));
+
+  // header and half of the data
+  Save(file, GetLut(16), 16);
+  XFILE::CFile cacheFile;
+  ASSERT_TRUE(cacheFile.OpenForWrite(file, false));
+  ASSERT_EQ(0, cacheFile.Truncate(16 + 16 * 16 * 16 * 3));
+  cacheFile.Close();
+  EXPECT_FALSE(Load(file, loaded, 16));
+}
+
+TEST_F(TestColorManager, Create3dLut)
+{
+  uint16_t *clutData = NULL;
+  cmsHPROFILE sourceProfile = cmsCreate_sRGBProfile();
+  ASSERT_TRUE(Create(cmsCreate_sRGBProfile(), sourceProfile, &clutData, 8));
+  ASSERT_TRUE(clutData != NULL);
+
+  // an sRGB to sRGB LUT keeps video black at 16 and white at 235
+  EXPECT_NEAR(16 * 65535 / 255, clutData[0], 256);
+  EXPECT_NEAR(235 * 65535 / 255, clutData[(8 * 8 * 8 - 1) * 3], 256);
+  free(clutData);
+  cmsCloseProfile(sourceProfile);
+}
+
+TEST_F(TestColorManager, Create3dLutFailure)
+{
+  // a Lab display profile can't be linked to RGB output
+  uint16_t *clutData = (uint16_t*)1;
+  cmsHPROFILE sourceProfile = cmsCreate_sRGBProfile();
+  EXPECT_FALSE(Create(cmsCreateLab4Profile(NULL), sourceProfile, &clutData, 8));
+  EXPECT_TRUE(clutData == NULL);
+  cmsCloseProfile(sourceProfile);
+}
+
+#endif // defined(HAVE_LCMS2)
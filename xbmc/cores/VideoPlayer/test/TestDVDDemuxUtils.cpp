@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxPacket.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+// packet sizes of a 20 Mbit/s video stream at 24 fps interleaved with
+// 5.1 AC3 audio, repeated to a few hundred MB
+std::vector<int> GetCorpus()
+{
+  std::vector<int> sizes;
+  for (int gop = 0; gop < 300; gop++)
+  {
+    sizes.push_back(400000);
+    for (int frame = 1; frame < 24; frame++)
+    {
+      sizes.push_back(frame % 3 ? 60000 : 120000);
+      sizes.push_back(1536);
+    }
+  }
+  return sizes;
+}
+
+bool IsPadded(const DemuxPacket *packet)
+{
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+  {
+    if (packet->pData[packet->iSize + i] != 0)
+      return false;
+  }
+  return true;
+}
+
+// demuxes the corpus the way av_read_frame hands out packets, copying or
+// referencing every payload, and touches the payload like a decoder
+void DemuxCorpus(bool reference)
+{
+  std::vector<int> sizes = GetCorpus();
+  unsigned int checksum = 0;
+  for (std::vector<int>::const_iterator it = sizes.begin(); it != sizes.end(); ++it)
+  {
+    AVPacket pkt;
+    ASSERT_EQ(0, av_new_packet(&pkt, *it));
+    memset(pkt.data, *it & 0xff, pkt.size);
+
+    DemuxPacket *packet;
+    if (reference)
+      packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt);
+    else
+    {
+      packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
+      packet->iSize = pkt.size;
+      memcpy(packet->pData, pkt.data, pkt.size);
+    }
+    av_packet_unref(&pkt);
+
+    checksum += packet->pData[0] + packet->pData[packet->iSize - 1];
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+  EXPECT_NE(0u, checksum);
+}
+
+}
+
+TEST(TestDVDDemuxUtils, ReferencePacket)
+{
+  AVPacket pkt;
+  ASSERT_EQ(0, av_new_packet(&pkt, 1000));
+  memset(pkt.data, 0x55, pkt.size);
+  uint8_t *data = pkt.data;
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(data, packet->pData);
+  EXPECT_EQ(1000, packet->iSize);
+  EXPECT_TRUE(packet->pBuffer != NULL);
+  EXPECT_TRUE(pkt.buf == NULL);
+  EXPECT_TRUE(IsPadded(packet));
+  EXPECT_EQ(-1, packet->iStreamId);
+
+  // the payload stays valid after the AVPacket is gone
+  av_packet_unref(&pkt);
+  EXPECT_EQ(0x55, packet->pData[999]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST(TestDVDDemuxUtils, SharedPacketIsCopied)
+{
+  AVPacket pkt;
+  ASSERT_EQ(0, av_new_packet(&pkt, 1000));
+  memset(pkt.data, 0x55, pkt.size);
+
+  AVPacket other;
+  ASSERT_EQ(0, av_packet_ref(&other, &pkt));
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_NE(pkt.data, packet->pData);
+  EXPECT_TRUE(packet->pBuffer == NULL);
+  EXPECT_TRUE(pkt.buf != NULL);
+  EXPECT_EQ(1000, packet->iSize);
+  EXPECT_EQ(0, memcmp(pkt.data, packet->pData, packet->iSize));
+  EXPECT_TRUE(IsPadded(packet));
+
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+  av_packet_unref(&other);
+  av_packet_unref(&pkt);
+}
+
+TEST(TestDVDDemuxUtils, UnpaddedPacketIsCopied)
+{
+  AVPacket pkt;
+  ASSERT_EQ(0, av_new_packet(&pkt, 1000));
+  memset(pkt.data, 0x55, pkt.size + FF_INPUT_BUFFER_PADDING_SIZE);
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_TRUE(packet->pBuffer == NULL);
+  EXPECT_TRUE(IsPadded(packet));
+
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+  av_packet_unref(&pkt);
+}
+
+TEST(TestDVDDemuxUtils, EmptyPacket)
+{
+  AVPacket pkt;
+  av_init_packet(&pkt);
+  pkt.data = NULL;
+  pkt.size = 0;
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(pkt);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_TRUE(packet->pData == NULL);
+  EXPECT_EQ(0, packet->iSize);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+// turning five minutes of a 20 Mbit/s stream into demux packets, by copying
+// the payloads and by referencing them
+TEST(TestDVDDemuxUtils, DISABLED_ThroughputCopy)
+{
+  DemuxCorpus(false);
+}
+
+TEST(TestDVDDemuxUtils, DISABLED_ThroughputReference)
+{
+  DemuxCorpus(true);
+}
@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "TextureCache.h"
+#include "TextureCacheJob.h"
+#include "cores/VideoPlayer/DVDFileInfo.h"
+#include "cores/VideoPlayer/DVDStreamInfo.h"
+#include "cores/VideoPlayer/DVDCodecs/Video/DVDVideoCodec.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/Job.h"
+#include "utils/StreamDetails.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+CDVDStreamInfo GetHint(int width, int height)
+{
+  CDVDStreamInfo hint;
+  hint.type = STREAM_VIDEO;
+  hint.codec = AV_CODEC_ID_MPEG4;
+  hint.width = width;
+  hint.height = height;
+  hint.software = true;
+  return hint;
+}
+
+/*!
+ \brief Job that was cancelled while it waited in the queue
+ */
+class CCancelledJob : public CJob
+{
+public:
+  virtual bool DoWork() { return false; }
+  virtual bool ShouldCancel(unsigned int progress, unsigned int total) const { return true; }
+};
+
+/*! \brief Write a short uncompressed video ffmpeg can open without any codec
+ */
+void WriteVideo(const std::string &path, int width, int height)
+{
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(path, true));
+  std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+                       " F25:1 Ip A1:1 C420jpeg\n";
+  file.Write(header.c_str(), header.size());
+
+  std::string frame = "FRAME\n";
+  frame.append(width * height, (char)0x80);
+  frame.append(width * height / 2, (char)0x80);
+  for (int i = 0; i < 50; i++)
+    ASSERT_EQ((ssize_t)frame.size(), file.Write(frame.c_str(), frame.size()));
+  file.Close();
+}
+
+}
+
+class TestDVDThumbCodecCache : public testing::Test
+{
+protected:
+  static size_t GetIdleCount(CDVDThumbCodecCache &cache)
+  {
+    CSingleLock lock(cache.m_section);
+    return cache.m_idle.size();
+  }
+};
+
+TEST_F(TestDVDThumbCodecCache, Reuse)
+{
+  CDVDThumbCodecCache cache(1);
+  CDVDStreamInfo hint = GetHint(640, 360);
+
+  CProcessInfo *processInfo = NULL;
+  CDVDVideoCodec *codec = cache.Acquire(hint, processInfo);
+  ASSERT_TRUE(codec != NULL);
+  ASSERT_TRUE(processInfo != NULL);
+  cache.Release(hint, codec, processInfo);
+  EXPECT_EQ(1u, GetIdleCount(cache));
+
+  // a file in the same format gets the idle codec instead of opening one
+  CProcessInfo *reusedInfo = NULL;
+  CDVDVideoCodec *reused = cache.Acquire(hint, reusedInfo);
+  EXPECT_EQ(codec, reused);
+  EXPECT_EQ(processInfo, reusedInfo);
+  EXPECT_EQ(0u, GetIdleCount(cache));
+
+  // another format opens its own
+  CDVDStreamInfo other = GetHint(1280, 720);
+  CProcessInfo *otherInfo = NULL;
+  CDVDVideoCodec *otherCodec = cache.Acquire(other, otherInfo);
+  ASSERT_TRUE(otherCodec != NULL);
+  EXPECT_NE(codec, otherCodec);
+
+  // only the format of the latest file is kept
+  cache.Release(hint, reused, reusedInfo);
+  cache.Release(other, otherCodec, otherInfo);
+  EXPECT_EQ(1u, GetIdleCount(cache));
+
+  otherInfo = NULL;
+  EXPECT_EQ(otherCodec, cache.Acquire(other, otherInfo));
+  cache.Release(other, otherCodec, otherInfo);
+}
+
+TEST(TestDVDFileInfo, CancelledExtraction)
+{
+  const std::string path = "special://temp/TestDVDFileInfo.y4m";
+  WriteVideo(path, 64, 48);
+
+  CTextureDetails details;
+  details.file = "t/TestDVDFileInfo.jpg";
+  CStreamDetails streamDetails;
+  CCancelledJob job;
+  bool cancelled = false;
+  EXPECT_FALSE(CDVDFileInfo::ExtractThumb(path, details, &streamDetails, -1, NULL, &job, &cancelled));
+  EXPECT_TRUE(cancelled);
+
+  // the stream details are still filled in, but no placeholder stops the next try
+  EXPECT_EQ(64, streamDetails.GetVideoWidth());
+  EXPECT_FALSE(XFILE::CFile::Exists(CTextureCache::GetCachedPath(details.file)));
+
+  XFILE::CFile::Delete(path);
+}
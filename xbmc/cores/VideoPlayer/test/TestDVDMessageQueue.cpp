@@ -0,0 +1,241 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDMessageQueue.h"
+#include "cores/VideoPlayer/DVDClock.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxPacket.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/Thread.h"
+
+#ifdef TARGET_POSIX
+#include "linux/XTimeUtils.h"
+#endif
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+CDVDMsgDemuxerPacket* CreatePacket(int size, double pts)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->pts = pts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+double GetPts(CDVDMsg* msg)
+{
+  if (!msg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return -1.0;
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->pts;
+}
+
+// pulls packets like a decoder thread, checking that they arrive in order
+class CDecoder : public IRunnable
+{
+public:
+  CDecoder(CDVDMessageQueue &queue, int count)
+    : m_queue(queue), m_count(count), m_received(0), m_outOfOrder(0) {}
+
+  void Run() override
+  {
+    while (m_received < m_count)
+    {
+      CDVDMsg* msg;
+      if (m_queue.Get(&msg, 1000) != MSGQ_OK)
+        break;
+      if (GetPts(msg) != (double)m_received)
+        m_outOfOrder++;
+      m_received++;
+      msg->Release();
+    }
+  }
+
+  CDVDMessageQueue &m_queue;
+  int m_count;
+  int m_received;
+  int m_outOfOrder;
+};
+
+}
+
+TEST(TestDVDMessageQueue, Order)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  for (int i = 0; i < 3; i++)
+    EXPECT_EQ(MSGQ_OK, queue.Put(CreatePacket(100, i * DVD_TIME_BASE)));
+  EXPECT_EQ(300, queue.GetDataSize());
+  EXPECT_EQ(2, queue.GetTimeSize());
+  EXPECT_EQ(3u, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  for (int i = 0; i < 3; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_EQ(i * DVD_TIME_BASE, GetPts(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0, queue.GetLevel());
+
+  CDVDMsg* msg;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 10));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Priority)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(CreatePacket(10, 1.0));
+  queue.Put(CreatePacket(10, 2.0));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC), 1);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 2);
+  // put back at the front, retrieved before the other normal messages
+  queue.Put(CreatePacket(10, 0.0), 0, false);
+
+  CDVDMsg* msg;
+  int priority = 2;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  msg->Release();
+  // nothing left with priority 2 or higher
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  for (int i = 0; i < 3; i++)
+  {
+    priority = 0;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+    EXPECT_EQ((double)i, GetPts(msg));
+    EXPECT_EQ(0, priority);
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(CreatePacket(10, 0.0));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  queue.Put(CreatePacket(20, 1.0));
+  queue.Put(CreatePacket(40, 2.0), 0, false);
+  EXPECT_EQ(70, queue.GetDataSize());
+  EXPECT_EQ(3u, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  queue.Flush();
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0u, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(1u, queue.GetPacketCount(CDVDMsg::GENERAL_EOF));
+
+  // the flushed packets are skipped
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+
+  queue.Put(CreatePacket(10, 3.0));
+  queue.Abort();
+  EXPECT_EQ(MSGQ_ABORT, queue.Get(&msg, 0));
+  queue.End();
+  EXPECT_EQ(0, queue.GetDataSize());
+}
+
+TEST(TestDVDMessageQueue, Overflow)
+{
+  // more messages than the lock-free ring holds
+  const int count = 10000;
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  for (int i = 0; i < count; i++)
+    queue.Put(CreatePacket(1, i));
+  EXPECT_EQ(count, queue.GetDataSize());
+  EXPECT_EQ((unsigned)count, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  for (int i = 0; i < count; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_EQ((double)i, GetPts(msg));
+    msg->Release();
+    if (i == count / 2)
+      queue.Put(CreatePacket(1, count));
+  }
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_EQ((double)count, GetPts(msg));
+  msg->Release();
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+static void FeedDecoder(int count)
+{
+  // demuxer thread feeding a decoder thread, as in VideoPlayer
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  queue.SetMaxDataSize(1000 * 100);
+
+  CDecoder decoder(queue, count);
+  CThread thread(&decoder, "TestDecoder");
+
+  thread.Create();
+  for (int i = 0; i < count; i++)
+  {
+    // throttle on the queue level like the player does
+    while (queue.IsFull())
+      Sleep(0);
+    queue.Put(CreatePacket(100, i));
+  }
+  thread.StopThread();
+
+  EXPECT_EQ(count, decoder.m_received);
+  EXPECT_EQ(0, decoder.m_outOfOrder);
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Threads)
+{
+  FeedDecoder(10000);
+}
+
+// a million 100 byte packets from a demuxer to a decoder thread through a queue
+// holding 1000 of them, the cost of Put() and Get() under contention
+TEST(TestDVDMessageQueue, DISABLED_Throughput)
+{
+  FeedDecoder(1000000);
+}
@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "dataset.h"
+#include "system.h" // for PRId64
 #include "utils/log.h"
 #include <cstring>
 #include <algorithm>
@@ -202,6 +203,75 @@ void Dataset::parse_sql(std::string &sql) {
 }
 
 
+void Dataset::set_prepared_param(int index, const std::string &literal) {
+  if (index < 1)
+    throw DbErrors("Invalid parameter index %d", index);
+  if (prepared_params.size() < (size_t)index)
+    prepared_params.resize(index);
+  prepared_params[index - 1] = literal;
+}
+
+
+std::string Dataset::format_prepared() {
+  std::string result;
+  size_t param = 0;
+  bool quoted = false;
+  for (std::string::const_iterator c = prepared_sql.begin(); c != prepared_sql.end(); ++c)
+  {
+    if (*c == '\'')
+      quoted = !quoted;
+    if (*c != '?' || quoted)
+    {
+      result += *c;
+      continue;
+    }
+    if (param >= prepared_params.size())
+      throw DbErrors("Missing parameter %d of %s", (int)param + 1, prepared_sql.c_str());
+    result += prepared_params[param++];
+  }
+  return result;
+}
+
+
+bool Dataset::prepare(const std::string &sql) {
+  close();
+  prepared_sql = sql;
+  prepared_params.clear();
+  return true;
+}
+
+
+void Dataset::bind(int index, int64_t value) {
+  char literal[32];
+  snprintf(literal, sizeof(literal), "%" PRId64, value);
+  set_prepared_param(index, literal);
+}
+
+void Dataset::bind(int index, double value) {
+  char literal[32];
+  snprintf(literal, sizeof(literal), "%.17g", value);
+  set_prepared_param(index, literal);
+}
+
+void Dataset::bind(int index, const std::string &value) {
+  set_prepared_param(index, db->prepare("'%s'", value.c_str()));
+}
+
+void Dataset::bind_null(int index) {
+  set_prepared_param(index, "NULL");
+}
+
+
+bool Dataset::query_prepared() {
+  return query(format_prepared());
+}
+
+
+int Dataset::exec_prepared() {
+  return exec(format_prepared());
+}
+
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
@@ -32,6 +32,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "qry_dat.h"
 #include <stdarg.h>
@@ -239,6 +240,16 @@ protected:
    Essentually field idobject must present in the
    result set (select_sql statement) */
 
+/* Statement given to prepare() and its bound parameters as SQL literals,
+   for backends without prepared statements of their own */
+  std::string prepared_sql;
+  std::vector<std::string> prepared_params;
+
+/* Sets the literal of parameter index (starting with 1) */
+  void set_prepared_param(int index, const std::string &literal);
+/* Returns prepared_sql with the placeholders replaced by the bound parameters */
+  std::string format_prepared();
+
 
 
 
@@ -308,6 +319,35 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &sql) = 0;
+
+/* ---------- prepared statements ---------- */
+  /*! \brief Prepare a statement for typed parameter binding.
+   Parameters are '?' placeholders in the SQL, bound with bind() by their
+   index starting with 1, then the statement is run with query_prepared() or
+   exec_prepared(). Backends without prepared statements format the bound
+   values into the SQL, the way prepare() of the database does.
+   \param sql - SQL text with '?' placeholders.
+   \return true on success.
+   */
+  virtual bool prepare(const std::string &sql);
+  virtual void bind(int index, int64_t value);
+  virtual void bind(int index, double value);
+  virtual void bind(int index, const std::string &value);
+  virtual void bind_null(int index);
+  /*! \brief Bind any other integer type, like int, unsigned int or long, as a 64 bit integer.
+   Without it, integers that aren't int64_t would be ambiguous between the
+   int64_t and double overloads.
+   */
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type bind(int index, T value) { bind(index, (int64_t)value); }
+  /*! \brief Run the prepared select statement, as query() does.
+   \return true on success.
+   */
+  virtual bool query_prepared();
+  /*! \brief Run the prepared statement, as exec() does.
+   \return the result of exec().
+   */
+  virtual int exec_prepared();
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -87,6 +87,31 @@ static int busy_callback(void*, int busyCount)
   return 1;
 }
 
+// converts column i of the current row of stmt into v, keeping its type
+static void column_to_field(sqlite3_stmt *stmt, int i, field_value &v)
+{
+  switch (sqlite3_column_type(stmt, i))
+  {
+  case SQLITE_INTEGER:
+    v.set_asInt64(sqlite3_column_int64(stmt, i));
+    break;
+  case SQLITE_FLOAT:
+    v.set_asDouble(sqlite3_column_double(stmt, i));
+    break;
+  case SQLITE_TEXT:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_BLOB:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_NULL:
+  default:
+    v.set_asString("");
+    v.set_isNull();
+    break;
+  }
+}
+
 //************* SqliteDatabase implementation ***************
 
 SqliteDatabase::SqliteDatabase() {
@@ -261,6 +286,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
@@ -416,6 +442,60 @@ void SqliteDatabase::rollback_transaction() {
 }
 
 
+// methods for the prepared statement cache
+// ---------------------------------------------
+sqlite3_stmt *SqliteDatabase::acquire_statement(const std::string &sql) {
+  if (!active) return NULL;
+
+  std::map<std::string, StatementList::iterator>::iterator it = stmt_index.find(sql);
+  if (it != stmt_index.end())
+  {
+    sqlite3_stmt *stmt = it->second->second;
+    stmt_cache.erase(it->second);
+    stmt_index.erase(it);
+    return stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if ((last_err = setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str())) != SQLITE_OK)
+  {
+    sqlite3_finalize(stmt);
+    return NULL;
+  }
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(const std::string &sql, sqlite3_stmt *stmt) {
+  if (stmt == NULL) return;
+
+  // the same SQL may have been in use by several datasets at once, keep one copy
+  if (!active || stmt_index.find(sql) != stmt_index.end())
+  {
+    sqlite3_finalize(stmt);
+    return;
+  }
+
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  stmt_cache.push_front(std::make_pair(sql, stmt));
+  stmt_index[sql] = stmt_cache.begin();
+
+  while (stmt_cache.size() > stmt_cache_size)
+  {
+    stmt_index.erase(stmt_cache.back().first);
+    sqlite3_finalize(stmt_cache.back().second);
+    stmt_cache.pop_back();
+  }
+}
+
+void SqliteDatabase::clear_statements() {
+  for (StatementList::iterator it = stmt_cache.begin(); it != stmt_cache.end(); ++it)
+    sqlite3_finalize(it->second);
+  stmt_cache.clear();
+  stmt_index.clear();
+}
+
+
 // methods for formatting
 // ---------------------------------------------
 std::string SqliteDatabase::vprepare(const char *format, va_list args)
@@ -455,6 +535,9 @@ SqliteDataset::SqliteDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  stmt = NULL;
+  streaming = false;
+  stream_rows = 0;
 }
 
 
@@ -463,9 +546,13 @@ SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  stmt = NULL;
+  streaming = false;
+  stream_rows = 0;
 }
 
  SqliteDataset::~SqliteDataset(){
+   release_stmt();
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -536,6 +623,58 @@ void SqliteDataset::make_deletion() {
 }
 
 
+void SqliteDataset::fill_fields_from_stmt() {
+  const unsigned int ncols = sqlite3_column_count(stmt);
+  if (fields_object->size() != ncols)
+  {
+    fields_object->resize(ncols);
+    for (unsigned int i = 0; i < ncols; i++)
+      (*fields_object)[i].props.name = sqlite3_column_name(stmt, i);
+  }
+
+  for (unsigned int i = 0; i < ncols; i++)
+    column_to_field(stmt, i, (*fields_object)[i].val);
+}
+
+
+void SqliteDataset::step_stmt() {
+  int rc = sqlite3_step(stmt);
+  if (rc == SQLITE_ROW)
+  {
+    stream_rows++;
+    feof = false;
+  }
+  else
+  {
+    // reset the exhausted statement right away, it holds the read lock until then
+    feof = true;
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+      db->setErr(rc, stmt_sql.c_str());
+      throw DbErrors(db->getErrorMsg());
+    }
+  }
+}
+
+
+void SqliteDataset::reset_stmt() {
+  if (stmt == NULL) throw DbErrors("No prepared statement");
+  // a statement that has been stepped can't be bound to before it is reset
+  sqlite3_reset(stmt);
+}
+
+
+void SqliteDataset::release_stmt() {
+  if (stmt != NULL && db != NULL)
+    static_cast<SqliteDatabase*>(db)->release_statement(stmt_sql, stmt);
+  stmt = NULL;
+  stmt_sql.clear();
+  streaming = false;
+  stream_rows = 0;
+}
+
+
 void SqliteDataset::fill_fields() {
   //cout <<"rr "<<result.records.size()<<"|" << frecno <<"\n";
   if ((db == NULL) || (result.record_header.empty()) || (result.records.size() < (unsigned int)frecno)) return;
@@ -666,29 +805,7 @@ bool SqliteDataset::query(const std::string &query) {
     sql_record *res = new sql_record;
     res->resize(numColumns);
     for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
+      column_to_field(stmt, i, res->at(i));
     result.records.push_back(res);
   }
   if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
@@ -719,7 +836,79 @@ void SqliteDataset::open() {
 }
 
 
+bool SqliteDataset::prepare(const std::string &sql) {
+  if (!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  stmt = static_cast<SqliteDatabase*>(db)->acquire_statement(sql);
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+  stmt_sql = sql;
+  return true;
+}
+
+
+void SqliteDataset::bind(int index, int64_t value) {
+  reset_stmt();
+  if (db->setErr(sqlite3_bind_int64(stmt, index, value), stmt_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+void SqliteDataset::bind(int index, double value) {
+  reset_stmt();
+  if (db->setErr(sqlite3_bind_double(stmt, index, value), stmt_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+void SqliteDataset::bind(int index, const std::string &value) {
+  reset_stmt();
+  if (db->setErr(sqlite3_bind_text(stmt, index, value.c_str(), value.size(), SQLITE_TRANSIENT), stmt_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+void SqliteDataset::bind_null(int index) {
+  reset_stmt();
+  if (db->setErr(sqlite3_bind_null(stmt, index), stmt_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+
+bool SqliteDataset::query_prepared() {
+  if (stmt == NULL) throw DbErrors("No prepared statement");
+
+  sqlite3_reset(stmt);
+  result.clear();
+  fields_object->clear();
+  streaming = true;
+  stream_rows = 0;
+  active = true;
+  ds_state = dsSelect;
+
+  step_stmt();
+  fbof = feof;
+  if (!feof)
+    fill_fields_from_stmt();
+  return true;
+}
+
+
+int SqliteDataset::exec_prepared() {
+  if (stmt == NULL) throw DbErrors("No prepared statement");
+
+  sqlite3_reset(stmt);
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    ;
+  sqlite3_reset(stmt);
+  if (db->setErr(rc == SQLITE_DONE ? SQLITE_OK : rc, stmt_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return SQLITE_OK;
+}
+
+
 void SqliteDataset::close() {
+  release_stmt();
   Dataset::close();
   result.clear();
   edit_object->clear();
@@ -740,6 +929,8 @@ void SqliteDataset::cancel() {
 
 
 int SqliteDataset::num_rows() {
+  if (streaming)
+    return stream_rows;
   return result.records.size();
 }
 
@@ -755,21 +946,41 @@ bool SqliteDataset::bof() {
 
 
 void SqliteDataset::first() {
+  if (streaming)
+  {
+    if (stream_rows > 1)
+      throw DbErrors("Streaming dataset can't be rewound");
+    return;
+  }
   Dataset::first();
   this->fill_fields();
 }
 
 void SqliteDataset::last() {
+  if (streaming)
+    throw DbErrors("Streaming dataset can only move forward");
   Dataset::last();
   fill_fields();
 }
 
 void SqliteDataset::prev(void) {
+  if (streaming)
+    throw DbErrors("Streaming dataset can only move forward");
   Dataset::prev();
   fill_fields();
 }
 
 void SqliteDataset::next(void) {
+  if (streaming)
+  {
+    if (ds_state != dsSelect || feof)
+      return;
+    fbof = false;
+    step_stmt();
+    if (!eof())
+      fill_fields_from_stmt();
+    return;
+  }
   Dataset::next();
   if (!eof()) 
       fill_fields();
@@ -789,6 +1000,8 @@ void SqliteDataset::free_row(void)
 }
 
 bool SqliteDataset::seek(int pos) {
+  if (streaming)
+    return false;
   if (ds_state == dsSelect) {
     Dataset::seek(pos);
     fill_fields();
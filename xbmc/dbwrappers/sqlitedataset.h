@@ -29,6 +29,8 @@
  **********************************************************************/
 
 #include <stdio.h>
+#include <list>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -96,6 +98,28 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* prepared statement cache */
+  /*! \brief Get a prepared statement for the given SQL.
+   Statements are taken from the per-connection cache when available, and
+   prepared with sqlite3_prepare_v2 otherwise. The caller owns the statement
+   until it is handed back with release_statement().
+   \param sql - SQL text of the statement, used as the cache key.
+   \return the prepared statement, NULL on error.
+   */
+  sqlite3_stmt *acquire_statement(const std::string &sql);
+  /*! \brief Return a statement obtained with acquire_statement() to the cache.
+   The statement is reset and its bindings cleared. The least recently used
+   statement is finalized when the cache is full.
+   */
+  void release_statement(const std::string &sql, sqlite3_stmt *stmt);
+  /*! \brief Finalize all cached prepared statements. */
+  void clear_statements();
+
+private:
+  typedef std::list<std::pair<std::string, sqlite3_stmt*> > StatementList;
+  StatementList stmt_cache;   // most recently used first
+  std::map<std::string, StatementList::iterator> stmt_index;
+  static const size_t stmt_cache_size = 32;
 };
 
 
@@ -127,6 +151,20 @@ protected:
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
 
+/* Streaming mode: the current row is read from stmt instead of the result set */
+  sqlite3_stmt *stmt;
+  std::string stmt_sql;
+  bool streaming;
+  int stream_rows;
+/* Fill the fields from the current row of the prepared statement */
+  void fill_fields_from_stmt();
+/* Step the prepared statement to the next row, updating eof */
+  void step_stmt();
+/* Reset the prepared statement for new bindings */
+  void reset_stmt();
+/* Return the prepared statement to the statement cache */
+  void release_stmt();
+
 public:
 /* constructor */
   SqliteDataset();
@@ -171,6 +209,35 @@ or insert() operations default = false) */
   virtual bool seek(int pos=0);
 
   virtual bool dropIndex(const char *table, const char *index);
+
+/* ---------- prepared statements and row streaming ---------- */
+  /*! \brief Prepare a statement for typed parameter binding.
+   The statement is taken from the connection's prepared statement cache, so
+   repeated calls with the same SQL text skip the SQL compiler. Parameters
+   are bound with bind() using sqlite's 1-based indices, then the statement
+   is run with query_prepared() or exec_prepared().
+   \param sql - SQL text with '?' placeholders.
+   \return true on success.
+   */
+  virtual bool prepare(const std::string &sql);
+  using Dataset::bind;
+  virtual void bind(int index, int64_t value);
+  virtual void bind(int index, double value);
+  virtual void bind(int index, const std::string &value);
+  virtual void bind_null(int index);
+  /*! \brief Run the prepared select statement and fetch the first row.
+   Unlike query(), rows are not collected into the result set: each call to
+   next() steps the statement and fills the fields of the new current row.
+   Only forward navigation is possible, and num_rows() returns the number of
+   rows fetched so far. The dataset remains usable with the regular field
+   accessors (fv(), get_field_value()).
+   \return true on success.
+   */
+  virtual bool query_prepared();
+  /*! \brief Run the prepared statement, discarding any returned rows.
+   \return SQLITE_OK on success.
+   */
+  virtual int exec_prepared();
 };
 } //namespace
 
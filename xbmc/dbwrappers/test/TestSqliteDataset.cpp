@@ -0,0 +1,217 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace dbiplus;
+
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    m_path = CSpecialProtocol::TranslatePath("special://temp/");
+    m_db.setHostName(m_path.c_str());
+    m_db.setDatabase("TestSqliteDataset.db");
+    m_db.connect(true);
+    m_ds.reset(m_db.CreateDataset());
+    m_ds->exec("CREATE TABLE movie (idMovie integer primary key, strTitle text, rating double, playCount integer)");
+  }
+
+  ~TestSqliteDataset()
+  {
+    m_ds.reset();
+    m_db.disconnect();
+    XFILE::CFile::Delete(URIUtils::AddFileToFolder(m_path, "TestSqliteDataset.db"));
+  }
+
+  void AddMovies(int count)
+  {
+    m_ds->prepare("INSERT INTO movie (strTitle, rating, playCount) VALUES (?, ?, ?)");
+    for (int i = 0; i < count; i++)
+    {
+      m_ds->bind(1, StringUtils::Format("Movie %d", i));
+      m_ds->bind(2, i / 10.0);
+      m_ds->bind(3, i);
+      m_ds->exec_prepared();
+    }
+    m_ds->close();
+  }
+
+  std::string m_path;
+  SqliteDatabase m_db;
+  std::unique_ptr<Dataset> m_ds;
+};
+
+TEST_F(TestSqliteDataset, BindAndExec)
+{
+  m_ds->prepare("INSERT INTO movie (strTitle, rating, playCount) VALUES (?, ?, ?)");
+  m_ds->bind(1, std::string("It's a 'quoted' ? title"));
+  m_ds->bind(2, 7.25);
+  m_ds->bind(3, (int64_t)1 << 40);
+  EXPECT_EQ(SQLITE_OK, m_ds->exec_prepared());
+
+  // the bindings of the last row are replaced, not kept
+  m_ds->bind(1, std::string("Second"));
+  m_ds->bind_null(2);
+  m_ds->bind(3, 2);
+  EXPECT_EQ(SQLITE_OK, m_ds->exec_prepared());
+
+  ASSERT_TRUE(m_ds->query("SELECT strTitle, rating, playCount FROM movie ORDER BY idMovie"));
+  ASSERT_EQ(2, m_ds->num_rows());
+  EXPECT_EQ("It's a 'quoted' ? title", m_ds->fv(0).get_asString());
+  EXPECT_DOUBLE_EQ(7.25, m_ds->fv(1).get_asDouble());
+  EXPECT_EQ((int64_t)1 << 40, m_ds->fv(2).get_asInt64());
+  m_ds->next();
+  EXPECT_EQ("Second", m_ds->fv(0).get_asString());
+  EXPECT_TRUE(m_ds->fv(1).get_isNull());
+  EXPECT_EQ(2, m_ds->fv(2).get_asInt());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, QueryPrepared)
+{
+  AddMovies(100);
+
+  m_ds->prepare("SELECT idMovie, strTitle FROM movie WHERE playCount >= ? ORDER BY playCount");
+  m_ds->bind(1, 50);
+  ASSERT_TRUE(m_ds->query_prepared());
+
+  // rows are fetched one at a time, the fields follow the current row
+  int count = 0;
+  while (!m_ds->eof())
+  {
+    EXPECT_EQ(count + 1, m_ds->num_rows());
+    EXPECT_EQ(StringUtils::Format("Movie %d", 50 + count), m_ds->fv("strTitle").get_asString());
+    EXPECT_EQ(51 + count, m_ds->fv(0).get_asInt());
+    m_ds->next();
+    count++;
+  }
+  EXPECT_EQ(50, count);
+
+  // and the statement runs again with other parameters
+  m_ds->bind(1, 99);
+  ASSERT_TRUE(m_ds->query_prepared());
+  ASSERT_FALSE(m_ds->eof());
+  EXPECT_EQ("Movie 99", m_ds->fv(1).get_asString());
+  m_ds->next();
+  EXPECT_TRUE(m_ds->eof());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, BindIntegerTypes)
+{
+  // every integer type binds as a 64 bit integer
+  m_ds->prepare("INSERT INTO movie (strTitle, rating, playCount) VALUES ('Movie', ?, ?)");
+  m_ds->bind(1, 2.5f);
+  m_ds->bind(2, 3u);
+  m_ds->exec_prepared();
+  m_ds->bind(1, (long)4);
+  m_ds->bind(2, (unsigned long)5);
+  m_ds->exec_prepared();
+  m_ds->bind(1, (short)6);
+  m_ds->bind(2, (uint64_t)1 << 40);
+  m_ds->exec_prepared();
+
+  ASSERT_TRUE(m_ds->query("SELECT rating, playCount FROM movie ORDER BY idMovie"));
+  ASSERT_EQ(3, m_ds->num_rows());
+  EXPECT_DOUBLE_EQ(2.5, m_ds->fv(0).get_asDouble());
+  EXPECT_EQ(3, m_ds->fv(1).get_asInt());
+  m_ds->next();
+  EXPECT_EQ(4, m_ds->fv(0).get_asInt());
+  EXPECT_EQ(5, m_ds->fv(1).get_asInt());
+  m_ds->next();
+  EXPECT_EQ(6, m_ds->fv(0).get_asInt());
+  EXPECT_EQ((int64_t)1 << 40, m_ds->fv(1).get_asInt64());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, StreamingReleasesLock)
+{
+  AddMovies(10);
+
+  SqliteDatabase writer;
+  writer.setHostName(m_path.c_str());
+  writer.setDatabase("TestSqliteDataset.db");
+  ASSERT_EQ(DB_CONNECTION_OK, writer.connect(false));
+  // fail instead of waiting for the reader
+  sqlite3_busy_timeout(writer.getHandle(), 0);
+  std::unique_ptr<Dataset> ds(writer.CreateDataset());
+
+  // a statement still stepping through its rows keeps the database locked
+  m_ds->prepare("SELECT strTitle FROM movie");
+  ASSERT_TRUE(m_ds->query_prepared());
+  EXPECT_THROW(ds->exec("DELETE FROM movie WHERE playCount = 0"), DbErrors);
+
+  // but not once all of them were read, even before the dataset is closed
+  while (!m_ds->eof())
+    m_ds->next();
+  EXPECT_NO_THROW(ds->exec("DELETE FROM movie WHERE playCount = 0"));
+  EXPECT_EQ(10, m_ds->num_rows());
+  m_ds->close();
+
+  ds.reset();
+  writer.disconnect();
+}
+
+TEST_F(TestSqliteDataset, StatementCache)
+{
+  const std::string sql = "SELECT strTitle FROM movie WHERE idMovie = ?";
+  sqlite3_stmt *stmt = m_db.acquire_statement(sql);
+  ASSERT_TRUE(stmt != NULL);
+  m_db.release_statement(sql, stmt);
+
+  // prepared once, then reused
+  EXPECT_EQ(stmt, m_db.acquire_statement(sql));
+  m_db.release_statement(sql, stmt);
+
+  EXPECT_TRUE(m_db.acquire_statement("SELECT nothing FROM nowhere") == NULL);
+}
+
+TEST_F(TestSqliteDataset, FormattedParameters)
+{
+  AddMovies(10);
+
+  // what backends without prepared statements do
+  m_ds->Dataset::prepare("SELECT strTitle FROM movie WHERE strTitle != '?' AND (strTitle = ? OR rating = ?) AND playCount > ?");
+  m_ds->Dataset::bind(1, std::string("Movie 'x'"));
+  m_ds->Dataset::bind(2, 0.5);
+  m_ds->Dataset::bind(3, (int64_t)-1);
+  ASSERT_TRUE(m_ds->Dataset::query_prepared());
+  ASSERT_EQ(1, m_ds->num_rows());
+  EXPECT_EQ("Movie 5", m_ds->fv(0).get_asString());
+  m_ds->close();
+
+  m_ds->Dataset::prepare("DELETE FROM movie WHERE playCount > ?");
+  EXPECT_THROW(m_ds->Dataset::exec_prepared(), DbErrors);
+  m_ds->Dataset::bind(1, (int64_t)4);
+  m_ds->Dataset::exec_prepared();
+  ASSERT_TRUE(m_ds->query("SELECT COUNT(*) FROM movie"));
+  EXPECT_EQ(5, m_ds->fv(0).get_asInt());
+  m_ds->close();
+}
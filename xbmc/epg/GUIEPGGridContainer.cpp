@@ -564,7 +564,7 @@ void CGUIEPGGridContainer::UpdateItems()
     if (newChannelIndex == oldChannelIndex && newBlockIndex == oldBlockIndex)
     {
       // same coordinates, keep current grid view port
-      m_item = GetItem(m_channelCursor);
+      SetItem(GetItem(m_channelCursor));
     }
     else
     {
@@ -581,7 +581,7 @@ void CGUIEPGGridContainer::UpdateItems()
   else
   {
     // no previous selection, goto now
-    m_item = GetItem(m_channelCursor);
+    SetItem(GetItem(m_channelCursor));
 
     SetInvalid();
     GoToNow();
@@ -666,7 +666,7 @@ void CGUIEPGGridContainer::OnLeft()
         m_item->item != m_gridModel->GetGridItem(m_channelCursor + m_channelOffset, m_blockOffset))
     {
       // this is not first item on page
-      m_item = GetPrevItem(m_channelCursor);
+      SetItem(GetPrevItem(m_channelCursor));
       SetBlock(GetBlock(m_item->item, m_channelCursor));
 
       return;
@@ -691,7 +691,7 @@ void CGUIEPGGridContainer::OnRight()
     if (m_item->item != m_gridModel->GetGridItem(m_channelCursor + m_channelOffset, m_blocksPerPage + m_blockOffset - 1))
     {
       // this is not last item on page
-      m_item = GetNextItem(m_channelCursor);
+      SetItem(GetNextItem(m_channelCursor));
       SetBlock(GetBlock(m_item->item, m_channelCursor));
 
       return;
@@ -743,7 +743,7 @@ void CGUIEPGGridContainer::SetChannel(int channel, bool bFindClosestItem /* = tr
 
   if (!bFindClosestItem || m_blockCursor + m_blockOffset == 0 || m_blockOffset + m_blockCursor + GetItemSize(m_item) == m_gridModel->GetBlockCount())
   {
-    m_item = GetItem(channel);
+    SetItem(GetItem(channel));
     if (m_item)
     {
       m_channelCursor = channel;
@@ -753,7 +753,7 @@ void CGUIEPGGridContainer::SetChannel(int channel, bool bFindClosestItem /* = tr
   }
 
   /* basic checks failed, need to correctly identify nearest item */
-  m_item = GetClosestItem(channel);
+  SetItem(GetClosestItem(channel));
   if (m_item)
   {
     m_channelCursor = channel;
@@ -772,7 +772,7 @@ void CGUIEPGGridContainer::SetBlock(int block)
   else
     m_blockCursor = block;
 
-  m_item = GetItem(m_channelCursor);
+  SetItem(GetItem(m_channelCursor));
 }
 
 CGUIListItemLayout *CGUIEPGGridContainer::GetFocusedLayout() const
@@ -1037,6 +1037,13 @@ std::string CGUIEPGGridContainer::GetLabel(int info) const
   return label;
 }
 
+void CGUIEPGGridContainer::SetItem(GridItem *item)
+{
+  if (m_item != item)
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_LISTITEM);
+  m_item = item;
+}
+
 GridItem *CGUIEPGGridContainer::GetClosestItem(int channel)
 {
   GridItem *closest = GetItem(channel);
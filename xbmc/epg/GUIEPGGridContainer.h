@@ -99,6 +99,7 @@ namespace EPG
     GridItem *GetNextItem(int channel);
     GridItem *GetPrevItem(int channel);
     GridItem *GetClosestItem(int channel);
+    void SetItem(GridItem *item);
 
     int GetItemSize(GridItem *item);
     int GetBlock(const CGUIListItemPtr &item, int channel);
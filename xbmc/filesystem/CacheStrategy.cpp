@@ -66,6 +66,24 @@ void CCacheStrategy::ClearEndOfInput()
   m_bEndOfInput = false;
 }
 
+int CCacheStrategy::GetReadView(const char **pBuffer, size_t iMaxSize)
+{
+  return CACHE_RC_ERROR;
+}
+
+void CCacheStrategy::ConsumeReadView(size_t iSize)
+{
+}
+
+int CCacheStrategy::GetWriteView(char **pBuffer, size_t iMaxSize)
+{
+  return CACHE_RC_ERROR;
+}
+
+void CCacheStrategy::CommitWriteView(size_t iSize)
+{
+}
+
 CSimpleFileCache::CSimpleFileCache()
   : m_cacheFileRead(new CacheLocalFile())
   , m_cacheFileWrite(new CacheLocalFile())
@@ -407,6 +425,26 @@ bool CDoubleCache::IsCachedPosition(int64_t iFilePosition)
   return m_pCache->IsCachedPosition(iFilePosition) || (m_pCacheOld && m_pCacheOld->IsCachedPosition(iFilePosition));
 }
 
+int CDoubleCache::GetReadView(const char **pBuffer, size_t iMaxSize)
+{
+  return m_pCache->GetReadView(pBuffer, iMaxSize);
+}
+
+void CDoubleCache::ConsumeReadView(size_t iSize)
+{
+  m_pCache->ConsumeReadView(iSize);
+}
+
+int CDoubleCache::GetWriteView(char **pBuffer, size_t iMaxSize)
+{
+  return m_pCache->GetWriteView(pBuffer, iMaxSize);
+}
+
+void CDoubleCache::CommitWriteView(size_t iSize)
+{
+  m_pCache->CommitWriteView(iSize);
+}
+
 CCacheStrategy *CDoubleCache::CreateNew()
 {
   return new CDoubleCache(m_pCache->CreateNew());
@@ -22,6 +22,7 @@
 #ifndef XFILECACHESTRATEGY_H
 #define XFILECACHESTRATEGY_H
 
+#include <atomic>
 #include <stdint.h>
 #include <string>
 #include "threads/Event.h"
@@ -67,11 +68,44 @@ public:
   virtual int64_t CachedDataEndPos() = 0;
   virtual bool IsCachedPosition(int64_t iFilePosition) = 0;
 
+  /*!
+   \brief Get the cached data at the read position without copying it
+   The data stays valid until the read position is moved.
+   \param pBuffer [out] pointer to the cached data
+   \param iMaxSize maximum number of bytes wanted
+   \return number of bytes available at pBuffer, 0 at end of input, CACHE_RC_WOULD_BLOCK if no
+           data is available yet or CACHE_RC_ERROR if the cache doesn't support read views
+   \sa ConsumeReadView
+   */
+  virtual int GetReadView(const char **pBuffer, size_t iMaxSize);
+
+  /*!
+   \brief Move the read position past data returned by GetReadView
+   \param iSize number of bytes consumed, no more than GetReadView returned
+   */
+  virtual void ConsumeReadView(size_t iSize);
+
+  /*!
+   \brief Get the space at the write position so that the caller can fill it directly
+   \param pBuffer [out] pointer to the space to write
+   \param iMaxSize maximum number of bytes to be written
+   \return number of bytes that may be written at pBuffer, 0 if the cache is full or
+           CACHE_RC_ERROR if the cache doesn't support write views
+   \sa CommitWriteView
+   */
+  virtual int GetWriteView(char **pBuffer, size_t iMaxSize);
+
+  /*!
+   \brief Make data written to the space returned by GetWriteView available to the reader
+   \param iSize number of bytes written, no more than GetWriteView returned
+   */
+  virtual void CommitWriteView(size_t iSize);
+
   virtual CCacheStrategy *CreateNew() = 0;
 
   CEvent m_space;
 protected:
-  bool  m_bEndOfInput;
+  std::atomic<bool> m_bEndOfInput;
 };
 
 /**
@@ -134,6 +168,11 @@ public:
   virtual int64_t CachedDataEndPos();
   virtual bool IsCachedPosition(int64_t iFilePosition);
 
+  virtual int GetReadView(const char **pBuffer, size_t iMaxSize);
+  virtual void ConsumeReadView(size_t iSize);
+  virtual int GetWriteView(char **pBuffer, size_t iMaxSize);
+  virtual void CommitWriteView(size_t iSize);
+
   virtual CCacheStrategy *CreateNew();
 
 protected:
@@ -24,6 +24,12 @@
 #include "threads/SingleLock.h"
 #include "CircularCache.h"
 
+#if defined(TARGET_POSIX)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace XFILE;
 
 CCircularCache::CCircularCache(size_t front, size_t back)
@@ -34,6 +40,8 @@ CCircularCache::CCircularCache(size_t front, size_t back)
  , m_buf(NULL)
  , m_size(front + back)
  , m_size_back(back)
+ , m_mirrored(false)
+ , m_readerWaiting(false)
 #ifdef TARGET_WINDOWS
  , m_handle(INVALID_HANDLE_VALUE)
 #endif
@@ -45,6 +53,46 @@ CCircularCache::~CCircularCache()
   Close();
 }
 
+bool CCircularCache::MapMirrored()
+{
+#if defined(TARGET_POSIX) && defined(SYS_memfd_create)
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = (m_size + page - 1) / page * page;
+
+  int fd = syscall(SYS_memfd_create, "CircularCache", 0);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, size) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // reserve room for both mappings, then map the same pages into each half
+  uint8_t *buf = (uint8_t*)mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buf == MAP_FAILED)
+  {
+    close(fd);
+    return false;
+  }
+  if (mmap(buf, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+      mmap(buf + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+  {
+    munmap(buf, 2 * size);
+    close(fd);
+    return false;
+  }
+  close(fd); // the mappings keep the memory alive
+
+  m_buf = buf;
+  m_size = size;
+  m_mirrored = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
 int CCircularCache::Open()
 {
 #ifdef TARGET_WINDOWS
@@ -53,7 +101,8 @@ int CCircularCache::Open()
     return CACHE_RC_ERROR;
   m_buf = (uint8_t*)MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
 #else
-  m_buf = new uint8_t[m_size];
+  if (!MapMirrored())
+    m_buf = new uint8_t[m_size];
 #endif
   if(m_buf == 0)
     return CACHE_RC_ERROR;
@@ -70,17 +119,25 @@ void CCircularCache::Close()
   CloseHandle(m_handle);
   m_handle = INVALID_HANDLE_VALUE;
 #else
-  delete[] m_buf;
+#if defined(TARGET_POSIX)
+  if (m_mirrored)
+  {
+    if (m_buf)
+      munmap(m_buf, 2 * m_size);
+  }
+  else
+#endif
+    delete[] m_buf;
 #endif
   m_buf = NULL;
+  m_mirrored = false;
 }
 
 size_t CCircularCache::GetMaxWriteSize(const size_t& iRequestSize)
 {
-  CSingleLock lock(m_sync);
-
-  size_t back  = (size_t)(m_cur - m_beg); // Backbuffer size
-  size_t front = (size_t)(m_end - m_cur); // Frontbuffer size
+  int64_t cur = m_cur;
+  size_t back  = (size_t)(cur - m_beg); // Backbuffer size
+  size_t front = (size_t)(m_end - cur); // Frontbuffer size
   size_t limit = m_size - std::min(back, m_size_back) - front;
 
   // Never return more than limit and size requested by caller
@@ -89,8 +146,9 @@ size_t CCircularCache::GetMaxWriteSize(const size_t& iRequestSize)
 
 /**
  * Function will write to m_buf at m_end % m_size location
- * it will write at maximum m_size, but it will only write
- * as much it can without wrapping around in the buffer
+ * it will write at maximum m_size, but unless the buffer
+ * is mirrored it will only write as much it can without
+ * wrapping around in the buffer
  *
  * It will always leave m_size_back of the backbuffer intact
  * but if the back buffer is less than that, that space is
@@ -108,12 +166,26 @@ size_t CCircularCache::GetMaxWriteSize(const size_t& iRequestSize)
  */
 int CCircularCache::WriteToCache(const char *buf, size_t len)
 {
-  CSingleLock lock(m_sync);
+  char *dst;
+  int ret = GetWriteView(&dst, len);
+  if (ret <= 0)
+    return ret;
 
+  // write the data
+  memcpy(dst, buf, ret);
+  CommitWriteView(ret);
+
+  return ret;
+}
+
+int CCircularCache::GetWriteView(char **buf, size_t len)
+{
   // where are we in the buffer
-  size_t pos   = m_end % m_size;
-  size_t back  = (size_t)(m_cur - m_beg);
-  size_t front = (size_t)(m_end - m_cur);
+  int64_t end  = m_end;
+  int64_t beg  = m_beg;
+  size_t pos   = end % m_size;
+  size_t back  = (size_t)(m_cur - beg);
+  size_t front = (size_t)(end - m_cur);
 
   size_t limit = m_size - std::min(back, m_size_back) - front;
   size_t wrap  = m_size - pos;
@@ -123,58 +195,88 @@ int CCircularCache::WriteToCache(const char *buf, size_t len)
     len = limit;
 
   // limit to wrap point
-  if(len > wrap)
+  if(len > wrap && !m_mirrored)
     len = wrap;
 
   if(len == 0)
     return 0;
 
-  // write the data
-  memcpy(m_buf + pos, buf, len);
-  m_end += len;
+  // drop history that is about to be overwritten. Seek() may have moved the
+  // read position back into it, so recheck the limit while holding it off.
+  if(end + (int64_t)len - (int64_t)m_size > beg)
+  {
+    CSingleLock lock(m_sync);
+    back  = (size_t)(m_cur - beg);
+    front = (size_t)(end - m_cur);
+    limit = m_size - std::min(back, m_size_back) - front;
+    if(len > limit)
+      len = limit;
+    if(len == 0)
+      return 0;
+    if(end + (int64_t)len - (int64_t)m_size > beg)
+      m_beg = end + len - m_size;
+  }
 
-  // drop history that was overwritten
-  if(m_end - m_beg > (int64_t)m_size)
-    m_beg = m_end - m_size;
+  *buf = (char*)m_buf + pos;
+  return len;
+}
 
-  m_written.Set();
+void CCircularCache::CommitWriteView(size_t len)
+{
+  m_end += len;
 
-  return len;
+  if (m_readerWaiting)
+    m_written.Set();
 }
 
 /**
- * Reads data from cache. Will only read up till
- * the buffer wrap point. So multiple calls
- * may be needed to empty the whole cache
+ * Reads data from cache. Unless the buffer is mirrored it
+ * will only read up till the buffer wrap point. So multiple
+ * calls may be needed to empty the whole cache
  */
 int CCircularCache::ReadFromCache(char *buf, size_t len)
 {
-  CSingleLock lock(m_sync);
+  const char *src;
+  int ret = GetReadView(&src, len);
+  if (ret <= 0)
+    return ret;
+
+  memcpy(buf, src, ret);
+  ConsumeReadView(ret);
 
-  size_t pos   = m_cur % m_size;
-  size_t front = (size_t)(m_end - m_cur);
-  size_t avail = std::min(m_size - pos, front);
+  return ret;
+}
+
+int CCircularCache::GetReadView(const char **buf, size_t len)
+{
+  int64_t cur  = m_cur;
+  size_t pos   = cur % m_size;
+  size_t front = (size_t)(m_end - cur);
+  size_t avail = m_mirrored ? front : std::min(m_size - pos, front);
 
   if(avail == 0)
   {
-    if(IsEndOfInput())
-      return 0;
-    else
+    if(!IsEndOfInput())
       return CACHE_RC_WOULD_BLOCK;
+    // the last data may have been written just before the end of input was flagged
+    front = (size_t)(m_end - cur);
+    avail = m_mirrored ? front : std::min(m_size - pos, front);
+    if(avail == 0)
+      return 0;
   }
 
   if(len > avail)
     len = avail;
 
-  if(len == 0)
-    return 0;
+  *buf = (const char*)m_buf + pos;
+  return len;
+}
 
-  memcpy(buf, m_buf + pos, len);
+void CCircularCache::ConsumeReadView(size_t len)
+{
   m_cur += len;
 
   m_space.Set();
-
-  return len;
 }
 
 /* Wait "millis" milliseconds for "minimum" amount of data to come in.
@@ -183,7 +285,6 @@ int CCircularCache::ReadFromCache(char *buf, size_t len)
  */
 int64_t CCircularCache::WaitForData(unsigned int minimum, unsigned int millis)
 {
-  CSingleLock lock(m_sync);
   int64_t avail = m_end - m_cur;
 
   if(millis == 0 || IsEndOfInput())
@@ -193,13 +294,14 @@ int64_t CCircularCache::WaitForData(unsigned int minimum, unsigned int millis)
     minimum = m_size - m_size_back;
 
   XbmcThreads::EndTime endtime(millis);
+  m_readerWaiting = true;
+  avail = m_end - m_cur;
   while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast() )
   {
-    lock.Leave();
     m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
-    lock.Enter();
     avail = m_end - m_cur;
   }
+  m_readerWaiting = false;
 
   return avail;
 }
@@ -216,7 +318,7 @@ int64_t CCircularCache::Seek(int64_t pos)
      * there's sufficient forward space. Increasing it with only 100000 may not be
      * sufficient due to variable filesystem chunksize
      */
-    m_cur = m_end;
+    m_cur = m_end.load();
     lock.Leave();
     WaitForData((size_t)(pos - m_cur), 5000);
     lock.Enter();
@@ -21,12 +21,26 @@
 #ifndef CACHECIRCULAR_H
 #define CACHECIRCULAR_H
 
+#include <atomic>
+
 #include "CacheStrategy.h"
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
 namespace XFILE {
 
+/*!
+ \brief Single producer, single consumer ring buffer cache
+
+ One thread writes to the cache while another reads from it. The read and
+ write positions are atomics, so neither ReadFromCache() nor the common case
+ of WriteToCache() takes a lock. Only Seek(), Reset() and writes that
+ overwrite back buffer history are serialised with m_sync.
+
+ Where the platform allows it, the buffer is mapped twice in a row in memory
+ so that data wrapping around the end of the buffer can be read and written
+ in one contiguous block.
+ */
 class CCircularCache : public CCacheStrategy
 {
 public:
@@ -48,14 +62,27 @@ public:
     virtual int64_t CachedDataEndPos(); 
     virtual bool IsCachedPosition(int64_t iFilePosition);
 
+    virtual int GetReadView(const char **buf, size_t len);
+    virtual void ConsumeReadView(size_t len);
+    virtual int GetWriteView(char **buf, size_t len);
+    virtual void CommitWriteView(size_t len);
+
     virtual CCacheStrategy *CreateNew();
 protected:
-    int64_t           m_beg;       /**< index in file (not buffer) of beginning of valid data */
-    int64_t           m_end;       /**< index in file (not buffer) of end of valid data */
-    int64_t           m_cur;       /**< current reading index in file */
+    /*!
+     \brief Map m_buf twice in a row, rounding m_size up to the page size
+     \return true if the buffer was mapped, false if the platform doesn't support it
+     */
+    bool MapMirrored();
+
+    std::atomic<int64_t> m_beg; /**< index in file (not buffer) of beginning of valid data, changed by the writer */
+    std::atomic<int64_t> m_end; /**< index in file (not buffer) of end of valid data, changed by the writer */
+    std::atomic<int64_t> m_cur; /**< current reading index in file, changed by the reader */
     uint8_t          *m_buf;       /**< buffer holding data */
     size_t            m_size;      /**< size of data buffer used (m_buf) */
     size_t            m_size_back; /**< guaranteed size of back buffer (actual size can be smaller, or larger if front buffer doesn't need it) */
+    bool              m_mirrored;  /**< whether m_buf is mapped twice in a row, making wrapped data contiguous */
+    std::atomic<bool> m_readerWaiting; /**< whether WaitForData() is waiting on m_written */
     CCriticalSection  m_sync;
     CEvent            m_written;
 #ifdef TARGET_WINDOWS
@@ -19,6 +19,7 @@
  */
 
 #include "CurlFile.h"
+#include "Application.h"
 #include "utils/URIUtils.h"
 #include "Util.h"
 #include "URL.h"
@@ -424,6 +425,8 @@ CCurlFile::CCurlFile()
   m_inError = false;
   m_multisession  = true;
   m_seekable = true;
+  m_limitSession = false;
+  m_sessionMayBlock = false;
   m_useOldHttpVersion = false;
   m_connecttimeout = 0;
   m_lowspeedtime = 0;
@@ -527,6 +530,10 @@ void CCurlFile::SetCommonOptions(CReadState* state)
   // resolves. Unfortunately, c-ares does not yet support IPv6.
   g_curlInterface.easy_setopt(h, CURLOPT_NOSIGNAL, TRUE);
 
+  // reuse resolved names, tls sessions and open connections of other handles
+  if (g_curlInterface.GetShareHandle())
+    g_curlInterface.easy_setopt(h, CURLOPT_SHARE, g_curlInterface.GetShareHandle());
+
   // not interested in failed requests
   g_curlInterface.easy_setopt(h, CURLOPT_FAILONERROR, 1);
 
@@ -612,6 +619,15 @@ void CCurlFile::SetCommonOptions(CReadState* state)
 
   if (m_useOldHttpVersion)
     g_curlInterface.easy_setopt(h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+#if LIBCURL_VERSION_NUM >= 0x072f00 // 7.47.0
+  else if (g_curlInterface.SupportsHTTP2())
+  {
+    // negotiate HTTP/2 for https and wait for a connection that can be
+    // multiplexed rather than opening another one to the same host
+    g_curlInterface.easy_setopt(h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    g_curlInterface.easy_setopt(h, CURLOPT_PIPEWAIT, 1L);
+  }
+#endif
 
   if (g_advancedSettings.m_curlDisableIPV6)
     g_curlInterface.easy_setopt(h, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
@@ -861,7 +877,15 @@ bool CCurlFile::Get(const std::string& strURL, std::string& strHTML)
 bool CCurlFile::Service(const std::string& strURL, std::string& strHTML)
 {
   const CURL pathToUrl(strURL);
-  if (Open(pathToUrl))
+
+  // downloads like those of scrapers are limited, streams opened elsewhere aren't,
+  // and the gui never waits for another download to finish
+  m_limitSession = true;
+  m_sessionMayBlock = !g_application.IsCurrentThread();
+  bool opened = Open(pathToUrl);
+  m_limitSession = false;
+  m_sessionMayBlock = false;
+  if (opened)
   {
     if (ReadData(strHTML))
     {
@@ -988,7 +1012,9 @@ bool CCurlFile::Open(const CURL& url)
     g_curlInterface.easy_aquire(url2.GetProtocol().c_str(),
                                 url2.GetHostName().c_str(),
                                 &m_state->m_easyHandle,
-                                &m_state->m_multiHandle);
+                                &m_state->m_multiHandle,
+                                m_limitSession,
+                                m_sessionMayBlock);
 
   // setup common curl options
   SetCommonOptions(m_state);
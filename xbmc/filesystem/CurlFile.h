@@ -196,6 +196,8 @@ namespace XFILE
       bool            m_skipshout;
       bool            m_postdataset;
       bool            m_allowRetry;
+      bool            m_limitSession;     // whether the transfer counts towards curlmaxsessions
+      bool            m_sessionMayBlock;  // whether opening may wait for a limited session to be released
 
       CRingBuffer     m_buffer;           // our ringhold buffer
       char *          m_overflowBuffer;   // in the rare case we would overflow the above buffer
@@ -0,0 +1,207 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DirectoryWatcher.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+#include "URL.h"
+
+#ifdef HAVE_INOTIFY
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | \
+                    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#endif
+
+using namespace XFILE;
+
+CDirectoryWatcher& CDirectoryWatcher::GetInstance()
+{
+  static CDirectoryWatcher watcher;
+  return watcher;
+}
+
+CDirectoryWatcher::CDirectoryWatcher()
+  : CThread("DirectoryWatcher"),
+    m_fd(-1),
+    m_overflow(false)
+{
+}
+
+CDirectoryWatcher::~CDirectoryWatcher()
+{
+  StopThread(true);
+#ifdef HAVE_INOTIFY
+  if (m_fd >= 0)
+    close(m_fd);
+#endif
+}
+
+bool CDirectoryWatcher::IsSupported()
+{
+#ifdef HAVE_INOTIFY
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryWatcher::Watch(const std::string &path)
+{
+#ifdef HAVE_INOTIFY
+  if (!URIUtils::IsHD(path))
+    return false;
+
+  CSingleLock lock(m_critSection);
+  if (m_paths.find(path) != m_paths.end())
+    return true;
+
+  if (m_fd < 0)
+  {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+      CLog::Log(LOGERROR, "CDirectoryWatcher::%s - unable to initialize inotify (%d)", __FUNCTION__, errno);
+      return false;
+    }
+  }
+  if (!IsRunning())
+    Create();
+
+  std::string directory = CSpecialProtocol::TranslatePath(path);
+  URIUtils::RemoveSlashAtEnd(directory);
+  int wd = inotify_add_watch(m_fd, directory.c_str(), WATCH_MASK);
+  if (wd < 0)
+  {
+    if (errno == ENOSPC)
+      CLog::Log(LOGWARNING, "CDirectoryWatcher::%s - out of inotify watches, increase fs.inotify.max_user_watches to watch more than %u directories",
+                __FUNCTION__, (unsigned int)m_paths.size());
+    else
+      CLog::Log(LOGDEBUG, "CDirectoryWatcher::%s - unable to watch %s (%d)", __FUNCTION__, CURL::GetRedacted(path).c_str(), errno);
+    return false;
+  }
+
+  // the same directory through another path, e.g. a symlink
+  if (m_watches.find(wd) != m_watches.end())
+    return false;
+
+  m_watches[wd] = path;
+  m_paths[path] = wd;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryWatcher::IsWatched(const std::string &path) const
+{
+  CSingleLock lock(m_critSection);
+  return m_paths.find(path) != m_paths.end() && m_changed.find(path) == m_changed.end();
+}
+
+bool CDirectoryWatcher::GetChanges(std::set<std::string> &paths)
+{
+  CSingleLock lock(m_critSection);
+  paths.swap(m_changed);
+  m_changed.clear();
+
+  if (m_overflow)
+  {
+    m_overflow = false;
+    return false;
+  }
+  return true;
+}
+
+void CDirectoryWatcher::Reset()
+{
+  CSingleLock lock(m_critSection);
+  RemoveWatches();
+  m_changed.clear();
+  m_overflow = false;
+}
+
+void CDirectoryWatcher::RemoveWatches()
+{
+#ifdef HAVE_INOTIFY
+  for (std::map<int, std::string>::const_iterator it = m_watches.begin(); it != m_watches.end(); ++it)
+    inotify_rm_watch(m_fd, it->first);
+#endif
+  m_watches.clear();
+  m_paths.clear();
+}
+
+void CDirectoryWatcher::OnChanged(int wd, bool removed)
+{
+  std::map<int, std::string>::iterator it = m_watches.find(wd);
+  if (it == m_watches.end())
+    return;
+
+  m_changed.insert(it->second);
+  if (removed)
+  {
+    m_paths.erase(it->second);
+    m_watches.erase(it);
+  }
+}
+
+void CDirectoryWatcher::Process()
+{
+#ifdef HAVE_INOTIFY
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  while (!m_bStop)
+  {
+    struct pollfd pfd = { m_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 500) <= 0)
+      continue;
+
+    ssize_t length = read(m_fd, buffer, sizeof(buffer));
+    if (length <= 0)
+      continue;
+
+    CSingleLock lock(m_critSection);
+    for (char *ptr = buffer; ptr < buffer + length;)
+    {
+      const struct inotify_event *event = (const struct inotify_event *)ptr;
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        CLog::Log(LOGWARNING, "CDirectoryWatcher::%s - notifications lost, dropping all watches", __FUNCTION__);
+        RemoveWatches();
+        m_changed.clear();
+        m_overflow = true;
+        break;
+      }
+
+      // a removed or unmounted directory loses its watch
+      bool removed = (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) != 0;
+      if (removed && !(event->mask & IN_IGNORED))
+        inotify_rm_watch(m_fd, event->wd);
+      OnChanged(event->wd, removed);
+    }
+  }
+#endif
+}
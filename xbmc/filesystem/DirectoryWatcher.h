@@ -0,0 +1,86 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+namespace XFILE
+{
+  /*!
+   \brief Collects the local directories whose entries changed.
+
+   Directories are watched one by one (not recursively) with inotify where
+   available. A watched directory that is not reported as changed is known
+   to have the same entries as when it was watched, so the video scanner can
+   skip it without even a stat(). If notifications are lost all watches are
+   dropped, as nothing is known about the watched directories any more.
+   */
+  class CDirectoryWatcher : private CThread
+  {
+  public:
+    static CDirectoryWatcher& GetInstance();
+
+    /*! \brief Whether directory watching is supported at all */
+    static bool IsSupported();
+
+    /*!
+     \brief Start watching a directory for added, removed, renamed or modified entries.
+     \param path the directory, only local directories can be watched
+     \return true if the directory is watched
+     */
+    bool Watch(const std::string &path);
+
+    /*! \brief Whether a directory is watched and not reported as changed yet */
+    bool IsWatched(const std::string &path) const;
+
+    /*!
+     \brief Take the directories that changed since the last call.
+     \param paths the changed directories, in the form passed to Watch()
+     \return false if notifications were lost since the last call. All
+             watches were dropped then, so none of the directories is watched.
+     */
+    bool GetChanges(std::set<std::string> &paths);
+
+    /*! \brief Stop watching all directories */
+    void Reset();
+
+  protected:
+    CDirectoryWatcher();
+    virtual ~CDirectoryWatcher();
+
+    virtual void Process() override;
+
+  private:
+    void RemoveWatches();
+    void OnChanged(int wd, bool removed);
+
+    CCriticalSection m_critSection;
+    int m_fd;
+    std::map<int, std::string> m_watches;
+    std::map<std::string, int> m_paths;
+    std::set<std::string> m_changed;
+    bool m_overflow;
+  };
+}
@@ -21,6 +21,7 @@
 #include "threads/SystemClock.h"
 #include "system.h"
 #include "DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 
@@ -61,6 +62,19 @@ unsigned long ssl_thread_id(void)
 
 using namespace XCURL;
 
+/* locks protecting the data shared between all handles */
+static CCriticalSection g_curlShareLocks[CURL_LOCK_DATA_LAST];
+
+static void share_lock(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  g_curlShareLocks[data].lock();
+}
+
+static void share_unlock(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  g_curlShareLocks[data].unlock();
+}
+
 /* okey this is damn ugly. our dll loader doesn't allow for postload, preunload functions */
 static long g_curlReferences = 0;
 #if(0)
@@ -91,6 +105,26 @@ bool DllLibCurlGlobal::Load()
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
+  /* all sessions share their dns cache, tls sessions and connections, so a
+     new session to a host that was contacted before can skip the handshakes */
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 // 7.57.0
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+  }
+
+  m_http2 = false;
+#ifdef CURL_VERSION_HTTP2
+  curl_version_info_data *info = version_info(CURLVERSION_NOW);
+  m_http2 = info != NULL && (info->features & CURL_VERSION_HTTP2) != 0;
+#endif
+
 #if defined(HAS_CURL_STATIC)
   // Initialize ssl locking array
   m_sslLockArray = new CCriticalSection*[CRYPTO_num_locks()];
@@ -112,6 +146,12 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    if (m_share)
+    {
+      share_cleanup(m_share);
+      m_share = NULL;
+    }
+
     // close libcurl
     global_cleanup();
 
@@ -174,12 +214,26 @@ void DllLibCurlGlobal::CheckIdle()
 #endif
 }
 
-void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle)
+void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle, bool limited /* = false */, bool mayBlock /* = false */)
 {
   assert(easy_handle != NULL);
 
   CSingleLock lock(m_critSection);
 
+  // bound the number of downloads running at the same time, but never wait
+  // longer than a connection attempt may take as this thread may be holding
+  // one of the busy sessions itself
+  unsigned int maxSessions = g_advancedSettings.m_curlMaxSessions;
+  if (limited && mayBlock && maxSessions > 0 && GetBusyLimitedSessions() >= maxSessions)
+  {
+    XbmcThreads::EndTime timeout(g_advancedSettings.m_curlconnecttimeout * 1000);
+    while (GetBusyLimitedSessions() >= maxSessions && !timeout.IsTimePast())
+      m_sessionReleased.wait(m_critSection, timeout.MillisLeft());
+
+    if (GetBusyLimitedSessions() >= maxSessions)
+      CLog::Log(LOGWARNING, "%s - %u sessions busy, not waiting any longer to connect to %s://%s", __FUNCTION__, maxSessions, protocol, hostname);
+  }
+
   VEC_CURLSESSIONS::iterator it;
   for(it = m_sessions.begin(); it != m_sessions.end(); ++it)
   {
@@ -190,6 +244,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
       if( it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
       {
         it->m_busy = true;
+        it->m_limited = limited;
         if(easy_handle)
         {
           if(!it->m_easy)
@@ -201,7 +256,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
         if(multi_handle)
         {
           if(!it->m_multi)
-            it->m_multi = multi_init();
+            it->m_multi = InitMultiHandle();
 
           *multi_handle = it->m_multi;
         }
@@ -213,6 +268,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
   SSession session = {};
   session.m_busy = true;
+  session.m_limited = limited;
   session.m_protocol = protocol;
   session.m_hostname = hostname;
 
@@ -227,7 +283,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
   if(multi_handle)
   {
-    session.m_multi = multi_init();
+    session.m_multi = InitMultiHandle();
     *multi_handle = session.m_multi;
   }
 
@@ -269,6 +325,7 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
       easy_reset(easy);
       it->m_busy = false;
       it->m_idletimestamp = XbmcThreads::SystemClockMillis();
+      m_sessionReleased.notifyAll();
       return;
     }
   }
@@ -301,7 +358,7 @@ void DllLibCurlGlobal::easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HAND
     *easy_out = DllLibCurl::easy_duphandle(easy);
 
   if(multi_out && multi)
-    *multi_out = DllLibCurl::multi_init();
+    *multi_out = InitMultiHandle();
 
   VEC_CURLSESSIONS::iterator it;
   for(it = m_sessions.begin(); it != m_sessions.end(); ++it)
@@ -326,3 +383,25 @@ void DllLibCurlGlobal::easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HAND
   }
   return;
 }
+
+CURLM* DllLibCurlGlobal::InitMultiHandle()
+{
+  CURLM* multi = multi_init();
+#if LIBCURL_VERSION_NUM >= 0x072b00 // 7.43.0
+  // run parallel transfers over a single HTTP/2 connection
+  if (multi && m_http2)
+    multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+  return multi;
+}
+
+unsigned int DllLibCurlGlobal::GetBusyLimitedSessions() const
+{
+  unsigned int busy = 0;
+  for (VEC_CURLSESSIONS::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it)
+  {
+    if (it->m_busy && it->m_limited)
+      busy++;
+  }
+  return busy;
+}
@@ -20,6 +20,7 @@
  */
 
 #include "DynamicDll.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
 #include <stdio.h>
 #include <vector>
@@ -55,6 +56,9 @@ namespace XCURL
     virtual CURLMcode multi_cleanup(CURLM * handle )=0;
     virtual struct curl_slist* slist_append(struct curl_slist *, const char *)=0;
     virtual void  slist_free_all(struct curl_slist *)=0;
+    virtual CURLSH * share_init(void)=0;
+    virtual CURLSHcode share_cleanup(CURLSH *share_handle)=0;
+    virtual curl_version_info_data * version_info(CURLversion type)=0;
   };
 
   class DllLibCurl : public DllDynamic, DllLibCurlInterface
@@ -81,6 +85,11 @@ namespace XCURL
     DEFINE_METHOD2(struct curl_slist*, slist_append, (struct curl_slist * p1, const char * p2))
     DEFINE_METHOD1(void, slist_free_all, (struct curl_slist * p1))
     DEFINE_METHOD1(const char *, easy_strerror, (CURLcode p1))
+    DEFINE_METHOD_FP(CURLMcode, multi_setopt, (CURLM *p1, CURLMoption p2, ...))
+    DEFINE_METHOD0(CURLSH *, share_init)
+    DEFINE_METHOD_FP(CURLSHcode, share_setopt, (CURLSH *p1, CURLSHoption p2, ...))
+    DEFINE_METHOD1(CURLSHcode, share_cleanup, (CURLSH *p1))
+    DEFINE_METHOD1(curl_version_info_data *, version_info, (CURLversion p1))
 #if defined(HAS_CURL_STATIC)
     DEFINE_METHOD1(void, crypto_set_id_callback, (unsigned long (*p1)(void)))
     DEFINE_METHOD1(void, crypto_set_locking_callback, (void (*p1)(int, int, const char *, int)))
@@ -107,6 +116,11 @@ namespace XCURL
       RESOLVE_METHOD_RENAME(curl_multi_cleanup, multi_cleanup)
       RESOLVE_METHOD_RENAME(curl_slist_append, slist_append)
       RESOLVE_METHOD_RENAME(curl_slist_free_all, slist_free_all)
+      RESOLVE_METHOD_RENAME_FP(curl_multi_setopt, multi_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_init, share_init)
+      RESOLVE_METHOD_RENAME_FP(curl_share_setopt, share_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_cleanup, share_cleanup)
+      RESOLVE_METHOD_RENAME(curl_version_info, version_info)
 #if defined(HAS_CURL_STATIC)
       RESOLVE_METHOD_RENAME(CRYPTO_set_id_callback, crypto_set_id_callback)
       RESOLVE_METHOD_RENAME(CRYPTO_set_locking_callback, crypto_set_locking_callback)
@@ -118,13 +132,22 @@ namespace XCURL
   class DllLibCurlGlobal : public DllLibCurl
   {
   public:
+    DllLibCurlGlobal() : m_share(NULL), m_http2(false) {}
+
     /* extend interface with buffered functions */
-    void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
+    /* limited sessions wait for one of them to be released when <curlmaxsessions> are busy
+       if the caller may block, other sessions, like those of streams, neither wait nor count */
+    void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle, bool limited = false, bool mayBlock = false);
     void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HANDLE** easy_out, CURLM** multi_out);
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
     void CheckIdle();
 
+    /* share handle holding the dns cache, tls sessions and connections of all sessions */
+    CURLSH* GetShareHandle() const { return m_share; }
+    /* whether libcurl was built with HTTP/2 support */
+    bool SupportsHTTP2() const { return m_http2; }
+
     /* overloaded load and unload with reference counter */
     virtual bool Load();
     virtual void Unload();
@@ -136,6 +159,7 @@ namespace XCURL
       std::string   m_protocol;
       std::string   m_hostname;
       bool          m_busy;
+      bool          m_limited;        // counts towards the session limit while busy
       CURL_HANDLE*  m_easy;
       CURLM*        m_multi;
     } SSession;
@@ -144,6 +168,14 @@ namespace XCURL
 
     VEC_CURLSESSIONS m_sessions;
     CCriticalSection m_critSection;
+
+  private:
+    CURLM* InitMultiHandle();
+    unsigned int GetBusyLimitedSessions() const;
+
+    CURLSH* m_share;
+    bool m_http2;
+    XbmcThreads::ConditionVariable m_sessionReleased;
   };
 }
 
@@ -325,8 +325,19 @@ void CFileCache::Process()
     }
 
     ssize_t iRead = 0;
+    char *writeView = NULL;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), maxWrite);
+    {
+      // read straight into the cache if it allows it, saving a copy
+      int viewSize = m_pCache->GetWriteView(&writeView, maxWrite);
+      if (viewSize > 0)
+        iRead = m_source.Read(writeView, viewSize);
+      else
+      {
+        writeView = NULL;
+        iRead = m_source.Read(buffer.get(), maxWrite);
+      }
+    }
     if (iRead == 0)
     {
       // Check for actual EOF and retry as long as we still have data in our cache
@@ -377,6 +388,12 @@ void CFileCache::Process()
     }
 
     int iTotalWrite = 0;
+    if (writeView && iRead > 0)
+    {
+      m_pCache->CommitWriteView(iRead);
+      iTotalWrite = iRead;
+    }
+
     while (!m_bStop && (iTotalWrite < iRead))
     {
       int iWrite = 0;
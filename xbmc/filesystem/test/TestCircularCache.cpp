@@ -0,0 +1,259 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CircularCache.h"
+#include "threads/Thread.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+
+// a multiple of any page size, so that mirroring doesn't round the buffer up
+const size_t CACHE_SIZE = 64 * 1024;
+
+/*!
+ \brief Circular cache exposing whether its buffer is mirrored
+ */
+class CTestCache : public CCircularCache
+{
+public:
+  CTestCache(size_t front, size_t back)
+    : CCircularCache(front, back)
+  {
+  }
+
+  bool IsMirrored() const { return m_mirrored; }
+  size_t GetSize() const { return m_size; }
+};
+
+char GetByte(int64_t pos)
+{
+  return (char)(pos * 31 + pos / 251);
+}
+
+/*! \brief Write the bytes from pos on, in as many calls as the cache needs
+ */
+void Write(CCacheStrategy &cache, int64_t pos, size_t len)
+{
+  std::vector<char> data(len);
+  for (size_t i = 0; i < len; i++)
+    data[i] = GetByte(pos + i);
+
+  size_t written = 0;
+  int ret;
+  while (written < len && (ret = cache.WriteToCache(data.data() + written, len - written)) > 0)
+    written += ret;
+  ASSERT_EQ(len, written);
+}
+
+/*! \brief Read len bytes and check that they are those from pos on
+ */
+void Read(CCacheStrategy &cache, int64_t pos, size_t len)
+{
+  std::vector<char> data(len);
+  size_t read = 0;
+  int ret;
+  while (read < len && (ret = cache.ReadFromCache(data.data() + read, len - read)) > 0)
+    read += ret;
+  ASSERT_EQ(len, read);
+
+  for (size_t i = 0; i < len; i++)
+    ASSERT_EQ(GetByte(pos + i), data[i]) << "at " << pos + i;
+}
+
+/*!
+ \brief Writes the bytes from 0 to m_size into the cache, waiting for space when it is full
+ */
+class CProducer : public CThread
+{
+public:
+  CProducer(CCacheStrategy &cache, size_t size)
+    : CThread("CircularCacheProducer"),
+      m_cache(cache),
+      m_size(size)
+  {
+  }
+
+protected:
+  virtual void Process()
+  {
+    std::vector<char> data(7919);
+    size_t pos = 0;
+    while (pos < m_size && !m_bStop)
+    {
+      size_t len = std::min(data.size(), m_size - pos);
+      for (size_t i = 0; i < len; i++)
+        data[i] = GetByte(pos + i);
+
+      size_t written = 0;
+      while (written < len && !m_bStop)
+      {
+        int ret = m_cache.WriteToCache(data.data() + written, len - written);
+        if (ret > 0)
+          written += ret;
+        else
+          m_cache.m_space.WaitMSec(5);
+      }
+      pos += written;
+    }
+    m_cache.EndOfInput();
+  }
+
+private:
+  CCacheStrategy &m_cache;
+  size_t m_size;
+};
+
+}
+
+TEST(TestCircularCache, WrapAround)
+{
+  CTestCache cache(CACHE_SIZE, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  ASSERT_EQ(CACHE_SIZE, cache.GetSize());
+
+  // move the positions close to the end of the buffer
+  Write(cache, 0, CACHE_SIZE - 1000);
+  Read(cache, 0, CACHE_SIZE - 1000);
+
+  // data across the end of the buffer is written and read in one block if mirrored
+  std::vector<char> data(3000);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = GetByte(CACHE_SIZE - 1000 + i);
+  int written = cache.WriteToCache(data.data(), data.size());
+  EXPECT_EQ(cache.IsMirrored() ? 3000 : 1000, written);
+  if (written < 3000)
+    EXPECT_EQ(3000 - written, cache.WriteToCache(data.data() + written, data.size() - written));
+
+  const char *view;
+  int viewed = cache.GetReadView(&view, 3000);
+  EXPECT_EQ(cache.IsMirrored() ? 3000 : 1000, viewed);
+  for (int i = 0; i < viewed; i++)
+    ASSERT_EQ(data[i], view[i]);
+  cache.ConsumeReadView(viewed);
+  Read(cache, CACHE_SIZE - 1000 + viewed, 3000 - viewed);
+
+  // the write view wraps the same way
+  char *space;
+  viewed = cache.GetWriteView(&space, CACHE_SIZE);
+  EXPECT_EQ(cache.IsMirrored() ? (int)CACHE_SIZE : (int)(CACHE_SIZE - 2000), viewed);
+  cache.Close();
+}
+
+TEST(TestCircularCache, HistoryDrop)
+{
+  CTestCache cache(CACHE_SIZE / 2, CACHE_SIZE / 2);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  Write(cache, 0, CACHE_SIZE);
+  Read(cache, 0, CACHE_SIZE);
+  EXPECT_TRUE(cache.IsCachedPosition(0));
+
+  // only the guaranteed back buffer is kept when more is written
+  EXPECT_EQ(CACHE_SIZE / 2, cache.GetMaxWriteSize(CACHE_SIZE));
+  Write(cache, CACHE_SIZE, CACHE_SIZE / 2);
+  EXPECT_EQ(0u, cache.GetMaxWriteSize(CACHE_SIZE));
+  EXPECT_FALSE(cache.IsCachedPosition(CACHE_SIZE / 2 - 1));
+  EXPECT_TRUE(cache.IsCachedPosition(CACHE_SIZE / 2));
+
+  // what was dropped can't be seeked to, what was kept can
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(0));
+  EXPECT_EQ(CACHE_SIZE / 2, cache.Seek(CACHE_SIZE / 2));
+  Read(cache, CACHE_SIZE / 2, CACHE_SIZE);
+
+  // seeking back makes history front buffer again, which no write may overwrite
+  EXPECT_EQ(CACHE_SIZE / 2, cache.Seek(CACHE_SIZE / 2));
+  EXPECT_EQ(0u, cache.GetMaxWriteSize(CACHE_SIZE));
+  cache.Close();
+}
+
+TEST(TestCircularCache, SeekAndReset)
+{
+  CTestCache cache(CACHE_SIZE / 2, CACHE_SIZE / 2);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  Write(cache, 0, 1000);
+  Read(cache, 0, 500);
+  EXPECT_EQ(100, cache.Seek(100));
+  Read(cache, 100, 100);
+  EXPECT_EQ(1000, cache.Seek(1000));
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(NULL, 1));
+
+  // past the end of input there's nothing to wait for
+  cache.EndOfInput();
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(1001));
+  EXPECT_EQ(0, cache.ReadFromCache(NULL, 1));
+  cache.ClearEndOfInput();
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(1000 + 200000));
+
+  // a cached position is only switched to unless the reset is forced
+  EXPECT_EQ(1000, cache.CachedDataEndPosIfSeekTo(200));
+  EXPECT_FALSE(cache.Reset(200, false));
+  Read(cache, 200, 800);
+  EXPECT_EQ(1000, cache.CachedDataEndPos());
+
+  EXPECT_TRUE(cache.Reset(5000, false));
+  EXPECT_EQ(5000, cache.CachedDataEndPos());
+  EXPECT_FALSE(cache.IsCachedPosition(200));
+  EXPECT_EQ(300, cache.CachedDataEndPosIfSeekTo(300));
+  Write(cache, 5000, 100);
+  Read(cache, 5000, 100);
+
+  EXPECT_TRUE(cache.Reset(5000));
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(NULL, 1));
+  cache.Close();
+}
+
+TEST(TestCircularCache, ProducerConsumer)
+{
+  CTestCache cache(CACHE_SIZE / 2, CACHE_SIZE / 2);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // many times the size of the buffer, in chunks that don't line up with it
+  const size_t size = 256 * CACHE_SIZE + 12345;
+  CProducer producer(cache, size);
+  producer.Create();
+
+  std::vector<char> data(4999);
+  size_t pos = 0;
+  while (pos < size)
+  {
+    if (cache.WaitForData(1, 1000) <= 0 && !cache.IsEndOfInput())
+      continue;
+    int ret = cache.ReadFromCache(data.data(), data.size());
+    if (ret == CACHE_RC_WOULD_BLOCK)
+      continue;
+    ASSERT_GT(ret, 0) << "at " << pos;
+    for (int i = 0; i < ret; i++)
+      ASSERT_EQ(GetByte(pos + i), data[i]) << "at " << pos + i;
+    pos += ret;
+  }
+  EXPECT_EQ(size, pos);
+  EXPECT_EQ(0, cache.ReadFromCache(data.data(), data.size()));
+
+  producer.StopThread(true);
+  cache.Close();
+}
@@ -0,0 +1,366 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "filesystem/CurlFile.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "URL.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// after the system headers, as it includes curl in a namespace
+#include "filesystem/DllLibCurl.h"
+
+#include "gtest/gtest.h"
+
+using namespace XCURL;
+using namespace XFILE;
+
+namespace
+{
+
+/*!
+ \brief Minimal HTTP/1.1 server on the loopback interface keeping connections
+ alive, counting the connections it accepted and the requests it answered.
+ */
+class CKeepAliveServer : public CThread
+{
+public:
+  CKeepAliveServer()
+    : CThread("KeepAliveServer"),
+      m_socket(-1),
+      m_port(0),
+      m_connections(0),
+      m_requests(0)
+  {
+  }
+
+  virtual ~CKeepAliveServer()
+  {
+    StopThread(true);
+    for (std::map<int, std::string>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      close(it->first);
+    if (m_socket >= 0)
+      close(m_socket);
+  }
+
+  bool Start()
+  {
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0)
+      return false;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t length = sizeof(addr);
+    if (bind(m_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(m_socket, 16) < 0 ||
+        getsockname(m_socket, (struct sockaddr *)&addr, &length) < 0)
+      return false;
+
+    m_port = ntohs(addr.sin_port);
+    Create();
+    return true;
+  }
+
+  std::string GetURL(const std::string &path) const
+  {
+    return StringUtils::Format("http://127.0.0.1:%u/%s", m_port, path.c_str());
+  }
+
+  long GetConnections() const { return m_connections; }
+  long GetRequests() const { return m_requests; }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      fd_set fds, writefds;
+      FD_ZERO(&fds);
+      FD_ZERO(&writefds);
+      FD_SET(m_socket, &fds);
+      int maxfd = m_socket;
+      for (std::map<int, std::string>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      {
+        FD_SET(it->first, &fds);
+        if (!m_output[it->first].empty())
+          FD_SET(it->first, &writefds);
+        if (it->first > maxfd)
+          maxfd = it->first;
+      }
+
+      struct timeval tv = { 0, 100000 };
+      if (select(maxfd + 1, &fds, &writefds, NULL, &tv) <= 0)
+        continue;
+
+      if (FD_ISSET(m_socket, &fds))
+      {
+        int client = accept(m_socket, NULL, NULL);
+        if (client >= 0)
+        {
+          m_clients[client] = "";
+          AtomicIncrement(&m_connections);
+        }
+      }
+
+      for (std::map<int, std::string>::iterator it = m_clients.begin(); it != m_clients.end();)
+      {
+        if ((!FD_ISSET(it->first, &fds) || Receive(it->first, it->second)) &&
+            (!FD_ISSET(it->first, &writefds) || Send(it->first)))
+        {
+          ++it;
+          continue;
+        }
+        close(it->first);
+        m_output.erase(it->first);
+        m_clients.erase(it++);
+      }
+    }
+  }
+
+private:
+  bool Receive(int client, std::string &buffer)
+  {
+    char data[4096];
+    ssize_t length = recv(client, data, sizeof(data), 0);
+    if (length <= 0)
+      return false;
+    buffer.append(data, length);
+
+    size_t end;
+    while ((end = buffer.find("\r\n\r\n")) != std::string::npos)
+    {
+      // answer with the path of the request, or with a body too large to be
+      // received at once when the path asks for it
+      std::string line = buffer.substr(0, buffer.find("\r\n"));
+      buffer.erase(0, end + 4);
+      std::vector<std::string> parts = StringUtils::Split(line, " ");
+      std::string body = parts.size() > 1 ? parts[1] : "";
+      if (StringUtils::StartsWith(body, "/large"))
+        body.resize(4 * 1024 * 1024, 'x');
+      m_output[client] += StringUtils::Format("HTTP/1.1 200 OK\r\n"
+                                              "Content-Type: text/plain\r\n"
+                                              "Content-Length: %u\r\n"
+                                              "\r\n", (unsigned int)body.size()) + body;
+      AtomicIncrement(&m_requests);
+    }
+    return Send(client);
+  }
+
+  bool Send(int client)
+  {
+    // never block, the other connections are served meanwhile
+    std::string &output = m_output[client];
+    if (output.empty())
+      return true;
+    ssize_t length = send(client, output.c_str(), output.size(), MSG_DONTWAIT);
+    if (length < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    output.erase(0, length);
+    return true;
+  }
+
+  int m_socket;
+  unsigned int m_port;
+  std::map<int, std::string> m_clients;
+  std::map<int, std::string> m_output;
+  volatile long m_connections;
+  volatile long m_requests;
+};
+
+class CGetThread : public CThread
+{
+public:
+  CGetThread(const std::string &url)
+    : CThread("CurlGet"),
+      m_url(url),
+      m_done(0)
+  {
+  }
+
+  unsigned int GetDone() const { return m_done; }
+
+  CEvent m_finished;
+
+protected:
+  virtual void Process()
+  {
+    CCurlFile file;
+    std::string content;
+    if (file.Get(m_url, content))
+      m_done = XbmcThreads::SystemClockMillis();
+    m_finished.Set();
+  }
+
+private:
+  std::string m_url;
+  unsigned int m_done;
+};
+
+size_t DiscardData(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+  return size * nmemb;
+}
+
+}
+
+TEST(TestCurlFile, ReuseConnection)
+{
+  CKeepAliveServer server;
+  ASSERT_TRUE(server.Start());
+
+  for (int i = 0; i < 5; i++)
+  {
+    CCurlFile file;
+    std::string content;
+    std::string path = StringUtils::Format("file%d", i);
+    EXPECT_TRUE(file.Get(server.GetURL(path), content));
+    EXPECT_EQ("/" + path, content);
+  }
+
+  EXPECT_EQ(5, server.GetRequests());
+  EXPECT_EQ(1, server.GetConnections());
+}
+
+TEST(TestCurlFile, ReuseParallelConnections)
+{
+  CKeepAliveServer server;
+  ASSERT_TRUE(server.Start());
+
+  // two transfers running at the same time need two connections, the bodies
+  // are too large to be received while opening
+  CCurlFile first, second;
+  ASSERT_TRUE(first.Open(CURL(server.GetURL("large1"))));
+  ASSERT_TRUE(second.Open(CURL(server.GetURL("large2"))));
+  EXPECT_EQ(2, server.GetConnections());
+
+  // the transfers have to complete for their connections to be kept
+  CCurlFile *files[] = { &first, &second };
+  for (int i = 0; i < 2; i++)
+  {
+    char data[65536];
+    int64_t total = 0;
+    ssize_t length;
+    while ((length = files[i]->Read(data, sizeof(data))) > 0)
+      total += length;
+    EXPECT_EQ(4 * 1024 * 1024, total);
+    files[i]->Close();
+  }
+
+  // which are both kept for the transfers after them
+  for (int i = 0; i < 4; i++)
+  {
+    CCurlFile file;
+    std::string content;
+    EXPECT_TRUE(file.Get(server.GetURL("next"), content));
+  }
+  EXPECT_EQ(6, server.GetRequests());
+  EXPECT_EQ(2, server.GetConnections());
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073900 // 7.57.0
+TEST(TestCurlFile, ShareConnections)
+{
+  CKeepAliveServer server;
+  ASSERT_TRUE(server.Start());
+  ASSERT_TRUE(g_curlInterface.Load());
+  ASSERT_TRUE(g_curlInterface.GetShareHandle() != NULL);
+
+  // both sessions are busy at the same time, so they have their own handles
+  CURL_HANDLE *first = NULL, *second = NULL;
+  CURLM *firstMulti = NULL, *secondMulti = NULL;
+  g_curlInterface.easy_aquire("http", "127.0.0.1", &first, &firstMulti);
+  g_curlInterface.easy_aquire("http", "127.0.0.1", &second, &secondMulti);
+  ASSERT_TRUE(first != second);
+
+  // the second handle uses the connection the first one left open
+  CURL_HANDLE *handles[] = { first, second };
+  for (int i = 0; i < 2; i++)
+  {
+    std::string url = server.GetURL(StringUtils::Format("file%d", i));
+    g_curlInterface.easy_setopt(handles[i], CURLOPT_SHARE, g_curlInterface.GetShareHandle());
+    g_curlInterface.easy_setopt(handles[i], CURLOPT_URL, url.c_str());
+    g_curlInterface.easy_setopt(handles[i], CURLOPT_WRITEFUNCTION, DiscardData);
+    EXPECT_EQ(CURLE_OK, g_curlInterface.easy_perform(handles[i]));
+  }
+
+  g_curlInterface.easy_release(&first, &firstMulti);
+  g_curlInterface.easy_release(&second, &secondMulti);
+  g_curlInterface.Unload();
+
+  EXPECT_EQ(2, server.GetRequests());
+  EXPECT_EQ(1, server.GetConnections());
+}
+#endif
+
+TEST(TestCurlFile, MaxSessions)
+{
+  CKeepAliveServer server;
+  ASSERT_TRUE(server.Start());
+
+  int maxSessions = g_advancedSettings.m_curlMaxSessions;
+  g_advancedSettings.m_curlMaxSessions = 1;
+
+  // a download holding the only session
+  CURL_HANDLE *easy = NULL;
+  CURLM *multi = NULL;
+  g_curlInterface.easy_aquire("http", "127.0.0.1", &easy, &multi, true, true);
+
+  // streams don't count
+  CCurlFile stream;
+  EXPECT_TRUE(stream.Open(CURL(server.GetURL("stream"))));
+  stream.Close();
+
+  // the next download has to wait for the first one to finish
+  CGetThread thread(server.GetURL("download"));
+  thread.Create();
+  EXPECT_FALSE(thread.m_finished.WaitMSec(200));
+  EXPECT_EQ(1, server.GetRequests());
+  unsigned int released = XbmcThreads::SystemClockMillis();
+  g_curlInterface.easy_release(&easy, &multi);
+  EXPECT_TRUE(thread.m_finished.WaitMSec(10000));
+  thread.StopThread(true);
+
+  g_advancedSettings.m_curlMaxSessions = maxSessions;
+
+  EXPECT_NE(0u, thread.GetDone());
+  EXPECT_GE(thread.GetDone(), released);
+  EXPECT_EQ(2, server.GetRequests());
+}
+
+#endif
@@ -1132,6 +1132,7 @@ void CGUIBaseContainer::Reset()
   m_items.clear();
   m_lastItem.reset();
   ResetAutoScrolling();
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_LISTITEM);
 }
 
 void CGUIBaseContainer::LoadLayout(TiXmlElement *layout)
@@ -1342,13 +1343,18 @@ void CGUIBaseContainer::GetCacheOffsets(int &cacheBefore, int &cacheAfter) const
 
 void CGUIBaseContainer::SetCursor(int cursor)
 {
+  if (m_cursor != cursor)
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_LISTITEM);
   m_cursor = cursor;
 }
 
 void CGUIBaseContainer::SetOffset(int offset)
 {
   if (m_offset != offset)
+  {
     MarkDirtyRegion();
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_LISTITEM);
+  }
   m_offset = offset;
 }
 
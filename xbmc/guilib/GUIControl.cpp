@@ -331,6 +331,8 @@ void CGUIControl::SetFocus(bool focus)
     QueueAnimation(ANIM_TYPE_UNFOCUS);
   else if (!m_bHasFocus && focus)
     QueueAnimation(ANIM_TYPE_FOCUS);
+  if (m_bHasFocus != focus)
+    g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_FOCUS | INFO::INFO_DEPENDS_LISTITEM);
   m_bHasFocus = focus;
 }
 
@@ -58,6 +58,7 @@
 #include "utils/XMLUtils.h"
 #include "GUIFontManager.h"
 #include "GUIColorManager.h"
+#include "TextureManager.h"
 #include "utils/RssManager.h"
 #include "utils/StringUtils.h"
 #include "GUIAction.h"
@@ -356,6 +357,12 @@ bool CGUIControlFactory::GetTexture(const TiXmlNode* pRootNode, const char* strT
   if (background && strnicmp(background, "true", 4) == 0)
     image.useLarge = true;
   image.filename = (pNode->FirstChild() && pNode->FirstChild()->ValueStr() != "-") ? pNode->FirstChild()->Value() : "";
+
+  // start decoding the textures while the rest of the window is loaded
+  if (!image.useLarge && image.filename.find('$') == std::string::npos)
+    g_TextureManager.Preload(image.filename);
+  if (image.diffuse.find('$') == std::string::npos)
+    g_TextureManager.Preload(image.diffuse);
   return true;
 }
 
@@ -28,6 +28,8 @@
 #include "GUIControlFactory.h"
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
+#include "LocalizeStrings.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/lib/Setting.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
@@ -39,6 +41,10 @@
 #include "filesystem/SpecialProtocol.h"
 #endif
 
+#include <algorithm>
+#include <functional>
+#include <map>
+
 GUIFontManager::GUIFontManager(void)
 {
   m_canReload = true;
@@ -150,6 +156,9 @@ CGUIFont* GUIFontManager::LoadTTF(const std::string& strFontName, const std::str
     m_vecFontFiles.push_back(pFontFile);
   }
 
+  // rasterise the characters likely drawn with it in the background
+  pFontFile->Prewarm(GetPrewarmGlyphs(), iStyle & (FONT_STYLE_BOLD | FONT_STYLE_ITALICS | FONT_STYLE_LIGHT));
+
   // font file is loaded, create our CGUIFont
   CGUIFont *pNewFont = new CGUIFont(strFontName, iStyle, textColor, shadowColor, lineSpacing, (float)iSize, pFontFile);
   m_vecFonts.push_back(pNewFont);
@@ -233,6 +242,7 @@ void GUIFontManager::ReloadTTFFonts(void)
       m_vecFontFiles.push_back(pFontFile);
     }
 
+    pFontFile->Prewarm(GetPrewarmGlyphs(), font->GetStyle() & (FONT_STYLE_BOLD | FONT_STYLE_ITALICS | FONT_STYLE_LIGHT));
     font->SetFont(pFontFile);
   }
 }
@@ -333,6 +343,38 @@ void GUIFontManager::Clear()
   m_vecFonts.clear();
   m_vecFontFiles.clear();
   m_vecFontInfo.clear();
+  m_prewarmGlyphs.clear();
+}
+
+const vecText& GUIFontManager::GetPrewarmGlyphs()
+{
+  // every glyph takes room in the texture of each font and style, so only the most frequent ones
+  size_t maxGlyphs = g_advancedSettings.m_guiFontPrewarmGlyphs;
+
+  if (!m_prewarmGlyphs.empty() || maxGlyphs == 0)
+    return m_prewarmGlyphs;
+
+  std::map<char32_t, unsigned int> counts;
+  g_localizeStrings.CountCharacters(counts);
+  // printable ascii is used by numbers, titles and file names whatever the language
+  for (char32_t ch = 0x20; ch < 0x7f; ch++)
+    counts[ch] += 1000000;
+
+  std::vector<std::pair<unsigned int, char32_t> > sorted;
+  sorted.reserve(counts.size());
+  for (std::map<char32_t, unsigned int>::const_iterator it = counts.begin(); it != counts.end(); ++it)
+  {
+    // glyphs are stored for the basic plane only
+    if (it->first > L' ' && it->first <= 0xffff)
+      sorted.push_back(std::make_pair(it->second, it->first));
+  }
+  std::sort(sorted.begin(), sorted.end(), std::greater<std::pair<unsigned int, char32_t> >());
+  if (sorted.size() > maxGlyphs)
+    sorted.resize(maxGlyphs);
+
+  for (std::vector<std::pair<unsigned int, char32_t> >::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+    m_prewarmGlyphs.push_back(it->second);
+  return m_prewarmGlyphs;
 }
 
 void GUIFontManager::LoadFonts(const std::string& fontSet)
@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "GraphicContext.h"
+#include "GUIFont.h"
 #include "IMsgTargetCallback.h"
 #include "utils/GlobalsHandling.h"
 
@@ -88,9 +89,13 @@ protected:
   CGUIFontTTFBase* GetFontFile(const std::string& strFontFile);
   static void GetStyle(const TiXmlNode *fontNode, int &iStyle);
 
+  /*! \brief the characters most likely drawn, prewarmed for every font */
+  const vecText& GetPrewarmGlyphs();
+
   std::vector<CGUIFont*> m_vecFonts;
   std::vector<CGUIFontTTFBase*> m_vecFontFiles;
   std::vector<OrigFontInfo> m_vecFontInfo;
+  vecText m_prewarmGlyphs;
   RESOLUTION_INFO m_skinResolution;
   bool m_canReload;
 };
@@ -29,8 +29,12 @@
 #include "windowing/WindowingFactory.h"
 #include "URL.h"
 #include "filesystem/File.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+#include "utils/TimeUtils.h"
 
+#include <algorithm>
 #include <math.h>
 #include <memory>
 #include <queue>
@@ -74,6 +78,9 @@ public:
 
   FT_Face GetFont(const std::string &filename, float size, float aspect, XUTILS::auto_buffer& memoryBuf)
   {
+    // faces are created from the threads prewarming fonts too
+    CSingleLock lock(m_section);
+
     // don't have it yet - create it
     if (!m_library)
       FT_Init_FreeType(&m_library);
@@ -127,6 +134,7 @@ public:
   
   FT_Stroker GetStroker()
   {
+    CSingleLock lock(m_section);
     if (!m_library)
       return NULL;
 
@@ -137,25 +145,161 @@ public:
     return stroker;
   };
 
-  static void ReleaseFont(FT_Face face)
+  void ReleaseFont(FT_Face face)
   {
     assert(face);
+    CSingleLock lock(m_section);
     FT_Done_Face(face);
   };
   
-  static void ReleaseStroker(FT_Stroker stroker)
+  void ReleaseStroker(FT_Stroker stroker)
   {
     assert(stroker);
+    CSingleLock lock(m_section);
     FT_Stroker_Done(stroker);
   }
 
+  /*! \brief held while glyphs are rasterised, FreeType's caches aren't thread safe before 2.6 */
+  CCriticalSection& GetSection() { return m_section; }
+
 private:
   FT_Library   m_library;
+  CCriticalSection m_section;
 };
 
 XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 #define g_freeTypeLibrary XBMC_GLOBAL_USE(CFreeTypeLibrary)
 
+CGUIFontAtlas::CGUIFontAtlas()
+  : m_width(0),
+    m_bottom(0),
+    m_usedArea(0)
+{
+}
+
+void CGUIFontAtlas::Reset(unsigned int width)
+{
+  m_shelves.clear();
+  m_width = width;
+  m_bottom = 0;
+  m_usedArea = 0;
+}
+
+unsigned int CGUIFontAtlas::GetShelfHeight(unsigned int height)
+{
+  // a little taller, so that slightly taller glyphs fit as well
+  return (height + 3) & ~3;
+}
+
+bool CGUIFontAtlas::Allocate(unsigned int width, unsigned int height, unsigned int textureHeight, unsigned int &x, unsigned int &y)
+{
+  if (width > m_width)
+    return false;
+
+  // the shelf wasting the least space
+  Shelf *best = NULL;
+  for (std::vector<Shelf>::iterator shelf = m_shelves.begin(); shelf != m_shelves.end(); ++shelf)
+  {
+    if (shelf->height < height || shelf->height > GetShelfHeight(height) + height / 4 || shelf->x + width > m_width)
+      continue;
+    if (!best || shelf->height < best->height)
+      best = &*shelf;
+  }
+
+  if (!best)
+  {
+    unsigned int shelfHeight = GetShelfHeight(height);
+    if (m_bottom + shelfHeight > textureHeight)
+      return false;
+
+    Shelf shelf = { m_bottom, shelfHeight, 0 };
+    m_shelves.push_back(shelf);
+    m_bottom += shelfHeight;
+    best = &m_shelves.back();
+  }
+
+  x = best->x;
+  y = best->y;
+  best->x += width;
+  m_usedArea += width * height;
+  return true;
+}
+
+unsigned int CGUIFontAtlas::GetRequiredHeight(unsigned int height) const
+{
+  return m_bottom + GetShelfHeight(height);
+}
+
+/*!
+ \ingroup textures,jobs
+ \brief Rasterises glyphs of a font in the background, using a face of its own
+ */
+class CGUIFontPrewarmer : public CJob
+{
+public:
+  CGUIFontPrewarmer(const std::string &filename, float height, float aspect, bool border, unsigned int cellBaseLine,
+                    const vecText &letters, uint32_t style, const std::shared_ptr<CGUIFontTTFBase::PrewarmedGlyphs> &glyphs)
+    : m_filename(filename),
+      m_height(height),
+      m_aspect(aspect),
+      m_border(border),
+      m_cellBaseLine(cellBaseLine),
+      m_letters(letters),
+      m_style(style),
+      m_glyphs(glyphs)
+  {
+  }
+
+  virtual const char *GetType() const { return "fontprewarmer"; }
+
+  virtual bool DoWork()
+  {
+    int64_t start = CurrentHostCounter();
+    std::vector<CGUIFontTTFBase::Glyph> glyphs;
+
+    XUTILS::auto_buffer fontFile;
+    FT_Face face = g_freeTypeLibrary.GetFont(m_filename, m_height, m_aspect, fontFile);
+    if (face)
+    {
+      FT_Stroker stroker = NULL;
+      if (m_border)
+      {
+        stroker = g_freeTypeLibrary.GetStroker();
+        if (stroker)
+          FT_Stroker_Set(stroker, CGUIFontTTFBase::GetBorderStrength(face), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+      }
+
+      glyphs.reserve(m_letters.size());
+      for (vecText::const_iterator letter = m_letters.begin(); letter != m_letters.end() && !ShouldCancel(0, 0); ++letter)
+      {
+        glyphs.push_back(CGUIFontTTFBase::Glyph());
+        if (!CGUIFontTTFBase::RasterizeGlyph(face, stroker, m_cellBaseLine, (wchar_t)(*letter & 0xffff), m_style, glyphs.back()))
+          glyphs.pop_back();
+      }
+
+      if (stroker)
+        g_freeTypeLibrary.ReleaseStroker(stroker);
+      g_freeTypeLibrary.ReleaseFont(face);
+    }
+
+    CSingleLock lock(m_glyphs->section);
+    m_glyphs->glyphs.swap(glyphs);
+    m_glyphs->time = 1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency();
+    m_glyphs->done = true;
+    return true;
+  }
+
+private:
+  std::string m_filename;
+  float m_height;
+  float m_aspect;
+  bool m_border;
+  unsigned int m_cellBaseLine;
+  vecText m_letters;
+  uint32_t m_style;
+  std::shared_ptr<CGUIFontTTFBase::PrewarmedGlyphs> m_glyphs;
+};
+
 CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName) : m_staticCache(*this), m_dynamicCache(*this)
 {
   m_texture = NULL;
@@ -173,12 +317,16 @@ CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName) : m_staticCache
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
   m_numChars = 0;
-  m_posX = m_posY = 0;
   m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
   m_color = 0;
   m_nTexture = 0;
+  m_aspect = 1.0f;
+  m_border = false;
+  m_prewarmStyles = 0;
+  m_prewarmedGlyphs = m_renderGlyphs = m_reallocations = 0;
+  m_renderTime = m_prewarmTime = 0.0f;
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -212,14 +360,30 @@ void CGUIFontTTFBase::ClearCharacterCache()
   memset(m_charquick, 0, sizeof(m_charquick));
   m_numChars = 0;
   m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // the texture is created on first character write
+  m_atlas.Reset(m_textureWidth);
   m_textureHeight = 0;
 }
 
 void CGUIFontTTFBase::Clear()
 {
+  if (m_numChars)
+  {
+    Statistics stats;
+    GetStatistics(stats);
+    CLog::Log(LOGDEBUG, "%s: %s: %u glyphs, %u prewarmed in %.1f ms, %u rasterised while drawing in %.1f ms, "
+              "texture %ux%u %.0f%% used after %u reallocations", __FUNCTION__, m_strFileName.c_str(),
+              stats.glyphs, stats.prewarmedGlyphs, stats.prewarmTime, stats.renderGlyphs, stats.renderTime,
+              stats.textureWidth, stats.textureHeight, stats.occupancy * 100.0f, stats.reallocations);
+  }
+
+  // running jobs only write to the glyphs they share with us
+  for (std::vector<unsigned int>::const_iterator job = m_prewarmJobs.begin(); job != m_prewarmJobs.end(); ++job)
+    CJobManager::GetInstance().CancelJob(*job);
+  m_prewarmJobs.clear();
+  m_prewarm.clear();
+  m_prewarmStyles = 0;
+
   delete(m_texture);
   m_texture = NULL;
   delete[] m_char;
@@ -227,8 +391,7 @@ void CGUIFontTTFBase::Clear()
   m_char = NULL;
   m_maxChars = 0;
   m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
+  m_atlas.Reset(0);
   m_nestedBeginCount = 0;
 
   if (m_face)
@@ -281,9 +444,7 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
      add on the strength of any border - the non-bordered font needs
      aligning with the bordered font by utilising GetTextBaseLine()
      */
-    FT_Pos strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
-    if (strength < 128)
-      strength = 128;
+    FT_Pos strength = GetBorderStrength(m_face);
 
     cellDescender -= strength;
     cellAscender  += strength;
@@ -302,6 +463,8 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
   m_cellHeight   = cellAscender - cellDescender;
 
   m_height = height;
+  m_aspect = aspect;
+  m_border = border;
 
   delete(m_texture);
   m_texture = NULL;
@@ -322,9 +485,8 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
     m_textureWidth = g_Windowing.GetMaxTextureSize();
   m_textureScaleX = 1.0f / m_textureWidth;
 
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // the texture is created on first character write
+  m_atlas.Reset(m_textureWidth);
 
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
@@ -333,8 +495,143 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
   return true;
 }
 
+long CGUIFontTTFBase::GetBorderStrength(FT_Face face)
+{
+  FT_Pos strength = FT_MulFix( face->units_per_EM, face->size->metrics.y_scale) / 12;
+  if (strength < 128)
+    strength = 128;
+  return strength;
+}
+
+void CGUIFontTTFBase::Prewarm(const vecText &letters, uint32_t style)
+{
+  style &= 7;
+  if (!m_face || letters.empty() || (m_prewarmStyles & (1 << style)))
+    return;
+  m_prewarmStyles |= 1 << style;
+
+  vecText styled;
+  styled.reserve(letters.size());
+  for (vecText::const_iterator letter = letters.begin(); letter != letters.end(); ++letter)
+  {
+    if (*letter <= 0xffff)
+      styled.push_back((style << 16) | *letter);
+  }
+
+  std::shared_ptr<PrewarmedGlyphs> glyphs(new PrewarmedGlyphs);
+  m_prewarm.push_back(glyphs);
+  m_prewarmJobs.push_back(CJobManager::GetInstance().AddJob(new CGUIFontPrewarmer(m_strFilename, m_height, m_aspect, m_border, m_cellBaseLine,
+                                                                                  styled, style, glyphs), NULL, CJob::PRIORITY_LOW));
+}
+
+bool CGUIFontTTFBase::HasPrewarmedGlyphs()
+{
+  for (std::vector<std::shared_ptr<PrewarmedGlyphs> >::const_iterator i = m_prewarm.begin(); i != m_prewarm.end(); ++i)
+  {
+    CSingleLock lock((*i)->section);
+    if ((*i)->done)
+      return true;
+  }
+  return false;
+}
+
+void CGUIFontTTFBase::AddPrewarmedGlyphs()
+{
+  std::vector<Glyph> glyphs;
+  for (std::vector<std::shared_ptr<PrewarmedGlyphs> >::iterator i = m_prewarm.begin(); i != m_prewarm.end();)
+  {
+    CSingleLock lock((*i)->section);
+    if (!(*i)->done)
+    {
+      ++i;
+      continue;
+    }
+    m_prewarmTime += (*i)->time;
+    glyphs.insert(glyphs.end(), (*i)->glyphs.begin(), (*i)->glyphs.end());
+    lock.Leave();
+    i = m_prewarm.erase(i);
+  }
+  if (glyphs.empty())
+    return;
+
+  // grow the texture once for all of them rather than glyph by glyph
+  uint64_t area = 0;
+  for (std::vector<Glyph>::const_iterator glyph = glyphs.begin(); glyph != glyphs.end(); ++glyph)
+    area += (glyph->width + spacing_between_characters_in_texture) * (glyph->rows + spacing_between_characters_in_texture);
+  unsigned int height = m_atlas.GetRequiredHeight(0) + (unsigned int)(area * 5 / 4 / std::max(m_textureWidth, 1u));
+  height = std::min(height, g_Windowing.GetMaxTextureSize());
+  if (height > m_textureHeight)
+  {
+    CBaseTexture* newTexture = ReallocTexture(height);
+    if (newTexture)
+    {
+      m_texture = newTexture;
+      m_reallocations++;
+    }
+  }
+
+  // make room for all of them, then sort them in
+  if (m_numChars + (int)glyphs.size() > m_maxChars)
+  {
+    int maxChars = m_numChars + (int)glyphs.size();
+    Character *newTable = new Character[maxChars];
+    if (m_char)
+    {
+      memcpy(newTable, m_char, m_numChars * sizeof(Character));
+      delete[] m_char;
+    }
+    m_char = newTable;
+    m_maxChars = maxChars;
+  }
+
+  int numChars = m_numChars;
+  for (std::vector<Glyph>::const_iterator glyph = glyphs.begin(); glyph != glyphs.end(); ++glyph)
+  {
+    // skip the characters that were drawn in the meantime
+    Character *end = m_char + numChars;
+    Character *ch = std::lower_bound(m_char, end, glyph->letterAndStyle,
+                                     [](const Character &ch, character_t letterAndStyle) { return ch.letterAndStyle < letterAndStyle; });
+    if (ch != end && ch->letterAndStyle == glyph->letterAndStyle)
+      continue;
+
+    // the rest can be rasterised when they're drawn
+    if (!StoreGlyph(*glyph, m_char + m_numChars))
+      break;
+    m_prewarmedGlyphs++;
+  }
+
+  std::sort(m_char, m_char + m_numChars, [](const Character &a, const Character &b) { return a.letterAndStyle < b.letterAndStyle; });
+
+  memset(m_charquick, 0, sizeof(m_charquick));
+  for(int i=0;i<m_numChars;i++)
+  {
+    if ((m_char[i].letterAndStyle & 0xffff) < 255)
+    {
+      character_t ch = ((m_char[i].letterAndStyle & 0xffff0000) >> 8) | (m_char[i].letterAndStyle & 0xff);
+      m_charquick[ch] = m_char+i;
+    }
+  }
+}
+
+void CGUIFontTTFBase::GetStatistics(Statistics &statistics) const
+{
+  statistics.glyphs = m_numChars;
+  statistics.prewarmedGlyphs = m_prewarmedGlyphs;
+  statistics.renderGlyphs = m_renderGlyphs;
+  statistics.renderTime = m_renderTime;
+  statistics.prewarmTime = m_prewarmTime;
+  statistics.reallocations = m_reallocations;
+  statistics.textureWidth = m_textureWidth;
+  statistics.textureHeight = m_textureHeight;
+  statistics.occupancy = m_textureWidth && m_textureHeight ? (float)m_atlas.GetUsedArea() / (m_textureWidth * m_textureHeight) : 0.0f;
+}
+
 void CGUIFontTTFBase::Begin()
 {
+  // glyphs rasterised in the background go into the texture before it's used
+  if (m_nestedBeginCount == 0 && !m_prewarm.empty() && HasPrewarmedGlyphs())
+    AddPrewarmedGlyphs();
+
   if (m_nestedBeginCount == 0 && m_texture != NULL && FirstBegin())
   {
     m_vertexTrans.clear();
@@ -636,6 +933,19 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     else
       return &m_char[mid];
   }
+
+  // it may have been rasterised in the background already
+  if (!m_prewarm.empty() && HasPrewarmedGlyphs())
+  {
+    unsigned int nestedBeginCount = m_nestedBeginCount;
+    m_nestedBeginCount = 1;
+    if (nestedBeginCount) End();
+    AddPrewarmedGlyphs();
+    if (nestedBeginCount) Begin();
+    m_nestedBeginCount = nestedBeginCount;
+    return GetCharacter(chr);
+  }
+
   // if we get to here, then low is where we should insert the new character
 
   // increase the size of the buffer if we need it
@@ -693,112 +1003,132 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
 {
-  int glyph_index = FT_Get_Char_Index( m_face, letter );
+  int64_t start = CurrentHostCounter();
+  Glyph glyph;
+  if (!RasterizeGlyph(m_face, m_stroker, m_cellBaseLine, letter, style, glyph))
+    return false;
+  m_renderTime += 1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency();
+  m_renderGlyphs++;
+
+  return StoreGlyph(glyph, ch);
+}
+
+bool CGUIFontTTFBase::RasterizeGlyph(FT_Face face, FT_Stroker stroker, unsigned int cellBaseLine, wchar_t letter, uint32_t style, Glyph &glyph)
+{
+  // the prewarmers rasterise on faces of their own, but share the library with the render thread
+  CSingleLock lock(g_freeTypeLibrary.GetSection());
 
-  FT_Glyph glyph = NULL;
-  if (FT_Load_Glyph( m_face, glyph_index, FT_LOAD_TARGET_LIGHT ))
+  int glyph_index = FT_Get_Char_Index( face, letter );
+
+  FT_Glyph ftGlyph = NULL;
+  if (FT_Load_Glyph( face, glyph_index, FT_LOAD_TARGET_LIGHT ))
   {
     CLog::Log(LOGDEBUG, "%s Failed to load glyph %x", __FUNCTION__, letter);
     return false;
   }
   // make bold if applicable
   if (style & FONT_STYLE_BOLD)
-    SetGlyphStrength(m_face->glyph, GLYPH_STRENGTH_BOLD);
+    SetGlyphStrength(face, face->glyph, GLYPH_STRENGTH_BOLD);
   // and italics if applicable
   if (style & FONT_STYLE_ITALICS)
-    ObliqueGlyph(m_face->glyph);
+    ObliqueGlyph(face->glyph);
   // and light if applicable
   if (style & FONT_STYLE_LIGHT)
-    SetGlyphStrength(m_face->glyph, GLYPH_STRENGTH_LIGHT);
+    SetGlyphStrength(face, face->glyph, GLYPH_STRENGTH_LIGHT);
   // grab the glyph
-  if (FT_Get_Glyph(m_face->glyph, &glyph))
+  if (FT_Get_Glyph(face->glyph, &ftGlyph))
   {
     CLog::Log(LOGDEBUG, "%s Failed to get glyph %x", __FUNCTION__, letter);
     return false;
   }
-  if (m_stroker)
-    FT_Glyph_StrokeBorder(&glyph, m_stroker, 0, 1);
+  if (stroker)
+    FT_Glyph_StrokeBorder(&ftGlyph, stroker, 0, 1);
   // render the glyph
-  if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, NULL, 1))
+  if (FT_Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_NORMAL, NULL, 1))
   {
     CLog::Log(LOGDEBUG, "%s Failed to render glyph %x to a bitmap", __FUNCTION__, letter);
+    FT_Done_Glyph(ftGlyph);
     return false;
   }
-  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-  bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
+  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)ftGlyph;
+  const FT_Bitmap &bitmap = bitGlyph->bitmap;
 
-  if (!isEmptyGlyph)
-  {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
+  glyph.letterAndStyle = (style << 16) | letter;
+  glyph.offsetX = (short)bitGlyph->left;
+  glyph.offsetY = (short)cellBaseLine - bitGlyph->top;
+  glyph.advance = (float)MathUtils::round_int( (float)face->glyph->advance.x / 64 );
+  glyph.width = bitmap.width;
+  glyph.rows = bitmap.rows;
+
+  // keep the pixels without the padding of the rows
+  glyph.pixels.resize(glyph.width * glyph.rows);
+  for (unsigned int y = 0; y < glyph.rows; y++)
+    memcpy(&glyph.pixels[y * glyph.width], bitmap.buffer + y * bitmap.pitch, glyph.width);
+
+  // free the glyph
+  FT_Done_Glyph(ftGlyph);
+
+  return true;
+}
 
-    // check we have enough room for the character
-    if ((m_posX + bitGlyph->left + bitmap.width) > static_cast<int>(m_textureWidth))
-    { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-      m_posX = 0;
-      m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
+bool CGUIFontTTFBase::StoreGlyph(const Glyph &glyph, Character *ch)
+{
+  bool isEmptyGlyph = (glyph.width == 0 || glyph.rows == 0);
+  unsigned int posX = 0;
+  unsigned int posY = 0;
 
-      if(m_posY + GetTextureLineHeight() >= m_textureHeight)
+  if (!isEmptyGlyph)
+  {
+    // find room for the character
+    unsigned int width = glyph.width + spacing_between_characters_in_texture;
+    unsigned int height = glyph.rows + spacing_between_characters_in_texture;
+    if (m_texture == NULL || !m_atlas.Allocate(width, height, m_textureHeight, posX, posY))
+    { // no space - create a larger texture and copy it across
+      unsigned int newHeight = m_atlas.GetRequiredHeight(height);
+      // check for max size
+      if (width > m_atlas.GetWidth() || newHeight > g_Windowing.GetMaxTextureSize())
       {
-        // create the new larger texture
-        unsigned int newHeight = m_posY + GetTextureLineHeight();
-        // check for max height
-        if (newHeight > g_Windowing.GetMaxTextureSize())
-        {
-          CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
-          return false;
-        }
+        CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
+        return false;
+      }
 
-        CBaseTexture* newTexture = NULL;
-        newTexture = ReallocTexture(newHeight);
-        if(newTexture == NULL)
-        {
-          FT_Done_Glyph(glyph);
-          CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
-          return false;
-        }
-        m_texture = newTexture;
+      CBaseTexture* newTexture = NULL;
+      newTexture = ReallocTexture(newHeight);
+      if(newTexture == NULL)
+      {
+        CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
+        return false;
       }
-    }
+      m_texture = newTexture;
+      m_reallocations++;
 
-    if(m_texture == NULL)
-    {
-      FT_Done_Glyph(glyph);
-      CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
-      return false;
+      if (!m_atlas.Allocate(width, height, m_textureHeight, posX, posY))
+      {
+        CLog::Log(LOGDEBUG, "%s: no room to cache character to", __FUNCTION__);
+        return false;
+      }
     }
   }
   // set the character in our table
-  ch->letterAndStyle = (style << 16) | letter;
-  ch->offsetX = (short)bitGlyph->left;
-  ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
-  ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
-  ch->right = ch->left + bitmap.width;
-  ch->bottom = ch->top + bitmap.rows;
-  ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->letterAndStyle = glyph.letterAndStyle;
+  ch->offsetX = glyph.offsetX;
+  ch->offsetY = glyph.offsetY;
+  ch->left = isEmptyGlyph ? 0 : (float)posX;
+  ch->top = isEmptyGlyph ? 0 : (float)posY;
+  ch->right = ch->left + glyph.width;
+  ch->bottom = ch->top + glyph.rows;
+  ch->advance = glyph.advance;
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = std::max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = std::max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = std::min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = std::min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  
-    m_posX += spacing_between_characters_in_texture + (unsigned short)std::max(ch->right - ch->left + ch->offsetX, ch->advance);
+    unsigned int x2 = std::min(posX + glyph.width, m_textureWidth);
+    unsigned int y2 = std::min(posY + glyph.rows, m_textureHeight);
+    CopyCharToTexture(&glyph.pixels[0], glyph.width, posX, posY, x2, y2);
   }
   m_numChars++;
 
-  // free the glyph
-  FT_Done_Glyph(glyph);
-
   return true;
 }
 
@@ -974,14 +1304,14 @@ void CGUIFontTTFBase::ObliqueGlyph(FT_GlyphSlot slot)
 
 
 // Embolden code - original taken from freetype2 (ftsynth.c)
-void CGUIFontTTFBase::SetGlyphStrength(FT_GlyphSlot slot, int glyphStrength)
+void CGUIFontTTFBase::SetGlyphStrength(FT_Face face, FT_GlyphSlot slot, int glyphStrength)
 {
   if ( slot->format != FT_GLYPH_FORMAT_OUTLINE )
     return;
 
   /* some reasonable strength */
-  FT_Pos strength = FT_MulFix( m_face->units_per_EM,
-                    m_face->size->metrics.y_scale ) / glyphStrength;
+  FT_Pos strength = FT_MulFix( face->units_per_EM,
+                    face->size->metrics.y_scale ) / glyphStrength;
 
   FT_BBox bbox_before, bbox_after;
   FT_Outline_Get_CBox( &slot->outline, &bbox_before );
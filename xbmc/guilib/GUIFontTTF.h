@@ -27,10 +27,12 @@
  *
  */
 
+#include <memory>
 #include <string>
 #include <stdint.h>
 #include <vector>
 
+#include "threads/CriticalSection.h"
 #include "utils/auto_buffer.h"
 #include "Geometry.h"
 
@@ -81,10 +83,56 @@ struct SVertex
 
 #include "GUIFontCache.h"
 
+/*!
+ \ingroup textures
+ \brief Shelf packer placing the glyphs of a font in its texture.
+
+ Glyphs are put side by side on horizontal shelves, each taking the glyphs of
+ about its height, so small glyphs don't take up the space of a full text line.
+ The texture has a fixed width and grows in height when no shelf has room left.
+ */
+class CGUIFontAtlas
+{
+public:
+  CGUIFontAtlas();
+
+  void Reset(unsigned int width);
+
+  /*!
+   \brief Find room for a glyph
+   \param width, height the size of the glyph including its spacing
+   \param textureHeight the current height of the texture
+   \param x, y [out] where to place the glyph
+   \return false if the texture has to grow to GetRequiredHeight() first
+   */
+  bool Allocate(unsigned int width, unsigned int height, unsigned int textureHeight, unsigned int &x, unsigned int &y);
+
+  /*! \brief Height the texture needs to have for a new shelf for glyphs of the given height */
+  unsigned int GetRequiredHeight(unsigned int height) const;
+
+  unsigned int GetWidth() const { return m_width; }
+  uint64_t GetUsedArea() const { return m_usedArea; }
+
+private:
+  struct Shelf
+  {
+    unsigned int y;
+    unsigned int height;
+    unsigned int x; ///< where the next glyph goes
+  };
+
+  static unsigned int GetShelfHeight(unsigned int height);
+
+  std::vector<Shelf> m_shelves;
+  unsigned int m_width;
+  unsigned int m_bottom;
+  uint64_t m_usedArea;
+};
 
 class CGUIFontTTFBase
 {
   friend class CGUIFont;
+  friend class CGUIFontPrewarmer;
 
 public:
 
@@ -103,6 +151,29 @@ public:
 
   const std::string& GetFileName() const { return m_strFileName; };
 
+  /*!
+   \brief Rasterise glyphs in the background before they're drawn.
+   The glyphs are added to the texture all at once the next time the font is
+   used, instead of one by one while text is drawn.
+   \param letters the characters to rasterise
+   \param style the style they'll be drawn with
+   */
+  void Prewarm(const vecText &letters, uint32_t style);
+
+  struct Statistics
+  {
+    unsigned int glyphs;          ///< glyphs in the texture
+    unsigned int prewarmedGlyphs; ///< glyphs that were rasterised in the background
+    unsigned int renderGlyphs;    ///< glyphs that were rasterised while drawing
+    float renderTime;             ///< ms spent rasterising while drawing
+    float prewarmTime;            ///< ms spent rasterising in the background
+    unsigned int reallocations;   ///< times the texture had to grow
+    unsigned int textureWidth;
+    unsigned int textureHeight;
+    float occupancy;              ///< share of the texture covered by glyphs
+  };
+  void GetStatistics(Statistics &statistics) const;
+
 protected:
   struct Character
   {
@@ -111,6 +182,28 @@ protected:
     float advance;
     character_t letterAndStyle;
   };
+
+  /*! \brief A rasterised glyph, not yet in the texture */
+  struct Glyph
+  {
+    character_t letterAndStyle;
+    short offsetX, offsetY;
+    float advance;
+    unsigned int width, rows;
+    std::vector<unsigned char> pixels; ///< 8 bit alpha, width bytes per row
+  };
+
+  /*! \brief Glyphs rasterised by a CGUIFontPrewarmer, shared with it */
+  struct PrewarmedGlyphs
+  {
+    PrewarmedGlyphs() : done(false), time(0.0f) {}
+
+    CCriticalSection section;
+    bool done;
+    std::vector<Glyph> glyphs;
+    float time; ///< ms spent rasterising
+  };
+
   void AddReference();
   void RemoveReference();
 
@@ -130,23 +223,27 @@ protected:
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  bool StoreGlyph(const Glyph &glyph, Character *ch);
+  static bool RasterizeGlyph(FT_Face face, FT_Stroker stroker, unsigned int cellBaseLine, wchar_t letter, uint32_t style, Glyph &glyph);
+  static long GetBorderStrength(FT_Face face);
+  bool HasPrewarmedGlyphs();
+  void AddPrewarmedGlyphs();
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX, std::vector<SVertex> &vertices);
   void ClearCharacterCache();
 
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
+  virtual bool CopyCharToTexture(const unsigned char* pixels, unsigned int pitch, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
   // modifying glyphs
-  void SetGlyphStrength(FT_GlyphSlot slot, int glyphStrength);
+  static void SetGlyphStrength(FT_Face face, FT_GlyphSlot slot, int glyphStrength);
   static void ObliqueGlyph(FT_GlyphSlot slot);
 
   CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
 
   unsigned int m_textureWidth;       // width of our texture
   unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
+  CGUIFontAtlas m_atlas;             // where the characters are in the texture
 
   /*! \brief the height of each line in the texture.
    Accounts for spacing between lines to avoid characters overlapping.
@@ -198,6 +295,19 @@ protected:
   CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue> m_staticCache;
   CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue> m_dynamicCache;
 
+  float m_aspect;
+  bool m_border;
+  uint32_t m_prewarmStyles;          // styles prewarming was requested for, one bit each
+  std::vector<unsigned int> m_prewarmJobs;
+  std::vector<std::shared_ptr<PrewarmedGlyphs> > m_prewarm;
+
+  // statistics
+  unsigned int m_prewarmedGlyphs;
+  unsigned int m_renderGlyphs;
+  float m_renderTime;
+  float m_prewarmTime;
+  unsigned int m_reallocations;
+
 private:
   virtual bool FirstBegin() = 0;
   virtual void LastEnd() = 0;
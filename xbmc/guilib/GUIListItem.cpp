@@ -22,6 +22,7 @@
 
 #include <utility>
 
+#include "GUIInfoManager.h"
 #include "GUIListItemLayout.h"
 #include "utils/Archive.h"
 #include "utils/CharsetConverter.h"
@@ -389,6 +390,7 @@ void CGUIListItem::SetInvalid()
 {
   if (m_layout) m_layout->SetInvalid();
   if (m_focusedLayout) m_focusedLayout->SetInvalid();
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_LISTITEM);
 }
 
 void CGUIListItem::SetProperty(const std::string &strKey, const CVariant &value)
@@ -0,0 +1,150 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIRenderBatch.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// touching edges don't matter, only actual overlaps do
+bool Overlap(const CRect &a, const CRect &b)
+{
+  return a.x1 < b.x2 && b.x1 < a.x2 && a.y1 < b.y2 && b.y1 < a.y2;
+}
+
+void Extend(CRect &rect, const CRect &add)
+{
+  rect.x1 = std::min(rect.x1, add.x1);
+  rect.y1 = std::min(rect.y1, add.y1);
+  rect.x2 = std::max(rect.x2, add.x2);
+  rect.y2 = std::max(rect.y2, add.y2);
+}
+
+}
+
+bool CGUIRenderBatch::Batch::Overlaps(const CRect &rect) const
+{
+  if (!Overlap(bounds, rect))
+    return false;
+  for (std::vector<CRect>::const_iterator region = regions.begin(); region != regions.end(); ++region)
+  {
+    if (Overlap(*region, rect))
+      return true;
+  }
+  return false;
+}
+
+CGUIRenderBatch::CGUIRenderBatch(unsigned int lookBehind)
+  : m_used(0),
+    m_lookBehind(lookBehind),
+    m_quads(0),
+    m_stateRuns(0)
+{
+  ResetStatistics();
+}
+
+void CGUIRenderBatch::AddQuad(const State &state, const Vertex *vertices)
+{
+  CRect bounds(vertices[0].x, vertices[0].y, vertices[0].x, vertices[0].y);
+  for (int i = 1; i < 4; i++)
+  {
+    bounds.x1 = std::min(bounds.x1, vertices[i].x);
+    bounds.y1 = std::min(bounds.y1, vertices[i].y);
+    bounds.x2 = std::max(bounds.x2, vertices[i].x);
+    bounds.y2 = std::max(bounds.y2, vertices[i].y);
+  }
+
+  if (m_quads == 0 || !(state == m_lastState))
+    m_stateRuns++;
+  m_lastState = state;
+  m_quads++;
+
+  // join the last batch with the same state, unless the quad would
+  // then be drawn before one it overlaps
+  Batch *batch = NULL;
+  size_t last = m_used > m_lookBehind ? m_used - m_lookBehind : 0;
+  for (size_t i = m_used; i > last; i--)
+  {
+    Batch &candidate = m_batches[i - 1];
+    if (candidate.state == state)
+    {
+      batch = &candidate;
+      break;
+    }
+    if (candidate.Overlaps(bounds))
+      break;
+  }
+
+  if (batch)
+  {
+    Extend(batch->bounds, bounds);
+
+    // a quad next to the previous one, like the next glyph of a label, extends its region
+    CRect &last = batch->regions.back();
+    float gap = bounds.Height();
+    if (bounds.x1 <= last.x2 + gap && last.x1 <= bounds.x2 + gap && bounds.y1 < last.y2 && last.y1 < bounds.y2)
+      Extend(last, bounds);
+    else
+      batch->regions.push_back(bounds);
+  }
+  else
+  {
+    if (m_used == m_batches.size())
+      m_batches.push_back(Batch());
+    batch = &m_batches[m_used++];
+    batch->state = state;
+    batch->bounds = bounds;
+    batch->regions.assign(1, bounds);
+    batch->vertices.clear();
+  }
+  batch->vertices.insert(batch->vertices.end(), vertices, vertices + 4);
+}
+
+void CGUIRenderBatch::Clear(float drawTime)
+{
+  if (m_quads)
+  {
+    m_statistics.flushes++;
+    m_statistics.quads += m_quads;
+    m_statistics.batches += m_used;
+    m_statistics.stateRuns += m_stateRuns;
+    m_statistics.drawTime += drawTime;
+  }
+
+  m_used = 0;
+  m_quads = 0;
+  m_stateRuns = 0;
+}
+
+void CGUIRenderBatch::GetStatistics(Statistics &statistics) const
+{
+  statistics = m_statistics;
+}
+
+void CGUIRenderBatch::ResetStatistics()
+{
+  m_statistics.flushes = 0;
+  m_statistics.quads = 0;
+  m_statistics.batches = 0;
+  m_statistics.stateRuns = 0;
+  m_statistics.drawTime = 0.0f;
+}
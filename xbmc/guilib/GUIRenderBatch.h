@@ -0,0 +1,120 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <vector>
+
+#include "Geometry.h"
+
+/*!
+ \ingroup textures
+ \brief Collects the quads of textures and text to draw them with as few draw calls as possible.
+
+ Quads drawn with the same state (shader and textures) are grouped into a
+ batch. A quad may join one of the last batches rather than starting a new
+ one, as long as it doesn't overlap any of the batches queued after that one,
+ so the result looks the same as drawing the quads in the order they came in.
+
+ The renderer draws the batches when anything else is to be drawn, or the
+ state the quads depend on (viewport, scissors, camera) is about to change.
+ */
+class CGUIRenderBatch
+{
+public:
+  struct Vertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u1, v1; ///< texture coordinates
+    float u2, v2; ///< diffuse texture coordinates
+  };
+
+  struct State
+  {
+    State() : shader(0), texture(0), diffuse(0) {}
+    State(int shader, unsigned int texture, unsigned int diffuse = 0) : shader(shader), texture(texture), diffuse(diffuse) {}
+
+    bool operator==(const State &right) const
+    {
+      return shader == right.shader && texture == right.texture && diffuse == right.diffuse;
+    }
+
+    int shader;           ///< how the textures are combined, up to the renderer
+    unsigned int texture;
+    unsigned int diffuse;
+  };
+
+  struct Batch
+  {
+    /*! \brief Whether any of the quads overlaps the given area */
+    bool Overlaps(const CRect &rect) const;
+
+    State state;
+    CRect bounds;                 ///< the area covered by the quads
+    std::vector<CRect> regions;   ///< the areas covered by runs of adjacent quads, e.g. the glyphs of a label
+    std::vector<Vertex> vertices; ///< 4 per quad
+  };
+
+  struct Statistics
+  {
+    unsigned int flushes;
+    unsigned int quads;
+    unsigned int batches;   ///< draw calls
+    unsigned int stateRuns; ///< draw calls without reordering, one per run of quads with the same state
+    float drawTime;         ///< ms spent drawing the batches
+  };
+
+  /*!
+   \param lookBehind how many of the last batches a quad may join
+   */
+  CGUIRenderBatch(unsigned int lookBehind = 16);
+
+  /*!
+   \brief Queue a quad
+   \param state the state to draw it with
+   \param vertices its 4 corners
+   */
+  void AddQuad(const State &state, const Vertex *vertices);
+
+  bool IsEmpty() const { return m_used == 0; }
+  size_t GetBatchCount() const { return m_used; }
+  const Batch& GetBatch(size_t index) const { return m_batches[index]; }
+
+  /*!
+   \brief Drop the batches once they're drawn, keeping their memory for the next ones
+   \param drawTime ms it took to draw them
+   */
+  void Clear(float drawTime = 0.0f);
+
+  void GetStatistics(Statistics &statistics) const;
+  void ResetStatistics();
+
+private:
+  std::vector<Batch> m_batches;
+  size_t m_used;
+  unsigned int m_lookBehind;
+
+  State m_lastState;
+  unsigned int m_quads;
+  unsigned int m_stateRuns;
+  Statistics m_statistics;
+};
@@ -0,0 +1,446 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUISkinCache.h"
+
+#include <string.h>
+#include <unordered_map>
+
+#include "filesystem/File.h"
+#include "GUIInfoManager.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/XBMCTinyXML.h"
+
+#define SKINCACHE_MAGIC   "XBSC"
+#define SKINCACHE_VERSION 2
+
+namespace
+{
+
+enum NodeType
+{
+  NODE_ELEMENT = 0,
+  NODE_TEXT,
+  NODE_CDATA
+};
+
+class CWriter
+{
+public:
+  explicit CWriter(std::string &data) : m_data(data) {}
+
+  void WriteByte(uint8_t value) { m_data.push_back((char)value); }
+  void Write32(uint32_t value) { m_data.append((const char *)&value, sizeof(value)); }
+  void Write64(uint64_t value) { m_data.append((const char *)&value, sizeof(value)); }
+  void WriteString(const std::string &value)
+  {
+    Write32(value.size());
+    m_data.append(value);
+  }
+
+private:
+  std::string &m_data;
+};
+
+class CReader
+{
+public:
+  CReader(const char *data, size_t size) : m_pos(data), m_end(data + size) {}
+
+  bool ReadByte(uint8_t &value)
+  {
+    if (m_pos >= m_end)
+      return false;
+    value = (uint8_t)*m_pos++;
+    return true;
+  }
+  bool Read32(uint32_t &value) { return Read(&value, sizeof(value)); }
+  bool Read64(uint64_t &value) { return Read(&value, sizeof(value)); }
+  size_t GetRemaining() const { return m_end - m_pos; }
+
+  bool ReadString(std::string &value)
+  {
+    uint32_t size;
+    if (!Read32(size) || size > (size_t)(m_end - m_pos))
+      return false;
+    value.assign(m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+private:
+  bool Read(void *value, size_t size)
+  {
+    if (size > (size_t)(m_end - m_pos))
+      return false;
+    memcpy(value, m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  const char *m_pos;
+  const char *m_end;
+};
+
+/*!
+ \brief Writes a tree as a table of the names and values it uses, followed by
+ the nodes referring to them by index. Control trees repeat the same few
+ element and attribute names over and over.
+ */
+class CTreeWriter
+{
+public:
+  CTreeWriter() : m_tree(m_treeData) {}
+
+  void WriteNode(const TiXmlNode *node)
+  {
+    const TiXmlElement *element = node->ToElement();
+    if (element)
+    {
+      m_tree.WriteByte(NODE_ELEMENT);
+      m_tree.Write32(GetIndex(element->ValueStr()));
+
+      uint32_t attributes = 0;
+      for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        attributes++;
+      m_tree.Write32(attributes);
+      for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+      {
+        m_tree.Write32(GetIndex(attribute->Name()));
+        m_tree.Write32(GetIndex(attribute->Value()));
+      }
+
+      std::vector<const TiXmlNode*> children;
+      for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+      {
+        if (child->ToElement() || child->ToText())
+          children.push_back(child);
+      }
+      m_tree.Write32(children.size());
+      for (std::vector<const TiXmlNode*>::const_iterator it = children.begin(); it != children.end(); ++it)
+        WriteNode(*it);
+    }
+    else
+    {
+      const TiXmlText *text = node->ToText();
+      m_tree.WriteByte(text->CDATA() ? NODE_CDATA : NODE_TEXT);
+      m_tree.Write32(GetIndex(text->ValueStr()));
+    }
+  }
+
+  void Finish(std::string &data)
+  {
+    CWriter writer(data);
+    writer.Write32(m_strings.size());
+    for (std::vector<std::string>::const_iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+      writer.WriteString(*it);
+    data.append(m_treeData);
+  }
+
+private:
+  uint32_t GetIndex(const std::string &value)
+  {
+    std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> result = m_index.insert(std::make_pair(value, (uint32_t)m_strings.size()));
+    if (result.second)
+      m_strings.push_back(value);
+    return result.first->second;
+  }
+
+  std::string m_treeData;
+  CWriter m_tree;
+  std::vector<std::string> m_strings;
+  std::unordered_map<std::string, uint32_t> m_index;
+};
+
+class CTreeReader
+{
+public:
+  explicit CTreeReader(CReader &reader) : m_reader(reader) {}
+
+  bool ReadStrings()
+  {
+    // every string takes at least its size, so the count can't exceed what is left
+    uint32_t count;
+    if (!m_reader.Read32(count) || count > m_reader.GetRemaining() / sizeof(uint32_t))
+      return false;
+    m_strings.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      if (!m_reader.ReadString(m_strings[i]))
+        return false;
+    }
+    return true;
+  }
+
+  TiXmlNode* ReadNode()
+  {
+    uint8_t type;
+    const std::string *value;
+    if (!m_reader.ReadByte(type) || !ReadIndex(value))
+      return NULL;
+
+    if (type == NODE_TEXT || type == NODE_CDATA)
+    {
+      TiXmlText *text = new TiXmlText(*value);
+      text->SetCDATA(type == NODE_CDATA);
+      return text;
+    }
+    if (type != NODE_ELEMENT)
+      return NULL;
+
+    TiXmlElement *element = new TiXmlElement(*value);
+    uint32_t attributes;
+    if (!m_reader.Read32(attributes))
+      return Fail(element);
+    for (uint32_t i = 0; i < attributes; i++)
+    {
+      const std::string *name;
+      if (!ReadIndex(name) || !ReadIndex(value))
+        return Fail(element);
+      element->SetAttribute(*name, *value);
+    }
+
+    uint32_t children;
+    if (!m_reader.Read32(children))
+      return Fail(element);
+    for (uint32_t i = 0; i < children; i++)
+    {
+      TiXmlNode *child = ReadNode();
+      if (!child)
+        return Fail(element);
+      element->LinkEndChild(child);
+    }
+    return element;
+  }
+
+private:
+  bool ReadIndex(const std::string *&value)
+  {
+    uint32_t index;
+    if (!m_reader.Read32(index) || index >= m_strings.size())
+      return false;
+    value = &m_strings[index];
+    return true;
+  }
+
+  static TiXmlNode* Fail(TiXmlElement *element)
+  {
+    delete element;
+    return NULL;
+  }
+
+  CReader &m_reader;
+  std::vector<std::string> m_strings;
+};
+
+}
+
+CGUISkinCache::CGUISkinCache()
+  : m_changed(false)
+{
+}
+
+void CGUISkinCache::Clear(const std::string &key)
+{
+  CSingleLock lock(m_section);
+  m_windows.clear();
+  m_key = key;
+  m_changed = false;
+}
+
+bool CGUISkinCache::Load(const std::string &file, const std::string &key)
+{
+  Clear(key);
+
+  XFILE::CFile cacheFile;
+  XFILE::auto_buffer buffer;
+  if (!XFILE::CFile::Exists(file) || cacheFile.LoadFile(file, buffer) <= 0)
+    return false;
+
+  CReader reader(buffer.get(), buffer.size());
+  std::string magic, cachedKey;
+  uint32_t version, count;
+  if (!reader.ReadString(magic) || magic != SKINCACHE_MAGIC ||
+      !reader.Read32(version) || version != SKINCACHE_VERSION ||
+      !reader.ReadString(cachedKey) || !reader.Read32(count))
+  {
+    CLog::Log(LOGWARNING, "CGUISkinCache::%s - ignoring invalid skin cache %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  if (cachedKey != key)
+  {
+    CLog::Log(LOGINFO, "CGUISkinCache::%s - skin or includes changed, not using %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  CSingleLock lock(m_section);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string path;
+    CWindow window;
+    uint32_t conditions;
+    if (!reader.ReadString(path) || !reader.ReadString(window.file) ||
+        !reader.Read64(window.time) || !reader.Read32(conditions))
+      break;
+
+    bool valid = true;
+    for (uint32_t j = 0; j < conditions && valid; j++)
+    {
+      std::string expression;
+      uint8_t value;
+      valid = reader.ReadString(expression) && reader.ReadByte(value);
+      window.conditions.push_back(std::make_pair(expression, value != 0));
+    }
+    if (!valid || !reader.ReadString(window.data))
+    {
+      CLog::Log(LOGWARNING, "CGUISkinCache::%s - skin cache %s is truncated", __FUNCTION__, file.c_str());
+      m_windows.clear();
+      return false;
+    }
+
+    // the window was edited since it was cached
+    if (window.time != GetModificationTime(window.file))
+    {
+      m_changed = true;
+      continue;
+    }
+
+    // register the conditions up front, they are checked at every load
+    for (std::vector<std::pair<std::string, bool> >::const_iterator it = window.conditions.begin(); it != window.conditions.end(); ++it)
+      g_infoManager.Register(it->first);
+
+    m_windows[path] = window;
+  }
+
+  CLog::Log(LOGDEBUG, "CGUISkinCache::%s - loaded %u windows from %s", __FUNCTION__, (unsigned int)m_windows.size(), file.c_str());
+  return true;
+}
+
+bool CGUISkinCache::Save(const std::string &file)
+{
+  CSingleLock lock(m_section);
+  if (!m_changed)
+    return true;
+
+  std::string data;
+  CWriter writer(data);
+  writer.WriteString(SKINCACHE_MAGIC);
+  writer.Write32(SKINCACHE_VERSION);
+  writer.WriteString(m_key);
+  writer.Write32(m_windows.size());
+  for (std::map<std::string, CWindow>::const_iterator it = m_windows.begin(); it != m_windows.end(); ++it)
+  {
+    writer.WriteString(it->first);
+    writer.WriteString(it->second.file);
+    writer.Write64(it->second.time);
+    writer.Write32(it->second.conditions.size());
+    for (std::vector<std::pair<std::string, bool> >::const_iterator condition = it->second.conditions.begin(); condition != it->second.conditions.end(); ++condition)
+    {
+      writer.WriteString(condition->first);
+      writer.WriteByte(condition->second ? 1 : 0);
+    }
+    writer.WriteString(it->second.data);
+  }
+
+  XFILE::CFile cacheFile;
+  if (!cacheFile.OpenForWrite(file, true) || cacheFile.Write(data.c_str(), data.size()) != (ssize_t)data.size())
+  {
+    CLog::Log(LOGERROR, "CGUISkinCache::%s - unable to write %s", __FUNCTION__, file.c_str());
+    cacheFile.Close();
+    XFILE::CFile::Delete(file);
+    return false;
+  }
+  cacheFile.Close();
+
+  m_changed = false;
+  return true;
+}
+
+TiXmlElement* CGUISkinCache::Get(const std::string &path, std::map<INFO::InfoPtr, bool> &conditions)
+{
+  CSingleLock lock(m_section);
+  std::map<std::string, CWindow>::const_iterator it = m_windows.find(path);
+  if (it == m_windows.end())
+    return NULL;
+
+  conditions.clear();
+  for (std::vector<std::pair<std::string, bool> >::const_iterator condition = it->second.conditions.begin(); condition != it->second.conditions.end(); ++condition)
+  {
+    INFO::InfoPtr info = g_infoManager.Register(condition->first);
+    if (!info || info->Get() != condition->second)
+    {
+      conditions.clear();
+      return NULL;
+    }
+    conditions[info] = condition->second;
+  }
+
+  TiXmlElement *root = Deserialize(it->second.data);
+  if (!root)
+    conditions.clear();
+  return root;
+}
+
+void CGUISkinCache::Add(const std::string &path, const std::string &file, const TiXmlElement &root, const std::map<INFO::InfoPtr, bool> &conditions)
+{
+  CWindow window;
+  window.file = file;
+  window.time = GetModificationTime(file);
+  for (std::map<INFO::InfoPtr, bool>::const_iterator it = conditions.begin(); it != conditions.end(); ++it)
+    window.conditions.push_back(std::make_pair(it->first->GetExpression(), it->second));
+  Serialize(root, window.data);
+
+  CSingleLock lock(m_section);
+  std::swap(m_windows[path], window);
+  m_changed = true;
+}
+
+void CGUISkinCache::Serialize(const TiXmlElement &root, std::string &data)
+{
+  CTreeWriter writer;
+  writer.WriteNode(&root);
+  writer.Finish(data);
+}
+
+TiXmlElement* CGUISkinCache::Deserialize(const std::string &data)
+{
+  CReader reader(data.c_str(), data.size());
+  CTreeReader tree(reader);
+  if (!tree.ReadStrings())
+    return NULL;
+
+  TiXmlNode *root = tree.ReadNode();
+  if (root && !root->ToElement())
+  {
+    delete root;
+    return NULL;
+  }
+  return root ? root->ToElement() : NULL;
+}
+
+uint64_t CGUISkinCache::GetModificationTime(const std::string &path)
+{
+  struct __stat64 buffer;
+  if (XFILE::CFile::Stat(path, &buffer) != 0)
+    return 0;
+  return buffer.st_mtime;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "interfaces/info/InfoBool.h"
+#include "threads/CriticalSection.h"
+
+class TiXmlElement;
+
+/*!
+ \brief Cache of skin windows with their includes resolved.
+
+ Resolving the includes, parameters, constants and expressions takes most of
+ the time of loading a window. The result only depends on the include files
+ and on the values the include conditions had, so the resolved tree is kept in
+ a compact binary form along with those conditions and reused for as long as
+ they keep their values.
+
+ The cache is written to disk when the skin is unloaded and read back when it
+ is loaded again, unless the skin version or any of its include files changed.
+ Windows whose file changed are dropped on loading.
+ */
+class CGUISkinCache
+{
+public:
+  CGUISkinCache();
+
+  /*! \brief Drop all windows
+   \param key identifies the skin, its version and its include files
+   */
+  void Clear(const std::string &key);
+
+  /*! \brief Read the cache written for the same key, start empty otherwise */
+  bool Load(const std::string &file, const std::string &key);
+
+  /*! \brief Write the cache if any window was added since it was loaded */
+  bool Save(const std::string &file);
+
+  /*!
+   \brief Get the resolved tree of a window.
+   \param path the window file
+   \param conditions [out] the include conditions and their values
+   \return a new tree owned by the caller, NULL if the window isn't cached or an include condition changed
+   */
+  TiXmlElement* Get(const std::string &path, std::map<INFO::InfoPtr, bool> &conditions);
+
+  /*!
+   \brief Store the resolved tree of a window.
+   \param path the window file
+   \param file the file the window was read from, which may differ from path in case
+   \param root the tree after resolving its includes
+   \param conditions the include conditions and their values used to resolve it
+   */
+  void Add(const std::string &path, const std::string &file, const TiXmlElement &root, const std::map<INFO::InfoPtr, bool> &conditions);
+
+  static void Serialize(const TiXmlElement &root, std::string &data);
+  static TiXmlElement* Deserialize(const std::string &data);
+
+private:
+  struct CWindow
+  {
+    CWindow() : time(0) {}
+
+    std::string file;                                       ///< the file the window was read from
+    uint64_t time;                                          ///< modification time of that file
+    std::vector<std::pair<std::string, bool> > conditions; ///< include conditions and their values
+    std::string data;                                       ///< serialized tree
+  };
+
+  static uint64_t GetModificationTime(const std::string &path);
+
+  std::map<std::string, CWindow> m_windows;
+  std::string m_key;
+  bool m_changed;
+  CCriticalSection m_section;
+};
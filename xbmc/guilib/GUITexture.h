@@ -92,6 +92,9 @@ public:
   bool Process(unsigned int currentTime);
   void Render();
 
+  /*! \brief Draw what the renderer queued so far, before anything is drawn in another way */
+  static void Flush() {};
+
   void DynamicResourceAlloc(bool bOnOff);
   bool AllocResources();
   void FreeResources(bool immediately = false);
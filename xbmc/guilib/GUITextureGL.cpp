@@ -23,61 +23,73 @@
 #include "GUITextureGL.h"
 #endif
 #include "Texture.h"
+#include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
+#include "utils/TimeUtils.h"
 #include "guilib/Geometry.h"
 #include "windowing/WindowingFactory.h"
 
 #if defined(HAS_GL)
 
-CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo &texture)
-: CGUITextureBase(posX, posY, width, height, texture)
+namespace
 {
-  memset(m_col, 0, sizeof(m_col));
-}
 
-void CGUITextureGL::Begin(color_t color)
+CGUIRenderBatch& GetRenderBatch()
 {
-  int range, unit = 0;
-  if(g_Windowing.UseLimitedColor())
-    range = 235 - 16;
-  else
-    range = 255 -  0;
+  static CGUIRenderBatch batch;
+  return batch;
+}
 
-  m_col[0] = GET_R(color) * range / 255;
-  m_col[1] = GET_G(color) * range / 255;
-  m_col[2] = GET_B(color) * range / 255;
-  m_col[3] = GET_A(color);
+void BindTexture(unsigned int unit, GLuint texture)
+{
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glEnable(GL_TEXTURE_2D);
+}
 
-  CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
-  texture->LoadToGPU();
-  if (m_diffuse.size())
-    m_diffuse.m_textures[0]->LoadToGPU();
+void SetBatchState(const CGUIRenderBatch::State &state, bool limitedColor)
+{
+  unsigned int unit = 0;
+  BindTexture(unit++, state.texture);
 
-  texture->BindToUnit(unit++);
+  if (state.shader == CGUITextureGL::BATCH_FONT)
+  {
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
 
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
+    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+  }
+  else
+  {
+    glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
 
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+    // diffuse coloring
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
 
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+  }
   VerifyGLState();
 
-  if (m_diffuse.size())
+  if (state.shader == CGUITextureGL::BATCH_TEXTURE_DIFFUSE)
   {
-    m_diffuse.m_textures[0]->BindToUnit(unit++);
+    BindTexture(unit++, state.diffuse);
     glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
     glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
     glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
@@ -93,9 +105,9 @@ void CGUITextureGL::Begin(color_t color)
     VerifyGLState();
   }
 
-  if(g_Windowing.UseLimitedColor())
+  if (limitedColor)
   {
-    texture->BindToUnit(unit++); // dummy bind
+    BindTexture(unit++, state.texture); // dummy bind
     const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
     glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
     glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
@@ -110,74 +122,180 @@ void CGUITextureGL::Begin(color_t color)
     VerifyGLState();
   }
 
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
+  // the units a previous batch used
+  for (; unit < 3; unit++)
+  {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glDisable(GL_TEXTURE_2D);
+  }
+  glActiveTexture(GL_TEXTURE0);
 }
 
-void CGUITextureGL::End()
+}
+
+CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo &texture)
+: CGUITextureBase(posX, posY, width, height, texture)
 {
-  glEnd();
-  glActiveTexture(GL_TEXTURE2_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE1_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE0_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
+  memset(m_col, 0, sizeof(m_col));
 }
 
-void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
+void CGUITextureGL::Begin(color_t color)
 {
-  // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
+  int range;
+  if(g_Windowing.UseLimitedColor())
+    range = 235 - 16;
+  else
+    range = 255 -  0;
+
+  m_col[0] = GET_R(color) * range / 255;
+  m_col[1] = GET_G(color) * range / 255;
+  m_col[2] = GET_B(color) * range / 255;
+  m_col[3] = GET_A(color);
+
+  CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
+  texture->LoadToGPU();
   if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+    m_diffuse.m_textures[0]->LoadToGPU();
 
-  // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
+  // the quads are drawn along with the others using the same textures
   if (m_diffuse.size())
+    m_state = CGUIRenderBatch::State(BATCH_TEXTURE_DIFFUSE, static_cast<CGLTexture*>(texture)->GetTextureObject(),
+                                     static_cast<CGLTexture*>(m_diffuse.m_textures[0])->GetTextureObject());
+  else
+    m_state = CGUIRenderBatch::State(BATCH_TEXTURE, static_cast<CGLTexture*>(texture)->GetTextureObject());
+}
+
+void CGUITextureGL::End()
+{
+  if (!IsBatching())
+    Flush();
+}
+
+void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
+{
+  CGUIRenderBatch::Vertex vertices[4];
+  for (int i = 0; i < 4; i++)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
+    vertices[i].x = x[i];
+    vertices[i].y = y[i];
+    vertices[i].z = z[i];
+    vertices[i].r = m_col[0];
+    vertices[i].g = m_col[1];
+    vertices[i].b = m_col[2];
+    vertices[i].a = m_col[3];
   }
-  glVertex3f(x[1], y[1], z[1]);
+
+  // Top-left vertex (corner)
+  vertices[0].u1 = texture.x1;
+  vertices[0].v1 = texture.y1;
+  vertices[0].u2 = diffuse.x1;
+  vertices[0].v2 = diffuse.y1;
+
+  // Top-right vertex (corner)
+  vertices[1].u1 = (orientation & 4) ? texture.x1 : texture.x2;
+  vertices[1].v1 = (orientation & 4) ? texture.y2 : texture.y1;
+  vertices[1].u2 = (m_info.orientation & 4) ? diffuse.x1 : diffuse.x2;
+  vertices[1].v2 = (m_info.orientation & 4) ? diffuse.y2 : diffuse.y1;
 
   // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+  vertices[2].u1 = texture.x2;
+  vertices[2].v1 = texture.y2;
+  vertices[2].u2 = diffuse.x2;
+  vertices[2].v2 = diffuse.y2;
 
   // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  if (m_diffuse.size())
+  vertices[3].u1 = (orientation & 4) ? texture.x2 : texture.x1;
+  vertices[3].v1 = (orientation & 4) ? texture.y1 : texture.y2;
+  vertices[3].u2 = (m_info.orientation & 4) ? diffuse.x2 : diffuse.x1;
+  vertices[3].v2 = (m_info.orientation & 4) ? diffuse.y1 : diffuse.y2;
+
+  GetRenderBatch().AddQuad(m_state, vertices);
+}
+
+void CGUITextureGL::AddQuad(const CGUIRenderBatch::State &state, const CGUIRenderBatch::Vertex *vertices)
+{
+  GetRenderBatch().AddQuad(state, vertices);
+}
+
+bool CGUITextureGL::IsBatching()
+{
+  return g_advancedSettings.m_guiBatchRendering;
+}
+
+void CGUITextureGL::Flush()
+{
+  CGUIRenderBatch &batch = GetRenderBatch();
+  if (batch.IsEmpty())
+    return;
+
+  int64_t start = CurrentHostCounter();
+  bool limitedColor = g_Windowing.UseLimitedColor();
+
+  glEnable(GL_BLEND);          // Turn Blending On
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glClientActiveTexture(GL_TEXTURE0);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+  const CGUIRenderBatch::State *state = NULL;
+  for (size_t i = 0; i < batch.GetBatchCount(); i++)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
+    const CGUIRenderBatch::Batch &quads = batch.GetBatch(i);
+    if (!state || !(*state == quads.state))
+    {
+      SetBatchState(quads.state, limitedColor);
+
+      glClientActiveTexture(GL_TEXTURE1);
+      if (quads.state.shader == BATCH_TEXTURE_DIFFUSE)
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+      else
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+      glClientActiveTexture(GL_TEXTURE0);
+    }
+    state = &quads.state;
+
+    const CGUIRenderBatch::Vertex *vertices = &quads.vertices[0];
+    glVertexPointer(3, GL_FLOAT, sizeof(CGUIRenderBatch::Vertex), &vertices->x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(CGUIRenderBatch::Vertex), &vertices->r);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(CGUIRenderBatch::Vertex), &vertices->u1);
+    if (quads.state.shader == BATCH_TEXTURE_DIFFUSE)
+    {
+      glClientActiveTexture(GL_TEXTURE1);
+      glTexCoordPointer(2, GL_FLOAT, sizeof(CGUIRenderBatch::Vertex), &vertices->u2);
+      glClientActiveTexture(GL_TEXTURE0);
+    }
+    glDrawArrays(GL_QUADS, 0, quads.vertices.size());
   }
-  glVertex3f(x[3], y[3], z[3]);
+
+  glPopClientAttrib();
+
+  glActiveTexture(GL_TEXTURE2_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  glActiveTexture(GL_TEXTURE1_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  glActiveTexture(GL_TEXTURE0_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  VerifyGLState();
+
+  batch.Clear(1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency());
+}
+
+void CGUITextureGL::GetStatistics(CGUIRenderBatch::Statistics &statistics)
+{
+  GetRenderBatch().GetStatistics(statistics);
 }
 
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  // drawn right away, after what was queued before
+  Flush();
+
   if (texture)
   {
     texture->LoadToGPU();
@@ -29,20 +29,43 @@
  */
 
 #include "GUITexture.h"
+#include "GUIRenderBatch.h"
 
 #include "system_gl.h"
 
 class CGUITextureGL : public CGUITextureBase
 {
 public:
+  enum BatchShader
+  {
+    BATCH_TEXTURE = 0,
+    BATCH_TEXTURE_DIFFUSE,
+    BATCH_FONT              ///< alpha only texture, coloured by the vertices
+  };
+
   CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo& texture);
   static void DrawQuad(const CRect &coords, color_t color, CBaseTexture *texture = NULL, const CRect *texCoords = NULL);
+
+  /*!
+   \brief Queue a quad to be drawn along with the others using the same state
+   \sa Flush
+   */
+  static void AddQuad(const CGUIRenderBatch::State &state, const CGUIRenderBatch::Vertex *vertices);
+
+  /*! \brief Draw the queued quads of textures and text */
+  static void Flush();
+
+  /*! \brief Whether quads are queued across controls, otherwise they're drawn at the end of each texture or text */
+  static bool IsBatching();
+
+  static void GetStatistics(CGUIRenderBatch::Statistics &statistics);
 protected:
   void Begin(color_t color);
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 private:
   GLubyte m_col[4];
+  CGUIRenderBatch::State m_state;
 };
 
 #endif
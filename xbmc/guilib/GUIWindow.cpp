@@ -133,13 +133,24 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLowerPath)
 {
+  // the window with its includes resolved, if none of the include conditions changed
+  TiXmlElement *pResolvedElement = g_SkinInfo->GetCachedWindow(strPath, m_xmlIncludeConditions);
+  if (pResolvedElement)
+    return LoadResolved(pResolvedElement);
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
     CXBMCTinyXML xmlDoc;
     std::string strPathLower = strPath;
     StringUtils::ToLower(strPathLower);
-    if (!xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(strPathLower) && !xmlDoc.LoadFile(strLowerPath))
+    if (xmlDoc.LoadFile(strPath))
+      m_windowXMLFile = strPath;
+    else if (xmlDoc.LoadFile(strPathLower))
+      m_windowXMLFile = strPathLower;
+    else if (xmlDoc.LoadFile(strLowerPath))
+      m_windowXMLFile = strLowerPath;
+    else
     {
       CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
       SetID(WINDOW_INVALID);
@@ -150,30 +161,50 @@ bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLower
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  pResolvedElement = ResolveXML(m_windowXMLRootElement);
+  if (!pResolvedElement)
+    return false;
+
+  // the cache checks the file that was read, which may be the lower case fallback
+  g_SkinInfo->CacheWindow(strPath, m_windowXMLFile, *pResolvedElement, m_xmlIncludeConditions);
+  return LoadResolved(pResolvedElement);
 }
 
 bool CGUIWindow::Load(TiXmlElement* pRootElement)
 {
-  if (!pRootElement)
+  TiXmlElement *pResolvedElement = ResolveXML(pRootElement);
+  if (!pResolvedElement)
     return false;
-  
+
+  return LoadResolved(pResolvedElement);
+}
+
+TiXmlElement* CGUIWindow::ResolveXML(const TiXmlElement *pRootElement)
+{
+  if (!pRootElement)
+    return NULL;
+
   if (strcmpi(pRootElement->Value(), "window"))
   {
     CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
-    return false;
+    return NULL;
   }
 
   // we must create copy of root element as we will manipulate it when resolving includes
   // and we don't want original root element to change
-  pRootElement = (TiXmlElement*)pRootElement->Clone();
+  TiXmlElement *pResolvedElement = (TiXmlElement*)pRootElement->Clone();
 
+  // Resolve any includes that may be present and save conditions used to do it
+  g_SkinInfo->ResolveIncludes(pResolvedElement, &m_xmlIncludeConditions);
+  return pResolvedElement;
+}
+
+bool CGUIWindow::LoadResolved(TiXmlElement* pRootElement)
+{
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
   // now load in the skin file
   SetDefaults();
 
@@ -382,6 +413,7 @@ void CGUIWindow::Close_Internal(bool forceClose /*= false*/, int nextWindowID /*
       // Perform the window out effect
       QueueAnimation(ANIM_TYPE_WINDOW_CLOSE);
       m_closing = true;
+      g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_WINDOW);
     }
     return;
   }
@@ -542,6 +574,7 @@ void CGUIWindow::OnInitWindow()
   RestoreControlStates();
   SetInitialVisibility();
   QueueAnimation(ANIM_TYPE_WINDOW_OPEN);
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_WINDOW);
 
   if (!m_manualRunActions)
   {
@@ -802,6 +835,7 @@ void CGUIWindow::FreeResources(bool forceUnload /*= FALSE */)
   {
     delete m_windowXMLRootElement;
     m_windowXMLRootElement = NULL;
+    m_windowXMLFile.clear();
     m_xmlIncludeConditions.clear();
   }
 }
@@ -1041,6 +1075,7 @@ void CGUIWindow::SetProperty(const std::string &strKey, const CVariant &value)
 {
   CSingleLock lock(*this);
   m_mapProperties[strKey] = value;
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_WINDOW);
 }
 
 CVariant CGUIWindow::GetProperty(const std::string &strKey) const
@@ -1057,6 +1092,7 @@ void CGUIWindow::ClearProperties()
 {
   CSingleLock lock(*this);
   m_mapProperties.clear();
+  g_infoManager.InvalidateCache(INFO::INFO_DEPENDS_WINDOW);
 }
 
 void CGUIWindow::SetRunActionsManually()
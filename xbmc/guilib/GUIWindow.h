@@ -204,6 +204,8 @@ protected:
   virtual EVENT_RESULT OnMouseEvent(const CPoint &point, const CMouseEvent &event);
   virtual bool LoadXML(const std::string& strPath, const std::string &strLowerPath);  ///< Loads from the given file
   bool Load(TiXmlElement *pRootElement);                 ///< Loads from the given XML root element
+  TiXmlElement* ResolveXML(const TiXmlElement *pRootElement); ///< Copy of the given XML root element with its includes resolved
+  bool LoadResolved(TiXmlElement *pRootElement);         ///< Loads from the given resolved XML root element, taking ownership
   /*! \brief Check if XML file needs (re)loading
    XML file has to be (re)loaded when window is not loaded or include conditions values were changed
    */
@@ -274,6 +276,7 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  std::string m_windowXMLFile; ///< the file m_windowXMLRootElement was read from
 
   bool m_manualRunActions;
 
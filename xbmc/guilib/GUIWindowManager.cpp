@@ -153,6 +153,9 @@ using namespace PVR;
 using namespace PERIPHERALS;
 using namespace KODI::MESSAGING;
 
+// info bool sources that change with the active window and dialogs
+static const unsigned int WINDOW_STATE_DEPENDENCIES = INFO::INFO_DEPENDS_WINDOW | INFO::INFO_DEPENDS_FOCUS | INFO::INFO_DEPENDS_LISTITEM;
+
 CGUIWindowManager::CGUIWindowManager(void)
 {
   m_pCallback = NULL;
@@ -588,6 +591,7 @@ void CGUIWindowManager::RegisterDialog(CGUIWindow* dialog)
       return;
   }
   m_activeDialogs.push_back(dialog);
+  g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
 }
 
 void CGUIWindowManager::Remove(int id)
@@ -606,6 +610,7 @@ void CGUIWindowManager::Remove(int id)
     }
 
     m_mapWindows.erase(it);
+    g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
   }
   else
   {
@@ -688,6 +693,7 @@ void CGUIWindowManager::PreviousWindow()
 
   // remove the current window off our window stack
   m_windowHistory.pop();
+  g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
 
   // ok, initialize the new window
   CLog::Log(LOGDEBUG,"CGUIWindowManager::PreviousWindow: Activate new");
@@ -995,6 +1001,9 @@ void CGUIWindowManager::Process(unsigned int currentTime)
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
+  // changes made while handling input and messages apply to this frame
+  g_infoManager.ApplyCacheInvalidation();
+
   CDirtyRegionList dirtyregions;
 
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
@@ -1107,6 +1116,9 @@ bool CGUIWindowManager::Render()
       CGUITexture::DrawQuad(*i, 0x4c00ff00);
   }
 
+  // the frame may be read back right after this
+  CGUITexture::Flush();
+
   return hasRendered;
 }
 
@@ -1224,6 +1236,7 @@ void CGUIWindowManager::DeInitialize()
   // clear our vectors of windows
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
+  g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
 
   m_initialized = false;
 }
@@ -1238,6 +1251,7 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
       return;
     }
   }
@@ -1509,6 +1523,7 @@ void CGUIWindowManager::AddToWindowHistory(int newWindowID)
     // but do not add the splash window to history, as we never want to travel back to it
     m_windowHistory.push(newWindowID);
   }
+  g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
 }
 
 void CGUIWindowManager::GetActiveModelessWindows(std::vector<int> &ids)
@@ -1557,6 +1572,7 @@ void CGUIWindowManager::ClearWindowHistory()
 {
   while (!m_windowHistory.empty())
     m_windowHistory.pop();
+  g_infoManager.InvalidateCache(WINDOW_STATE_DEPENDENCIES);
 }
 
 void CGUIWindowManager::CloseWindowSync(CGUIWindow *window, int nextWindowID /*= 0*/)
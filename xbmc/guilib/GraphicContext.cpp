@@ -29,6 +29,7 @@
 #include "settings/Settings.h"
 #include "windowing/WindowingFactory.h"
 #include "TextureManager.h"
+#include "GUITexture.h"
 #include "input/InputManager.h"
 #include "GUIWindowManager.h"
 #include "ServiceBroker.h"
@@ -241,6 +242,8 @@ bool CGraphicContext::SetViewPort(float fx, float fy, float fwidth, float fheigh
   m_viewStack.push(newviewport);
 
   newviewport = StereoCorrection(newviewport);
+  // the quads queued so far are drawn in the old viewport
+  CGUITexture::Flush();
   g_Windowing.SetViewPort(newviewport);
 
 
@@ -254,6 +257,7 @@ void CGraphicContext::RestoreViewPort()
 
   m_viewStack.pop();
   CRect viewport = StereoCorrection(m_viewStack.top());
+  CGUITexture::Flush();
   g_Windowing.SetViewPort(viewport);
 
   UpdateCameraPosition(m_cameras.top(), m_stereoFactors.top());
@@ -291,12 +295,14 @@ void CGraphicContext::SetScissors(const CRect &rect)
 {
   m_scissors = rect;
   m_scissors.Intersect(CRect(0,0,(float)m_iScreenWidth, (float)m_iScreenHeight));
+  CGUITexture::Flush();
   g_Windowing.SetScissors(StereoCorrection(m_scissors));
 }
 
 void CGraphicContext::ResetScissors()
 {
   m_scissors.SetRect(0, 0, (float)m_iScreenWidth, (float)m_iScreenHeight);
+  CGUITexture::Flush();
   g_Windowing.SetScissors(StereoCorrection(m_scissors));
 }
 
@@ -647,11 +653,14 @@ void CGraphicContext::ResetScreenParameters(RESOLUTION res)
 
 void CGraphicContext::Clear(color_t color)
 {
+  CGUITexture::Flush();
   g_Windowing.ClearBuffers(color);
 }
 
 void CGraphicContext::CaptureStateBlock()
 {
+  // whatever comes next draws directly
+  CGUITexture::Flush();
   g_Windowing.CaptureStateBlock();
 }
 
@@ -816,6 +825,7 @@ void CGraphicContext::SetStereoView(RENDER_STEREO_VIEW view)
   m_viewStack.push(viewport);
 
   viewport = StereoCorrection(viewport);
+  CGUITexture::Flush();
   g_Windowing.SetStereoMode(m_stereoMode, m_stereoView);
   g_Windowing.SetViewPort(viewport);
   g_Windowing.SetScissors(viewport);
@@ -921,6 +931,7 @@ void CGraphicContext::UpdateCameraPosition(const CPoint &camera, const float &fa
     float scaleX = static_cast<float>(CSettings::GetInstance().GetInt(CSettings::SETTING_LOOKANDFEEL_STEREOSTRENGTH)) * scaleRes;
     stereoFactor = factor * (m_stereoView == RENDER_STEREO_VIEW_LEFT ? scaleX : -scaleX);
   }
+  CGUITexture::Flush();
   g_Windowing.SetCameraPosition(camera, m_iScreenWidth, m_iScreenHeight, stereoFactor);
 }
 
@@ -979,6 +990,8 @@ void CGraphicContext::SetMediaDir(const std::string &strMediaDir)
 
 void CGraphicContext::Flip(bool rendered, bool videoLayer)
 {
+  CGUITexture::Flush();
+
   if (IsFullScreenVideo() && CServiceBroker::GetDataCacheCore().IsRenderClockSync())
     g_Windowing.FinishPipeline();
 
@@ -994,11 +1007,13 @@ void CGraphicContext::Flip(bool rendered, bool videoLayer)
 
 void CGraphicContext::ApplyHardwareTransform()
 {
+  CGUITexture::Flush();
   g_Windowing.ApplyHardwareTransform(m_finalTransform.matrix);
 }
 
 void CGraphicContext::RestoreHardwareTransform()
 {
+  CGUITexture::Flush();
   g_Windowing.RestoreHardwareTransform();
 }
 
@@ -264,6 +264,19 @@ const std::string& CLocalizeStrings::Get(uint32_t dwCode) const
   return i->second.strTranslated;
 }
 
+void CLocalizeStrings::CountCharacters(std::map<char32_t, unsigned int> &counts) const
+{
+  CSharedLock lock(m_stringsMutex);
+  for (ciStrings i = m_strings.begin(); i != m_strings.end(); ++i)
+  {
+    std::u32string text;
+    if (!g_charsetConverter.utf8ToUtf32(i->second.strTranslated, text, false))
+      continue;
+    for (std::u32string::const_iterator ch = text.begin(); ch != text.end(); ++ch)
+      counts[*ch]++;
+  }
+}
+
 void CLocalizeStrings::Clear()
 {
   CExclusiveLock lock(m_stringsMutex);
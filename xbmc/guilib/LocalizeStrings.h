@@ -60,6 +60,8 @@ public:
   bool LoadAddonStrings(const std::string& path, const std::string& language, const std::string& addonId);
   void ClearSkinStrings();
   const std::string& Get(uint32_t code) const;
+  /*! \brief Count how often each character occurs in the strings, e.g. to know which glyphs will be drawn */
+  void CountCharacters(std::map<char32_t, unsigned int> &counts) const;
   std::string GetAddonString(const std::string& addonId, uint32_t code);
   void Clear();
 
@@ -78,6 +78,16 @@ int CTextureBundle::LoadAnim(const std::string& Filename, CBaseTexture*** ppText
   return 0;
 }
 
+bool CTextureBundle::PrepareBatch(const std::vector<std::string>& names, CTextureBundleXBT::CBatch& batch)
+{
+  if (m_useXBT)
+  {
+    return m_tbXBT.PrepareBatch(names, batch);
+  }
+
+  return false;
+}
+
 void CTextureBundle::SetThemeBundle(bool themeBundle)
 {
   m_tbXBT.SetThemeBundle(themeBundle);
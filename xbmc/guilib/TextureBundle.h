@@ -40,6 +40,8 @@ public:
 
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
 
+  bool PrepareBatch(const std::vector<std::string>& names, CTextureBundleXBT::CBatch& batch);
+
 private:
   CTextureBundleXBT m_tbXBT;
 
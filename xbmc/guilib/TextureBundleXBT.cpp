@@ -27,10 +27,16 @@
 #include "settings/Settings.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/XbtManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
 #include "XBTF.h"
 #include "XBTFReader.h"
+#include <algorithm>
+#include <functional>
 #include <lzo/lzo1x.h>
 
 #ifdef TARGET_WINDOWS
@@ -41,6 +47,63 @@
 #endif
 #endif
 
+namespace
+{
+
+/*!
+ \brief Runs a function for all items, on the calling thread and on jobs helping it.
+ The caller takes items too until none are left, so the work finishes even when
+ the job manager has no worker to spare. Jobs that only run after that find
+ nothing to do.
+ */
+class CParallelWork
+{
+public:
+  CParallelWork(size_t count, const std::function<void(size_t)>& work)
+    : m_count(count),
+      m_next(0),
+      m_done(0),
+      m_work(work)
+  {
+  }
+
+  void Run()
+  {
+    while (true)
+    {
+      size_t item;
+      {
+        CSingleLock lock(m_section);
+        if (m_next >= m_count)
+          return;
+        item = m_next++;
+      }
+
+      m_work(item);
+
+      CSingleLock lock(m_section);
+      if (++m_done == m_count)
+        m_finished.Set();
+    }
+  }
+
+  void Wait()
+  {
+    if (m_count > 0)
+      m_finished.Wait();
+  }
+
+private:
+  size_t m_count;
+  size_t m_next;
+  size_t m_done;
+  std::function<void(size_t)> m_work;
+  CCriticalSection m_section;
+  CEvent m_finished;
+};
+
+}
+
 CTextureBundleXBT::CTextureBundleXBT()
   : m_TimeStamp{0}
   , m_themeBundle{false}
@@ -163,7 +226,7 @@ bool CTextureBundleXBT::LoadTexture(const std::string& Filename, CBaseTexture**
     return false;
 
   CXBTFFrame& frame = file.GetFrames().at(0);
-  if (!ConvertFrameToTexture(Filename, frame, ppTexture))
+  if (!ConvertFrameToTexture(*m_XBTFReader, Filename, frame, ppTexture))
   {
     return false;
   }
@@ -194,7 +257,7 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   {
     CXBTFFrame& frame = file.GetFrames().at(i);
 
-    if (!ConvertFrameToTexture(Filename, frame, &((*ppTextures)[i])))
+    if (!ConvertFrameToTexture(*m_XBTFReader, Filename, frame, &((*ppTextures)[i])))
     {
       return false;
     }
@@ -209,50 +272,66 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   return nTextures;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+bool CTextureBundleXBT::PrepareBatch(const std::vector<std::string>& names, CBatch& batch)
 {
-  // found texture - allocate the necessary buffers
-  unsigned char *buffer = new unsigned char [(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
-  {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+  if ((m_XBTFReader == nullptr || !m_XBTFReader->IsOpen()) && !OpenBundle())
     return false;
-  }
 
-  // load the compressed texture
-  if (!m_XBTFReader->Load(frame, buffer))
+  batch.reader = m_XBTFReader;
+  for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name)
   {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
+    CXBTFFile file;
+    if (!m_XBTFReader->Get(Normalize(*name), file) || file.GetFrames().empty())
+      continue;
+
+    batch.names.push_back(*name);
+    batch.frames.push_back(file.GetFrames().front());
   }
+  batch.textures.assign(batch.names.size(), nullptr);
 
-  // check if it's packed with lzo
-  if (frame.IsPacked())
-  { // unpack
-    unsigned char *unpacked = new unsigned char[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
-    {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
-    }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
+  return !batch.names.empty();
+}
+
+void CTextureBundleXBT::LoadBatch(CBatch& batch)
+{
+  batch.textures.assign(batch.frames.size(), nullptr);
+  if (batch.reader == nullptr || batch.frames.empty())
+    return;
+
+  std::shared_ptr<CParallelWork> work(new CParallelWork(batch.frames.size(), [&batch](size_t i)
+  {
+    if (!ConvertFrameToTexture(*batch.reader, batch.names[i], batch.frames[i], &batch.textures[i]))
+      batch.textures[i] = nullptr;
+  }));
+
+  // one thread per core, including the calling one
+  size_t threads = std::min(batch.frames.size(), static_cast<size_t>(std::max(g_cpuInfo.getCPUCount(), 1)));
+  for (size_t i = 1; i < threads; i++)
+    CJobManager::GetInstance().Submit([work]() { work->Run(); });
+
+  work->Run();
+  work->Wait();
+}
+
+bool CTextureBundleXBT::ConvertFrameToTexture(const CXBTFReader& reader, const std::string& name, const CXBTFFrame& frame, CBaseTexture** ppTexture)
+{
+  // frames that aren't packed are used straight from the mapped bundle
+  const unsigned char* pixels = reader.GetFrameData(frame);
+  unsigned char* buffer = nullptr;
+  if (pixels == nullptr || frame.IsPacked())
+  {
+    buffer = UnpackFrame(reader, frame);
+    if (buffer == nullptr)
     {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
       return false;
     }
-    delete[] buffer;
-    buffer = unpacked;
+    pixels = buffer;
   }
 
   // create an xbmc texture
   *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), pixels);
 
   delete[] buffer;
 
@@ -279,24 +358,32 @@ std::string CTextureBundleXBT::Normalize(const std::string &name)
 
 uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
 {
-  uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
-  if (packedBuffer == nullptr)
+  // packed frames are decompressed straight from the mapped bundle
+  const uint8_t* packedData = reader.GetFrameData(frame);
+  uint8_t* packedBuffer = nullptr;
+  if (packedData == nullptr || !frame.IsPacked())
   {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
-    return nullptr;
-  }
+    packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
+    if (packedBuffer == nullptr)
+    {
+      CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
+      return nullptr;
+    }
 
-  // load the compressed texture
-  if (!reader.Load(frame, packedBuffer))
-  {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
-    delete[] packedBuffer;
-    return nullptr;
-  }
+    // load the compressed texture
+    if (!reader.Load(frame, packedBuffer))
+    {
+      CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
+      delete[] packedBuffer;
+      return nullptr;
+    }
+
+    // if the frame isn't packed there's nothing else to be done
+    if (!frame.IsPacked())
+      return packedBuffer;
 
-  // if the frame isn't packed there's nothing else to be done
-  if (!frame.IsPacked())
-    return packedBuffer;
+    packedData = packedBuffer;
+  }
 
   uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
   if (unpackedBuffer == nullptr)
@@ -316,7 +403,7 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   }
 
   lzo_uint size = static_cast<lzo_uint>(frame.GetUnpackedSize());
-  if (lzo1x_decompress_safe(packedBuffer, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
+  if (lzo1x_decompress_safe(packedData, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to decompress frame with %" PRIu64" unpacked bytes to %" PRIu64" bytes", frame.GetPackedSize(), frame.GetUnpackedSize());
     delete[] packedBuffer;
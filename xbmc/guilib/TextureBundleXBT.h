@@ -25,9 +25,10 @@
 #include <string>
 #include <vector>
 
+#include "XBTF.h"
+
 class CBaseTexture;
 class CXBTFReader;
-class CXBTFFrame;
 
 class CTextureBundleXBT
 {
@@ -47,11 +48,38 @@ public:
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*!
+   \brief Textures looked up by PrepareBatch() and decoded by LoadBatch()
+   */
+  struct CBatch
+  {
+    std::shared_ptr<CXBTFReader> reader;
+    std::vector<std::string> names;      ///< textures found in the bundle
+    std::vector<CXBTFFrame> frames;      ///< their first frame
+    std::vector<CBaseTexture*> textures; ///< the decoded textures, owned by the caller, NULL on failure
+  };
+
+  /*!
+   \brief Look up the static textures to decode with LoadBatch()
+   \param names the textures to look up
+   \param batch [out] the textures that were found
+   \return true if any texture was found
+   */
+  bool PrepareBatch(const std::vector<std::string>& names, CBatch& batch);
+
+  /*!
+   \brief Decode a batch of textures, decompressing the frames in parallel
+   Doesn't access the bundle itself, so it can be called without the lock
+   serializing the accesses to it.
+   \param batch the batch prepared by PrepareBatch()
+   */
+  static void LoadBatch(CBatch& batch);
+
   static uint8_t* UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
 
 private:
   bool OpenBundle();
-  bool ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
+  static bool ConvertFrameToTexture(const CXBTFReader& reader, const std::string& name, const CXBTFFrame& frame, CBaseTexture** ppTexture);
 
   time_t m_TimeStamp;
 
@@ -23,14 +23,17 @@
 #include <cassert>
 
 #include "addons/Skin.h"
+#include "Application.h"
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "GraphicContext.h"
+#include "GUITexture.h"
 #include "system.h"
 #include "Texture.h"
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -207,6 +210,12 @@ void CTextureMap::SetWidth(int height)
   m_texture.m_width = height;
 }
 
+void CTextureMap::LoadToGPU()
+{
+  for (unsigned int i = 0; i < m_texture.m_textures.size(); i++)
+    m_texture.m_textures[i]->LoadToGPU();
+}
+
 bool CTextureMap::IsEmpty() const
 {
   return m_texture.m_textures.empty();
@@ -220,10 +229,74 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
     m_memUsage += sizeof(CTexture) + (texture->GetTextureWidth() * texture->GetTextureHeight() * 4);
 }
 
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+CTexturePreloader::CTexturePreloader(const std::vector<std::string> &textureNames)
+{
+  m_textures.resize(textureNames.size());
+  for (size_t i = 0; i < textureNames.size(); i++)
+  {
+    m_textures[i].name = textureNames[i];
+    m_textures[i].texture = NULL;
+    m_textures[i].width = 0;
+    m_textures[i].height = 0;
+  }
+}
+
+CTexturePreloader::~CTexturePreloader()
+{
+  for (std::vector<CPreloadedTexture>::iterator i = m_textures.begin(); i != m_textures.end(); ++i)
+    delete i->texture;
+}
+
+bool CTexturePreloader::DoWork()
+{
+  std::vector<std::string> bundled[2];
+  std::unordered_map<std::string, size_t> index;
+  for (size_t i = 0; i < m_textures.size(); i++)
+  {
+    CPreloadedTexture &preloaded = m_textures[i];
+    std::string path;
+    int bundle = -1;
+    int size = 0;
+    if (!g_TextureManager.HasTexture(preloaded.name, &path, &bundle, &size) || size)
+      continue;
+
+    if (bundle >= 0)
+    {
+      bundled[bundle].push_back(preloaded.name);
+      index[preloaded.name] = i;
+    }
+    else
+      preloaded.texture = g_TextureManager.LoadStaticTexture(preloaded.name, path, bundle, preloaded.width, preloaded.height);
+  }
+
+  for (int bundle = 0; bundle < 2; bundle++)
+  {
+    CTextureBundleXBT::CBatch batch;
+    if (bundled[bundle].empty() || !g_TextureManager.PrepareBatch(bundle, bundled[bundle], batch))
+      continue;
+
+    CTextureBundleXBT::LoadBatch(batch);
+    for (size_t i = 0; i < batch.names.size(); i++)
+    {
+      CPreloadedTexture &preloaded = m_textures[index[batch.names[i]]];
+      preloaded.texture = batch.textures[i];
+      preloaded.width = batch.frames[i].GetWidth();
+      preloaded.height = batch.frames[i].GetHeight();
+    }
+  }
+  return true;
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
 CGUITextureManager::CGUITextureManager(void)
+  : m_frameStalls(0),
+    m_frameStallTime(0),
+    m_totalStalls(0)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
@@ -261,16 +334,16 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
 
   // Check our loaded and bundled textures - we store in bundles using \\.
   std::string bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
+    CSingleLock lock(m_textureSection);
+    if (m_textures.find(textureName) != m_textures.end())
     {
       if (size) *size = 1;
       return true;
     }
   }
 
+  CSingleLock lock(m_bundleSection);
   for (int i = 0; i < 2; i++)
   {
     if (m_TexBundle[i].HasFile(bundledName))
@@ -279,6 +352,7 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
       return true;
     }
   }
+  lock.Leave();
 
   std::string fullPath = GetTexturePath(textureName);
   if (path)
@@ -289,45 +363,62 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
 
 const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName, bool checkBundleOnly /*= false */)
 {
-  std::string strPath;
   static CTextureArray emptyTexture;
-  int bundle = -1;
-  int size = 0;
-  if (!HasTexture(strTextureName, &strPath, &bundle, &size))
+  if (!CanLoad(strTextureName))
     return emptyTexture;
 
-  if (size) // we found the texture
+  // only the app thread changes the index, no need to lock for lookups
+  TextureIndex::const_iterator it = m_textures.find(strTextureName);
+  if (it != m_textures.end())
   {
-    for (int i = 0; i < (int)m_vecTextures.size(); ++i)
-    {
-      CTextureMap *pMap = m_vecTextures[i];
-      if (pMap->GetName() == strTextureName)
-      {
-        //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-        return pMap->GetTexture();
-      }
-    }
-    // Whoops, not there.
-    return emptyTexture;
+    //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
+    return it->second->GetTexture();
   }
 
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
+  std::unordered_map<std::string, ilistUnused>::iterator unused = m_unusedIndex.find(strTextureName);
+  if (unused != m_unusedIndex.end())
   {
-    CTextureMap* pMap = i->first;
-    if (pMap->GetName() == strTextureName && i->second > 0)
-    {
-      m_vecTextures.push_back(pMap);
-      m_unusedTextures.erase(i);
-      return pMap->GetTexture();
-    }
+    CTextureMap* pMap = unused->second->first;
+    m_unusedTextures.erase(unused->second);
+    m_unusedIndex.erase(unused);
+    CSingleLock lock(m_textureSection);
+    m_textures[strTextureName] = pMap;
+    return pMap->GetTexture();
+  }
+
+  CTextureMap* pPreloaded = GetPreloaded(strTextureName);
+  if (pPreloaded)
+  {
+    CSingleLock lock(m_textureSection);
+    m_textures[strTextureName] = pPreloaded;
+    return pPreloaded->GetTexture();
   }
 
+  std::string strPath;
+  int bundle = -1;
+  int size = 0;
+  if (!HasTexture(strTextureName, &strPath, &bundle, &size))
+    return emptyTexture;
+
   if (checkBundleOnly && bundle == -1)
     return emptyTexture;
 
   //Lock here, we will do stuff that could break rendering
   CSingleLock lock(g_graphicsContext);
 
+  // the texture wasn't preloaded, so decoding it holds up the frame
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  m_frameStalls++;
+  m_totalStalls++;
+  const CTextureArray& texture = LoadTexture(strTextureName, strPath, bundle);
+  m_frameStallTime += XbmcThreads::SystemClockMillis() - start;
+  return texture;
+}
+
+const CTextureArray& CGUITextureManager::LoadTexture(const std::string& strTextureName, const std::string& strPath, int bundle)
+{
+  static CTextureArray emptyTexture;
+
 #ifdef _DEBUG_TEXTURES
   int64_t start;
   start = CurrentHostCounter();
@@ -339,7 +430,9 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     CBaseTexture **pTextures = nullptr;
     int nLoops = 0, width = 0, height = 0;
     int* Delay = nullptr;
+    CSingleLock bundleLock(m_bundleSection);
     int nImages = m_TexBundle[bundle].LoadAnim(strTextureName, &pTextures, width, height, nLoops, &Delay);
+    bundleLock.Leave();
     if (!nImages)
     {
       CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
@@ -364,7 +457,8 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     delete[] pTextures;
     delete[] Delay;
 
-    m_vecTextures.push_back(pMap);
+    CSingleLock indexLock(m_textureSection);
+    m_textures[strTextureName] = pMap;
     return pMap->GetTexture();
   }
   else if (StringUtils::EndsWithNoCase(strPath, ".gif") ||
@@ -423,34 +517,20 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
     file.Close();
 
-    m_vecTextures.push_back(pMap);
+    CSingleLock indexLock(m_textureSection);
+    m_textures[strTextureName] = pMap;
     return pMap->GetTexture();
   }
 
-  CBaseTexture *pTexture = NULL;
   int width = 0, height = 0;
-  if (bundle >= 0)
-  {
-    if (!m_TexBundle[bundle].LoadTexture(strTextureName, &pTexture, width, height))
-    {
-      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
-      return emptyTexture;
-    }
-  }
-  else
-  {
-    pTexture = CBaseTexture::LoadFromFile(strPath);
-    if (!pTexture)
-      return emptyTexture;
-    width = pTexture->GetWidth();
-    height = pTexture->GetHeight();
-  }
-
+  CBaseTexture *pTexture = LoadStaticTexture(strTextureName, strPath, bundle, width, height);
   if (!pTexture) return emptyTexture;
 
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
   pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+  CSingleLock indexLock(m_textureSection);
+  m_textures[strTextureName] = pMap;
+  indexLock.Leave();
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -464,30 +544,193 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
   return pMap->GetTexture();
 }
 
+CBaseTexture* CGUITextureManager::LoadStaticTexture(const std::string &textureName, const std::string &path, int bundle, int &width, int &height)
+{
+  CBaseTexture *pTexture = NULL;
+  if (bundle >= 0)
+  {
+    // the frame is decoded without holding the bundle lock
+    std::vector<std::string> names(1, textureName);
+    CTextureBundleXBT::CBatch batch;
+    if (!PrepareBatch(bundle, names, batch))
+    {
+      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", textureName.c_str());
+      return NULL;
+    }
+    CTextureBundleXBT::LoadBatch(batch);
+    pTexture = batch.textures[0];
+    if (!pTexture)
+    {
+      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", textureName.c_str());
+      return NULL;
+    }
+    width = batch.frames[0].GetWidth();
+    height = batch.frames[0].GetHeight();
+  }
+  else
+  {
+    pTexture = CBaseTexture::LoadFromFile(path);
+    if (!pTexture)
+      return NULL;
+    width = pTexture->GetWidth();
+    height = pTexture->GetHeight();
+  }
+  return pTexture;
+}
+
+bool CGUITextureManager::PrepareBatch(int bundle, const std::vector<std::string> &textureNames, CTextureBundleXBT::CBatch &batch)
+{
+  CSingleLock lock(m_bundleSection);
+  return m_TexBundle[bundle].PrepareBatch(textureNames, batch);
+}
 
 void CGUITextureManager::ReleaseTexture(const std::string& strTextureName, bool immediately /*= false */)
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureIndex::iterator i = m_textures.find(strTextureName);
+  if (i == m_textures.end())
+  {
+    CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
+    return;
+  }
+
+  CTextureMap* pMap = i->second;
+  if (pMap->Release())
+  {
+    //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
+    // add to our textures to free
+    unsigned int time = immediately ? 0 : XbmcThreads::SystemClockMillis();
+    ilistUnused unused = m_unusedTextures.insert(m_unusedTextures.end(), std::make_pair(pMap, time));
+    if (time > 0)
+      m_unusedIndex[strTextureName] = unused;
+    CSingleLock indexLock(m_textureSection);
+    m_textures.erase(i);
+  }
+}
+
+void CGUITextureManager::Preload(const std::string &textureName)
+{
+  // only a hint, the index can't be checked from other threads
+  if (!g_application.IsCurrentThread())
+    return;
+
+  if (textureName.empty() || !CanLoad(textureName) ||
+      StringUtils::EndsWithNoCase(textureName, ".gif") ||
+      StringUtils::EndsWithNoCase(textureName, ".apng"))
+    return;
+
+  if (m_textures.find(textureName) != m_textures.end() ||
+      m_unusedIndex.find(textureName) != m_unusedIndex.end())
+    return;
+
+  CSingleLock lock(m_preloadSection);
+  if (m_preloadJobs.find(textureName) != m_preloadJobs.end() ||
+      m_preloaded.find(textureName) != m_preloaded.end())
+    return;
+
+  m_preloadJobs[textureName] = 0;
+  m_preloadBatch.push_back(textureName);
+  // big enough to keep all cores busy decompressing
+  if (m_preloadBatch.size() >= 32)
+    SubmitPreloads();
+}
+
+void CGUITextureManager::SubmitPreloads()
+{
+  // skip the textures that were loaded since they were requested
+  std::vector<std::string> textureNames;
+  for (std::vector<std::string>::const_iterator i = m_preloadBatch.begin(); i != m_preloadBatch.end(); ++i)
+  {
+    std::unordered_map<std::string, unsigned int>::const_iterator job = m_preloadJobs.find(*i);
+    if (job != m_preloadJobs.end() && job->second == 0)
+      textureNames.push_back(*i);
+  }
+  m_preloadBatch.clear();
+  if (textureNames.empty())
+    return;
+
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CTexturePreloader(textureNames), this, CJob::PRIORITY_NORMAL);
+  for (std::vector<std::string>::const_iterator i = textureNames.begin(); i != textureNames.end(); ++i)
+    m_preloadJobs[*i] = jobID;
+}
+
+void CGUITextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CTexturePreloader *preloader = static_cast<CTexturePreloader*>(job);
+
+  CSingleLock lock(m_preloadSection);
+  for (std::vector<CTexturePreloader::CPreloadedTexture>::iterator i = preloader->m_textures.begin(); i != preloader->m_textures.end(); ++i)
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    std::unordered_map<std::string, unsigned int>::iterator it = m_preloadJobs.find(i->name);
+    if (it == m_preloadJobs.end() || it->second != jobID)
+      continue; // the texture was loaded in the meantime
+
+    m_preloadJobs.erase(it);
+    if (!success || !i->texture)
+      continue;
+
+    CTextureMap* pMap = new CTextureMap(i->name, i->width, i->height, 0);
+    pMap->Add(i->texture, 100);
+    i->texture = NULL; // we keep the texture, jobs are auto-deleted
+    m_preloaded[i->name] = std::make_pair(pMap, XbmcThreads::SystemClockMillis());
+    m_uploadQueue.push_back(i->name);
+  }
+}
+
+CTextureMap* CGUITextureManager::GetPreloaded(const std::string &textureName)
+{
+  CSingleLock lock(m_preloadSection);
+  std::unordered_map<std::string, std::pair<CTextureMap*, unsigned int> >::iterator it = m_preloaded.find(textureName);
+  if (it != m_preloaded.end())
+  {
+    CTextureMap* pMap = it->second.first;
+    m_preloaded.erase(it);
+    return pMap;
+  }
+
+  // still being decoded, quicker to do it ourselves than to wait for the
+  // jobs queued before it. The job is cancelled once none of its textures
+  // are needed anymore.
+  std::unordered_map<std::string, unsigned int>::iterator job = m_preloadJobs.find(textureName);
+  if (job != m_preloadJobs.end())
+  {
+    unsigned int jobID = job->second;
+    m_preloadJobs.erase(job);
+    if (jobID == 0)
+      return NULL;
+    for (job = m_preloadJobs.begin(); job != m_preloadJobs.end(); ++job)
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(std::make_pair(pMap, immediately ? 0 : XbmcThreads::SystemClockMillis()));
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      if (job->second == jobID)
+        return NULL;
+    }
+    CJobManager::GetInstance().CancelJob(jobID);
+  }
+  return NULL;
+}
+
+void CGUITextureManager::FrameMove(unsigned int maxUploads /* = 8 */)
+{
+  if (m_frameStalls)
+    CLog::Log(LOGDEBUG, "%s - %u textures loaded synchronously in the last frame, taking %u ms (%u in total)",
+              __FUNCTION__, m_frameStalls, m_frameStallTime, m_totalStalls);
+  m_frameStalls = 0;
+  m_frameStallTime = 0;
+
+  CSingleLock graphicsLock(g_graphicsContext);
+  CSingleLock lock(m_preloadSection);
+  SubmitPreloads();
+  for (unsigned int uploads = 0; uploads < maxUploads && !m_uploadQueue.empty(); )
+  {
+    // textures that were loaded or freed in the meantime are skipped
+    std::unordered_map<std::string, std::pair<CTextureMap*, unsigned int> >::iterator it = m_preloaded.find(m_uploadQueue.front());
+    m_uploadQueue.pop_front();
+    if (it != m_preloaded.end())
+    {
+      it->second.first->LoadToGPU();
+      uploads++;
     }
-    ++i;
   }
-  CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
 
 void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
@@ -498,6 +741,9 @@ void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
   {
     if (currFrameTime - i->second >= timeDelay)
     {
+      std::unordered_map<std::string, ilistUnused>::iterator index = m_unusedIndex.find(i->first->GetName());
+      if (index != m_unusedIndex.end() && index->second == i)
+        m_unusedIndex.erase(index);
       delete i->first;
       i = m_unusedTextures.erase(i);
     }
@@ -505,7 +751,25 @@ void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
       ++i;
   }
 
+  // preloaded textures that nobody asked for
+  CSingleLock preloadLock(m_preloadSection);
+  for (std::unordered_map<std::string, std::pair<CTextureMap*, unsigned int> >::iterator i = m_preloaded.begin(); i != m_preloaded.end();)
+  {
+    if (currFrameTime - i->second.second >= timeDelay)
+    {
+      delete i->second.first;
+      i = m_preloaded.erase(i);
+    }
+    else
+      ++i;
+  }
+  preloadLock.Leave();
+
 #if defined(HAS_GL) || defined(HAS_GLES)
+  // quads still queued may use them
+  if (!m_unusedHwTextures.empty())
+    CGUITexture::Flush();
+
   for (unsigned int i = 0; i < m_unusedHwTextures.size(); ++i)
   {
   // on ios the hw textures might be deleted from the os
@@ -530,28 +794,41 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  CSingleLock preloadLock(m_preloadSection);
+  for (std::unordered_map<std::string, unsigned int>::const_iterator i = m_preloadJobs.begin(); i != m_preloadJobs.end(); ++i)
   {
-    CTextureMap* pMap = *i;
+    if (i->second)
+      CJobManager::GetInstance().CancelJob(i->second);
+  }
+  m_preloadJobs.clear();
+  m_preloadBatch.clear();
+  m_uploadQueue.clear();
+  preloadLock.Leave();
+
+  CSingleLock indexLock(m_textureSection);
+  for (TextureIndex::iterator i = m_textures.begin(); i != m_textures.end(); ++i)
+  {
+    CTextureMap* pMap = i->second;
     CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
     delete pMap;
-    i = m_vecTextures.erase(i);
   }
+  m_textures.clear();
+  indexLock.Leave();
 
+  CSingleLock bundleLock(m_bundleSection);
   m_TexBundle[0] = CTextureBundle(true);
   m_TexBundle[1] = CTextureBundle();
+  bundleLock.Leave();
   FreeUnusedTextures();
 }
 
 void CGUITextureManager::Dump() const
 {
-  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_vecTextures.size());
+  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_textures.size());
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
+    const CTextureMap* pMap = i->second;
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
@@ -560,17 +837,17 @@ void CGUITextureManager::Dump() const
 void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
+  CSingleLock indexLock(m_textureSection);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureIndex::iterator i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     pMap->Flush();
     if (pMap->IsEmpty() )
     {
       delete pMap;
-      i = m_vecTextures.erase(i);
+      i = m_textures.erase(i);
     }
     else
     {
@@ -582,9 +859,9 @@ void CGUITextureManager::Flush()
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
   unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
+    memUsage += i->second->GetMemoryUsage();
   }
   return memUsage;
 }
@@ -643,6 +920,7 @@ std::string CGUITextureManager::GetTexturePath(const std::string &textureName, b
 
 void CGUITextureManager::GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items)
 {
+  CSingleLock lock(m_bundleSection);
   m_TexBundle[0].GetTexturesFromPath(texturePath, items);
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
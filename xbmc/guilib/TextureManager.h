@@ -24,12 +24,15 @@
 */
 #pragma once
 
+#include <deque>
 #include <list>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
+#include "utils/Job.h"
 
 /************************************************************************/
 /*                                                                      */
@@ -85,6 +88,7 @@ public:
   bool IsEmpty() const;
   void SetHeight(int height);
   void SetWidth(int height);
+  void LoadToGPU();
 protected:
   void FreeTexture();
 
@@ -94,6 +98,30 @@ protected:
   uint32_t m_memUsage;
 };
 
+/*!
+ \ingroup textures,jobs
+ \brief Decodes a batch of skin textures in the background for CGUITextureManager::Preload()
+ Bundled textures are decoded together, decompressing them in parallel.
+ */
+class CTexturePreloader : public CJob
+{
+public:
+  CTexturePreloader(const std::vector<std::string> &textureNames);
+  virtual ~CTexturePreloader();
+
+  virtual const char *GetType() const { return "texturepreloader"; }
+  virtual bool DoWork();
+
+  struct CPreloadedTexture
+  {
+    std::string name;
+    CBaseTexture *texture; ///< the decoded texture, not yet uploaded
+    int width;
+    int height;
+  };
+  std::vector<CPreloadedTexture> m_textures;
+};
+
 /*!
  \ingroup textures
  \brief
@@ -101,7 +129,7 @@ protected:
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
-class CGUITextureManager
+class CGUITextureManager : public IJobCallback
 {
 public:
   CGUITextureManager(void);
@@ -124,17 +152,65 @@ public:
 
   void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+
+  /*!
+   \brief Decode a texture in the background ahead of its Load().
+   Only requests from the app thread are followed. Animated textures and
+   textures that are loaded already are skipped. The requests are collected
+   into batches that are decoded once they're full or in the next FrameMove().
+   Preloaded textures that aren't loaded are freed along with the unused textures.
+   \param textureName the texture as it will be passed to Load()
+   */
+  void Preload(const std::string &textureName);
+
+  /*!
+   \brief Upload some of the preloaded textures to the GPU (called from app thread only)
+   Spreads the uploads over several frames and logs the textures that had to
+   be decoded by Load() in the last frame.
+   \param maxUploads maximum number of textures to upload
+   */
+  void FrameMove(unsigned int maxUploads = 8);
+
+  /*! \brief Number of textures Load() had to decode itself */
+  unsigned int GetStallCount() const { return m_totalStalls; }
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
-  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
+  friend class CTexturePreloader;
+  friend class TestTextureManager;
+
+  const CTextureArray& LoadTexture(const std::string& strTextureName, const std::string& strPath, int bundle);
+  CBaseTexture* LoadStaticTexture(const std::string &textureName, const std::string &path, int bundle, int &width, int &height);
+  CTextureMap* GetPreloaded(const std::string &textureName);
+  bool PrepareBatch(int bundle, const std::vector<std::string> &textureNames, CTextureBundleXBT::CBatch &batch);
+  void SubmitPreloads();
+
+  typedef std::unordered_map<std::string, CTextureMap*> TextureIndex;
+  typedef std::list<std::pair<CTextureMap*, unsigned int> > UnusedTextures;
+  typedef UnusedTextures::iterator ilistUnused;
+
+  TextureIndex m_textures;
+  UnusedTextures m_unusedTextures;
+  std::unordered_map<std::string, ilistUnused> m_unusedIndex; ///< unused textures that can be loaded again
   std::vector<unsigned int> m_unusedHwTextures;
-  typedef std::vector<CTextureMap*>::iterator ivecTextures;
-  typedef std::list<std::pair<CTextureMap*, unsigned int> >::iterator ilistUnused;
+  CCriticalSection m_textureSection; ///< guards changes to m_textures, read from other threads
+
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
+  CCriticalSection m_bundleSection;
 
   std::vector<std::string> m_texturePaths;
   CCriticalSection m_section;
+
+  std::unordered_map<std::string, unsigned int> m_preloadJobs; ///< texture name -> job id, 0 while in m_preloadBatch
+  std::vector<std::string> m_preloadBatch;                     ///< textures to preload in the next job
+  std::unordered_map<std::string, std::pair<CTextureMap*, unsigned int> > m_preloaded; ///< decoded textures and when they were
+  std::deque<std::string> m_uploadQueue;
+  CCriticalSection m_preloadSection;
+
+  unsigned int m_frameStalls;
+  unsigned int m_frameStallTime;
+  unsigned int m_totalStalls;
 };
 
 /*!
@@ -25,7 +25,13 @@
 
 #include "XBTFReader.h"
 #include "guilib/XBTF.h"
+#include "threads/SingleLock.h"
 #include "utils/EndianSwap.h"
+#include "utils/log.h"
+
+#ifdef TARGET_POSIX
+#include <sys/mman.h>
+#endif
 
 #ifdef TARGET_WINDOWS
 #include "filesystem/SpecialProtocol.h"
@@ -68,12 +74,15 @@ static bool ReadUInt64(FILE* file, uint64_t& value)
 CXBTFReader::CXBTFReader()
   : CXBTFBase(),
     m_path(),
-    m_file(nullptr)
+    m_file(nullptr),
+    m_mapping(nullptr),
+    m_mappingSize(0)
 { }
 
 CXBTFReader::~CXBTFReader()
 {
   Close();
+  Unmap();
 }
 
 bool CXBTFReader::Open(const std::string& path)
@@ -176,6 +185,24 @@ bool CXBTFReader::Open(const std::string& path)
   if (pos != GetHeaderSize())
     return false;
 
+#ifdef TARGET_POSIX
+  // map the whole bundle, frames are then read without any system call
+  Unmap();
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == 0 && fileStat.st_size > 0 &&
+      static_cast<uint64_t>(fileStat.st_size) <= SIZE_MAX)
+  {
+    void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fileno(m_file), 0);
+    if (mapping != MAP_FAILED)
+    {
+      m_mapping = static_cast<unsigned char*>(mapping);
+      m_mappingSize = static_cast<uint64_t>(fileStat.st_size);
+    }
+    else
+      CLog::Log(LOGDEBUG, "CXBTFReader: unable to map %s, reading it instead", m_path.c_str());
+  }
+#endif
+
   return true;
 }
 
@@ -186,6 +213,9 @@ bool CXBTFReader::IsOpen() const
 
 void CXBTFReader::Close()
 {
+  // the mapping is kept until the reader is destroyed as the data of its
+  // frames may still be used by others
+  CSingleLock lock(m_fileSection);
   if (m_file != nullptr)
   {
     fclose(m_file);
@@ -208,8 +238,35 @@ time_t CXBTFReader::GetLastModificationTimestamp() const
   return fileStat.st_mtime;
 }
 
+void CXBTFReader::Unmap()
+{
+#ifdef TARGET_POSIX
+  if (m_mapping != nullptr)
+    munmap(m_mapping, static_cast<size_t>(m_mappingSize));
+#endif
+  m_mapping = nullptr;
+  m_mappingSize = 0;
+}
+
+const unsigned char* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
+{
+  if (m_mapping == nullptr || frame.GetOffset() > m_mappingSize ||
+      frame.GetPackedSize() > m_mappingSize - frame.GetOffset())
+    return nullptr;
+
+  return m_mapping + frame.GetOffset();
+}
+
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
 {
+  const unsigned char* data = GetFrameData(frame);
+  if (data != nullptr)
+  {
+    memcpy(buffer, data, static_cast<size_t>(frame.GetPackedSize()));
+    return true;
+  }
+
+  CSingleLock lock(m_fileSection);
   if (m_file == nullptr)
     return false;
 
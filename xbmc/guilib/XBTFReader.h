@@ -26,7 +26,16 @@
 #include <stdint.h>
 
 #include "XBTF.h"
+#include "threads/CriticalSection.h"
 
+/*!
+ \brief Reader of XBT texture bundles.
+
+ On POSIX platforms the whole bundle is mapped into memory once it's opened,
+ which allows reading frames from several threads at once and handing out the
+ data of frames without copying it. Elsewhere the frames are read from the
+ file, one at a time.
+ */
 class CXBTFReader : public CXBTFBase
 {
 public:
@@ -41,9 +50,23 @@ public:
 
   bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
 
+  /*!
+   \brief Get the data of a frame as it's stored in the bundle, without copying it.
+   The data is packed if the frame is. It stays valid for as long as the reader
+   exists, even after it's closed.
+   \param frame the frame to get the data of
+   \return the data of the frame, NULL if the bundle isn't mapped into memory
+   */
+  const unsigned char* GetFrameData(const CXBTFFrame& frame) const;
+
 private:
+  void Unmap();
+
   std::string m_path;
   FILE* m_file;
+  unsigned char* m_mapping;
+  uint64_t m_mappingSize;
+  mutable CCriticalSection m_fileSection; ///< serializes reads from m_file when it isn't mapped
 };
 
 typedef std::shared_ptr<CXBTFReader> CXBTFReaderPtr;
@@ -23,13 +23,23 @@
 
 namespace INFO
 {
+  std::atomic<unsigned int> InfoBool::m_evaluated(0);
+  std::atomic<unsigned int> InfoBool::m_skipped(0);
+
   InfoBool::InfoBool(const std::string &expression, int context)
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
+      m_dependencies(INFO_DEPENDS_OTHER),
       m_expression(expression),
       m_dirty(true)
   {
     StringUtils::ToLower(m_expression);
   }
+
+  void InfoBool::GetAndResetCounters(unsigned int &evaluated, unsigned int &skipped)
+  {
+    evaluated = m_evaluated.exchange(0);
+    skipped = m_skipped.exchange(0);
+  }
 }
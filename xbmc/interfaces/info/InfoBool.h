@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <memory>
 
@@ -27,6 +28,26 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief State sources an info bool can depend on.
+ An info bool is only marked dirty when one of the sources it depends on
+ has changed, see CGUIInfoManager::UpdateCache().
+ */
+enum InfoDependency
+{
+  INFO_DEPENDS_NONE     = 0,      ///< constant, never needs re-evaluation
+  INFO_DEPENDS_PLAYER   = 1 << 0, ///< player state (media, speed, time, seeking, ...)
+  INFO_DEPENDS_WINDOW   = 1 << 1, ///< active window, open dialogs, next/previous window, window properties
+  INFO_DEPENDS_FOCUS    = 1 << 2, ///< focused control
+  INFO_DEPENDS_LISTITEM = 1 << 3, ///< focused or offset list item of a container, container state
+  INFO_DEPENDS_TIME     = 1 << 4, ///< system time and date
+  INFO_DEPENDS_LIBRARY  = 1 << 5, ///< library content counters
+  INFO_DEPENDS_SKIN     = 1 << 6, ///< skin settings
+  INFO_DEPENDS_OTHER    = 1 << 7, ///< untracked state, re-evaluated every frame
+  INFO_DEPENDS_ALL      = (1 << 8) - 1
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -51,12 +72,18 @@ public:
   inline bool Get(const CGUIListItem *item = NULL)
   {
     if (item && m_listItemDependent)
+    {
       Update(item);
+      m_evaluated.fetch_add(1, std::memory_order_relaxed);
+    }
     else if (m_dirty)
     {
       Update(NULL);
       m_dirty = false;
+      m_evaluated.fetch_add(1, std::memory_order_relaxed);
     }
+    else
+      m_skipped.fetch_add(1, std::memory_order_relaxed);
     return m_value;
   }
 
@@ -72,12 +99,28 @@ public:
   virtual void Update(const CGUIListItem *item) {};
 
   const std::string &GetExpression() const { return m_expression; }
+  int GetContext() const { return m_context; }
   bool ListItemDependent() const { return m_listItemDependent; }
+  /*! \brief Get the state sources this info bool depends on
+   \return a combination of InfoDependency flags
+   */
+  unsigned int GetDependencies() const { return m_dependencies; }
+
+  /*! \brief Get and reset the number of evaluated and cached Get() calls
+   The counters are shared by all info bools and are only meant for statistics.
+   \param evaluated [out] number of calls that re-evaluated the condition
+   \param skipped [out] number of calls that returned the cached value
+   */
+  static void GetAndResetCounters(unsigned int &evaluated, unsigned int &skipped);
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_dependencies; ///< InfoDependency flags of the state this bool depends on
+
+  static std::atomic<unsigned int> m_evaluated; ///< number of Get() calls that updated the value
+  static std::atomic<unsigned int> m_skipped;   ///< number of Get() calls that used the cached value
 
 private:
   std::string  m_expression;   ///< original expression
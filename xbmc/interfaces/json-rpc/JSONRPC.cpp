@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "JSONRPC.h"
+#include "JSONRPCStatistics.h"
 #include "ServiceDescription.h"
 #include "addons/Addon.h"
 #include "addons/IAddon.h"
@@ -29,6 +30,9 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/JSONStreamParser.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -39,6 +43,120 @@ using namespace JSONRPC;
 
 bool CJSONRPC::m_initialized = false;
 
+namespace
+{
+
+bool IsLongRunningMethod(std::string methodName)
+{
+  StringUtils::ToLower(methodName);
+  return StringUtils::StartsWith(methodName, "videolibrary.") ||
+         StringUtils::StartsWith(methodName, "audiolibrary.") ||
+         StringUtils::StartsWith(methodName, "files.") ||
+         StringUtils::StartsWith(methodName, "pvr.") ||
+         StringUtils::StartsWith(methodName, "addons.") ||
+         StringUtils::StartsWith(methodName, "textures.");
+}
+
+// looks for long running methods in a request or batch without parsing all of it
+class CMethodNameScanner : public IJSONStreamHandler
+{
+public:
+  CMethodNameScanner()
+    : m_depth(0),
+      m_batch(false),
+      m_isMethod(false),
+      m_longRunning(false)
+  { }
+
+  bool IsLongRunning() const { return m_longRunning; }
+
+  virtual bool OnNull() override { return OnValue(); }
+  virtual bool OnBoolean(bool value) override { return OnValue(); }
+  virtual bool OnInteger(int64_t value) override { return OnValue(); }
+  virtual bool OnDouble(double value) override { return OnValue(); }
+
+  virtual bool OnString(const char *value, size_t length) override
+  {
+    if (m_isMethod && IsLongRunningMethod(std::string(value, length)))
+    {
+      // no need to look any further
+      m_longRunning = true;
+      return false;
+    }
+
+    return OnValue();
+  }
+
+  virtual bool OnObjectStart() override
+  {
+    m_depth++;
+    return OnValue();
+  }
+
+  virtual bool OnKey(const char *key, size_t length) override
+  {
+    m_isMethod = m_depth == (m_batch ? 2 : 1) && length == 6 && strncmp(key, "method", 6) == 0;
+    return true;
+  }
+
+  virtual bool OnObjectEnd() override
+  {
+    m_depth--;
+    return true;
+  }
+
+  virtual bool OnArrayStart() override
+  {
+    if (m_depth == 0)
+      m_batch = true;
+    m_depth++;
+    return OnValue();
+  }
+
+  virtual bool OnArrayEnd() override
+  {
+    m_depth--;
+    return true;
+  }
+
+private:
+  bool OnValue()
+  {
+    m_isMethod = false;
+    return true;
+  }
+
+  int m_depth;
+  bool m_batch;
+  bool m_isMethod;
+  bool m_longRunning;
+};
+
+// remembers whether any of a response has been passed on to the output
+class CPassedOnOutput : public IJSONStreamOutput
+{
+public:
+  explicit CPassedOnOutput(IJSONStreamOutput *output)
+    : m_output(output),
+      m_passedOn(false)
+  { }
+
+  bool IsPassedOn() const { return m_passedOn; }
+
+  virtual bool Write(const char *data, size_t length) override
+  {
+    m_passedOn = true;
+    return m_output->Write(data, length);
+  }
+
+private:
+  IJSONStreamOutput *m_output;
+  bool m_passedOn;
+};
+
+}
+
+
 void CJSONRPC::Initialize()
 {
   if (m_initialized)
@@ -233,9 +351,60 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const std::string &method, ITransportLayer *t
   return ACK;
 }
 
+JSONRPC_STATUS CJSONRPC::GetStatistics(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result)
+{
+  CJSONRPCStatistics::GetInstance().Serialize(result);
+  if (parameterObject["reset"].asBoolean())
+    CJSONRPCStatistics::GetInstance().Reset();
+
+  return OK;
+}
+
+bool CJSONRPC::IsLongRunning(const std::string &inputString)
+{
+  CMethodNameScanner scanner;
+  CJSONStreamParser::Parse(inputString, &scanner);
+  return scanner.IsLongRunning();
+}
+
 std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  CVariant outputroot;
+  if (!HandleRequest(inputString, transport, client, outputroot))
+    return "";
+
+  return CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact);
+}
+
+JSONRPC_STATUS CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, IJSONStreamOutput *output)
+{
+  CVariant outputroot;
+  if (!HandleRequest(inputString, transport, client, outputroot))
+    return ACK;
+
+  // the results are released while they are written, so the response never exists twice
+  CPassedOnOutput passedOn(output);
+  CJSONStreamWriter writer(g_advancedSettings.m_jsonOutputCompact, &passedOn);
+  if (writer.Value(std::move(outputroot)) && writer.Flush())
+    return OK;
+
+  CLog::Log(LOGERROR, "JSONRPC: Failed to write the response");
+  if (passedOn.IsPassedOn())
+    return InternalError;
+
+  // the client hasn't received anything yet, so it can still get an error
+  CVariant error;
+  BuildResponse(CVariant(), InternalError, CVariant(), error);
+  CJSONStreamWriter errorWriter(g_advancedSettings.m_jsonOutputCompact, output);
+  if (!errorWriter.Value(error) || !errorWriter.Flush())
+    return InternalError;
+
+  return OK;
+}
+
+bool CJSONRPC::HandleRequest(const std::string &inputString, ITransportLayer *transport, IClient *client, CVariant &outputroot)
+{
+  CVariant inputroot;
   bool hasResponse = false;
 
   if(g_advancedSettings.CanLogComponent(LOGJSONRPC))
@@ -259,7 +428,7 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
           CVariant response;
           if (HandleMethodCall(*itr, response, transport, client))
           {
-            outputroot.append(response);
+            outputroot.append(std::move(response));
             hasResponse = true;
           }
         }
@@ -275,8 +444,7 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
     hasResponse = true;
   }
 
-  std::string str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  return hasResponse;
 }
 
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
@@ -296,7 +464,15 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     CVariant params;
 
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName.c_str(), request["params"], transport, client, isNotification, method, params)) == OK)
+    {
+      CJSONRPCStatistics &statistics = CJSONRPCStatistics::GetInstance();
+      statistics.OnCallStarted(methodName);
+      unsigned int start = XbmcThreads::SystemClockMillis();
+
       errorCode = method(methodName, transport, client, params, result);
+
+      statistics.OnCallFinished(methodName, XbmcThreads::SystemClockMillis() - start, errorCode == OK || errorCode == ACK);
+    }
     else
       result = params;
   }
@@ -306,7 +482,7 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     errorCode = InvalidRequest;
   }
 
-  BuildResponse(request, errorCode, result, response);
+  BuildResponse(request, errorCode, std::move(result), response);
 
   return !isNotification;
 }
@@ -316,7 +492,7 @@ inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
   return inputroot.isObject() && inputroot.isMember("jsonrpc") && inputroot["jsonrpc"].isString() && inputroot["jsonrpc"] == CVariant("2.0") && inputroot.isMember("method") && inputroot["method"].isString() && (!inputroot.isMember("params") || inputroot["params"].isArray() || inputroot["params"].isObject());
 }
 
-inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response)
+inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant&& result, CVariant& response)
 {
   response["jsonrpc"] = "2.0";
   response["id"] = request.isObject() && request.isMember("id") ? request["id"] : CVariant();
@@ -324,7 +500,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
   switch (code)
   {
     case OK:
-      response["result"] = result;
+      response["result"] = std::move(result);
       break;
     case ACK:
       response["result"] = "OK";
@@ -337,7 +513,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
       response["error"]["code"] = InvalidParams;
       response["error"]["message"] = "Invalid params.";
       if (!result.isNull())
-        response["error"]["data"] = result;
+        response["error"]["data"] = std::move(result);
       break;
     case MethodNotFound:
       response["error"]["code"] = MethodNotFound;
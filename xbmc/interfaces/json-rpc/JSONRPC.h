@@ -28,6 +28,7 @@
 #include "JSONServiceDescription.h"
 
 class CVariant;
+class IJSONStreamOutput;
 
 namespace JSONRPC
 {
@@ -64,6 +65,32 @@ namespace JSONRPC
      */
     static std::string MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request and streams the response
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param output Receives the JSON-RPC response in chunks while it is written
+     \return OK if the response has been written, ACK if there is no response
+     because the request only contained notifications, InternalError if writing
+     failed after part of the response had been passed on to the output
+
+     If writing fails before anything has been passed on to the output, an
+     internal error response is written instead. After InternalError the output
+     holds an incomplete response and the connection should be closed.
+     */
+    static JSONRPC_STATUS MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, IJSONStreamOutput *output);
+
+    /*
+     \brief Handles an incoming JSON-RPC request without serializing the response
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param outputroot [out] JSON-RPC response
+     \return false if there is no response because the request only contained notifications
+     */
+    static bool HandleRequest(const std::string &inputString, ITransportLayer *transport, IClient *client, CVariant &outputroot);
+
     static JSONRPC_STATUS Introspect(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -71,13 +98,25 @@ namespace JSONRPC
     static JSONRPC_STATUS GetConfiguration(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS SetConfiguration(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS NotifyAll(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
+    static JSONRPC_STATUS GetStatistics(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
+
+    /*!
+     \brief Whether any of the methods called by a JSON-RPC request may take long
+     \param inputString received JSON-RPC request
+     \return true if the request calls a method that accesses the libraries,
+     the filesystem, the PVR backends or the add-on repositories
+
+     Requests that don't are answered quickly enough to be handled directly
+     by the transport layer they arrived on.
+     */
+    static bool IsLongRunning(const std::string &inputString);
   
   private:
     static void setup();
     static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
-    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
+    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant&& result, CVariant& response);
 
     static bool m_initialized;
   };
@@ -0,0 +1,127 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "JSONRPCStatistics.h"
+#include "threads/SingleLock.h"
+#include "utils/Variant.h"
+
+using namespace JSONRPC;
+
+const unsigned int CJSONRPCStatistics::HistogramSize;
+const unsigned int CJSONRPCStatistics::HistogramBounds[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 };
+
+CJSONRPCStatistics::MethodStatistics::MethodStatistics()
+  : inFlight(0),
+    calls(0),
+    errors(0),
+    totalTime(0),
+    maxTime(0)
+{
+  memset(histogram, 0, sizeof(histogram));
+}
+
+CJSONRPCStatistics& CJSONRPCStatistics::GetInstance()
+{
+  static CJSONRPCStatistics statistics;
+  return statistics;
+}
+
+void CJSONRPCStatistics::OnCallStarted(const std::string &method)
+{
+  CSingleLock lock(m_critSection);
+  m_methods[method].inFlight++;
+}
+
+void CJSONRPCStatistics::OnCallFinished(const std::string &method, unsigned int duration, bool success)
+{
+  CSingleLock lock(m_critSection);
+  MethodStatistics &statistics = m_methods[method];
+  if (statistics.inFlight > 0)
+    statistics.inFlight--;
+  statistics.calls++;
+  if (!success)
+    statistics.errors++;
+  statistics.totalTime += duration;
+  statistics.maxTime = std::max(statistics.maxTime, duration);
+  statistics.histogram[GetBucket(duration)]++;
+}
+
+bool CJSONRPCStatistics::GetStatistics(const std::string &method, MethodStatistics &statistics) const
+{
+  CSingleLock lock(m_critSection);
+  std::map<std::string, MethodStatistics>::const_iterator it = m_methods.find(method);
+  if (it == m_methods.end())
+    return false;
+
+  statistics = it->second;
+  return true;
+}
+
+void CJSONRPCStatistics::Serialize(CVariant &result) const
+{
+  result["buckets"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int bucket = 0; bucket < HistogramSize - 1; bucket++)
+    result["buckets"].push_back(HistogramBounds[bucket]);
+
+  result["methods"] = CVariant(CVariant::VariantTypeArray);
+
+  CSingleLock lock(m_critSection);
+  for (std::map<std::string, MethodStatistics>::const_iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+  {
+    const MethodStatistics &statistics = it->second;
+    CVariant method;
+    method["method"] = it->first;
+    method["inflight"] = statistics.inFlight;
+    method["calls"] = statistics.calls;
+    method["errors"] = statistics.errors;
+    method["totaltime"] = statistics.totalTime;
+    method["maxtime"] = statistics.maxTime;
+    method["histogram"] = CVariant(CVariant::VariantTypeArray);
+    for (unsigned int bucket = 0; bucket < HistogramSize; bucket++)
+      method["histogram"].push_back(statistics.histogram[bucket]);
+
+    result["methods"].push_back(method);
+  }
+}
+
+void CJSONRPCStatistics::Reset()
+{
+  CSingleLock lock(m_critSection);
+  for (std::map<std::string, MethodStatistics>::iterator it = m_methods.begin(); it != m_methods.end();)
+  {
+    if (it->second.inFlight == 0)
+      m_methods.erase(it++);
+    else
+    {
+      unsigned int inFlight = it->second.inFlight;
+      it->second = MethodStatistics();
+      it->second.inFlight = inFlight;
+      ++it;
+    }
+  }
+}
+
+unsigned int CJSONRPCStatistics::GetBucket(unsigned int duration)
+{
+  return std::lower_bound(HistogramBounds, HistogramBounds + HistogramSize - 1, duration) - HistogramBounds;
+}
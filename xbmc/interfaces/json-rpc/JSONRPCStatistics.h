@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <stdint.h>
+#include <string>
+
+#include "threads/CriticalSection.h"
+
+class CVariant;
+
+namespace JSONRPC
+{
+  /*!
+   \ingroup jsonrpc
+   \brief Per-method counters of the JSON-RPC calls
+
+   Keeps the number of calls being executed, the number of calls and errors
+   and a histogram of the execution times of every method that has been
+   called at least once.
+   */
+  class CJSONRPCStatistics
+  {
+  public:
+    /*! \brief Number of histogram buckets, the last one counts all calls above the largest bound */
+    static const unsigned int HistogramSize = 13;
+    /*! \brief Upper bounds (in ms, inclusive) of all but the last histogram bucket */
+    static const unsigned int HistogramBounds[HistogramSize - 1];
+
+    struct MethodStatistics
+    {
+      MethodStatistics();
+
+      unsigned int inFlight;                 ///< number of calls being executed
+      uint64_t calls;                        ///< number of finished calls
+      uint64_t errors;                       ///< number of finished calls that failed
+      uint64_t totalTime;                    ///< time spent in all finished calls (ms)
+      unsigned int maxTime;                  ///< longest time spent in a call (ms)
+      uint64_t histogram[HistogramSize];     ///< number of finished calls per bucket
+    };
+
+    static CJSONRPCStatistics& GetInstance();
+
+    /*!
+     \brief Record the start of a call
+     \param method lower case name of the method
+     */
+    void OnCallStarted(const std::string &method);
+
+    /*!
+     \brief Record the end of a call started with OnCallStarted()
+     \param method lower case name of the method
+     \param duration time spent in the call (ms)
+     \param success false if the call returned an error
+     */
+    void OnCallFinished(const std::string &method, unsigned int duration, bool success);
+
+    /*!
+     \brief Get the counters of a method
+     \return false if the method has not been called yet
+     */
+    bool GetStatistics(const std::string &method, MethodStatistics &statistics) const;
+
+    /*! \brief Serialize the counters of all methods as returned by JSONRPC.GetStatistics */
+    void Serialize(CVariant &result) const;
+
+    /*! \brief Clear the counters of all methods, calls being executed are still counted */
+    void Reset();
+
+    /*! \brief Get the histogram bucket of a duration (ms) */
+    static unsigned int GetBucket(unsigned int duration);
+
+  private:
+    CJSONRPCStatistics() { }
+    CJSONRPCStatistics(const CJSONRPCStatistics&);
+    CJSONRPCStatistics& operator=(const CJSONRPCStatistics&);
+
+    std::map<std::string, MethodStatistics> m_methods;
+    CCriticalSection m_critSection;
+  };
+}
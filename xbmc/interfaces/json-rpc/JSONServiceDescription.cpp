@@ -57,6 +57,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   { "JSONRPC.GetConfiguration",                     CJSONRPC::GetConfiguration },
   { "JSONRPC.SetConfiguration",                     CJSONRPC::SetConfiguration },
   { "JSONRPC.NotifyAll",                            CJSONRPC::NotifyAll },
+  { "JSONRPC.GetStatistics",                        CJSONRPC::GetStatistics },
 
 // Player
   { "Player.GetActivePlayers",                      CPlayerOperations::GetActivePlayers },
@@ -0,0 +1,110 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "interfaces/json-rpc/JSONRPCStatistics.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+using namespace JSONRPC;
+
+TEST(TestJSONRPCStatistics, GetBucket)
+{
+  EXPECT_EQ(0u, CJSONRPCStatistics::GetBucket(0));
+  EXPECT_EQ(0u, CJSONRPCStatistics::GetBucket(1));
+  EXPECT_EQ(1u, CJSONRPCStatistics::GetBucket(2));
+  EXPECT_EQ(2u, CJSONRPCStatistics::GetBucket(3));
+  EXPECT_EQ(9u, CJSONRPCStatistics::GetBucket(1000));
+  EXPECT_EQ(11u, CJSONRPCStatistics::GetBucket(5000));
+  EXPECT_EQ(12u, CJSONRPCStatistics::GetBucket(5001));
+}
+
+TEST(TestJSONRPCStatistics, Calls)
+{
+  CJSONRPCStatistics &statistics = CJSONRPCStatistics::GetInstance();
+  statistics.Reset();
+
+  CJSONRPCStatistics::MethodStatistics method;
+  EXPECT_FALSE(statistics.GetStatistics("test.calls", method));
+
+  statistics.OnCallStarted("test.calls");
+  statistics.OnCallStarted("test.calls");
+  ASSERT_TRUE(statistics.GetStatistics("test.calls", method));
+  EXPECT_EQ(2u, method.inFlight);
+  EXPECT_EQ(0u, method.calls);
+
+  statistics.OnCallFinished("test.calls", 3, true);
+  statistics.OnCallFinished("test.calls", 7000, false);
+  ASSERT_TRUE(statistics.GetStatistics("test.calls", method));
+  EXPECT_EQ(0u, method.inFlight);
+  EXPECT_EQ(2u, method.calls);
+  EXPECT_EQ(1u, method.errors);
+  EXPECT_EQ(7003u, method.totalTime);
+  EXPECT_EQ(7000u, method.maxTime);
+  EXPECT_EQ(1u, method.histogram[2]);
+  EXPECT_EQ(1u, method.histogram[CJSONRPCStatistics::HistogramSize - 1]);
+}
+
+TEST(TestJSONRPCStatistics, Reset)
+{
+  CJSONRPCStatistics &statistics = CJSONRPCStatistics::GetInstance();
+  statistics.OnCallStarted("test.idle");
+  statistics.OnCallFinished("test.idle", 1, true);
+  statistics.OnCallStarted("test.running");
+  statistics.OnCallStarted("test.running");
+  statistics.OnCallFinished("test.running", 1, true);
+  statistics.Reset();
+
+  // calls still being executed are kept
+  CJSONRPCStatistics::MethodStatistics method;
+  EXPECT_FALSE(statistics.GetStatistics("test.idle", method));
+  ASSERT_TRUE(statistics.GetStatistics("test.running", method));
+  EXPECT_EQ(1u, method.inFlight);
+  EXPECT_EQ(0u, method.calls);
+
+  statistics.OnCallFinished("test.running", 1, true);
+  statistics.Reset();
+}
+
+TEST(TestJSONRPCStatistics, Serialize)
+{
+  CJSONRPCStatistics &statistics = CJSONRPCStatistics::GetInstance();
+  statistics.Reset();
+  statistics.OnCallStarted("test.serialize");
+  statistics.OnCallFinished("test.serialize", 12, true);
+
+  CVariant result;
+  statistics.Serialize(result);
+  ASSERT_TRUE(result["buckets"].isArray());
+  EXPECT_EQ(CJSONRPCStatistics::HistogramSize - 1, result["buckets"].size());
+  EXPECT_EQ(5000u, result["buckets"][CJSONRPCStatistics::HistogramSize - 2].asUnsignedInteger());
+
+  ASSERT_TRUE(result["methods"].isArray());
+  ASSERT_EQ(1u, result["methods"].size());
+  const CVariant &method = result["methods"][0];
+  EXPECT_EQ("test.serialize", method["method"].asString());
+  EXPECT_EQ(0u, method["inflight"].asUnsignedInteger());
+  EXPECT_EQ(1u, method["calls"].asUnsignedInteger());
+  EXPECT_EQ(12u, method["maxtime"].asUnsignedInteger());
+  ASSERT_EQ(CJSONRPCStatistics::HistogramSize, method["histogram"].size());
+  EXPECT_EQ(1u, method["histogram"][4].asUnsignedInteger());
+
+  statistics.Reset();
+}
@@ -0,0 +1,89 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MusicTagReader.h"
+#include "MusicInfoTag.h"
+#include "MusicInfoTagLoaderFactory.h"
+#include "FileItem.h"
+
+#include <algorithm>
+
+using namespace MUSIC_INFO;
+
+CMusicTagReader::CMusicTagReader(unsigned int threads, const LoadFunction &load /* = LoadFunction() */)
+  : m_threads(std::max(1u, threads)),
+    m_load(load ? load : LoadFunction(LoadTag)),
+    m_items(NULL),
+    m_stop(NULL),
+    m_next(0)
+{
+}
+
+CMusicTagReader::~CMusicTagReader()
+{
+}
+
+bool CMusicTagReader::Load(const std::vector<CFileItemPtr> &items, const std::atomic<bool> *stop /* = NULL */)
+{
+  m_items = &items;
+  m_stop = stop;
+  m_next = 0;
+
+  std::vector<std::unique_ptr<CThread> > workers;
+  size_t threads = std::min<size_t>(m_threads, items.size());
+  for (size_t i = 1; i < threads; i++)
+  {
+    workers.push_back(std::unique_ptr<CThread>(new CThread(this, "MusicTagReader")));
+    workers.back()->Create();
+  }
+
+  Run();
+
+  // the workers return as soon as no items are left
+  for (std::vector<std::unique_ptr<CThread> >::iterator it = workers.begin(); it != workers.end(); ++it)
+    (*it)->StopThread(true);
+
+  m_items = NULL;
+  m_stop = NULL;
+  return !(stop && *stop);
+}
+
+void CMusicTagReader::Run()
+{
+  while (!(m_stop && *m_stop))
+  {
+    size_t index = m_next++;
+    if (index >= m_items->size())
+      break;
+
+    m_load(*(*m_items)[index]);
+  }
+}
+
+void CMusicTagReader::LoadTag(CFileItem &item)
+{
+  CMusicInfoTag& tag = *item.GetMusicInfoTag();
+  if (tag.Loaded())
+    return;
+
+  std::unique_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(item));
+  if (NULL != pLoader.get())
+    pLoader->Load(item.GetPath(), tag);
+}
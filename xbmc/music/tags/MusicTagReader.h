@@ -0,0 +1,79 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "threads/Thread.h"
+
+class CFileItem;
+typedef std::shared_ptr<CFileItem> CFileItemPtr;
+
+namespace MUSIC_INFO
+{
+  /*!
+   \brief Reads the tags of a batch of files on several threads at once.
+
+   Opening a file dominates tag reading on network shares, so the loaders
+   of up to the given number of files run at the same time. The calling
+   thread takes part in loading, the remaining threads only live as long
+   as a batch.
+   */
+  class CMusicTagReader : private IRunnable
+  {
+  public:
+    typedef std::function<void(CFileItem&)> LoadFunction;
+
+    /*!
+     \param threads the maximum number of files read at once, 1 reads them
+                    one after the other on the calling thread
+     \param load loads the tag of an item, defaults to LoadTag()
+     */
+    explicit CMusicTagReader(unsigned int threads, const LoadFunction &load = LoadFunction());
+    virtual ~CMusicTagReader();
+
+    /*!
+     \brief Load the tags of all items. Blocks until all are loaded.
+     \param items the items to load, every item is only touched by one thread
+     \param stop optional flag to stop loading early, items not started yet
+                 are left as they are
+     \return false if loading was stopped
+     */
+    bool Load(const std::vector<CFileItemPtr> &items, const std::atomic<bool> *stop = NULL);
+
+    unsigned int GetThreadCount() const { return m_threads; }
+
+    /*! \brief Load the tag of an item with the loader from CMusicInfoTagLoaderFactory */
+    static void LoadTag(CFileItem &item);
+
+  private:
+    virtual void Run() override;
+
+    unsigned int m_threads;
+    LoadFunction m_load;
+
+    const std::vector<CFileItemPtr> *m_items;
+    const std::atomic<bool> *m_stop;
+    std::atomic<size_t> m_next;
+  };
+}
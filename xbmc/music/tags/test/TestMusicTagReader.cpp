@@ -0,0 +1,170 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/tags/MusicTagReader.h"
+#include "music/tags/MusicInfoTag.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "FileItem.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace MUSIC_INFO;
+
+namespace
+{
+
+void AddFrame(std::string &tag, const char *id, const std::string &text)
+{
+  // ID3v2.3 text frame, ISO-8859-1 encoded
+  uint32_t size = text.size() + 1;
+  tag.append(id, 4);
+  tag.push_back((char)(size >> 24));
+  tag.push_back((char)(size >> 16));
+  tag.push_back((char)(size >> 8));
+  tag.push_back((char)size);
+  tag.append(2, '\0');
+  tag.push_back('\0');
+  tag.append(text);
+}
+
+std::string CreateMP3(const std::string &title, const std::string &artist, const std::string &album, int track)
+{
+  std::string frames;
+  AddFrame(frames, "TIT2", title);
+  AddFrame(frames, "TPE1", artist);
+  AddFrame(frames, "TALB", album);
+  AddFrame(frames, "TRCK", StringUtils::Format("%d", track));
+
+  std::string data("ID3\x03\x00\x00", 6);
+  uint32_t size = frames.size();
+  data.push_back((char)((size >> 21) & 0x7f));
+  data.push_back((char)((size >> 14) & 0x7f));
+  data.push_back((char)((size >> 7) & 0x7f));
+  data.push_back((char)(size & 0x7f));
+  data.append(frames);
+
+  // silent MPEG-1 layer III frames, 128 kbit/s at 44.1 kHz
+  for (int i = 0; i < 40; i++)
+  {
+    data.append("\xff\xfb\x90\x64", 4);
+    data.append(417 - 4, '\0');
+  }
+  return data;
+}
+
+void LoadWithLatency(CFileItem &item)
+{
+  // the time it takes to open a file on a network share before its tag is read
+  XbmcThreads::ThreadSleep(20);
+  CMusicTagReader::LoadTag(item);
+}
+
+}
+
+class TestMusicTagReader : public testing::Test
+{
+protected:
+  TestMusicTagReader()
+  {
+    m_path = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestMusicTagReader");
+    XFILE::CDirectory::Create(m_path);
+    for (int i = 0; i < 48; i++)
+    {
+      std::string file = URIUtils::AddFileToFolder(m_path, StringUtils::Format("%02d.mp3", i));
+      std::string data = CreateMP3(StringUtils::Format("Title %d", i), StringUtils::Format("Artist %d", i % 3),
+                                   StringUtils::Format("Album %d", i / 12), i % 12 + 1);
+      XFILE::CFile out;
+      if (out.OpenForWrite(file, true))
+        out.Write(data.c_str(), data.size());
+      m_files.push_back(file);
+    }
+  }
+
+  ~TestMusicTagReader()
+  {
+    for (std::vector<std::string>::const_iterator it = m_files.begin(); it != m_files.end(); ++it)
+      XFILE::CFile::Delete(*it);
+    XFILE::CDirectory::Remove(m_path);
+  }
+
+  std::vector<CFileItemPtr> GetItems() const
+  {
+    std::vector<CFileItemPtr> items;
+    for (std::vector<std::string>::const_iterator it = m_files.begin(); it != m_files.end(); ++it)
+      items.push_back(CFileItemPtr(new CFileItem(*it, false)));
+    return items;
+  }
+
+  std::string m_path;
+  std::vector<std::string> m_files;
+};
+
+TEST_F(TestMusicTagReader, Load)
+{
+  std::vector<CFileItemPtr> serial = GetItems();
+  std::vector<CFileItemPtr> parallel = GetItems();
+
+  EXPECT_TRUE(CMusicTagReader(1).Load(serial));
+  EXPECT_TRUE(CMusicTagReader(8).Load(parallel));
+
+  for (size_t i = 0; i < serial.size(); i++)
+  {
+    const CMusicInfoTag &expected = *serial[i]->GetMusicInfoTag();
+    const CMusicInfoTag &tag = *parallel[i]->GetMusicInfoTag();
+    ASSERT_TRUE(expected.Loaded());
+    ASSERT_TRUE(tag.Loaded());
+    EXPECT_EQ(StringUtils::Format("Title %d", (int)i), tag.GetTitle());
+    EXPECT_EQ(expected.GetTitle(), tag.GetTitle());
+    EXPECT_EQ(expected.GetArtistString(), tag.GetArtistString());
+    EXPECT_EQ(expected.GetAlbum(), tag.GetAlbum());
+    EXPECT_EQ(expected.GetTrackNumber(), tag.GetTrackNumber());
+  }
+}
+
+TEST_F(TestMusicTagReader, Stop)
+{
+  std::vector<CFileItemPtr> items = GetItems();
+  std::atomic<bool> stop(true);
+  EXPECT_FALSE(CMusicTagReader(4).Load(items, &stop));
+  for (size_t i = 0; i < items.size(); i++)
+    EXPECT_FALSE(items[i]->GetMusicInfoTag()->Loaded());
+}
+
+// reading the tags of a folder on a network share with 20 ms to open each
+// file, by one thread and by eight
+TEST_F(TestMusicTagReader, DISABLED_NetworkLatency1Thread)
+{
+  std::vector<CFileItemPtr> items = GetItems();
+  EXPECT_TRUE(CMusicTagReader(1, LoadWithLatency).Load(items));
+}
+
+TEST_F(TestMusicTagReader, DISABLED_NetworkLatency8Threads)
+{
+  std::vector<CFileItemPtr> items = GetItems();
+  EXPECT_TRUE(CMusicTagReader(8, LoadWithLatency).Load(items));
+}
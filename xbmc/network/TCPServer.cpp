@@ -572,8 +572,17 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        // the response is sent while it is written instead of all at once
+        CResponseOutput output(this);
+        if (CJSONRPC::MethodCall(m_buffer, host, this, &output) == InternalError)
+        {
+          // part of the response has already been sent, closing the
+          // connection is the only way to tell the client it's incomplete
+          CLog::Log(LOGERROR, "JSONRPC Server: Closing the connection after an incomplete response");
+          Disconnect();
+          return;
+        }
+        output.Finish();
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -581,6 +590,31 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
   }
 }
 
+bool CTCPServer::CTCPClient::CResponseOutput::Write(const char *data, size_t length)
+{
+  if (m_pending)
+  {
+    m_client->SendChunk(m_chunk.c_str(), m_chunk.size(), m_first, false);
+    m_first = false;
+  }
+
+  m_chunk.assign(data, length);
+  m_pending = true;
+  return true;
+}
+
+void CTCPServer::CTCPClient::CResponseOutput::Finish()
+{
+  // a request without response still gets an empty one
+  if (!m_pending)
+    m_chunk.clear();
+
+  m_client->SendChunk(m_chunk.c_str(), m_chunk.size(), m_first, true);
+  m_chunk.clear();
+  m_first = true;
+  m_pending = false;
+}
+
 void CTCPServer::CTCPClient::Disconnect()
 {
   if (m_socket > 0)
@@ -648,6 +682,23 @@ void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
     CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
 }
 
+void CTCPServer::CWebSocketClient::SendChunk(const char *data, unsigned int size, bool first, bool final)
+{
+  // a response in a single chunk is sent as a single frame, anything else as a fragmented message
+  if (first && final)
+  {
+    Send(data, size);
+    return;
+  }
+
+  CWebSocketFrame *frame = m_websocket->SendFragment(first ? WebSocketTextFrame : WebSocketContinuationFrame, data, size, final);
+  if (frame == NULL)
+    return;
+
+  CTCPClient::Send(frame->GetFrameData(), (unsigned int)frame->GetFrameLength());
+  delete frame;
+}
+
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
 {
   bool send;
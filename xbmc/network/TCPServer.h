@@ -28,6 +28,7 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/JSONStreamWriter.h"
 #include "websocket/WebSocket.h"
 
 class CVariant;
@@ -74,7 +75,7 @@ namespace JSONRPC
       virtual void Disconnect();
 
       virtual bool IsNew() const { return m_new; }
-      virtual bool Closing() const { return false; }
+      virtual bool Closing() const { return m_socket == INVALID_SOCKET; }
 
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
@@ -83,6 +84,31 @@ namespace JSONRPC
 
     protected:
       void Copy(const CTCPClient& client);
+
+      /*!
+       \brief Sends a chunk of a response, a response may consist of any number of chunks
+       \param first whether this is the first chunk of the response
+       \param final whether this is the last chunk of the response
+       */
+      virtual void SendChunk(const char *data, unsigned int size, bool first, bool final) { Send(data, size); }
+
+      // passes the chunks of a streamed response on to SendChunk(), holding
+      // back the latest one until it is known whether it's the last one
+      class CResponseOutput : public IJSONStreamOutput
+      {
+      public:
+        explicit CResponseOutput(CTCPClient *client) : m_client(client), m_first(true), m_pending(false) { }
+
+        bool Write(const char *data, size_t length) override;
+        void Finish();
+
+      private:
+        CTCPClient *m_client;
+        std::string m_chunk;
+        bool m_first;
+        bool m_pending;
+      };
+
     private:
       bool m_new;
       int m_announcementflags;
@@ -107,6 +133,9 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_websocket == NULL; }
       virtual bool Closing() const { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
 
+    protected:
+      virtual void SendChunk(const char *data, unsigned int size, bool first, bool final);
+
     private:
       CWebSocket *m_websocket;
     };
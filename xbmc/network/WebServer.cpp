@@ -31,10 +31,13 @@
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
@@ -43,6 +46,7 @@
 #include "URL.h"
 #include "Util.h"
 #include "utils/Base64.h"
+#include "utils/Job.h"
 #include "utils/log.h"
 #include "utils/Mime.h"
 #include "utils/StringUtils.h"
@@ -86,6 +90,7 @@ CWebServer::CWebServer()
     m_running(false),
     m_needcredentials(false),
     m_thread_stacksize(0),
+    m_threadPoolSize(0),
     m_Credentials64Encoded("eGJtYzp4Ym1j") // xbmc:xbmc
 {
 #if defined(TARGET_DARWIN)
@@ -116,6 +121,62 @@ static MHD_Response* create_response(size_t size, void* data, int free, int copy
 #endif
 }
 
+// returns the path of a file on a local disk, empty for any other file
+static std::string get_local_path(const std::string &filePath)
+{
+  std::string path = CSpecialProtocol::TranslatePath(filePath);
+  if (!CURL(path).GetProtocol().empty())
+    return "";
+
+  return path;
+}
+
+static MHD_Response* create_fd_response(const std::string &localPath, uint64_t offset, uint64_t length)
+{
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00094400)
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  // libmicrohttpd sends the data with sendfile() where possible and closes the descriptor with the response
+  MHD_Response *response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == nullptr)
+    close(fd);
+  return response;
+#else
+  return nullptr;
+#endif
+}
+
+#if (MHD_VERSION >= 0x00094400)
+// handles a long request on the executor and resumes its suspended connection afterwards
+class CWebServerRequestJob : public CJob
+{
+public:
+  CWebServerRequestJob(struct MHD_Connection *connection, const std::shared_ptr<IHTTPRequestHandler>& handler, int *handlerResult)
+    : m_connection(connection),
+      m_handler(handler),
+      m_handlerResult(handlerResult)
+  { }
+
+  virtual bool DoWork()
+  {
+    *m_handlerResult = m_handler->HandleRequest();
+
+    // the connection handler holding the result may be gone as soon as the connection is resumed
+    MHD_resume_connection(m_connection);
+    return true;
+  }
+
+  virtual const char *GetType() const { return "webserverrequest"; }
+
+private:
+  struct MHD_Connection *m_connection;
+  std::shared_ptr<IHTTPRequestHandler> m_handler;
+  int *m_handlerResult;
+};
+#endif
+
 int CWebServer::AskForAuthentication(struct MHD_Connection *connection) const
 {
   struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
@@ -375,6 +436,10 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
     // again we need to take special care of the POST data
     if (request.method == POST)
     {
+      // the request has been handled by the executor and the connection was resumed
+      if (conHandler->dispatched)
+        return HandleRequestResult(conHandler->requestHandler, conHandler->handlerResult);
+
       if (conHandler->requestHandler == nullptr)
       {
         CLog::Log(LOGERROR, "CWebServer[%hu]: cannot handle partial HTTP POST for %s request because there is no valid request handler available", m_port, request.pathUrl.c_str());
@@ -422,6 +487,18 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
         if (conHandler->errorStatus != MHD_HTTP_OK)
           return SendErrorResponse(connection, conHandler->errorStatus, request.method);
 
+        // don't hold up the other connections handled by the same thread
+        if (m_threadPoolSize > 0 && conHandler->requestHandler->IsLongRunning())
+        {
+          DispatchRequest(connection, conHandler.get());
+
+          // the response is created in the next call to AnswerToConnection once the connection is resumed
+          // as ownership of the connection handler is passed to libmicrohttpd we must not destroy it
+          *con_cls = conHandler.release();
+
+          return MHD_YES;
+        }
+
         return HandleRequest(conHandler->requestHandler);
       }
     }
@@ -467,12 +544,20 @@ int CWebServer::HandlePostField(void *cls, enum MHD_ValueKind kind, const char *
 }
 
 int CWebServer::HandleRequest(const std::shared_ptr<IHTTPRequestHandler>& handler)
+{
+  if (handler == nullptr)
+    return MHD_NO;
+
+  return HandleRequestResult(handler, handler->HandleRequest());
+}
+
+int CWebServer::HandleRequestResult(const std::shared_ptr<IHTTPRequestHandler>& handler, int handlerResult)
 {
   if (handler == nullptr)
     return MHD_NO;
 
   HTTPRequest request = handler->GetRequest();
-  int ret = handler->HandleRequest();
+  int ret = handlerResult;
   if (ret == MHD_NO)
   {
     CLog::Log(LOGERROR, "CWebServer[%hu]: failed to handle HTTP request for %s", m_port, request.pathUrl.c_str());
@@ -502,6 +587,10 @@ int CWebServer::HandleRequest(const std::shared_ptr<IHTTPRequestHandler>& handle
       ret = CreateMemoryDownloadResponse(handler, response);
       break;
 
+    case HTTPStreamDownload:
+      ret = CreateStreamDownloadResponse(handler, response);
+      break;
+
     case HTTPError:
       ret = CreateErrorResponse(request.connection, responseDetails.status, request.method, response);
       break;
@@ -520,6 +609,17 @@ int CWebServer::HandleRequest(const std::shared_ptr<IHTTPRequestHandler>& handle
   return FinalizeRequest(handler, responseDetails.status, response);
 }
 
+void CWebServer::DispatchRequest(struct MHD_Connection *connection, ConnectionHandler* connectionHandler)
+{
+#if (MHD_VERSION >= 0x00094400)
+  connectionHandler->dispatched = true;
+
+  // the connection must be suspended before the job may resume it
+  MHD_suspend_connection(connection);
+  m_executor.AddJob(new CWebServerRequestJob(connection, connectionHandler->requestHandler, &connectionHandler->handlerResult));
+#endif
+}
+
 int CWebServer::FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& handler, int responseStatus, struct MHD_Response *response)
 {
   if (handler == nullptr || response == nullptr)
@@ -578,7 +678,7 @@ int CWebServer::FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& hand
     handler->AddResponseHeader(MHD_HTTP_HEADER_ACCEPT_RANGES, "none");
 
   // add MHD_HTTP_HEADER_CONTENT_LENGTH
-  if (responseDetails.totalLength > 0)
+  if (responseDetails.totalLength > 0 && responseDetails.totalLength != MHD_SIZE_UNKNOWN)
     handler->AddResponseHeader(MHD_HTTP_HEADER_CONTENT_LENGTH, StringUtils::Format("%" PRIu64, responseDetails.totalLength));
 
   // add all headers set by the request handler
@@ -764,8 +864,20 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
 
   std::shared_ptr<XFILE::CFile> file = std::make_shared<XFILE::CFile>();
   std::string filePath = handler->GetResponseFile();
+  std::string localPath = get_local_path(filePath);
+
+  // files that aren't on a local disk are read in large blocks, optionally by the file cache ahead of the client
+  unsigned int flags = XFILE::READ_NO_CACHE;
+  if (localPath.empty() && request.method != HEAD)
+  {
+    flags = XFILE::READ_CHUNKED;
+    if (!g_advancedSettings.m_webserverReadAhead)
+      flags |= XFILE::READ_NO_CACHE;
+    else if (URIUtils::IsSmb(filePath) || URIUtils::IsNfs(filePath) || URIUtils::IsFTP(filePath) || URIUtils::IsDAV(filePath))
+      flags |= XFILE::READ_CACHED;
+  }
 
-  if (!file->Open(filePath, XFILE::READ_NO_CACHE))
+  if (!file->Open(filePath, flags))
   {
     CLog::Log(LOGERROR, "CWebServer[%hu]: Failed to open %s", m_port, filePath.c_str());
     return SendErrorResponse(request.connection, MHD_HTTP_NOT_FOUND, request.method);
@@ -850,18 +962,26 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
+    // a local file with a single range is sent straight from its file descriptor
+    response = nullptr;
+    if (!localPath.empty() && context->rangeCountTotal == 1 && totalLength > 0)
+      response = create_fd_response(localPath, context->writePosition, totalLength);
+
     if (response == nullptr)
     {
-      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      // create the response object
+      response = MHD_create_response_from_callback(totalLength, g_advancedSettings.m_webserverBlockSize,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -886,6 +1006,43 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
   return MHD_YES;
 }
 
+int CWebServer::CreateStreamDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response) const
+{
+  if (handler == nullptr)
+    return MHD_NO;
+
+  const HTTPRequest &request = handler->GetRequest();
+  const HTTPResponseDetails &responseDetails = handler->GetResponseDetails();
+
+  if (request.method != HEAD)
+  {
+    // the response keeps the handler alive until all of its data has been read
+    std::unique_ptr<std::shared_ptr<IHTTPRequestHandler>> context(new std::shared_ptr<IHTTPRequestHandler>(handler));
+    response = MHD_create_response_from_callback(responseDetails.totalLength, g_advancedSettings.m_webserverBlockSize,
+                                                  &CWebServer::StreamReaderCallback,
+                                                  context.get(),
+                                                  &CWebServer::StreamReaderFreeCallback);
+    if (response == nullptr)
+    {
+      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled by its handler", m_port, request.pathUrl.c_str());
+      return MHD_NO;
+    }
+
+    context.release(); // ownership was passed to mhd
+  }
+  else
+  {
+    response = create_response(0, nullptr, MHD_NO, MHD_NO);
+    if (response == nullptr)
+    {
+      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP HEAD response for %s", m_port, request.pathUrl.c_str());
+      return MHD_NO;
+    }
+  }
+
+  return MHD_YES;
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const
 {
   size_t payloadSize = 0;
@@ -1078,6 +1235,42 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
   return written;
 }
 
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::StreamReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  std::shared_ptr<IHTTPRequestHandler> *handler = static_cast<std::shared_ptr<IHTTPRequestHandler>*>(cls);
+  if (handler == nullptr || *handler == nullptr || max <= 0)
+    return -1;
+
+  ssize_t read = (*handler)->ReadResponseData(buf, static_cast<size_t>(max));
+  if (read < 0)
+  {
+    // let the client know the response is incomplete
+#if defined(MHD_CONTENT_READER_END_WITH_ERROR)
+    return MHD_CONTENT_READER_END_WITH_ERROR;
+#else
+    return -1;
+#endif
+  }
+  if (read == 0)
+    return -1;
+
+  if (g_advancedSettings.CanLogComponent(LOGWEBSERVER))
+    CLog::Log(LOGDEBUG, "CWebServer [OUT] streamed %zd bytes from %" PRIu64, read, static_cast<uint64_t>(pos));
+
+  return read;
+}
+
+void CWebServer::StreamReaderFreeCallback(void *cls)
+{
+  delete static_cast<std::shared_ptr<IHTTPRequestHandler>*>(cls);
+}
+
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
   HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
@@ -1119,22 +1312,38 @@ static void logFromMHD(void* unused, const char* fmt, va_list ap)
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
   unsigned int timeout = 60 * 60 * 24;
+  unsigned int threadPoolSize = 0;
 
 #if MHD_VERSION >= 0x00040500
   MHD_set_panic_func(&panicHandlerForMHD, nullptr);
 #endif
 
-  return MHD_start_daemon(flags |
 #if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          // use main thread for each connection, can only handle one request at a
-                          // time [unless you set the thread pool size]
-                          MHD_USE_SELECT_INTERNALLY
+  // use main thread for each connection, can only handle one request at a
+  // time [unless you set the thread pool size]
+  flags |= MHD_USE_SELECT_INTERNALLY;
+  threadPoolSize = 4;
 #else
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
+#if (MHD_VERSION >= 0x00094400)
+  if (m_threadPoolSize > 0)
+  {
+    // a fixed number of threads waiting for events on all connections, long
+    // requests are moved to the executor by suspending their connection
+    flags |= MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME;
+#if defined(TARGET_LINUX)
+    flags |= MHD_USE_EPOLL_LINUX_ONLY;
 #endif
+    threadPoolSize = m_threadPoolSize;
+  }
+  else
+#endif
+  // one thread per connection
+  // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+  // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+  flags |= MHD_USE_THREAD_PER_CONNECTION;
+#endif
+
+  return MHD_start_daemon(flags
 #if (MHD_VERSION >= 0x00040001)
                           | MHD_USE_DEBUG /* Print MHD error messages to log */
 #endif 
@@ -1145,8 +1354,8 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           &CWebServer::AnswerToConnection,
                           this,
 
-#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
+#if (MHD_VERSION >= 0x00040002)
+                          MHD_OPTION_THREAD_POOL_SIZE, threadPoolSize,
 #endif
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
@@ -1163,6 +1372,12 @@ bool CWebServer::Start(uint16_t port, const std::string &username, const std::st
   SetCredentials(username, password);
   if (!m_running)
   {
+#if (MHD_VERSION >= 0x00094400)
+    m_threadPoolSize = g_advancedSettings.m_webserverThreads;
+    if (m_threadPoolSize > 0)
+      m_executor.Start(m_threadPoolSize);
+#endif
+
     int v6testSock;
     if ((v6testSock = socket(AF_INET6, SOCK_STREAM, 0)) >= 0)
     {
@@ -1176,10 +1391,16 @@ bool CWebServer::Start(uint16_t port, const std::string &username, const std::st
     if (m_running)
     {
       m_port = port;
-      CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started", m_port);
+      if (m_threadPoolSize > 0)
+        CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started with %u threads", m_port, m_threadPoolSize);
+      else
+        CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started", m_port);
     }
     else
+    {
+      m_executor.Stop();
       CLog::Log(LOGERROR, "CWebServer[%hu]: Failed to start", port);
+    }
   }
 
   return m_running;
@@ -1190,6 +1411,10 @@ bool CWebServer::Stop()
   if (!m_running)
     return true;
 
+  // libmicrohttpd can't be stopped with suspended connections so let the executor resume them,
+  // requests dispatched from now on are handled right away
+  m_executor.Stop();
+
   if (m_daemon_ip6 != nullptr)
     MHD_stop_daemon(m_daemon_ip6);
 
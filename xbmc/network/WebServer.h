@@ -25,6 +25,7 @@
 #include <memory>
 #include <vector>
 
+#include "network/WebServerExecutor.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "threads/CriticalSection.h"
 
@@ -57,6 +58,8 @@ protected:
     std::shared_ptr<IHTTPRequestHandler> requestHandler;
     struct MHD_PostProcessor *postprocessor;
     int errorStatus;
+    bool dispatched;
+    int handlerResult;
 
     ConnectionHandler(const std::string& uri)
       : fullUri(uri)
@@ -64,6 +67,8 @@ protected:
       , requestHandler(nullptr)
       , postprocessor(nullptr)
       , errorStatus(MHD_HTTP_OK)
+      , dispatched(false)
+      , handlerResult(MHD_NO)
     { }
   } ConnectionHandler;
 
@@ -72,11 +77,14 @@ protected:
   virtual int HandlePartialRequest(struct MHD_Connection *connection, ConnectionHandler* connectionHandler, HTTPRequest request,
                                    const char *upload_data, size_t *upload_data_size, void **con_cls);
   virtual int HandleRequest(const std::shared_ptr<IHTTPRequestHandler>& handler);
+  virtual int HandleRequestResult(const std::shared_ptr<IHTTPRequestHandler>& handler, int handlerResult);
   virtual int FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& handler, int responseStatus, struct MHD_Response *response);
 
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
 
+  void DispatchRequest(struct MHD_Connection *connection, ConnectionHandler* connectionHandler);
+
   int AskForAuthentication(struct MHD_Connection *connection) const;
   bool IsAuthenticated(struct MHD_Connection *connection) const;
 
@@ -85,6 +93,7 @@ private:
 
   int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response) const;
   int CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response) const;
+  int CreateStreamDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response) const;
   int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const;
   int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response) const;
 
@@ -106,6 +115,15 @@ private:
 #endif
   static void ContentReaderFreeCallback(void *cls);
 
+#if (MHD_VERSION >= 0x00090200)
+  static ssize_t StreamReaderCallback (void *cls, uint64_t pos, char *buf, size_t max);
+#elif (MHD_VERSION >= 0x00040001)
+  static int StreamReaderCallback (void *cls, uint64_t pos, char *buf, int max);
+#else
+  static int StreamReaderCallback (void *cls, size_t pos, char *buf, int max);
+#endif
+  static void StreamReaderFreeCallback(void *cls);
+
 #if (MHD_VERSION >= 0x00040001)
   static int AnswerToConnection (void *cls, struct MHD_Connection *connection,
                         const char *url, const char *method,
@@ -132,6 +150,8 @@ private:
   bool m_running;
   bool m_needcredentials;
   size_t m_thread_stacksize;
+  unsigned int m_threadPoolSize;
+  CWebServerExecutor m_executor;
   std::string m_Credentials64Encoded;
   CCriticalSection m_critSection;
   std::vector<IHTTPRequestHandler *> m_requestHandlers;
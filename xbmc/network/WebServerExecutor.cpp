@@ -0,0 +1,133 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "WebServerExecutor.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/Job.h"
+
+class CWebServerExecutorThread : public CThread
+{
+public:
+  CWebServerExecutorThread(CWebServerExecutor &executor)
+    : CThread("WebServerExecutor"),
+      m_executor(executor)
+  { }
+
+protected:
+  virtual void Process()
+  {
+    CJob *job;
+    while ((job = m_executor.GetNextJob()) != NULL)
+    {
+      job->DoWork();
+      delete job;
+      m_executor.OnJobDone();
+    }
+  }
+
+private:
+  CWebServerExecutor &m_executor;
+};
+
+CWebServerExecutor::CWebServerExecutor()
+  : m_running(0),
+    m_stopping(false)
+{ }
+
+CWebServerExecutor::~CWebServerExecutor()
+{
+  Stop();
+}
+
+void CWebServerExecutor::Start(unsigned int threads)
+{
+  CSingleLock lock(m_section);
+  if (!m_threads.empty())
+    return;
+
+  m_stopping = false;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    CWebServerExecutorThread *thread = new CWebServerExecutorThread(*this);
+    thread->Create();
+    m_threads.push_back(thread);
+  }
+}
+
+void CWebServerExecutor::Stop()
+{
+  std::vector<CWebServerExecutorThread*> threads;
+  {
+    CSingleLock lock(m_section);
+    m_stopping = true;
+    m_jobAdded.notifyAll();
+    threads.swap(m_threads);
+  }
+
+  // the threads run the jobs that are left before they exit
+  for (std::vector<CWebServerExecutorThread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+}
+
+void CWebServerExecutor::AddJob(CJob *job)
+{
+  CSingleLock lock(m_section);
+  if (m_threads.empty() || m_stopping)
+  {
+    lock.Leave();
+    job->DoWork();
+    delete job;
+    return;
+  }
+
+  m_jobs.push_back(job);
+  m_jobAdded.notify();
+}
+
+unsigned int CWebServerExecutor::GetPendingJobs() const
+{
+  CSingleLock lock(m_section);
+  return m_jobs.size() + m_running;
+}
+
+CJob *CWebServerExecutor::GetNextJob()
+{
+  CSingleLock lock(m_section);
+  while (m_jobs.empty() && !m_stopping)
+    m_jobAdded.wait(lock);
+
+  if (m_jobs.empty())
+    return NULL;
+
+  CJob *job = m_jobs.front();
+  m_jobs.pop_front();
+  m_running++;
+  return job;
+}
+
+void CWebServerExecutor::OnJobDone()
+{
+  CSingleLock lock(m_section);
+  m_running--;
+}
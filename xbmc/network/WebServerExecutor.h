@@ -0,0 +1,84 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+
+class CJob;
+class CWebServerExecutorThread;
+
+/*!
+ \brief Threads of the web server running long requests.
+
+ Unlike the job manager's workers, whose number is capped per priority and
+ which are shared with the rest of the application, these only run the
+ requests of the web server, as many at once as there are threads.
+ */
+class CWebServerExecutor
+{
+public:
+  CWebServerExecutor();
+  ~CWebServerExecutor();
+
+  /*!
+   \brief Start the threads
+   \param threads how many requests may run at once
+   */
+  void Start(unsigned int threads);
+
+  /*!
+   \brief Run all jobs added so far and stop the threads once they're done
+   */
+  void Stop();
+
+  /*!
+   \brief Run a job on one of the threads, or right away on the calling
+   thread if the executor isn't started or is stopping
+   \param job the job to run, deleted once done
+   */
+  void AddJob(CJob *job);
+
+  /*! \brief Number of jobs waiting or running */
+  unsigned int GetPendingJobs() const;
+
+private:
+  friend class CWebServerExecutorThread;
+
+  /*!
+   \brief Wait for the next job, for the threads
+   \return the job, or NULL once stopped and no job is left
+   */
+  CJob *GetNextJob();
+  void OnJobDone();
+
+  CWebServerExecutor(const CWebServerExecutor&);
+  CWebServerExecutor& operator=(const CWebServerExecutor&);
+
+  std::vector<CWebServerExecutorThread*> m_threads;
+  std::deque<CJob*> m_jobs;
+  unsigned int m_running;
+  bool m_stopping;
+  mutable CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_jobAdded;
+};
@@ -26,10 +26,13 @@
 #include "interfaces/json-rpc/JSONUtils.h"
 #include "network/WebServer.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
-#include "utils/JSONVariantWriter.h"
+#include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+#include <string.h>
+
 #define MAX_HTTP_POST_SIZE 65536
 
 bool CHTTPJsonRpcHandler::CanHandleRequest(const HTTPRequest &request)
@@ -82,19 +85,26 @@ int CHTTPJsonRpcHandler::HandleRequest()
       jsonpCallback = argument->second;
   }
 
+  CVariant result;
+  bool hasResult = true;
+  bool compact = g_advancedSettings.m_jsonOutputCompact;
   if (isRequest)
   {
-    m_responseData = JSONRPC::CJSONRPC::MethodCall(m_requestData, &m_transportLayer, &client);
-
     if (!jsonpCallback.empty())
-      m_responseData = jsonpCallback + "(" + m_responseData + ");";
+    {
+      m_responseData.Write(jsonpCallback.c_str(), jsonpCallback.size());
+      m_responseData.Write("(", 1);
+      m_responseSuffix = ");";
+    }
+
+    // a request with only notifications has an empty response
+    hasResult = JSONRPC::CJSONRPC::HandleRequest(m_requestData, &m_transportLayer, &client, result);
   }
   else if (jsonpCallback.empty())
   {
     // get the whole output of JSONRPC.Introspect
-    CVariant result;
     JSONRPC::CJSONServiceDescription::Print(result, &m_transportLayer, &client);
-    m_responseData = CJSONVariantWriter::Write(result, false);
+    compact = false;
   }
   else
   {
@@ -106,22 +116,69 @@ int CHTTPJsonRpcHandler::HandleRequest()
 
   m_requestData.clear();
 
-  m_responseRange.SetData(m_responseData.c_str(), m_responseData.size());
+  // the response is written as fast as MHD sends it, only the first block is
+  // written here so that a failure can still be answered with an error
+  m_responseWriter.reset(new CJSONStreamWriter(compact, &m_responseData, g_advancedSettings.m_webserverBlockSize));
+  if (hasResult)
+    m_responseValue.reset(new CJSONStreamValue(std::move(result)));
+  if (!WriteResponseData(g_advancedSettings.m_webserverBlockSize))
+  {
+    CLog::Log(LOGERROR, "JSONRPC: Failed to write the response");
+    m_response.type = HTTPError;
+    m_response.status = MHD_HTTP_INTERNAL_SERVER_ERROR;
+
+    return MHD_YES;
+  }
 
-  m_response.type = HTTPMemoryDownloadNoFreeCopy;
+  m_response.type = HTTPStreamDownload;
   m_response.status = MHD_HTTP_OK;
   m_response.contentType = "application/json";
-  m_response.totalLength = m_responseData.size();
+  // responses that don't fit into the first block are sent chunked
+  m_response.totalLength = m_responseFinished ? m_responseData.GetLength() : MHD_SIZE_UNKNOWN;
 
   return MHD_YES;
 }
 
-HttpResponseRanges CHTTPJsonRpcHandler::GetResponseData() const
+bool CHTTPJsonRpcHandler::IsLongRunning() const
 {
-  HttpResponseRanges ranges;
-  ranges.push_back(m_responseRange);
+  return m_request.method == POST && JSONRPC::CJSONRPC::IsLongRunning(m_requestData);
+}
+
+ssize_t CHTTPJsonRpcHandler::ReadResponseData(char *buffer, size_t size)
+{
+  if (!WriteResponseData(size))
+  {
+    // the status has already been sent, the client can only tell the
+    // response is incomplete by the connection being closed
+    CLog::Log(LOGERROR, "JSONRPC: Failed to write the response, aborting it");
+    return -1;
+  }
 
-  return ranges;
+  return m_responseData.Read(buffer, size);
+}
+
+bool CHTTPJsonRpcHandler::WriteResponseData(size_t size)
+{
+  while (!m_responseFinished && m_responseData.GetAvailable() < size)
+  {
+    if (m_responseValue && !m_responseValue->IsFinished())
+    {
+      if (!m_responseValue->WriteNext(*m_responseWriter))
+        return false;
+    }
+    else
+    {
+      if (!m_responseWriter->Flush())
+        return false;
+      m_responseData.Write(m_responseSuffix.c_str(), m_responseSuffix.size());
+      m_responseFinished = true;
+
+      m_responseValue.reset();
+      m_responseWriter.reset();
+    }
+  }
+
+  return true;
 }
 
 #if (MHD_VERSION >= 0x00040001)
@@ -141,6 +198,30 @@ bool CHTTPJsonRpcHandler::appendPostData(const char *data, unsigned int size)
   return true;
 }
 
+bool CHTTPJsonRpcHandler::CResponseBuffer::Write(const char *data, size_t length)
+{
+  // drop what has been sent before the buffer grows
+  if (m_offset > 0 && m_data.size() + length > m_data.capacity())
+  {
+    m_data.erase(0, m_offset);
+    m_offset = 0;
+  }
+
+  m_data.append(data, length);
+  m_length += length;
+
+  return true;
+}
+
+size_t CHTTPJsonRpcHandler::CResponseBuffer::Read(char *buffer, size_t size)
+{
+  size_t read = std::min(GetAvailable(), size);
+  memcpy(buffer, m_data.c_str() + m_offset, read);
+  m_offset += read;
+
+  return read;
+}
+
 bool CHTTPJsonRpcHandler::CHTTPTransportLayer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
 {
   if (!XFILE::CFile::Exists(path))
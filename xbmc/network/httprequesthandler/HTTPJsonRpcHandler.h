@@ -19,16 +19,18 @@
  *
  */
 
+#include <memory>
 #include <string>
 
 #include "interfaces/json-rpc/IClient.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
+#include "utils/JSONStreamWriter.h"
 
 class CHTTPJsonRpcHandler : public IHTTPRequestHandler
 {
 public:
-  CHTTPJsonRpcHandler() { }
+  CHTTPJsonRpcHandler() : m_responseFinished(false) { }
   virtual ~CHTTPJsonRpcHandler() { }
   
   // implementations of IHTTPRequestHandler
@@ -36,14 +38,16 @@ public:
   virtual bool CanHandleRequest(const HTTPRequest &request);
 
   virtual int HandleRequest();
+  virtual bool IsLongRunning() const;
 
-  virtual HttpResponseRanges GetResponseData() const;
+  virtual ssize_t ReadResponseData(char *buffer, size_t size);
 
   virtual int GetPriority() const { return 5; }
 
 protected:
   explicit CHTTPJsonRpcHandler(const HTTPRequest &request)
-    : IHTTPRequestHandler(request)
+    : IHTTPRequestHandler(request),
+      m_responseFinished(false)
   { }
 
 #if (MHD_VERSION >= 0x00040001)
@@ -53,9 +57,34 @@ protected:
 #endif
 
 private:
+  // writes the response until at least size bytes are waiting to be sent or it is complete
+  bool WriteResponseData(size_t size);
+
   std::string m_requestData;
-  std::string m_responseData;
-  CHttpResponseRange m_responseRange;
+
+  // holds the part of the response that has been written but not sent yet
+  class CResponseBuffer : public IJSONStreamOutput
+  {
+  public:
+    CResponseBuffer() : m_offset(0), m_length(0) { }
+
+    // implementation of IJSONStreamOutput
+    bool Write(const char *data, size_t length) override;
+
+    size_t Read(char *buffer, size_t size);
+    size_t GetAvailable() const { return m_data.size() - m_offset; }
+    uint64_t GetLength() const { return m_length; }
+
+  private:
+    std::string m_data;
+    size_t m_offset;
+    uint64_t m_length;
+  };
+  CResponseBuffer m_responseData;
+  std::unique_ptr<CJSONStreamWriter> m_responseWriter;
+  std::unique_ptr<CJSONStreamValue> m_responseValue;
+  std::string m_responseSuffix;
+  bool m_responseFinished;
 
   class CHTTPTransportLayer : public JSONRPC::ITransportLayer
   {
@@ -65,7 +65,9 @@ typedef enum HTTPResponseType
   HTTPMemoryDownloadFreeNoCopy,
   // creates a HTTP response from a buffer by copying followed by freeing the buffer
   // the buffer must have been malloc'ed and not new'ed
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  // creates a HTTP response with the content read in chunks from the request handler
+  HTTPStreamDownload
 } HTTPResponseType;
 
 typedef struct HTTPRequest
@@ -127,6 +129,16 @@ public:
    */
   virtual int HandleRequest() = 0;
 
+  /*!
+   * \brief Whether handling the HTTP request may take long.
+   *
+   * \details Such requests are handled on a separate executor if the web
+   * server runs a fixed number of threads, so they don't hold up the
+   * requests of other connections. This is only used once all HTTP POST
+   * data has been added.
+   */
+  virtual bool IsLongRunning() const { return false; }
+
   /*!
    * \brief Whether the HTTP response could also be provided in ranges.
    */
@@ -158,6 +170,17 @@ public:
    */
   virtual HttpResponseRanges GetResponseData() const { return HttpResponseRanges(); };
 
+  /*!
+   * \brief Reads the next chunk of the response data into the given buffer.
+   *
+   * \details This is only used if the response type is HTTPStreamDownload.
+   * The data is read in order and the total length of the response is taken
+   * from the response details, a length of MHD_SIZE_UNKNOWN sends it chunked.
+   * \return Number of bytes read, 0 at the end of the response data, -1 if the
+   * response can't be completed and the connection has to be closed
+   */
+  virtual ssize_t ReadResponseData(char *buffer, size_t size) { return 0; }
+
   /*!
   * \brief Returns the URL to which the request should be redirected.
   *
@@ -34,6 +34,7 @@
 #endif // HAS_JSONRPC
 #include "settings/MediaSourceSettings.h"
 #include "test/TestUtils.h"
+#include "threads/Thread.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -51,6 +52,61 @@ using namespace XFILE;
 #define TEST_FILES_HTML         TEST_FILES_DATA ".html"
 #define TEST_FILES_RANGES       TEST_FILES_DATA "-ranges.txt"
 
+#define TEST_LARGE_FILE_SIZE    (4 * 1024 * 1024)
+#define TEST_LARGE_RANGE_SIZE   (256 * 1024)
+#define TEST_LARGE_CLIENTS      4
+#define TEST_LARGE_REQUESTS     16
+
+namespace
+{
+
+unsigned char GetLargeFileByte(uint64_t position)
+{
+  return static_cast<unsigned char>(position * 7 + position / 251);
+}
+
+// requests ranges of a large file like a player seeking through a video
+class CRangeClient : public IRunnable
+{
+public:
+  CRangeClient(const std::string &url, int client)
+    : m_url(url), m_client(client), m_bytes(0), m_errors(0) {}
+
+  virtual void Run()
+  {
+    for (int request = 0; request < TEST_LARGE_REQUESTS; request++)
+    {
+      uint64_t start = ((m_client * TEST_LARGE_REQUESTS + request) * 3 * TEST_LARGE_RANGE_SIZE / 2) % (TEST_LARGE_FILE_SIZE - TEST_LARGE_RANGE_SIZE);
+
+      std::string result;
+      XFILE::CCurlFile curl;
+      curl.SetRequestHeader(MHD_HTTP_HEADER_RANGE, StringUtils::Format("bytes=%" PRIu64 "-%" PRIu64, start, start + TEST_LARGE_RANGE_SIZE - 1));
+      if (!curl.Get(m_url, result) || result.size() != TEST_LARGE_RANGE_SIZE)
+      {
+        m_errors++;
+        continue;
+      }
+
+      for (size_t i = 0; i < result.size(); i++)
+      {
+        if (static_cast<unsigned char>(result[i]) != GetLargeFileByte(start + i))
+        {
+          m_errors++;
+          break;
+        }
+      }
+      m_bytes += result.size();
+    }
+  }
+
+  std::string m_url;
+  int m_client;
+  uint64_t m_bytes;
+  int m_errors;
+};
+
+}
+
 class TestWebServer : public testing::Test
 {
 protected:
@@ -787,4 +843,54 @@ TEST_F(TestWebServer, CanGetCachedRangedFileWithNewerIfRange)
   curl.SetRequestHeader(MHD_HTTP_HEADER_IF_RANGE, lastModifiedNewer.GetAsRFC1123DateTime());
   ASSERT_TRUE(curl.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
   CheckRangesTestFileResponse(curl, result, ranges);
-}
\ No newline at end of file
+}
+
+TEST_F(TestWebServer, CanGetRangesOfLargeFileConcurrently)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".bin");
+  ASSERT_TRUE(file != NULL);
+  std::vector<unsigned char> data(TEST_LARGE_RANGE_SIZE);
+  for (uint64_t position = 0; position < TEST_LARGE_FILE_SIZE; position += data.size())
+  {
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = GetLargeFileByte(position + i);
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), file->Write(&data[0], data.size()));
+  }
+  file->Flush();
+
+  std::string path = XBMC_TEMPFILEPATH(file);
+  CMediaSource source;
+  source.strName = "WebServer Temp";
+  source.strPath = URIUtils::GetDirectory(path);
+  source.vecPaths.push_back(source.strPath);
+  source.m_allowSharing = true;
+  source.m_iDriveType = CMediaSource::SOURCE_TYPE_LOCAL;
+  source.m_iLockMode = LOCK_MODE_EVERYONE;
+  source.m_ignore = true;
+  CMediaSourceSettings::GetInstance().AddShare("videos", source);
+
+  std::string url = GetUrl(URIUtils::AddFileToFolder("vfs", CURL::Encode(path)));
+
+  std::vector<CRangeClient*> clients;
+  std::vector<CThread*> threads;
+  for (int client = 0; client < TEST_LARGE_CLIENTS; client++)
+  {
+    clients.push_back(new CRangeClient(url, client));
+    threads.push_back(new CThread(clients.back(), "RangeClient"));
+    threads.back()->Create();
+  }
+
+  uint64_t bytes = 0;
+  for (int client = 0; client < TEST_LARGE_CLIENTS; client++)
+  {
+    threads[client]->StopThread(true);
+    EXPECT_EQ(0, clients[client]->m_errors);
+    bytes += clients[client]->m_bytes;
+    delete threads[client];
+    delete clients[client];
+  }
+
+  EXPECT_EQ(static_cast<uint64_t>(TEST_LARGE_CLIENTS * TEST_LARGE_REQUESTS) * TEST_LARGE_RANGE_SIZE, bytes);
+
+  XBMC_DELETETEMPFILE(file);
+}
@@ -0,0 +1,108 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "network/WebServerExecutor.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/Job.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+struct SCounters
+{
+  SCounters() : release(true), done(0), running(0), maxRunning(0) { }
+
+  CCriticalSection section;
+  CEvent started;
+  CEvent release;
+  int done;
+  int running;
+  int maxRunning;
+};
+
+class CBlockingJob : public CJob
+{
+public:
+  CBlockingJob(SCounters &counters) : m_counters(counters) { }
+
+  virtual bool DoWork()
+  {
+    {
+      CSingleLock lock(m_counters.section);
+      m_counters.running++;
+      if (m_counters.running > m_counters.maxRunning)
+        m_counters.maxRunning = m_counters.running;
+    }
+    m_counters.started.Set();
+    m_counters.release.Wait();
+    CSingleLock lock(m_counters.section);
+    m_counters.running--;
+    m_counters.done++;
+    return true;
+  }
+
+private:
+  SCounters &m_counters;
+};
+
+}
+
+TEST(TestWebServerExecutor, RunsAsManyAsThreads)
+{
+  SCounters counters;
+
+  CWebServerExecutor executor;
+  executor.Start(8);
+  for (int i = 0; i < 16; i++)
+    executor.AddJob(new CBlockingJob(counters));
+
+  // more threads than the job manager allows for one priority
+  for (;;)
+  {
+    CSingleLock lock(counters.section);
+    if (counters.running == 8)
+      break;
+    lock.Leave();
+    if (!counters.started.WaitMSec(5000))
+      break;
+  }
+  EXPECT_EQ(8, counters.running);
+  EXPECT_EQ(16u, executor.GetPendingJobs());
+
+  // stopping runs the jobs that are still waiting
+  counters.release.Set();
+  executor.Stop();
+  EXPECT_EQ(16, counters.done);
+  EXPECT_EQ(8, counters.maxRunning);
+  EXPECT_EQ(0u, executor.GetPendingJobs());
+}
+
+TEST(TestWebServerExecutor, RunsInlineWhenStopped)
+{
+  SCounters counters;
+  counters.release.Set();
+
+  CWebServerExecutor executor;
+  executor.AddJob(new CBlockingJob(counters));
+  EXPECT_EQ(1, counters.done);
+}
@@ -21,6 +21,7 @@
 #include "SlideShowPicture.h"
 #include "system.h"
 #include "guilib/GraphicContext.h"
+#include "guilib/GUITexture.h"
 #include "guilib/Texture.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
@@ -836,6 +837,8 @@ void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t c
   }
 
 #elif defined(HAS_GL)
+  // after the queued textures and text
+  CGUITexture::Flush();
   if (pTexture)
   {
     int unit = 0;
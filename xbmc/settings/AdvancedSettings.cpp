@@ -159,6 +159,7 @@ void CAdvancedSettings::Initialize()
   m_DXVAAllowHqScaling = true;
   m_videoFpsDetect = 1;
   m_videoBusyDialogDelay_ms = 500;
+  m_videoExtractionJobs = 2; // files opened at once for thumbs and stream details
 
   m_mediacodecForceSoftwareRendring = false;
 
@@ -261,6 +262,8 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_imageScalingAlgorithm = CPictureScalingAlgorithm::Default;
+  m_textureCacheFetchJobs = 2;
+  m_textureCacheDecodeJobs = 2;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -282,11 +285,13 @@ void CAdvancedSettings::Initialize()
   m_musicArtistSeparators = { ";", ":", "|", " feat. ", " ft. " };
   m_videoItemSeparator = " / ";
   m_iMusicLibraryDateAdded = 1; // prefer mtime over ctime and current time
+  m_iMusicLibraryTagReaders = 4; // files read at once while scanning
 
   m_bVideoLibraryAllItemsOnBottom = false;
   m_iVideoLibraryRecentlyAddedItems = 25;
   m_bVideoLibraryCleanOnUpdate = false;
   m_bVideoLibraryUseFastHash = true;
+  m_bVideoLibraryWatchSources = false;
   m_bVideoLibraryExportAutoThumbs = false;
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
@@ -321,6 +326,11 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_curlMaxSessions = 0;
+
+  m_webserverBlockSize = 128 * 1024; // bytes read at once for files on network sources
+  m_webserverReadAhead = true;
+  m_webserverThreads = 0;
 
 #if defined(TARGET_DARWIN_IOS)
   m_startFullScreen = true;
@@ -375,6 +385,8 @@ void CAdvancedSettings::Initialize()
 #endif
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
+  m_guiBatchRendering = true;
+  m_guiFontPrewarmGlyphs = 128;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -652,6 +664,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     // the busy dialog is shown when starting video playback.
     XMLUtils::GetInt(pElement, "busydialogdelayms", m_videoBusyDialogDelay_ms, 0, 1000);
 
+    // number of files thumbs and stream details are extracted from at once,
+    // the job manager doesn't run more than two low priority jobs anyway
+    XMLUtils::GetInt(pElement, "extractionjobs", m_videoExtractionJobs, 1, 2);
+
     // Store global display latency settings
     TiXmlElement* pVideoLatency = pElement->FirstChildElement("latency");
     if (pVideoLatency)
@@ -700,6 +716,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetString(pElement, "albumformat", m_strMusicLibraryAlbumFormat);
     XMLUtils::GetString(pElement, "itemseparator", m_musicItemSeparator);
     XMLUtils::GetInt(pElement, "dateadded", m_iMusicLibraryDateAdded);
+    XMLUtils::GetInt(pElement, "tagreaders", m_iMusicLibraryTagReaders, 1, 32);
     //Music artist name separators
     TiXmlElement* separators = pElement->FirstChildElement("artistseparators");
     if (separators)
@@ -722,6 +739,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "recentlyaddeditems", m_iVideoLibraryRecentlyAddedItems, 1, INT_MAX);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", m_bVideoLibraryCleanOnUpdate);
     XMLUtils::GetBoolean(pElement, "usefasthash", m_bVideoLibraryUseFastHash);
+    XMLUtils::GetBoolean(pElement, "watchsources", m_bVideoLibraryWatchSources);
     XMLUtils::GetString(pElement, "itemseparator", m_videoItemSeparator);
     XMLUtils::GetBoolean(pElement, "exportautothumbs", m_bVideoLibraryExportAutoThumbs);
     XMLUtils::GetBoolean(pElement, "importwatchedstate", m_bVideoLibraryImportWatchedState);
@@ -756,6 +774,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetInt(pElement, "curlmaxsessions", m_curlMaxSessions, 0, 256);
+    XMLUtils::GetInt(pElement, "webserverblocksize", m_webserverBlockSize, 2048, 4 * 1024 * 1024);
+    XMLUtils::GetBoolean(pElement, "webserverreadahead", m_webserverReadAhead);
+    XMLUtils::GetInt(pElement, "webserverthreads", m_webserverThreads, 0, 64);
   }
 
   pElement = pRootElement->FirstChildElement("cache");
@@ -807,6 +829,17 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  pElement = pRootElement->FirstChildElement("logging");
+  if (pElement)
+  {
+    bool async = false;
+    if (XMLUtils::GetBoolean(pElement, "async", async))
+      CLog::SetAsync(async);
+    std::string format;
+    if (XMLUtils::GetString(pElement, "format", format))
+      CLog::SetLogFormat(StringUtils::EqualsNoCase(format, "json") ? CLog::LOG_FORMAT_JSON : CLog::LOG_FORMAT_TEXT);
+  }
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
@@ -981,6 +1014,12 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
   if (XMLUtils::GetString(pRootElement, "imagescalingalgorithm", tmp))
     m_imageScalingAlgorithm = CPictureScalingAlgorithm::FromString(tmp);
+  TiXmlElement *pTextureCache = pRootElement->FirstChildElement("texturecache");
+  if (pTextureCache)
+  {
+    XMLUtils::GetUInt(pTextureCache, "fetchjobs", m_textureCacheFetchJobs, 1, 8);
+    XMLUtils::GetUInt(pTextureCache, "decodejobs", m_textureCacheDecodeJobs, 1, 8);
+  }
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
 
@@ -1135,6 +1174,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   {
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
+    XMLUtils::GetBoolean(pElement, "batchrendering", m_guiBatchRendering);
+    XMLUtils::GetInt(pElement, "fontprewarmglyphs", m_guiFontPrewarmGlyphs, 0, 4096);
   }
 
   std::string seekSteps;
@@ -190,6 +190,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_DXVAAllowHqScaling;
     int  m_videoFpsDetect;
     int  m_videoBusyDialogDelay_ms;
+    int  m_videoExtractionJobs;
     bool m_mediacodecForceSoftwareRendring;
 
     std::string m_videoDefaultPlayer;
@@ -239,6 +240,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_fanartRes; ///< \brief the maximal resolution to cache fanart at (assumes 16x9)
     unsigned int m_imageRes;  ///< \brief the maximal resolution to cache images at (assumes 16x9)
     CPictureScalingAlgorithm::Algorithm m_imageScalingAlgorithm;
+    unsigned int m_textureCacheFetchJobs;  ///< \brief number of images the texture cache fetches at once
+    unsigned int m_textureCacheDecodeJobs; ///< \brief number of images the texture cache decodes and encodes at once
 
     int m_sambaclienttimeout;
     std::string m_sambadoscodepage;
@@ -253,6 +256,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     int m_iMusicLibraryRecentlyAddedItems;
     int m_iMusicLibraryDateAdded;
+    int m_iMusicLibraryTagReaders;
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryCleanOnUpdate;
     std::string m_strMusicLibraryAlbumFormat;
@@ -266,6 +270,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iVideoLibraryRecentlyAddedItems;
     bool m_bVideoLibraryCleanOnUpdate;
     bool m_bVideoLibraryUseFastHash;
+    bool m_bVideoLibraryWatchSources;
     bool m_bVideoLibraryExportAutoThumbs;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
@@ -297,6 +302,10 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    int m_curlMaxSessions;          // background downloads running at the same time, 0 for no limit
+    int m_webserverBlockSize;
+    bool m_webserverReadAhead;
+    int m_webserverThreads;         // 0 for a thread per connection
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -338,6 +347,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
+    bool m_guiBatchRendering;
+    int  m_guiFontPrewarmGlyphs;    // characters rasterised ahead of time per font, 0 to disable
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemSize;
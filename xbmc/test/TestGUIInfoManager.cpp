@@ -0,0 +1,247 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "guilib/GUIControlGroup.h"
+#include "guilib/GUIListItem.h"
+#include "guilib/WindowIDs.h"
+#include "interfaces/info/InfoBool.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace INFO;
+
+namespace
+{
+
+/*!
+ \brief An info bool with fixed dependencies that counts its evaluations
+ */
+class CountingBool : public InfoBool
+{
+public:
+  explicit CountingBool(unsigned int dependencies)
+    : InfoBool("counting", 0),
+      m_updates(0)
+  {
+    m_dependencies = dependencies;
+  }
+
+  virtual void Update(const CGUIListItem *item) { m_updates++; }
+
+  unsigned int m_updates;
+};
+
+} // namespace
+
+class TestGUIInfoManager : public testing::Test
+{
+protected:
+  TestGUIInfoManager()
+  {
+    // drop whatever earlier tests left pending
+    g_infoManager.ApplyCacheInvalidation();
+  }
+
+  ~TestGUIInfoManager()
+  {
+    CSingleLock lock(g_infoManager.m_critInfo);
+    std::vector<InfoPtr> &bools = g_infoManager.m_bools;
+    for (std::vector<std::shared_ptr<CountingBool> >::const_iterator it = m_bools.begin(); it != m_bools.end(); ++it)
+      bools.erase(std::remove(bools.begin(), bools.end(), *it), bools.end());
+  }
+
+  /*! \brief Add a counting bool to the info manager, evaluated once so it starts out clean
+   */
+  std::shared_ptr<CountingBool> AddBool(unsigned int dependencies)
+  {
+    std::shared_ptr<CountingBool> info(new CountingBool(dependencies));
+    info->Get();
+    info->m_updates = 0;
+    CSingleLock lock(g_infoManager.m_critInfo);
+    g_infoManager.m_bools.push_back(info);
+    m_bools.push_back(info);
+    return info;
+  }
+
+  /*! \brief Evaluate all counting bools once
+   */
+  void GetAll()
+  {
+    for (std::vector<std::shared_ptr<CountingBool> >::const_iterator it = m_bools.begin(); it != m_bools.end(); ++it)
+      (*it)->Get();
+  }
+
+  static int GetDependencies(const std::string &condition)
+  {
+    return g_infoManager.GetConditionDependencies(g_infoManager.TranslateSingleString(condition));
+  }
+
+  static int GetExpressionDependencies(const std::string &expression)
+  {
+    return g_infoManager.Register(expression)->GetDependencies();
+  }
+
+  std::vector<std::shared_ptr<CountingBool> > m_bools;
+};
+
+TEST_F(TestGUIInfoManager, ConditionDependencies)
+{
+  EXPECT_EQ(INFO_DEPENDS_NONE, GetDependencies("true"));
+  EXPECT_EQ(INFO_DEPENDS_NONE, GetDependencies("system.platform.linux"));
+  EXPECT_EQ(INFO_DEPENDS_PLAYER, GetDependencies("player.playing"));
+  EXPECT_EQ(INFO_DEPENDS_PLAYER, GetDependencies("videoplayer.title"));
+  EXPECT_EQ(INFO_DEPENDS_OTHER, GetDependencies("player.muted"));
+  EXPECT_EQ(INFO_DEPENDS_PLAYER | INFO_DEPENDS_WINDOW, GetDependencies("videoplayer.isfullscreen"));
+  EXPECT_EQ(INFO_DEPENDS_WINDOW, GetDependencies("window.isactive(home)"));
+  EXPECT_EQ(INFO_DEPENDS_WINDOW, GetDependencies("system.hasmodaldialog"));
+  EXPECT_EQ(INFO_DEPENDS_FOCUS, GetDependencies("control.hasfocus(50)"));
+  EXPECT_EQ(INFO_DEPENDS_FOCUS | INFO_DEPENDS_LISTITEM, GetDependencies("container(50).hasfocus(2)"));
+  EXPECT_EQ(INFO_DEPENDS_LISTITEM, GetDependencies("listitem.label"));
+  EXPECT_EQ(INFO_DEPENDS_LISTITEM, GetDependencies("container.numitems"));
+  EXPECT_EQ(INFO_DEPENDS_OTHER, GetDependencies("container.scrolling"));
+  EXPECT_EQ(INFO_DEPENDS_TIME, GetDependencies("system.time"));
+  EXPECT_EQ(INFO_DEPENDS_LIBRARY, GetDependencies("library.hascontent(movies)"));
+  EXPECT_EQ(INFO_DEPENDS_SKIN, GetDependencies("string.isempty(skin.currenttheme)"));
+  EXPECT_EQ(INFO_DEPENDS_OTHER, GetDependencies("system.hasaddon(skin.estuary)"));
+
+  // comparisons depend on both labels
+  EXPECT_EQ(INFO_DEPENDS_LISTITEM | INFO_DEPENDS_PLAYER, GetDependencies("string.isequal(listitem.label,player.title)"));
+  EXPECT_EQ(INFO_DEPENDS_LISTITEM, GetDependencies("string.isequal(listitem.label,abc)"));
+}
+
+TEST_F(TestGUIInfoManager, ExpressionDependencies)
+{
+  EXPECT_EQ(INFO_DEPENDS_PLAYER | INFO_DEPENDS_WINDOW, GetExpressionDependencies("player.playing + !window.isactive(home)"));
+  EXPECT_EQ(INFO_DEPENDS_FOCUS | INFO_DEPENDS_TIME, GetExpressionDependencies("[control.hasfocus(3) | true] + system.time"));
+  EXPECT_EQ(INFO_DEPENDS_NONE, GetExpressionDependencies("true | false"));
+}
+
+TEST_F(TestGUIInfoManager, Invalidation)
+{
+  std::shared_ptr<CountingBool> player = AddBool(INFO_DEPENDS_PLAYER);
+  std::shared_ptr<CountingBool> window = AddBool(INFO_DEPENDS_WINDOW);
+  std::shared_ptr<CountingBool> both = AddBool(INFO_DEPENDS_WINDOW | INFO_DEPENDS_LISTITEM);
+  std::shared_ptr<CountingBool> other = AddBool(INFO_DEPENDS_OTHER);
+  std::shared_ptr<CountingBool> constant = AddBool(INFO_DEPENDS_NONE);
+
+  // nothing changed, everything is cached
+  GetAll();
+  GetAll();
+  EXPECT_EQ(0u, player->m_updates + window->m_updates + both->m_updates + other->m_updates + constant->m_updates);
+
+  // only the bools depending on a signalled source are evaluated again, and only once
+  g_infoManager.InvalidateCache(INFO_DEPENDS_WINDOW);
+  GetAll();
+  EXPECT_EQ(0u, window->m_updates);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  GetAll();
+  EXPECT_EQ(0u, player->m_updates);
+  EXPECT_EQ(1u, window->m_updates);
+  EXPECT_EQ(1u, both->m_updates);
+  EXPECT_EQ(0u, other->m_updates);
+
+  g_infoManager.InvalidateCache(INFO_DEPENDS_LISTITEM);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  EXPECT_EQ(1u, window->m_updates);
+  EXPECT_EQ(2u, both->m_updates);
+
+  // untracked state is invalidated every frame, the player only while playing
+  g_infoManager.UpdateCache();
+  GetAll();
+  EXPECT_EQ(0u, player->m_updates);
+  EXPECT_EQ(1u, other->m_updates);
+  EXPECT_EQ(0u, constant->m_updates);
+
+  // pending sources are applied by the frame update as well
+  g_infoManager.InvalidateCache(INFO_DEPENDS_PLAYER);
+  g_infoManager.UpdateCache();
+  GetAll();
+  EXPECT_EQ(1u, player->m_updates);
+  EXPECT_EQ(2u, other->m_updates);
+
+  // a reset invalidates everything, constants included
+  g_infoManager.ResetCache();
+  GetAll();
+  EXPECT_EQ(1u, constant->m_updates);
+}
+
+TEST_F(TestGUIInfoManager, CacheStats)
+{
+  std::shared_ptr<CountingBool> window = AddBool(INFO_DEPENDS_WINDOW);
+  std::shared_ptr<CountingBool> constant = AddBool(INFO_DEPENDS_NONE);
+  g_infoManager.UpdateCache();
+
+  g_infoManager.InvalidateCache(INFO_DEPENDS_WINDOW);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  GetAll();
+  g_infoManager.UpdateCache();
+
+  unsigned int evaluated, skipped;
+  g_infoManager.GetBoolCacheStats(evaluated, skipped);
+  EXPECT_EQ(1u, evaluated);
+  EXPECT_EQ(3u, skipped);
+}
+
+TEST_F(TestGUIInfoManager, ChangeNotifications)
+{
+  std::shared_ptr<CountingBool> focus = AddBool(INFO_DEPENDS_FOCUS);
+  std::shared_ptr<CountingBool> listItem = AddBool(INFO_DEPENDS_LISTITEM);
+  std::shared_ptr<CountingBool> window = AddBool(INFO_DEPENDS_WINDOW);
+
+  // focusing a control changes the focused control and the focused item
+  CGUIControlGroup control(0, 1, 0, 0, 100, 100);
+  control.SetFocus(true);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  EXPECT_EQ(1u, focus->m_updates);
+  EXPECT_EQ(1u, listItem->m_updates);
+
+  // focusing it again doesn't
+  control.SetFocus(true);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  EXPECT_EQ(1u, focus->m_updates);
+  EXPECT_EQ(1u, listItem->m_updates);
+
+  // changing a list item only invalidates list item infos
+  CGUIListItem item;
+  item.SetLabel("label");
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  EXPECT_EQ(1u, focus->m_updates);
+  EXPECT_EQ(2u, listItem->m_updates);
+  EXPECT_EQ(0u, window->m_updates);
+
+  g_infoManager.SetNextWindow(10000);
+  g_infoManager.SetNextWindow(WINDOW_INVALID);
+  g_infoManager.ApplyCacheInvalidation();
+  GetAll();
+  EXPECT_EQ(1u, window->m_updates);
+  EXPECT_EQ(2u, listItem->m_updates);
+}
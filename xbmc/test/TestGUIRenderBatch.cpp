@@ -0,0 +1,203 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIRenderBatch.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+enum Shader { TEXTURE, FONT };
+
+void AddQuad(CGUIRenderBatch &batch, const CGUIRenderBatch::State &state, float x, float y, float width, float height)
+{
+  CGUIRenderBatch::Vertex vertices[4] = {};
+  vertices[0].x = vertices[3].x = x;
+  vertices[1].x = vertices[2].x = x + width;
+  vertices[0].y = vertices[1].y = y;
+  vertices[2].y = vertices[3].y = y + height;
+  batch.AddQuad(state, vertices);
+}
+
+void AddLabel(CGUIRenderBatch &batch, unsigned int font, float x, float y, unsigned int length, float size)
+{
+  for (unsigned int i = 0; i < length; i++)
+    AddQuad(batch, CGUIRenderBatch::State(FONT, font), x + i * size * 0.6f, y, size * 0.6f, size);
+}
+
+/*!
+ \brief A home screen as skins have it: a fanart background, a main menu,
+ rows of posters with labels and overlays, a header with clock and weather.
+ \return the number of textures and labels drawn, each of which used to be a draw call
+ */
+unsigned int AddHomeScreen(CGUIRenderBatch &batch)
+{
+  const unsigned int background = 1, button = 2, buttonFocus = 3, shadow = 4, overlay = 5, header = 6;
+  const unsigned int icons = 100, posters = 200;
+  const unsigned int font = 1000, fontBold = 1001, fontSmall = 1002;
+  unsigned int controls = 0;
+
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, background), 0, 0, 1920, 1080);
+  controls++;
+
+  // header
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, header), 0, 0, 1920, 80);
+  AddLabel(batch, fontBold, 1700, 20, 5, 40);
+  AddLabel(batch, fontSmall, 1400, 30, 12, 24);
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, icons + 50), 1340, 20, 48, 48);
+  controls += 4;
+
+  // main menu
+  for (unsigned int i = 0; i < 10; i++)
+  {
+    float x = 60.0f + i * 180.0f;
+    AddQuad(batch, CGUIRenderBatch::State(TEXTURE, i == 2 ? buttonFocus : button), x, 120, 170, 120);
+    AddQuad(batch, CGUIRenderBatch::State(TEXTURE, icons + i), x + 53, 130, 64, 64);
+    AddLabel(batch, i == 2 ? fontBold : font, x + 10, 200, 9, 30);
+    controls += 3;
+  }
+
+  // widgets
+  for (unsigned int row = 0; row < 3; row++)
+  {
+    AddLabel(batch, fontBold, 60, 290 + row * 260.0f, 14, 30);
+    controls++;
+    for (unsigned int i = 0; i < 9; i++)
+    {
+      float x = 60.0f + i * 205.0f;
+      float y = 330.0f + row * 260.0f;
+      AddQuad(batch, CGUIRenderBatch::State(TEXTURE, shadow), x - 5, y - 5, 195, 200);
+      AddQuad(batch, CGUIRenderBatch::State(TEXTURE, posters + row * 9 + i), x, y, 185, 160);
+      AddQuad(batch, CGUIRenderBatch::State(TEXTURE, overlay), x + 150, y + 5, 30, 30);
+      AddLabel(batch, font, x, y + 165, 13, 22);
+      AddLabel(batch, fontSmall, x, y + 190, 10, 18);
+      controls += 5;
+    }
+  }
+  return controls;
+}
+
+}
+
+TEST(TestGUIRenderBatch, JoinsSameState)
+{
+  CGUIRenderBatch batch;
+  CGUIRenderBatch::State a(TEXTURE, 1), b(TEXTURE, 2);
+
+  // text next to icons, as in a list
+  for (int i = 0; i < 10; i++)
+  {
+    AddQuad(batch, a, 0, i * 50.0f, 40, 40);
+    AddQuad(batch, b, 50, i * 50.0f, 200, 40);
+  }
+  ASSERT_EQ(2u, batch.GetBatchCount());
+  EXPECT_EQ(40u, batch.GetBatch(0).vertices.size());
+  EXPECT_EQ(40u, batch.GetBatch(1).vertices.size());
+  EXPECT_FLOAT_EQ(40.0f, batch.GetBatch(0).bounds.x2);
+  EXPECT_FLOAT_EQ(490.0f, batch.GetBatch(0).bounds.y2);
+}
+
+TEST(TestGUIRenderBatch, PaintersOrder)
+{
+  CGUIRenderBatch batch;
+  CGUIRenderBatch::State a(TEXTURE, 1), b(TEXTURE, 2);
+
+  // the second quad of a covers b, so it can't be drawn before it
+  AddQuad(batch, a, 0, 0, 100, 100);
+  AddQuad(batch, b, 50, 50, 100, 100);
+  AddQuad(batch, a, 100, 100, 100, 100);
+  ASSERT_EQ(3u, batch.GetBatchCount());
+  EXPECT_EQ(1u, batch.GetBatch(0).state.texture);
+  EXPECT_EQ(2u, batch.GetBatch(1).state.texture);
+  EXPECT_EQ(1u, batch.GetBatch(2).state.texture);
+
+  // one that only touches b can
+  batch.Clear();
+  AddQuad(batch, a, 0, 0, 100, 100);
+  AddQuad(batch, b, 50, 50, 100, 100);
+  AddQuad(batch, a, 150, 150, 100, 100);
+  EXPECT_EQ(2u, batch.GetBatchCount());
+}
+
+TEST(TestGUIRenderBatch, LookBehind)
+{
+  CGUIRenderBatch batch(2);
+  for (unsigned int i = 0; i < 4; i++)
+    AddQuad(batch, CGUIRenderBatch::State(TEXTURE, i), i * 100.0f, 0, 50, 50);
+
+  // the first batch is too far back
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, 0), 0, 100, 50, 50);
+  EXPECT_EQ(5u, batch.GetBatchCount());
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, 3), 300, 100, 50, 50);
+  EXPECT_EQ(5u, batch.GetBatchCount());
+}
+
+TEST(TestGUIRenderBatch, Statistics)
+{
+  CGUIRenderBatch batch;
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, 1), 0, 0, 10, 10);
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, 2), 20, 0, 10, 10);
+  AddQuad(batch, CGUIRenderBatch::State(TEXTURE, 1), 40, 0, 10, 10);
+  batch.Clear(2.0f);
+  batch.Clear();
+
+  CGUIRenderBatch::Statistics statistics;
+  batch.GetStatistics(statistics);
+  EXPECT_EQ(1u, statistics.flushes);
+  EXPECT_EQ(3u, statistics.quads);
+  EXPECT_EQ(2u, statistics.batches);
+  EXPECT_EQ(3u, statistics.stateRuns);
+  EXPECT_FLOAT_EQ(2.0f, statistics.drawTime);
+  EXPECT_TRUE(batch.IsEmpty());
+
+  batch.ResetStatistics();
+  batch.GetStatistics(statistics);
+  EXPECT_EQ(0u, statistics.quads);
+}
+
+TEST(TestGUIRenderBatch, HomeScreen)
+{
+  // every texture and label changes state, yet they take fewer draw calls
+  CGUIRenderBatch batch;
+  unsigned int controls = AddHomeScreen(batch);
+  batch.Clear();
+
+  CGUIRenderBatch::Statistics statistics;
+  batch.GetStatistics(statistics);
+  EXPECT_EQ(1u, statistics.flushes);
+  EXPECT_EQ(controls, statistics.stateRuns);
+  EXPECT_LT(statistics.batches, statistics.stateRuns);
+}
+
+// queueing the quads of a home screen and merging them into batches, 1000 frames
+TEST(TestGUIRenderBatch, DISABLED_Benchmark)
+{
+  CGUIRenderBatch batch;
+  for (unsigned int frame = 0; frame < 1000; frame++)
+  {
+    AddHomeScreen(batch);
+    batch.Clear();
+  }
+
+  CGUIRenderBatch::Statistics statistics;
+  batch.GetStatistics(statistics);
+  EXPECT_EQ(1000u, statistics.flushes);
+}
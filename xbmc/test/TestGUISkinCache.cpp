@@ -0,0 +1,185 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "filesystem/File.h"
+#include "guilib/GUISkinCache.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <map>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const char *WINDOW_XML =
+  "<window id=\"1100\">"
+    "<defaultcontrol always=\"true\">9000</defaultcontrol>"
+    "<controls>"
+      "<control type=\"label\" id=\"1\"><label>$INFO[ListItem.Label]</label></control>"
+      "<control type=\"label\" id=\"2\"><label><![CDATA[<b>bold</b>]]></label></control>"
+    "</controls>"
+  "</window>";
+
+std::string Print(const TiXmlNode &node)
+{
+  std::string output;
+  output << node;
+  return output;
+}
+
+}
+
+class TestGUISkinCache : public testing::Test
+{
+protected:
+  TestGUISkinCache()
+  {
+    m_cacheFile = "special://temp/TestGUISkinCache.skincache";
+    m_windowFile = "special://temp/testguiskincache.xml";
+    m_window.Parse(WINDOW_XML);
+
+    // the window is looked up by its mixed case path, but was read from its lower case fallback
+    m_windowPath = "special://temp/TestGUISkinCache.xml";
+    WriteFile(m_windowFile, WINDOW_XML);
+  }
+
+  ~TestGUISkinCache()
+  {
+    XFILE::CFile::Delete(m_cacheFile);
+    XFILE::CFile::Delete(m_windowFile);
+  }
+
+  static void WriteFile(const std::string &path, const std::string &data)
+  {
+    XFILE::CFile file;
+    ASSERT_TRUE(file.OpenForWrite(path, true));
+    ASSERT_EQ((ssize_t)data.size(), file.Write(data.c_str(), data.size()));
+    file.Close();
+  }
+
+  /*! \brief Add the window to a cache and write it to the cache file
+   */
+  void Save(const std::string &key, const std::map<INFO::InfoPtr, bool> &conditions)
+  {
+    CGUISkinCache cache;
+    cache.Clear(key);
+    cache.Add(m_windowPath, m_windowFile, *m_window.RootElement(), conditions);
+    ASSERT_TRUE(cache.Save(m_cacheFile));
+  }
+
+  /*! \brief Get the window from a cache read from the cache file
+   */
+  TiXmlElement* Load(const std::string &key, bool expectLoaded = true)
+  {
+    std::map<INFO::InfoPtr, bool> conditions;
+    EXPECT_EQ(expectLoaded, m_cache.Load(m_cacheFile, key));
+    return m_cache.Get(m_windowPath, conditions);
+  }
+
+  std::string m_cacheFile;
+  std::string m_windowFile;
+  std::string m_windowPath;
+  CXBMCTinyXML m_window;
+  CGUISkinCache m_cache;
+};
+
+TEST_F(TestGUISkinCache, Serialize)
+{
+  std::string data;
+  CGUISkinCache::Serialize(*m_window.RootElement(), data);
+
+  std::unique_ptr<TiXmlElement> root(CGUISkinCache::Deserialize(data));
+  ASSERT_TRUE(root.get() != NULL);
+  EXPECT_EQ(Print(*m_window.RootElement()), Print(*root));
+
+  // every truncation is rejected
+  for (size_t size = 0; size < data.size(); size++)
+    EXPECT_TRUE(CGUISkinCache::Deserialize(data.substr(0, size)) == NULL);
+
+  // as is a string count that doesn't fit into the data
+  std::string count("\xff\xff\xff\x7f", 4);
+  EXPECT_TRUE(CGUISkinCache::Deserialize(count + data.substr(4)) == NULL);
+}
+
+TEST_F(TestGUISkinCache, RoundTrip)
+{
+  Save("skin.test|1.0", std::map<INFO::InfoPtr, bool>());
+
+  std::unique_ptr<TiXmlElement> root(Load("skin.test|1.0"));
+  ASSERT_TRUE(root.get() != NULL);
+  EXPECT_EQ(Print(*m_window.RootElement()), Print(*root));
+}
+
+TEST_F(TestGUISkinCache, KeyMismatch)
+{
+  Save("skin.test|1.0", std::map<INFO::InfoPtr, bool>());
+
+  // another skin version or changed includes don't use the cache
+  EXPECT_TRUE(Load("skin.test|1.1", false) == NULL);
+}
+
+TEST_F(TestGUISkinCache, TruncatedFile)
+{
+  Save("skin.test|1.0", std::map<INFO::InfoPtr, bool>());
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(m_cacheFile, false));
+  ASSERT_EQ(0, file.Truncate(file.GetLength() - 8));
+  file.Close();
+
+  EXPECT_TRUE(Load("skin.test|1.0", false) == NULL);
+}
+
+TEST_F(TestGUISkinCache, ChangedWindowFile)
+{
+  Save("skin.test|1.0", std::map<INFO::InfoPtr, bool>());
+
+  // the file that was read decides, not the path the window is looked up by
+  XFILE::CFile::Delete(m_windowFile);
+  EXPECT_TRUE(Load("skin.test|1.0") == NULL);
+}
+
+TEST_F(TestGUISkinCache, ChangedIncludeCondition)
+{
+  INFO::InfoPtr condition = g_infoManager.Register("true");
+  ASSERT_TRUE(condition != NULL);
+
+  std::map<INFO::InfoPtr, bool> conditions;
+  conditions[condition] = true;
+  Save("skin.test|1.0", conditions);
+
+  std::map<INFO::InfoPtr, bool> cachedConditions;
+  ASSERT_TRUE(m_cache.Load(m_cacheFile, "skin.test|1.0"));
+  std::unique_ptr<TiXmlElement> root(m_cache.Get(m_windowPath, cachedConditions));
+  EXPECT_TRUE(root.get() != NULL);
+  ASSERT_EQ(1u, cachedConditions.size());
+  EXPECT_TRUE(cachedConditions[condition]);
+
+  // resolved while the condition had another value
+  conditions[condition] = false;
+  Save("skin.test|1.0", conditions);
+
+  ASSERT_TRUE(m_cache.Load(m_cacheFile, "skin.test|1.0"));
+  EXPECT_TRUE(m_cache.Get(m_windowPath, cachedConditions) == NULL);
+  EXPECT_TRUE(cachedConditions.empty());
+}
@@ -0,0 +1,311 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "guilib/Texture.h"
+#include "guilib/TextureBundleXBT.h"
+#include "guilib/XBTF.h"
+#include "guilib/XBTFReader.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+
+#include <lzo/lzo1x.h>
+
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const unsigned int TextureSize = 128;
+
+// a pattern that compresses about as well as skin textures do
+std::string GetPixels(unsigned int seed)
+{
+  std::string pixels(TextureSize * TextureSize * 4, 0);
+  for (unsigned int y = 0; y < TextureSize; y++)
+  {
+    for (unsigned int x = 0; x < TextureSize; x++)
+    {
+      char *pixel = &pixels[(y * TextureSize + x) * 4];
+      pixel[0] = static_cast<char>(x + seed);
+      pixel[1] = static_cast<char>(y ^ seed);
+      pixel[2] = static_cast<char>(((x * y) >> 4) & 0xf0);
+      pixel[3] = static_cast<char>(x < 8 || y < 8 ? 0 : 0xff);
+    }
+  }
+  return pixels;
+}
+
+void AppendUInt32(std::string &data, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+    data += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+void AppendUInt64(std::string &data, uint64_t value)
+{
+  for (int i = 0; i < 8; i++)
+    data += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+/*!
+ \brief Writes a bundle of textures named "texture<n>.png", packing every texture but the first.
+ */
+bool WriteBundle(XFILE::CFile *file, unsigned int count)
+{
+  std::vector<std::string> frames;
+  std::vector<uint64_t> unpackedSizes;
+  std::vector<unsigned char> workMemory(LZO1X_1_MEM_COMPRESS);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    std::string pixels = GetPixels(i);
+    unpackedSizes.push_back(pixels.size());
+    if (i == 0)
+    {
+      frames.push_back(pixels);
+      continue;
+    }
+
+    std::string packed(pixels.size() + pixels.size() / 16 + 64 + 3, 0);
+    lzo_uint packedSize = packed.size();
+    if (lzo1x_1_compress(reinterpret_cast<const unsigned char*>(pixels.c_str()), pixels.size(),
+                         reinterpret_cast<unsigned char*>(&packed[0]), &packedSize, &workMemory[0]) != LZO_E_OK)
+      return false;
+    packed.resize(packedSize);
+    frames.push_back(packed);
+  }
+
+  std::string header = XBTF_MAGIC + XBTF_VERSION;
+  AppendUInt32(header, count);
+  uint64_t offset = header.size() + count * (CXBTFFile::MaximumPathLength + 4 + 4 + 40);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    std::string path = StringUtils::Format("texture%u.png", i);
+    path.resize(CXBTFFile::MaximumPathLength, 0);
+    header += path;
+    AppendUInt32(header, 0); // loop
+    AppendUInt32(header, 1); // frames
+    AppendUInt32(header, TextureSize);
+    AppendUInt32(header, TextureSize);
+    AppendUInt32(header, XB_FMT_A8R8G8B8);
+    AppendUInt64(header, frames[i].size());
+    AppendUInt64(header, unpackedSizes[i]);
+    AppendUInt32(header, 0); // duration
+    AppendUInt64(header, offset);
+    offset += frames[i].size();
+  }
+
+  if (file->Write(header.c_str(), header.size()) != static_cast<ssize_t>(header.size()))
+    return false;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    if (file->Write(frames[i].c_str(), frames[i].size()) != static_cast<ssize_t>(frames[i].size()))
+      return false;
+  }
+  file->Flush();
+  return true;
+}
+
+XFILE::CFile* CreateBundle(unsigned int count)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".xbt");
+  if (!file)
+    return NULL;
+  file->Close();
+  if (!file->OpenForWrite(XBMC_TEMPFILEPATH(file), true) || !WriteBundle(file, count))
+  {
+    XBMC_DELETETEMPFILE(file);
+    return NULL;
+  }
+  file->Close();
+  return file;
+}
+
+void PrepareBatch(const CXBTFReaderPtr &reader, CTextureBundleXBT::CBatch &batch)
+{
+  std::vector<CXBTFFile> files = reader->GetFiles();
+  batch.reader = reader;
+  for (std::vector<CXBTFFile>::const_iterator i = files.begin(); i != files.end(); ++i)
+  {
+    batch.names.push_back(i->GetPath());
+    batch.frames.push_back(i->GetFrames().front());
+  }
+}
+
+// drops the bundle from the page cache, like after a reboot
+void Evict(const std::string &path)
+{
+#if defined(TARGET_POSIX)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+#endif
+}
+
+}
+
+TEST(TestTextureBundleXBT, Frames)
+{
+  XFILE::CFile *file = CreateBundle(2);
+  ASSERT_NE(nullptr, file);
+
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  CXBTFFile unpacked, packed;
+  ASSERT_TRUE(reader.Get("texture0.png", unpacked));
+  ASSERT_TRUE(reader.Get("texture1.png", packed));
+  EXPECT_FALSE(unpacked.GetFrames()[0].IsPacked());
+  EXPECT_TRUE(packed.GetFrames()[0].IsPacked());
+
+  std::string pixels = GetPixels(0);
+  std::vector<unsigned char> buffer(pixels.size());
+  ASSERT_TRUE(reader.Load(unpacked.GetFrames()[0], &buffer[0]));
+  EXPECT_EQ(0, memcmp(pixels.c_str(), &buffer[0], pixels.size()));
+
+#if defined(TARGET_POSIX)
+  // frames are used where they're mapped
+  const unsigned char *data = reader.GetFrameData(unpacked.GetFrames()[0]);
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(0, memcmp(pixels.c_str(), data, pixels.size()));
+#endif
+
+  pixels = GetPixels(1);
+  uint8_t *frame = CTextureBundleXBT::UnpackFrame(reader, packed.GetFrames()[0]);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(0, memcmp(pixels.c_str(), frame, pixels.size()));
+  delete[] frame;
+
+  reader.Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestTextureBundleXBT, LoadBatch)
+{
+  XFILE::CFile *file = CreateBundle(50);
+  ASSERT_NE(nullptr, file);
+
+  CXBTFReaderPtr reader(new CXBTFReader());
+  ASSERT_TRUE(reader->Open(XBMC_TEMPFILEPATH(file)));
+
+  CTextureBundleXBT::CBatch batch;
+  PrepareBatch(reader, batch);
+  CTextureBundleXBT::LoadBatch(batch);
+  ASSERT_EQ(50u, batch.textures.size());
+  for (size_t i = 0; i < batch.textures.size(); i++)
+  {
+    ASSERT_NE(nullptr, batch.textures[i]);
+    EXPECT_EQ(TextureSize, batch.textures[i]->GetWidth());
+    EXPECT_EQ(TextureSize, batch.textures[i]->GetHeight());
+  }
+
+  // the textures end up in the order they were asked for
+  std::string pixels = GetPixels(StringUtils::ReturnDigits(batch.names[10]));
+  EXPECT_EQ(0, memcmp(pixels.c_str(), batch.textures[10]->GetPixels(), TextureSize * 4));
+
+  for (size_t i = 0; i < batch.textures.size(); i++)
+    delete batch.textures[i];
+  reader->Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+/*!
+ \brief Loading the textures a skin loads on startup from a bundle that isn't cached yet,
+ one by one and batched, for bundles of a small, an average and a large skin.
+ */
+class TestTextureBundleXBTLoad : public testing::TestWithParam<unsigned int>
+{
+protected:
+  TestTextureBundleXBTLoad()
+  {
+    m_file = CreateBundle(GetParam());
+  }
+
+  ~TestTextureBundleXBTLoad()
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  /*! \brief Open the bundle after dropping it from the page cache
+   */
+  CXBTFReaderPtr Open()
+  {
+    std::string path = XBMC_TEMPFILEPATH(m_file);
+    Evict(path);
+    CXBTFReaderPtr reader(new CXBTFReader());
+    if (!reader->Open(path))
+      reader.reset();
+    return reader;
+  }
+
+  XFILE::CFile *m_file;
+};
+
+TEST_P(TestTextureBundleXBTLoad, DISABLED_OneByOne)
+{
+  ASSERT_NE(nullptr, m_file);
+  CXBTFReaderPtr reader = Open();
+  ASSERT_TRUE(reader != nullptr);
+
+  // one texture after the other, as Load() does
+  CTextureBundleXBT::CBatch all;
+  PrepareBatch(reader, all);
+  for (size_t i = 0; i < all.names.size(); i++)
+  {
+    CTextureBundleXBT::CBatch single;
+    single.reader = reader;
+    single.names.push_back(all.names[i]);
+    single.frames.push_back(all.frames[i]);
+    CTextureBundleXBT::LoadBatch(single);
+    EXPECT_NE(nullptr, single.textures[0]);
+    delete single.textures[0];
+  }
+}
+
+TEST_P(TestTextureBundleXBTLoad, DISABLED_Batched)
+{
+  ASSERT_NE(nullptr, m_file);
+  CXBTFReaderPtr reader = Open();
+  ASSERT_TRUE(reader != nullptr);
+
+  // all at once, as the preloader does
+  CTextureBundleXBT::CBatch batch;
+  PrepareBatch(reader, batch);
+  CTextureBundleXBT::LoadBatch(batch);
+  for (size_t i = 0; i < batch.textures.size(); i++)
+  {
+    EXPECT_NE(nullptr, batch.textures[i]);
+    delete batch.textures[i];
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Textures, TestTextureBundleXBTLoad, testing::Values(100u, 500u, 2000u));
@@ -0,0 +1,247 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/Texture.h"
+#include "guilib/TextureManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+/*!
+ \brief Job occupying a worker until it is released
+ */
+class CBlockingJob : public CJob
+{
+public:
+  CBlockingJob(CEvent &started, CEvent &release, CEvent &finished)
+    : m_started(started),
+      m_release(release),
+      m_finished(finished)
+  {
+  }
+
+  virtual bool DoWork()
+  {
+    m_started.Set();
+    m_release.Wait();
+    m_finished.Set();
+    return true;
+  }
+
+private:
+  CEvent &m_started;
+  CEvent &m_release;
+  CEvent &m_finished;
+};
+
+} // namespace
+
+class TestTextureManager : public testing::Test
+{
+protected:
+  ~TestTextureManager()
+  {
+    m_manager.Cleanup();
+  }
+
+  /*! \brief Queue textures for the next preload job, as Preload() does on the app thread
+   */
+  void Queue(const std::vector<std::string> &textureNames)
+  {
+    CSingleLock lock(m_manager.m_preloadSection);
+    for (std::vector<std::string>::const_iterator it = textureNames.begin(); it != textureNames.end(); ++it)
+    {
+      m_manager.m_preloadJobs[*it] = 0;
+      m_manager.m_preloadBatch.push_back(*it);
+    }
+  }
+
+  void Submit()
+  {
+    CSingleLock lock(m_manager.m_preloadSection);
+    m_manager.SubmitPreloads();
+  }
+
+  /*! \brief Complete a preload job for a single texture, as a job worker does
+   */
+  void Complete(unsigned int jobID, const std::string &textureName, bool success = true)
+  {
+    CTexturePreloader job(std::vector<std::string>(1, textureName));
+    job.m_textures[0].texture = new CTexture(16, 8);
+    job.m_textures[0].width = 16;
+    job.m_textures[0].height = 8;
+    m_manager.OnJobComplete(jobID, success, &job);
+  }
+
+  /*! \brief Preload a texture without a job manager
+   */
+  void Preload(const std::string &textureName)
+  {
+    {
+      CSingleLock lock(m_manager.m_preloadSection);
+      m_manager.m_preloadJobs[textureName] = 1;
+    }
+    Complete(1, textureName);
+  }
+
+  bool IsPreloaded(const std::string &textureName)
+  {
+    CSingleLock lock(m_manager.m_preloadSection);
+    return m_manager.m_preloaded.find(textureName) != m_manager.m_preloaded.end();
+  }
+
+  bool IsLoaded(const std::string &textureName) const
+  {
+    return m_manager.m_textures.find(textureName) != m_manager.m_textures.end();
+  }
+
+  bool IsUnused(const std::string &textureName) const
+  {
+    return m_manager.m_unusedIndex.find(textureName) != m_manager.m_unusedIndex.end();
+  }
+
+  size_t GetUnusedCount() const { return m_manager.m_unusedTextures.size(); }
+
+  CTextureMap* GetPreloaded(const std::string &textureName)
+  {
+    return m_manager.GetPreloaded(textureName);
+  }
+
+  CGUITextureManager m_manager;
+};
+
+TEST_F(TestTextureManager, PreloadLookup)
+{
+  Preload("preload.png");
+  EXPECT_TRUE(IsPreloaded("preload.png"));
+
+  // results of a job that no longer decodes the texture, or that failed, are dropped
+  Complete(2, "other.png");
+  EXPECT_FALSE(IsPreloaded("other.png"));
+  Queue(std::vector<std::string>(1, "failed.png"));
+  Complete(0, "failed.png", false);
+  EXPECT_FALSE(IsPreloaded("failed.png"));
+
+  // the preloaded texture is taken by Load() without decoding it again
+  const CTextureArray &texture = m_manager.Load("preload.png");
+  ASSERT_EQ(1u, texture.size());
+  EXPECT_EQ(16, texture.m_width);
+  EXPECT_EQ(8, texture.m_height);
+  EXPECT_EQ(0u, m_manager.GetStallCount());
+  EXPECT_FALSE(IsPreloaded("preload.png"));
+  EXPECT_TRUE(IsLoaded("preload.png"));
+  EXPECT_TRUE(GetPreloaded("preload.png") == NULL);
+
+  // and found in the index afterwards
+  EXPECT_EQ(&texture, &m_manager.Load("preload.png"));
+}
+
+TEST_F(TestTextureManager, ReleaseAndReuse)
+{
+  Preload("reuse.png");
+  const CTextureArray &texture = m_manager.Load("reuse.png");
+  m_manager.Load("reuse.png");
+
+  // only the last release makes the texture unused
+  m_manager.ReleaseTexture("reuse.png");
+  EXPECT_TRUE(IsLoaded("reuse.png"));
+  EXPECT_FALSE(IsUnused("reuse.png"));
+  m_manager.ReleaseTexture("reuse.png");
+  EXPECT_FALSE(IsLoaded("reuse.png"));
+  EXPECT_TRUE(IsUnused("reuse.png"));
+  EXPECT_EQ(1u, GetUnusedCount());
+
+  // loading it again takes it back from the unused textures
+  EXPECT_EQ(&texture, &m_manager.Load("reuse.png"));
+  EXPECT_TRUE(IsLoaded("reuse.png"));
+  EXPECT_FALSE(IsUnused("reuse.png"));
+  EXPECT_EQ(0u, GetUnusedCount());
+  EXPECT_EQ(0u, m_manager.GetStallCount());
+
+  // textures released immediately can't be loaded again
+  m_manager.ReleaseTexture("reuse.png", true);
+  EXPECT_FALSE(IsUnused("reuse.png"));
+  EXPECT_EQ(1u, GetUnusedCount());
+  EXPECT_EQ(0u, m_manager.Load("reuse.png").size());
+  m_manager.FreeUnusedTextures();
+  EXPECT_EQ(0u, GetUnusedCount());
+}
+
+TEST_F(TestTextureManager, DropUnused)
+{
+  Preload("preload.png");
+  Preload("unused.png");
+  m_manager.Load("unused.png");
+  m_manager.ReleaseTexture("unused.png");
+
+  // both are kept until they weren't used for the delay
+  m_manager.FreeUnusedTextures(60000);
+  EXPECT_TRUE(IsPreloaded("preload.png"));
+  EXPECT_TRUE(IsUnused("unused.png"));
+
+  m_manager.FreeUnusedTextures();
+  EXPECT_FALSE(IsPreloaded("preload.png"));
+  EXPECT_FALSE(IsUnused("unused.png"));
+  EXPECT_EQ(0u, GetUnusedCount());
+  EXPECT_TRUE(GetPreloaded("preload.png") == NULL);
+}
+
+TEST_F(TestTextureManager, CancelQueuedPreload)
+{
+  CJobManager &jobs = CJobManager::GetInstance();
+
+  // a texture loaded before its batch is submitted isn't decoded by it
+  Queue(std::vector<std::string>(1, "early.png"));
+  EXPECT_TRUE(GetPreloaded("early.png") == NULL);
+  Submit();
+  EXPECT_EQ(0u, jobs.GetStats(CJob::PRIORITY_NORMAL).queued);
+
+  // keep the preload job queued behind another one
+  CEvent started, release, finished;
+  jobs.SetMaxConcurrency(CJob::PRIORITY_NORMAL, 1);
+  jobs.AddJob(new CBlockingJob(started, release, finished), NULL, CJob::PRIORITY_NORMAL);
+  EXPECT_TRUE(started.WaitMSec(10000));
+
+  std::vector<std::string> textureNames;
+  textureNames.push_back("first.png");
+  textureNames.push_back("second.png");
+  Queue(textureNames);
+  Submit();
+  EXPECT_EQ(1u, jobs.GetStats(CJob::PRIORITY_NORMAL).queued);
+
+  // the job is cancelled once none of its textures are wanted anymore
+  EXPECT_TRUE(GetPreloaded("first.png") == NULL);
+  EXPECT_EQ(1u, jobs.GetStats(CJob::PRIORITY_NORMAL).queued);
+  EXPECT_TRUE(GetPreloaded("second.png") == NULL);
+  EXPECT_EQ(0u, jobs.GetStats(CJob::PRIORITY_NORMAL).queued);
+
+  release.Set();
+  EXPECT_TRUE(finished.WaitMSec(10000));
+  jobs.SetMaxConcurrency(CJob::PRIORITY_NORMAL, 0);
+}
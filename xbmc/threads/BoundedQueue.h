@@ -0,0 +1,153 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+namespace XbmcThreads
+{
+  /**
+   * A fixed size lock-free queue for many producers and consumers, after
+   * Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number
+   * telling whether it is free for the producer at a given position or holds
+   * data for the consumer at that position.
+   *
+   * Push and Pop never block or allocate. T should be cheap to copy, such as
+   * a pointer or a small struct.
+   */
+  template<typename T> class BoundedQueue
+  {
+  public:
+    /**
+     * capacity is rounded up to a power of two
+     */
+    explicit BoundedQueue(size_t capacity) : m_mask(0), m_enqueuePos(0), m_dequeuePos(0)
+    {
+      size_t size = 2;
+      while (size < capacity)
+        size <<= 1;
+
+      m_cells.reset(new Cell[size]);
+      for (size_t i = 0; i < size; i++)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+      m_mask = size - 1;
+    }
+
+    /**
+     * Returns false without touching the queue if all cells are in use.
+     */
+    bool Push(const T& value)
+    {
+      Cell* cell;
+      uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        cell = &m_cells[pos & m_mask];
+        uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)seq - (int64_t)pos;
+        if (diff == 0)
+        {
+          if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+
+      cell->value = value;
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Takes the oldest value, returns false if the queue is empty.
+     */
+    bool Pop(T& value)
+    {
+      Cell* cell;
+      uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        cell = &m_cells[pos & m_mask];
+        uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+        if (diff == 0)
+        {
+          if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+
+      value = cell->value;
+      cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Calls func with a reference to every queued value, oldest first. The
+     * function may modify the value in place. Only safe while no other
+     * thread pops, producers may keep pushing.
+     */
+    template<typename F> void ForEach(F func)
+    {
+      uint64_t pos = m_dequeuePos.load(std::memory_order_acquire);
+      for (;; pos++)
+      {
+        Cell& cell = m_cells[pos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+          break;
+        func(cell.value);
+      }
+    }
+
+    bool IsEmpty() const
+    {
+      uint64_t pos = m_dequeuePos.load(std::memory_order_acquire);
+      uint64_t seq = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+      return (int64_t)seq - (int64_t)(pos + 1) < 0;
+    }
+
+    size_t GetCapacity() const { return (size_t)m_mask + 1; }
+
+  private:
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    struct Cell
+    {
+      std::atomic<uint64_t> sequence;
+      T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    uint64_t m_mask;
+    std::atomic<uint64_t> m_enqueuePos;
+    std::atomic<uint64_t> m_dequeuePos;
+  };
+}
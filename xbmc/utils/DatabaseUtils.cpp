@@ -28,6 +28,127 @@
 #include "utils/StringUtils.h"
 #include "video/VideoDatabase.h"
 
+DatabaseResultColumns::DatabaseResultColumns()
+  : m_rowCount(0)
+{ }
+
+void DatabaseResultColumns::Initialize(const MediaType &mediaType, const FieldList &fields, size_t rows /* = 0 */)
+{
+  m_mediaType = mediaType;
+  m_fields = fields;
+  m_rowCount = 0;
+  m_columns.assign(fields.size(), std::vector<Value>());
+  for (std::vector<std::vector<Value> >::iterator column = m_columns.begin(); column != m_columns.end(); ++column)
+    column->reserve(rows);
+  m_strings.clear();
+  m_stringIds.clear();
+}
+
+void DatabaseResultColumns::AddRow(const std::vector<CVariant> &values)
+{
+  for (size_t column = 0; column < m_columns.size(); column++)
+  {
+    const CVariant &variant = column < values.size() ? values[column] : CVariant::ConstNullVariant;
+    Value value;
+    value.type = variant.type();
+    switch (variant.type())
+    {
+    case CVariant::VariantTypeInteger:
+      value.integer = variant.asInteger();
+      break;
+    case CVariant::VariantTypeUnsignedInteger:
+      value.unsignedInteger = variant.asUnsignedInteger();
+      break;
+    case CVariant::VariantTypeBoolean:
+      value.boolean = variant.asBoolean();
+      break;
+    case CVariant::VariantTypeDouble:
+      value.dbl = variant.asDouble();
+      break;
+    case CVariant::VariantTypeNull:
+    case CVariant::VariantTypeConstNull:
+      value.type = CVariant::VariantTypeNull;
+      value.integer = 0;
+      break;
+    default:
+      value.type = CVariant::VariantTypeString;
+      value.string = Intern(variant.asString());
+      break;
+    }
+    m_columns[column].push_back(value);
+  }
+
+  m_rowCount++;
+}
+
+void DatabaseResultColumns::GetRow(size_t row, DatabaseResult &result) const
+{
+  result[FieldRow] = (unsigned int)row;
+  if (m_fields.empty())
+    return;
+
+  for (size_t column = 0; column < m_columns.size(); column++)
+  {
+    const Value &value = m_columns[column][row];
+    CVariant &variant = result[m_fields[column]];
+    switch (value.type)
+    {
+    case CVariant::VariantTypeInteger:
+      variant = value.integer;
+      break;
+    case CVariant::VariantTypeUnsignedInteger:
+      variant = value.unsignedInteger;
+      break;
+    case CVariant::VariantTypeBoolean:
+      variant = value.boolean;
+      break;
+    case CVariant::VariantTypeDouble:
+      variant = value.dbl;
+      break;
+    case CVariant::VariantTypeString:
+      variant = m_strings[value.string];
+      break;
+    default:
+      variant = CVariant();
+      break;
+    }
+  }
+
+  result[FieldMediaType] = m_mediaType;
+  if (m_mediaType == MediaTypeMovie || m_mediaType == MediaTypeVideoCollection ||
+      m_mediaType == MediaTypeTvShow || m_mediaType == MediaTypeMusicVideo)
+    result[FieldLabel] = result.at(FieldTitle).asString();
+  else if (m_mediaType == MediaTypeEpisode)
+  {
+    std::ostringstream label;
+    label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
+  }
+  else if (m_mediaType == MediaTypeAlbum)
+    result[FieldLabel] = result.at(FieldAlbum).asString();
+  else if (m_mediaType == MediaTypeSong)
+  {
+    std::ostringstream label;
+    label << (int)result.at(FieldTrackNumber).asInteger();
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
+  }
+  else if (m_mediaType == MediaTypeArtist)
+    result[FieldLabel] = result.at(FieldArtist).asString();
+}
+
+size_t DatabaseResultColumns::Intern(const std::string &str)
+{
+  std::pair<std::unordered_map<std::string, size_t>::iterator, bool> it = m_stringIds.insert(std::make_pair(str, m_strings.size()));
+  if (it.second)
+    m_strings.push_back(str);
+
+  return it.first->second;
+}
+
 MediaType DatabaseUtils::MediaTypeFromVideoContentType(int videoContentType)
 {
   VIDEODB_CONTENT_TYPE type = (VIDEODB_CONTENT_TYPE)videoContentType;
@@ -358,20 +479,36 @@ bool DatabaseUtils::GetFieldValue(const dbiplus::field_value &fieldValue, CVaria
 
 bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldList &fields, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
 {
+  DatabaseResultColumns columns;
+  if (!GetDatabaseColumns(mediaType, fields, dataset, columns))
+    return false;
+
+  unsigned int offset = results.size();
+  results.reserve(columns.GetRowCount() + offset);
+  for (size_t index = 0; index < columns.GetRowCount(); index++)
+  {
+    DatabaseResult result;
+    columns.GetRow(index, result);
+    result[FieldRow] = (unsigned int)index + offset;
+    results.push_back(result);
+  }
+
+  return true;
+}
+
+bool DatabaseUtils::GetDatabaseColumns(const MediaType &mediaType, const FieldList &fields, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResultColumns &columns)
+{
+  columns.Initialize(mediaType, fields);
   if (dataset->num_rows() == 0)
     return true;
 
   const dbiplus::result_set &resultSet = dataset->get_result_set();
-  unsigned int offset = results.size();
-
   if (fields.empty())
   {
-    DatabaseResult result;
+    columns.Initialize(mediaType, fields, resultSet.records.size());
+    std::vector<CVariant> values;
     for (unsigned int index = 0; index < resultSet.records.size(); index++)
-    {
-      result[FieldRow] = index + offset;
-      results.push_back(result);
-    }
+      columns.AddRow(values);
 
     return true;
   }
@@ -382,67 +519,42 @@ bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldLi
   std::vector<int> fieldIndexLookup;
   fieldIndexLookup.reserve(fields.size());
   for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
-    fieldIndexLookup.push_back(GetFieldIndex(*it, mediaType));
+  {
+    int fieldIndex = GetFieldIndex(*it, mediaType);
+    if (fieldIndex < 0)
+      return false;
+    fieldIndexLookup.push_back(fieldIndex);
+  }
 
-  results.reserve(resultSet.records.size() + offset);
+  columns.Initialize(mediaType, fields, resultSet.records.size());
+  std::vector<CVariant> values;
+  values.reserve(fields.size());
   for (unsigned int index = 0; index < resultSet.records.size(); index++)
   {
-    DatabaseResult result;
-    result[FieldRow] = index + offset;
-
-    unsigned int lookupIndex = 0;
-    for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
+    values.clear();
+    for (unsigned int column = 0; column < fields.size(); column++)
     {
-      int fieldIndex = fieldIndexLookup[lookupIndex++];
-      if (fieldIndex < 0)
-        return false;
-
-      std::pair<Field, CVariant> value;
-      value.first = *it;
-      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value.second))
+      int fieldIndex = fieldIndexLookup[column];
+      CVariant value;
+      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value))
         CLog::Log(LOGWARNING, "GetDatabaseResults: unable to retrieve value of field %s", resultSet.record_header[fieldIndex].name.c_str());
 
-      if (value.first == FieldYear &&
+      if (fields[column] == FieldYear &&
          (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode))
       {
         CDateTime dateTime;
-        dateTime.SetFromDBDate(value.second.asString());
+        dateTime.SetFromDBDate(value.asString());
         if (dateTime.IsValid())
         {
-          value.second.clear();
-          value.second = dateTime.GetYear();
+          value.clear();
+          value = dateTime.GetYear();
         }
       }
 
-      result.insert(value);
-    }
-
-    result[FieldMediaType] = mediaType;
-    if (mediaType == MediaTypeMovie || mediaType == MediaTypeVideoCollection ||
-        mediaType == MediaTypeTvShow || mediaType == MediaTypeMusicVideo)
-      result[FieldLabel] = result.at(FieldTitle).asString();
-    else if (mediaType == MediaTypeEpisode)
-    {
-      std::ostringstream label;
-      label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-    }
-    else if (mediaType == MediaTypeAlbum)
-      result[FieldLabel] = result.at(FieldAlbum).asString();
-    else if (mediaType == MediaTypeSong)
-    {
-      std::ostringstream label;
-      label << (int)result.at(FieldTrackNumber).asInteger();
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
+      values.push_back(std::move(value));
     }
-    else if (mediaType == MediaTypeArtist)
-      result[FieldLabel] = result.at(FieldArtist).asString();
 
-    results.push_back(result);
+    columns.AddRow(values);
   }
 
   return true;
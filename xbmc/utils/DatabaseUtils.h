@@ -20,9 +20,11 @@
  */
 
 #include <map>
+#include <stdint.h>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "media/MediaType.h"
@@ -150,6 +152,75 @@ typedef enum {
 typedef std::map<Field, CVariant> DatabaseResult;
 typedef std::vector<DatabaseResult> DatabaseResults;
 
+/*!
+ \brief Column oriented storage of the rows of a library query.
+
+ Instead of one map per row every field is kept in a typed column with a
+ compact value per row. Strings are interned in a pool shared by all columns,
+ so repeated values like genres, artists or paths are only stored once.
+ Rows are turned into a DatabaseResult on demand, e.g. only for the page of
+ rows that is left after sorting.
+ */
+class DatabaseResultColumns
+{
+public:
+  DatabaseResultColumns();
+
+  /*!
+   \brief Remove all rows and set up the columns for the given fields.
+   \param mediaType media type of the rows, used for the derived label
+   \param fields fields stored per row, in the order of AddRow()
+   \param rows expected number of rows
+   */
+  void Initialize(const MediaType &mediaType, const FieldList &fields, size_t rows = 0);
+
+  /*!
+   \brief Append a row.
+   \param values one value per field passed to Initialize(). Integers,
+                 booleans, doubles and null keep their type, everything
+                 else is stored as a string.
+   */
+  void AddRow(const std::vector<CVariant> &values);
+
+  size_t GetRowCount() const { return m_rowCount; }
+  const FieldList& GetFields() const { return m_fields; }
+
+  /*!
+   \brief Fill a DatabaseResult with the values of a row.
+
+   Sets FieldRow to the index of the row and, like
+   DatabaseUtils::GetDatabaseResults(), FieldMediaType and FieldLabel.
+   Values of other fields already in the result are kept, which allows
+   reusing the same result for all rows. Null values are returned as
+   CVariant::VariantTypeNull so that they can be overwritten.
+   */
+  void GetRow(size_t row, DatabaseResult &result) const;
+
+private:
+  struct Value
+  {
+    int type;
+    union
+    {
+      int64_t integer;
+      uint64_t unsignedInteger;
+      double dbl;
+      bool boolean;
+      size_t string;
+    };
+  };
+
+  size_t Intern(const std::string &str);
+
+  MediaType m_mediaType;
+  FieldList m_fields;
+  std::vector<std::vector<Value> > m_columns;
+  size_t m_rowCount;
+
+  std::vector<std::string> m_strings;
+  std::unordered_map<std::string, size_t> m_stringIds;
+};
+
 class DatabaseUtils
 {
 public:
@@ -162,6 +233,7 @@ public:
   
   static bool GetFieldValue(const dbiplus::field_value &fieldValue, CVariant &variantValue);
   static bool GetDatabaseResults(const MediaType &mediaType, const FieldList &fields, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  static bool GetDatabaseColumns(const MediaType &mediaType, const FieldList &fields, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResultColumns &columns);
 
   static std::string BuildLimitClause(int end, int start = 0);
 
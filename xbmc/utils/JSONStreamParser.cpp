@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JSONStreamParser.h"
+
+yajl_callbacks CJSONStreamParser::callbacks = {
+  CJSONStreamParser::ParseNull,
+  CJSONStreamParser::ParseBoolean,
+  CJSONStreamParser::ParseInteger,
+  CJSONStreamParser::ParseDouble,
+  NULL,
+  CJSONStreamParser::ParseString,
+  CJSONStreamParser::ParseMapStart,
+  CJSONStreamParser::ParseMapKey,
+  CJSONStreamParser::ParseMapEnd,
+  CJSONStreamParser::ParseArrayStart,
+  CJSONStreamParser::ParseArrayEnd
+};
+
+CJSONStreamParser::CJSONStreamParser(IJSONStreamHandler *handler)
+  : m_handler(handler),
+    m_failed(false)
+{
+  m_parser = yajl_alloc(&callbacks, NULL, this);
+
+  yajl_config(m_parser, yajl_allow_comments, 1);
+  yajl_config(m_parser, yajl_dont_validate_strings, 0);
+}
+
+CJSONStreamParser::~CJSONStreamParser()
+{
+  yajl_free(m_parser);
+}
+
+bool CJSONStreamParser::Parse(const char *data, size_t length)
+{
+  if (!m_failed && yajl_parse(m_parser, (const unsigned char *)data, length) != yajl_status_ok)
+    m_failed = true;
+
+  return !m_failed;
+}
+
+bool CJSONStreamParser::Finish()
+{
+  if (!m_failed && yajl_complete_parse(m_parser) != yajl_status_ok)
+    m_failed = true;
+
+  return !m_failed;
+}
+
+bool CJSONStreamParser::Parse(const std::string &json, IJSONStreamHandler *handler)
+{
+  CJSONStreamParser parser(handler);
+  return parser.Parse(json.c_str(), json.size()) && parser.Finish();
+}
+
+int CJSONStreamParser::ParseNull(void *ctx)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnNull() ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseBoolean(void *ctx, int boolean)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnBoolean(boolean != 0) ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseInteger(void *ctx, long long integerVal)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnInteger((int64_t)integerVal) ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseDouble(void *ctx, double doubleVal)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnDouble(doubleVal) ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseString(void *ctx, const unsigned char *stringVal, size_t stringLen)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnString((const char *)stringVal, stringLen) ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseMapStart(void *ctx)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnObjectStart() ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseMapKey(void *ctx, const unsigned char *stringVal, size_t stringLen)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnKey((const char *)stringVal, stringLen) ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseMapEnd(void *ctx)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnObjectEnd() ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseArrayStart(void *ctx)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnArrayStart() ? 1 : 0;
+}
+
+int CJSONStreamParser::ParseArrayEnd(void *ctx)
+{
+  return static_cast<CJSONStreamParser*>(ctx)->m_handler->OnArrayEnd() ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+#include <yajl/yajl_parse.h>
+
+/*!
+ \brief Receives the values of a JSON document parsed by CJSONStreamParser
+
+ Every method returns false to stop parsing.
+ */
+class IJSONStreamHandler
+{
+public:
+  virtual ~IJSONStreamHandler() { }
+
+  virtual bool OnNull() = 0;
+  virtual bool OnBoolean(bool value) = 0;
+  virtual bool OnInteger(int64_t value) = 0;
+  virtual bool OnDouble(double value) = 0;
+  virtual bool OnString(const char *value, size_t length) = 0;
+  virtual bool OnObjectStart() = 0;
+  virtual bool OnKey(const char *key, size_t length) = 0;
+  virtual bool OnObjectEnd() = 0;
+  virtual bool OnArrayStart() = 0;
+  virtual bool OnArrayEnd() = 0;
+};
+
+/*!
+ \brief Event based JSON parser
+
+ Passes every value to a handler as soon as it has been parsed instead of
+ building a CVariant tree, the JSON can be pushed in chunks of any size.
+ */
+class CJSONStreamParser
+{
+public:
+  explicit CJSONStreamParser(IJSONStreamHandler *handler);
+  ~CJSONStreamParser();
+
+  /*!
+   \brief Parse the next chunk of JSON
+   \return false if the JSON is invalid or the handler stopped parsing
+   */
+  bool Parse(const char *data, size_t length);
+
+  /*!
+   \brief Parse the end of the JSON, completing a trailing number
+   \return false if the JSON is invalid or incomplete
+   */
+  bool Finish();
+
+  /*!
+   \brief Parse a complete JSON document
+   \return false if the JSON is invalid or the handler stopped parsing
+   */
+  static bool Parse(const std::string &json, IJSONStreamHandler *handler);
+
+private:
+  CJSONStreamParser(const CJSONStreamParser&);
+  CJSONStreamParser& operator=(const CJSONStreamParser&);
+
+  static int ParseNull(void *ctx);
+  static int ParseBoolean(void *ctx, int boolean);
+  static int ParseInteger(void *ctx, long long integerVal);
+  static int ParseDouble(void *ctx, double doubleVal);
+  static int ParseString(void *ctx, const unsigned char *stringVal, size_t stringLen);
+  static int ParseMapStart(void *ctx);
+  static int ParseMapKey(void *ctx, const unsigned char *stringVal, size_t stringLen);
+  static int ParseMapEnd(void *ctx);
+  static int ParseArrayStart(void *ctx);
+  static int ParseArrayEnd(void *ctx);
+
+  static yajl_callbacks callbacks;
+
+  IJSONStreamHandler *m_handler;
+  yajl_handle m_parser;
+  bool m_failed;
+};
@@ -0,0 +1,325 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "JSONStreamWriter.h"
+#include "utils/Variant.h"
+
+CJSONStreamWriter::CJSONStreamWriter(bool compact, IJSONStreamOutput *output /* = NULL */, size_t chunkSize /* = DefaultChunkSize */)
+  : m_output(output),
+    m_chunkSize(chunkSize),
+    m_failed(false)
+{
+  m_gen = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_gen, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_gen, yajl_gen_indent_string, "\t");
+}
+
+CJSONStreamWriter::~CJSONStreamWriter()
+{
+  yajl_gen_free(m_gen);
+}
+
+bool CJSONStreamWriter::Check(yajl_gen_status status)
+{
+  if (status != yajl_gen_status_ok)
+    m_failed = true;
+  else if (m_output != NULL)
+  {
+    const unsigned char *buffer;
+    size_t length;
+    yajl_gen_get_buf(m_gen, &buffer, &length);
+    if (length >= m_chunkSize)
+      return Flush();
+  }
+
+  return !m_failed;
+}
+
+bool CJSONStreamWriter::BeginObject()
+{
+  return !m_failed && Check(yajl_gen_map_open(m_gen));
+}
+
+bool CJSONStreamWriter::EndObject()
+{
+  return !m_failed && Check(yajl_gen_map_close(m_gen));
+}
+
+bool CJSONStreamWriter::BeginArray()
+{
+  return !m_failed && Check(yajl_gen_array_open(m_gen));
+}
+
+bool CJSONStreamWriter::EndArray()
+{
+  return !m_failed && Check(yajl_gen_array_close(m_gen));
+}
+
+bool CJSONStreamWriter::Key(const char *key, size_t length)
+{
+  return String(key, length);
+}
+
+bool CJSONStreamWriter::Null()
+{
+  return !m_failed && Check(yajl_gen_null(m_gen));
+}
+
+bool CJSONStreamWriter::Boolean(bool value)
+{
+  return !m_failed && Check(yajl_gen_bool(m_gen, value ? 1 : 0));
+}
+
+bool CJSONStreamWriter::Integer(int64_t value)
+{
+  return !m_failed && Check(yajl_gen_integer(m_gen, (long long int)value));
+}
+
+bool CJSONStreamWriter::UnsignedInteger(uint64_t value)
+{
+  return !m_failed && Check(yajl_gen_integer(m_gen, (long long int)value));
+}
+
+bool CJSONStreamWriter::Double(double value)
+{
+  if (m_failed)
+    return false;
+  if (!std::isfinite(value))
+    return Check(yajl_gen_invalid_number);
+
+  // yajl_gen_double() formats the number with the decimal point of the current
+  // locale, so format it the same way here and replace the decimal point
+  // instead of switching the locale of the whole process while writing
+  char number[32];
+  int length = snprintf(number, sizeof(number), "%.20g", value);
+  if (length <= 0 || length >= (int)sizeof(number))
+    return Check(yajl_gen_invalid_number);
+
+  const char *decimalPoint = localeconv()->decimal_point;
+  if (decimalPoint != NULL && decimalPoint[0] != '.' && decimalPoint[0] != 0)
+  {
+    char *point = strchr(number, decimalPoint[0]);
+    if (point != NULL)
+      *point = '.';
+  }
+
+  // keep numbers without fraction or exponent recognisable as double
+  if (strspn(number, "0123456789-") == (size_t)length)
+  {
+    strcat(number, ".0");
+    length += 2;
+  }
+
+  return Check(yajl_gen_number(m_gen, number, length));
+}
+
+bool CJSONStreamWriter::String(const char *value, size_t length)
+{
+  return !m_failed && Check(yajl_gen_string(m_gen, (const unsigned char *)value, length));
+}
+
+bool CJSONStreamWriter::Value(const CVariant &value)
+{
+  return !m_failed && WriteValue(value);
+}
+
+bool CJSONStreamWriter::Value(CVariant &&value)
+{
+  return !m_failed && ReleaseValue(value);
+}
+
+bool CJSONStreamWriter::WriteValue(const CVariant &value)
+{
+  switch (value.type())
+  {
+  case CVariant::VariantTypeInteger:
+    return Integer(value.asInteger());
+  case CVariant::VariantTypeUnsignedInteger:
+    return UnsignedInteger(value.asUnsignedInteger());
+  case CVariant::VariantTypeDouble:
+    return Double(value.asDouble());
+  case CVariant::VariantTypeBoolean:
+    return Boolean(value.asBoolean());
+  case CVariant::VariantTypeString:
+    return String(value.c_str(), (size_t)value.size());
+  case CVariant::VariantTypeArray:
+    if (!BeginArray())
+      return false;
+
+    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array(); ++itr)
+    {
+      if (!WriteValue(*itr))
+        return false;
+    }
+
+    return EndArray();
+  case CVariant::VariantTypeObject:
+    if (!BeginObject())
+      return false;
+
+    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map(); ++itr)
+    {
+      if (!Key(itr->first) || !WriteValue(itr->second))
+        return false;
+    }
+
+    return EndObject();
+  case CVariant::VariantTypeConstNull:
+  case CVariant::VariantTypeNull:
+  default:
+    return Null();
+  }
+}
+
+bool CJSONStreamWriter::ReleaseValue(CVariant &value)
+{
+  bool success;
+  switch (value.type())
+  {
+  case CVariant::VariantTypeArray:
+    if (!BeginArray())
+      return false;
+
+    for (CVariant::iterator_array itr = value.begin_array(); itr != value.end_array(); ++itr)
+    {
+      if (!ReleaseValue(*itr))
+        return false;
+    }
+
+    success = EndArray();
+    break;
+  case CVariant::VariantTypeObject:
+    if (!BeginObject())
+      return false;
+
+    for (CVariant::iterator_map itr = value.begin_map(); itr != value.end_map(); ++itr)
+    {
+      if (!Key(itr->first) || !ReleaseValue(itr->second))
+        return false;
+    }
+
+    success = EndObject();
+    break;
+  default:
+    success = WriteValue(value);
+    break;
+  }
+
+  value = CVariant();
+  return success;
+}
+
+bool CJSONStreamWriter::Flush()
+{
+  if (m_failed)
+    return false;
+  if (m_output == NULL)
+    return true;
+
+  const unsigned char *buffer;
+  size_t length;
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+  if (length > 0)
+  {
+    if (!m_output->Write((const char *)buffer, length))
+      m_failed = true;
+    yajl_gen_clear(m_gen);
+  }
+
+  return !m_failed;
+}
+
+std::string CJSONStreamWriter::GetOutput()
+{
+  const unsigned char *buffer;
+  size_t length;
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+
+  std::string output((const char *)buffer, length);
+  yajl_gen_clear(m_gen);
+  return output;
+}
+
+CJSONStreamValue::CJSONStreamValue(CVariant &&value)
+  : m_value(std::move(value)),
+    m_started(false)
+{ }
+
+bool CJSONStreamValue::WriteNext(CJSONStreamWriter &writer)
+{
+  if (!m_started)
+  {
+    m_started = true;
+    return Begin(writer, m_value);
+  }
+  if (m_stack.empty())
+    return !writer.IsFailed();
+
+  Frame &frame = m_stack.back();
+  CVariant *value = frame.value;
+  if (value->isArray())
+  {
+    if (frame.array != value->end_array())
+      return Begin(writer, *frame.array++);
+    if (!writer.EndArray())
+      return false;
+  }
+  else
+  {
+    if (frame.map != value->end_map())
+    {
+      CVariant::iterator_map element = frame.map++;
+      return writer.Key(element->first) && Begin(writer, element->second);
+    }
+    if (!writer.EndObject())
+      return false;
+  }
+
+  m_stack.pop_back();
+  *value = CVariant();
+  return true;
+}
+
+bool CJSONStreamValue::Begin(CJSONStreamWriter &writer, CVariant &value)
+{
+  Frame frame;
+  frame.value = &value;
+  if (value.isArray())
+  {
+    frame.array = value.begin_array();
+    m_stack.push_back(frame);
+    return writer.BeginArray();
+  }
+  if (value.isObject())
+  {
+    frame.map = value.begin_map();
+    m_stack.push_back(frame);
+    return writer.BeginObject();
+  }
+
+  bool success = writer.Value(value);
+  value = CVariant();
+  return success;
+}
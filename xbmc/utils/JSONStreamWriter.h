@@ -0,0 +1,146 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <yajl/yajl_gen.h>
+
+#include "utils/Variant.h"
+
+/*!
+ \brief Receives the output of a CJSONStreamWriter in chunks
+ */
+class IJSONStreamOutput
+{
+public:
+  virtual ~IJSONStreamOutput() { }
+
+  /*!
+   \brief Write the next chunk of JSON
+   \return false to abort writing
+   */
+  virtual bool Write(const char *data, size_t length) = 0;
+};
+
+/*!
+ \brief Writes JSON value by value instead of from a complete CVariant tree
+
+ The JSON is collected until chunkSize bytes are buffered and then passed on
+ to the output, so a response can be sent while it is being written and
+ never needs to be held in memory as a whole. Without an output all JSON is
+ collected and can be retrieved with GetOutput().
+
+ Every method returns false once writing has failed, e.g. because a value
+ was written where a key was expected or the output aborted.
+ */
+class CJSONStreamWriter
+{
+public:
+  static const size_t DefaultChunkSize = 64 * 1024;
+
+  explicit CJSONStreamWriter(bool compact, IJSONStreamOutput *output = NULL, size_t chunkSize = DefaultChunkSize);
+  ~CJSONStreamWriter();
+
+  bool BeginObject();
+  bool EndObject();
+  bool BeginArray();
+  bool EndArray();
+
+  bool Key(const char *key, size_t length);
+  bool Key(const std::string &key) { return Key(key.c_str(), key.size()); }
+
+  bool Null();
+  bool Boolean(bool value);
+  bool Integer(int64_t value);
+  bool UnsignedInteger(uint64_t value);
+  bool Double(double value);
+  bool String(const char *value, size_t length);
+  bool String(const std::string &value) { return String(value.c_str(), value.size()); }
+
+  /*! \brief Write a complete value */
+  bool Value(const CVariant &value);
+
+  /*!
+   \brief Write a complete value and release every element of it as soon as
+   it has been written, so large values shrink while they are written
+   */
+  bool Value(CVariant &&value);
+
+  /*! \brief Pass all buffered JSON on to the output */
+  bool Flush();
+
+  /*! \brief Take the JSON collected so far, only used without an output */
+  std::string GetOutput();
+
+  bool IsFailed() const { return m_failed; }
+
+private:
+  CJSONStreamWriter(const CJSONStreamWriter&);
+  CJSONStreamWriter& operator=(const CJSONStreamWriter&);
+
+  bool Check(yajl_gen_status status);
+  bool WriteValue(const CVariant &value);
+  bool ReleaseValue(CVariant &value);
+
+  yajl_gen m_gen;
+  IJSONStreamOutput *m_output;
+  size_t m_chunkSize;
+  bool m_failed;
+};
+
+/*!
+ \brief A CVariant written into a CJSONStreamWriter element by element
+
+ Lets the consumer of the JSON decide how much of it is written at a time,
+ e.g. an HTTP response that is written as fast as it is sent. Like
+ CJSONStreamWriter::Value(CVariant&&) every element is released as soon as
+ it has been written.
+ */
+class CJSONStreamValue
+{
+public:
+  explicit CJSONStreamValue(CVariant &&value);
+
+  /*!
+   \brief Write the next scalar, key, or start or end of an array or object
+   \return false once writing has failed
+   */
+  bool WriteNext(CJSONStreamWriter &writer);
+
+  /*! \brief Whether the whole value has been written */
+  bool IsFinished() const { return m_started && m_stack.empty(); }
+
+private:
+  struct Frame
+  {
+    CVariant *value;
+    CVariant::iterator_array array;
+    CVariant::iterator_map map;
+  };
+
+  bool Begin(CJSONStreamWriter &writer, CVariant &value);
+
+  CVariant m_value;
+  std::vector<Frame> m_stack;
+  bool m_started;
+};
@@ -20,41 +20,20 @@
 
 #include "JSONVariantParser.h"
 
-yajl_callbacks CJSONVariantParser::callbacks = {
-  CJSONVariantParser::ParseNull,
-  CJSONVariantParser::ParseBoolean,
-  CJSONVariantParser::ParseInteger,
-  CJSONVariantParser::ParseDouble,
-  NULL,
-  CJSONVariantParser::ParseString,
-  CJSONVariantParser::ParseMapStart,
-  CJSONVariantParser::ParseMapKey,
-  CJSONVariantParser::ParseMapEnd,
-  CJSONVariantParser::ParseArrayStart,
-  CJSONVariantParser::ParseArrayEnd
-};
-
 CJSONVariantParser::CJSONVariantParser(IParseCallback *callback)
+  : m_callback(callback),
+    m_parser(this)
 {
-  m_callback = callback;
-
-  m_handler = yajl_alloc(&callbacks, NULL, this);
-
-  yajl_config(m_handler, yajl_allow_comments, 1);
-  yajl_config(m_handler, yajl_dont_validate_strings, 0);
-
-  m_status = ParseVariable;
 }
 
 CJSONVariantParser::~CJSONVariantParser()
 {
-  yajl_complete_parse(m_handler);
-  yajl_free(m_handler);
+  m_parser.Finish();
 }
 
 void CJSONVariantParser::push_buffer(const unsigned char *buffer, unsigned int length)
 {
-  yajl_parse(m_handler, buffer, length);
+  m_parser.Parse((const char *)buffer, length);
 }
 
 CVariant CJSONVariantParser::Parse(const std::string& json)
@@ -65,155 +44,107 @@ CVariant CJSONVariantParser::Parse(const std::string& json)
 CVariant CJSONVariantParser::Parse(const unsigned char *json, unsigned int length)
 {
   CSimpleParseCallback callback;
-  CJSONVariantParser parser(&callback);
-
-  parser.push_buffer(json, length);
+  {
+    CJSONVariantParser parser(&callback);
+    parser.push_buffer(json, length);
+  }
 
   return callback.GetOutput();
 }
 
-int CJSONVariantParser::ParseNull(void * ctx)
+bool CJSONVariantParser::OnNull()
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant::VariantTypeNull);
-  parser->PopObject();
-
-  return 1;
+  AddValue(CVariant(CVariant::VariantTypeNull));
+  return true;
 }
 
-int CJSONVariantParser::ParseBoolean(void * ctx, int boolean)
+bool CJSONVariantParser::OnBoolean(bool value)
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant(boolean != 0));
-  parser->PopObject();
-
-  return 1;
+  AddValue(CVariant(value));
+  return true;
 }
 
-int CJSONVariantParser::ParseInteger(void * ctx, long long integerVal)
+bool CJSONVariantParser::OnInteger(int64_t value)
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant((int64_t)integerVal));
-  parser->PopObject();
-
-  return 1;
+  AddValue(CVariant(value));
+  return true;
 }
 
-int CJSONVariantParser::ParseDouble(void * ctx, double doubleVal)
+bool CJSONVariantParser::OnDouble(double value)
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant((float)doubleVal));
-  parser->PopObject();
-
-  return 1;
+  AddValue(CVariant((float)value));
+  return true;
 }
 
-int CJSONVariantParser::ParseString(void * ctx, const unsigned char * stringVal, size_t stringLen)
+bool CJSONVariantParser::OnString(const char *value, size_t length)
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant((const char *)stringVal, stringLen));
-  parser->PopObject();
-
-  return 1;
+  AddValue(CVariant(value, length));
+  return true;
 }
 
-int CJSONVariantParser::ParseMapStart(void * ctx)
+bool CJSONVariantParser::OnObjectStart()
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant::VariantTypeObject);
-
-  return 1;
+  AddValue(CVariant(CVariant::VariantTypeObject));
+  return true;
 }
 
-int CJSONVariantParser::ParseMapKey(void * ctx, const unsigned char * stringVal, size_t stringLen)
+bool CJSONVariantParser::OnKey(const char *key, size_t length)
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->m_key = std::string((const char *)stringVal, 0, stringLen);
-
-  return 1;
+  m_key.assign(key, length);
+  return true;
 }
 
-int CJSONVariantParser::ParseMapEnd(void * ctx)
+bool CJSONVariantParser::OnObjectEnd()
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PopObject();
-
-  return 1;
+  PopObject();
+  return true;
 }
 
-int CJSONVariantParser::ParseArrayStart(void * ctx)
+bool CJSONVariantParser::OnArrayStart()
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PushObject(CVariant::VariantTypeArray);
-
-  return 1;
+  AddValue(CVariant(CVariant::VariantTypeArray));
+  return true;
 }
 
-int CJSONVariantParser::ParseArrayEnd(void * ctx)
+bool CJSONVariantParser::OnArrayEnd()
 {
-  CJSONVariantParser *parser = (CJSONVariantParser *)ctx;
-
-  parser->PopObject();
-
-  return 1;
+  PopObject();
+  return true;
 }
 
-void CJSONVariantParser::PushObject(CVariant variant)
+void CJSONVariantParser::AddValue(CVariant &&variant)
 {
-  if (m_status == ParseObject)
+  // values are moved straight into their place in the parsed tree
+  CVariant *value;
+  if (m_parse.empty())
   {
-    (*m_parse[m_parse.size() - 1])[m_key] = variant;
-    m_parse.push_back(&(*m_parse[m_parse.size() - 1])[m_key]);
+    m_parsedObject = std::move(variant);
+    value = &m_parsedObject;
   }
-  else if (m_status == ParseArray)
+  else if (m_parse.back()->isObject())
   {
-    CVariant *temp = m_parse[m_parse.size() - 1];
-    temp->push_back(variant);
-    m_parse.push_back(&(*temp)[temp->size() - 1]);
+    value = &(*m_parse.back())[m_key];
+    *value = std::move(variant);
   }
-  else if (m_parse.empty())
+  else
   {
-    m_parse.push_back(new CVariant(variant));
+    CVariant *parent = m_parse.back();
+    parent->push_back(std::move(variant));
+    value = &(*parent)[parent->size() - 1];
   }
 
-  if (variant.isObject())
-    m_status = ParseObject;
-  else if (variant.isArray())
-    m_status = ParseArray;
-  else
-    m_status = ParseVariable;
+  m_parse.push_back(value);
+  if (!value->isObject() && !value->isArray())
+    PopObject();
 }
 
 void CJSONVariantParser::PopObject()
 {
-  CVariant *variant = m_parse[m_parse.size() - 1];
   m_parse.pop_back();
 
-  if (m_parse.size())
-  {
-    variant = m_parse[m_parse.size() - 1];
-    if (variant->isObject())
-      m_status = ParseObject;
-    else if (variant->isArray())
-      m_status = ParseArray;
-    else
-      m_status = ParseVariable;
-  }
-  else if (m_callback)
+  if (m_parse.empty() && m_callback)
   {
-    m_callback->onParsed(variant);
-    delete variant;
-
-    m_parse.clear();
-    m_status = ParseVariable;
+    m_callback->onParsed(&m_parsedObject);
+    m_parsedObject = CVariant();
   }
 }
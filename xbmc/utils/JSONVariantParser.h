@@ -22,10 +22,9 @@
 #include <string>
 #include <vector>
 
+#include "utils/JSONStreamParser.h"
 #include "utils/Variant.h"
 
-#include <yajl/yajl_parse.h>
-
 class IParseCallback
 {
 public:
@@ -37,14 +36,14 @@ public:
 class CSimpleParseCallback : public IParseCallback
 {
 public:
-  virtual void onParsed(CVariant *variant) { m_parsed = *variant; }
+  virtual void onParsed(CVariant *variant) { m_parsed = std::move(*variant); }
   CVariant &GetOutput() { return m_parsed; }
 
 private:
   CVariant m_parsed;
 };
 
-class CJSONVariantParser
+class CJSONVariantParser : private IJSONStreamHandler
 {
 public:
   CJSONVariantParser(IParseCallback *callback);
@@ -57,34 +56,25 @@ public:
   static CVariant Parse(const std::string& json);
 
 private:
-  static int ParseNull(void * ctx);
-  static int ParseBoolean(void * ctx, int boolean);
-  static int ParseInteger(void * ctx, long long integerVal);
-  static int ParseDouble(void * ctx, double doubleVal);
-  static int ParseString(void * ctx, const unsigned char * stringVal, size_t stringLen);
-  static int ParseMapStart(void * ctx);
-  static int ParseMapKey(void * ctx, const unsigned char * stringVal, size_t stringLen);
-  static int ParseMapEnd(void * ctx);
-  static int ParseArrayStart(void * ctx);
-  static int ParseArrayEnd(void * ctx);
-
-  void PushObject(CVariant variant);
+  // implementation of IJSONStreamHandler
+  virtual bool OnNull() override;
+  virtual bool OnBoolean(bool value) override;
+  virtual bool OnInteger(int64_t value) override;
+  virtual bool OnDouble(double value) override;
+  virtual bool OnString(const char *value, size_t length) override;
+  virtual bool OnObjectStart() override;
+  virtual bool OnKey(const char *key, size_t length) override;
+  virtual bool OnObjectEnd() override;
+  virtual bool OnArrayStart() override;
+  virtual bool OnArrayEnd() override;
+
+  void AddValue(CVariant &&variant);
   void PopObject();
 
-  static yajl_callbacks callbacks;
-
   IParseCallback *m_callback;
-  yajl_handle m_handler;
+  CJSONStreamParser m_parser;
 
   CVariant m_parsedObject;
   std::vector<CVariant *> m_parse;
   std::string m_key;
-
-  enum PARSE_STATUS
-  {
-    ParseArray = 1,
-    ParseObject = 2,
-    ParseVariable = 0
-  };
-  PARSE_STATUS m_status;
 };
@@ -19,7 +19,6 @@
  *
  */
 
-#include <yajl/yajl_gen.h>
 #include <string>
 
 class CVariant;
@@ -28,6 +27,4 @@ class CJSONVariantWriter
 {
 public:
   static std::string Write(const CVariant &value, bool compact);
-private:
-  static bool InternalWrite(yajl_gen g, const CVariant &value);
 };
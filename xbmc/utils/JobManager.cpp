@@ -23,6 +23,7 @@
 #include <functional>
 #include <stdexcept>
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #ifdef TARGET_POSIX
 #include "linux/XTimeUtils.h"
@@ -37,9 +38,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int slot) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_slot = slot;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -72,7 +74,7 @@ void CJobWorker::Process()
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(this, success, job);
   }
 }
 
@@ -167,6 +169,14 @@ bool CJobQueue::IsProcessing() const
   return !m_processing.empty() || !m_jobQueue.empty();
 }
 
+void CJobQueue::SetJobsAtOnce(unsigned int jobsAtOnce)
+{
+  CSingleLock lock(m_section);
+  m_jobsAtOnce = std::max(jobsAtOnce, 1U);
+  while (m_jobQueue.size() && m_processing.size() < m_jobsAtOnce)
+    QueueNextJob();
+}
+
 bool CJobQueue::QueueEmpty() const
 {
   CSingleLock lock(m_section);
@@ -184,6 +194,16 @@ CJobManager::CJobManager()
   m_jobCounter = 0;
   m_running = true;
   m_pauseJobs = false;
+  m_processingTotal = 0;
+  m_idleWorkers = 0;
+  m_wakeups = 0;
+  m_jobsAdded = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    m_queued[priority] = 0;
+    m_maxConcurrency[priority] = 0;
+    m_processingCount[priority] = 0;
+  }
 }
 
 void CJobManager::Restart()
@@ -200,22 +220,29 @@ void CJobManager::CancelJobs()
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  // clear any pending jobs and cancel any callbacks on jobs still processing
+  for (unsigned int i = 0; i <= MAX_WORKERS; ++i)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), std::mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
+    CWorkQueue &queue = i < MAX_WORKERS ? m_workerQueues[i] : m_sharedQueue;
+    CSingleLock queueLock(queue.m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      m_queued[priority] -= queue.m_jobs[priority].size();
+      for_each(queue.m_jobs[priority].begin(), queue.m_jobs[priority].end(), std::mem_fun_ref(&CWorkItem::FreeJob));
+      queue.m_jobs[priority].clear();
+    }
+    for_each(queue.m_processing.begin(), queue.m_processing.end(), std::mem_fun_ref(&CWorkItem::Cancel));
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), std::mem_fun_ref(&CWorkItem::Cancel));
-
   // tell our workers to finish
   while (m_workers.size())
   {
     lock.Leave();
-    m_jobEvent.Set();
-    Sleep(0); // yield after setting the event to give the workers some time to die
+    {
+      CSingleLock wakeLock(m_wakeSection);
+      m_jobAdded.notifyAll();
+    }
+    Sleep(0); // yield after waking the workers to give them some time to die
     lock.Enter();
   }
 }
@@ -226,43 +253,107 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
+
+  // jobs added by a job keep to the worker running it, everything else goes to the shared queue
+  CWorkQueue *queue = &m_sharedQueue;
+  CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+  if (worker && worker->GetManager() == this)
+    queue = &m_workerQueues[worker->GetSlot()];
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+  work.m_queueTime = XbmcThreads::SystemClockMillis();
+  {
+    CSingleLock queueLock(queue->m_section);
+    // checked again under the queue lock so that CancelJobs() can't miss this job
+    if (!m_running)
+      return 0;
+    queue->m_jobs[priority].push_back(work);
+    m_queued[priority]++;
+  }
 
-  StartWorkers(priority);
-  return work.m_id;
+  WakeWorker(priority);
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  // check whether we have this job in any of the queues. A job only moves from
+  // a queue to the jobs being processed, with both locked, so looking at the
+  // queues first can't miss it
+  for (unsigned int i = 0; i <= MAX_WORKERS; ++i)
+  {
+    CWorkQueue &queue = i < MAX_WORKERS ? m_workerQueues[i] : m_sharedQueue;
+    CSingleLock queueLock(queue.m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      JobQueue::iterator it = find(queue.m_jobs[priority].begin(), queue.m_jobs[priority].end(), jobID);
+      if (it != queue.m_jobs[priority].end())
+      {
+        delete it->m_job;
+        queue.m_jobs[priority].erase(it);
+        m_queued[priority]--;
+        return;
+      }
+    }
+  }
+  // or if we're processing it
+  for (unsigned int i = 0; i < MAX_WORKERS; ++i)
+  {
+    CWorkQueue &queue = m_workerQueues[i];
+    CSingleLock queueLock(queue.m_section);
+    Processing::iterator it = find(queue.m_processing.begin(), queue.m_processing.end(), jobID);
+    if (it != queue.m_processing.end())
+    {
+      it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+      return;
+    }
+  }
+}
+
+void CJobManager::WakeWorker(CJob::PRIORITY priority)
+{
+  // a worker looking for a job while this one was added looks again instead of sleeping
+  m_jobsAdded++;
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    CSingleLock lock(m_wakeSection);
+    // every job wakes its own worker, so jobs added at once are processed at once
+    if (m_idleWorkers > m_wakeups)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
+      m_wakeups++;
+      m_jobAdded.notify();
       return;
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+
+  StartWorkers(priority);
+}
+
+bool CJobManager::WaitForJob(unsigned int added)
+{
+  CSingleLock lock(m_wakeSection);
+  if (m_jobsAdded != added)
+    return true;
+
+  // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+  XbmcThreads::EndTime timeout(30000);
+  m_idleWorkers++;
+  while (!m_wakeups && m_running && !timeout.IsTimePast())
+    m_jobAdded.wait(lock, timeout.MillisLeft());
+  bool woken = m_wakeups > 0;
+  if (woken)
+    m_wakeups--;
+  m_idleWorkers--;
+
+  return woken && m_running;
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
@@ -270,67 +361,125 @@ void CJobManager::StartWorkers(CJob::PRIORITY priority)
   CSingleLock lock(m_section);
 
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if (!m_running || m_processingTotal >= GetMaxWorkers(priority))
     return;
 
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  // everyone is busy - we need more workers, each owning a free queue slot
+  for (unsigned int slot = 0; slot < MAX_WORKERS; ++slot)
   {
-    m_jobEvent.Set();
-    return;
+    bool used = false;
+    for (Workers::const_iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+      used |= (*it)->GetSlot() == slot;
+    if (!used)
+    {
+      m_workers.push_back(new CJobWorker(this, slot));
+      return;
+    }
   }
+}
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+bool CJobManager::ReserveProcessing(CJob::PRIORITY priority)
+{
+  unsigned int total = m_processingTotal;
+  do
+  {
+    if (total >= GetMaxWorkers(priority))
+      return false;
+  } while (!m_processingTotal.compare_exchange_weak(total, total + 1));
+
+  unsigned int maxJobs = m_maxConcurrency[priority];
+  unsigned int count = m_processingCount[priority];
+  do
+  {
+    if (maxJobs && count >= maxJobs)
+    {
+      m_processingTotal--;
+      return false;
+    }
+  } while (!m_processingCount[priority].compare_exchange_weak(count, count + 1));
+
+  return true;
 }
 
-CJob *CJobManager::PopJob()
+void CJobManager::ReleaseProcessing(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  m_processingCount[priority]--;
+  m_processingTotal--;
+}
+
+CJob *CJobManager::TakeJob(CWorkQueue &queue, CWorkQueue &worker, CJob::PRIORITY priority)
+{
+  // both queues are locked in a fixed order so that workers stealing from each other can't deadlock
+  CSingleLock firstLock(&queue < &worker ? queue.m_section : worker.m_section);
+  CSingleLock secondLock(&queue < &worker ? worker.m_section : queue.m_section);
+  if (queue.m_jobs[priority].empty())
+    return NULL;
+
+  CWorkItem job = queue.m_jobs[priority].front();
+  queue.m_jobs[priority].pop_front();
+  m_queued[priority]--;
+
+  // add to the processing vector of the worker
+  job.m_startTime = XbmcThreads::SystemClockMillis();
+  unsigned int waitTime = job.m_startTime - job.m_queueTime;
+  JobStats &stats = worker.m_stats[priority];
+  stats.totalWaitTime += waitTime;
+  stats.maxWaitTime = std::max(stats.maxWaitTime, waitTime);
+  job.m_job->m_callback = this;
+  worker.m_processing.push_back(job);
+  return job.m_job;
+}
+
+CJob *CJobManager::PopJob(const CJobWorker *worker)
+{
+  CWorkQueue &own = m_workerQueues[worker->GetSlot()];
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
-    {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
-    }
+    if (!m_queued[priority] || !ReserveProcessing(CJob::PRIORITY(priority)))
+      continue;
+
+    // our own queue first, then the shared queue, then steal from the other workers
+    CJob *job = TakeJob(own, own, CJob::PRIORITY(priority));
+    if (!job)
+      job = TakeJob(m_sharedQueue, own, CJob::PRIORITY(priority));
+    for (unsigned int i = 1; !job && i < MAX_WORKERS; ++i)
+      job = TakeJob(m_workerQueues[(worker->GetSlot() + i) % MAX_WORKERS], own, CJob::PRIORITY(priority));
+    if (job)
+      return job;
+
+    ReleaseProcessing(CJob::PRIORITY(priority));
   }
   return NULL;
 }
 
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int i = 0; i < MAX_WORKERS; ++i)
   {
-    if (priority == it->m_priority)
-      return true;
+    const CWorkQueue &queue = m_workerQueues[i];
+    CSingleLock lock(queue.m_section);
+    for (Processing::const_iterator it = queue.m_processing.begin(); it < queue.m_processing.end(); ++it)
+    {
+      if (priority == it->m_priority)
+        return true;
+    }
   }
   return false;
 }
@@ -338,40 +487,66 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int i = 0; i < MAX_WORKERS; ++i)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    const CWorkQueue &queue = m_workerQueues[i];
+    CSingleLock lock(queue.m_section);
+    for (Processing::const_iterator it = queue.m_processing.begin(); it < queue.m_processing.end(); ++it)
+    {
+      if (type == std::string(it->m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
+void CJobManager::SetMaxConcurrency(CJob::PRIORITY priority, unsigned int maxJobs)
+{
+  m_maxConcurrency[priority] = maxJobs;
+}
+
+CJobManager::JobStats CJobManager::GetStats(CJob::PRIORITY priority) const
+{
+  JobStats stats = JobStats();
+  for (unsigned int i = 0; i < MAX_WORKERS; ++i)
+  {
+    const CWorkQueue &queue = m_workerQueues[i];
+    CSingleLock lock(queue.m_section);
+    const JobStats &workerStats = queue.m_stats[priority];
+    stats.completed += workerStats.completed;
+    stats.maxWaitTime = std::max(stats.maxWaitTime, workerStats.maxWaitTime);
+    stats.totalWaitTime += workerStats.totalWaitTime;
+    stats.totalRunTime += workerStats.totalRunTime;
+  }
+  stats.queued = m_queued[priority];
+  stats.processing = m_processingCount[priority];
+  return stats;
+}
+
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   while (m_running)
   {
     // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    unsigned int added = m_jobsAdded;
+    CJob *job = PopJob(worker);
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
-      break;
+    if (WaitForJob(added))
+      continue;
+
+    // we timed out - stop unless a job came in after we looked. Holding the lock
+    // here means that a job added from now on starts a new worker in our place
+    CSingleLock lock(m_section);
+    if (m_running && m_jobsAdded != added)
+      continue;
+    RemoveWorker(worker);
+    return NULL;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
   // have no jobs
   RemoveWorker(worker);
   return NULL;
@@ -379,28 +554,34 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // find the job in the processing queues, and check whether it's cancelled (no callback)
+  for (unsigned int i = 0; i < MAX_WORKERS; ++i)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    const CWorkQueue &queue = m_workerQueues[i];
+    CSingleLock lock(queue.m_section);
+    Processing::const_iterator it = find(queue.m_processing.begin(), queue.m_processing.end(), job);
+    if (it != queue.m_processing.end())
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CWorkItem item(*it);
+      lock.Leave(); // leave section prior to call
+      if (item.m_callback)
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
+      break;
     }
   }
   return true; // couldn't find the job, or it's been cancelled
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+void CJobManager::OnJobComplete(const CJobWorker *worker, bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
+  CWorkQueue &queue = m_workerQueues[worker->GetSlot()];
+  CSingleLock lock(queue.m_section);
   // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  Processing::iterator i = find(queue.m_processing.begin(), queue.m_processing.end(), job);
+  if (i != queue.m_processing.end())
   {
     // tell any listeners we're done with the job, then delete it
     CWorkItem item(*i);
@@ -415,9 +596,15 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+    Processing::iterator j = find(queue.m_processing.begin(), queue.m_processing.end(), job);
+    if (j != queue.m_processing.end())
+    {
+      JobStats &stats = queue.m_stats[j->m_priority];
+      stats.completed++;
+      stats.totalRunTime += XbmcThreads::SystemClockMillis() - j->m_startTime;
+      ReleaseProcessing(j->m_priority);
+      queue.m_processing.erase(j);
+    }
     lock.Leave();
     item.FreeJob();
   }
@@ -434,6 +621,5 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return MAX_WORKERS - (CJob::PRIORITY_HIGH - priority);
 }
@@ -19,9 +19,12 @@
  *
  */
 
+#include <atomic>
 #include <queue>
 #include <vector>
 #include <string>
+#include <stdint.h>
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +34,19 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int slot);
   virtual ~CJobWorker();
 
   void Process();
+
+  /*!
+   \brief Index of the work queue owned by this worker
+   */
+  unsigned int GetSlot() const { return m_slot; }
+  CJobManager *GetManager() const { return m_jobManager; }
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_slot;
 };
 
 /*!
@@ -125,6 +135,13 @@ public:
    */
   bool IsProcessing() const;
 
+  /*!
+   \brief Change the number of jobs that may be processed at once
+   Raising the limit starts queued jobs straight away, lowering it lets the jobs being processed finish.
+   \param jobsAtOnce the number of jobs to process at once.
+   */
+  void SetJobsAtOnce(unsigned int jobsAtOnce);
+
   /*!
    \brief The callback used when a job completes.
 
@@ -170,10 +187,33 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Every worker owns a set of per-priority queues. Jobs added from a job running on
+ a worker go to that worker's queues, jobs added from any other thread go to a
+ shared queue. Workers take jobs from their own queues first, then from the shared
+ queue, and finally steal from the other workers, so adding, taking and completing
+ a job only lock the queues involved. Every added job wakes a sleeping worker or
+ starts a new one.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
 {
+public:
+  /*!
+   \brief Statistics of the jobs of one priority
+   \sa GetStats()
+   */
+  struct JobStats
+  {
+    unsigned int queued;        ///< number of jobs waiting to be processed
+    unsigned int processing;    ///< number of jobs being processed
+    unsigned int completed;     ///< number of jobs processed so far
+    unsigned int maxWaitTime;   ///< longest time a job waited in the queue (ms)
+    uint64_t     totalWaitTime; ///< time all started jobs waited in the queue (ms)
+    uint64_t     totalRunTime;  ///< time spent processing completed jobs (ms)
+  };
+
+private:
   class CWorkItem
   {
   public:
@@ -183,6 +223,8 @@ class CJobManager
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_queueTime = 0;
+      m_startTime = 0;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -205,6 +247,31 @@ class CJobManager
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    unsigned int  m_queueTime; ///< time the job was queued (ms)
+    unsigned int  m_startTime; ///< time the job started processing (ms)
+  };
+
+  typedef std::deque<CWorkItem>    JobQueue;
+  typedef std::vector<CWorkItem>   Processing;
+
+  /*!
+   \brief Per-priority job queues owned by a worker, or shared by other threads.
+   The queue of a worker also holds the job the worker is processing and the
+   statistics of the jobs it has processed.
+   */
+  class CWorkQueue
+  {
+  public:
+    CWorkQueue()
+    {
+      for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+        m_stats[priority] = JobStats();
+    }
+
+    CCriticalSection m_section;
+    JobQueue         m_jobs[CJob::PRIORITY_HIGH+1];
+    Processing       m_processing;
+    JobStats         m_stats[CJob::PRIORITY_HIGH+1];
   };
 
   template<typename F>
@@ -297,6 +364,22 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Limit the number of jobs of a priority that may be processed at once.
+   Jobs of the priority are additionally limited by the number of free workers.
+   \param priority the priority to limit
+   \param maxJobs maximum number of concurrently processed jobs, 0 to remove the limit
+   */
+  void SetMaxConcurrency(CJob::PRIORITY priority, unsigned int maxJobs);
+
+  /*!
+   \brief Get queue depth, concurrency and latency counters of a priority.
+   \param priority the priority to retrieve statistics for
+   \return the statistics
+   \sa JobStats
+   */
+  JobStats GetStats(CJob::PRIORITY priority) const;
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -311,11 +394,12 @@ protected:
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
-   \param job a pointer to the calling subclassed CJob instance.
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \param success the result from the DoWork call
+   \param job a pointer to the calling subclassed CJob instance.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(const CJobWorker *worker, bool success, CJob *job);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -335,27 +419,61 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the job queues and add to the processing queue ready to process
+   \param worker the worker requesting the job
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(const CJobWorker *worker);
+
+  /*! \brief Move the oldest job of the given priority from a queue to the jobs processed by a worker
+   \param queue the queue to take the job from
+   \param worker the queue of the worker that will process the job
+   \return the job to process, NULL if the queue was empty
+   */
+  CJob *TakeJob(CWorkQueue &queue, CWorkQueue &worker, CJob::PRIORITY priority);
+
+  /*! \brief Count a job of the given priority as processing, unless a limit has been reached
+   \return true if the job may be processed, false otherwise
+   \sa ReleaseProcessing()
+   */
+  bool ReserveProcessing(CJob::PRIORITY priority);
+  void ReleaseProcessing(CJob::PRIORITY priority);
+
+  /*! \brief Wake a sleeping worker for a newly added job, or start a new one
+   */
+  void WakeWorker(CJob::PRIORITY priority);
+
+  /*! \brief Sleep until a job is added or the timeout expires
+   \param added the number of jobs that had been added when the worker last looked for one
+   \return true if a job may be available, false on timeout or when jobs are cancelled
+   */
+  bool WaitForJob(unsigned int added);
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  static const unsigned int MAX_WORKERS = 5;
+
+  std::atomic<unsigned int> m_jobCounter;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_pauseJobs;
-  Processing m_processing;
+  CWorkQueue m_sharedQueue;                    ///< jobs added from non-worker threads
+  CWorkQueue m_workerQueues[MAX_WORKERS];      ///< jobs added from jobs running on a worker, by worker slot
+  std::atomic<unsigned int> m_queued[CJob::PRIORITY_HIGH+1];
+  std::atomic<bool> m_pauseJobs;
   Workers    m_workers;
 
-  CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  std::atomic<unsigned int> m_maxConcurrency[CJob::PRIORITY_HIGH+1];
+  std::atomic<unsigned int> m_processingCount[CJob::PRIORITY_HIGH+1];
+  std::atomic<unsigned int> m_processingTotal;
+
+  CCriticalSection m_section;                  ///< guards the workers
+  CCriticalSection m_wakeSection;              ///< guards sleeping workers and their wakeups
+  XbmcThreads::ConditionVariable m_jobAdded;
+  unsigned int m_idleWorkers;                  ///< workers waiting for a job
+  unsigned int m_wakeups;                      ///< idle workers woken for a job that haven't taken one yet
+  std::atomic<unsigned int> m_jobsAdded;
+  std::atomic<bool> m_running;
 };
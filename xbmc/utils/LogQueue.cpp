@@ -0,0 +1,119 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LogQueue.h"
+
+// Bounded queue after Dmitry Vyukov: every cell carries a sequence number
+// telling whether it is free for the producer at a given position or holds
+// data for the consumer at that position.
+
+CLogQueue::CLogQueue(size_t capacity, size_t maxBytes)
+  : m_mask(0)
+  , m_maxBytes(maxBytes)
+  , m_enqueuePos(0)
+  , m_dequeuePos(0)
+  , m_bytes(0)
+  , m_dropped(0)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+
+  m_cells.reset(new Cell[size]);
+  for (size_t i = 0; i < size; i++)
+    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  m_mask = size - 1;
+}
+
+bool CLogQueue::Push(LogEntry &entry, uint64_t *ticket)
+{
+  size_t bytes = entry.message.size() + entry.function.size();
+  if (m_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes > m_maxBytes)
+  {
+    m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    m_dropped++;
+    return false;
+  }
+
+  Cell *cell;
+  uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    cell = &m_cells[pos & m_mask];
+    uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+    int64_t diff = (int64_t)seq - (int64_t)pos;
+    if (diff == 0)
+    {
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // the consumer hasn't freed this cell yet, the queue is full
+      m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+      m_dropped++;
+      return false;
+    }
+    else
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+  }
+
+  cell->entry.level = entry.level;
+  cell->entry.threadId = entry.threadId;
+  cell->entry.time = entry.time;
+  cell->entry.function.swap(entry.function);
+  cell->entry.message.swap(entry.message);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+
+  if (ticket)
+    *ticket = pos;
+  return true;
+}
+
+bool CLogQueue::Pop(LogEntry &entry)
+{
+  uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+  Cell *cell = &m_cells[pos & m_mask];
+  uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+  if ((int64_t)seq - (int64_t)(pos + 1) < 0)
+    return false;
+
+  entry.level = cell->entry.level;
+  entry.threadId = cell->entry.threadId;
+  entry.time = cell->entry.time;
+  entry.function.swap(cell->entry.function);
+  entry.message.swap(cell->entry.message);
+  // the strings handed back to the producer are released by the consumer
+  // so the producers never free memory while holding a cell
+  std::string().swap(cell->entry.function);
+  std::string().swap(cell->entry.message);
+
+  m_bytes.fetch_sub(entry.message.size() + entry.function.size(), std::memory_order_relaxed);
+  cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+  m_dequeuePos.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool CLogQueue::IsEmpty() const
+{
+  uint64_t pos = m_dequeuePos.load(std::memory_order_acquire);
+  uint64_t seq = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+  return (int64_t)seq - (int64_t)(pos + 1) < 0;
+}
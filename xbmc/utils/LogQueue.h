@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+/*!
+ \brief A log line as handed from the logging thread to the log writer.
+ */
+struct LogEntry
+{
+  LogEntry() : level(0), threadId(0), time(0) {}
+
+  int level;            //!< log level, including the component bits
+  uint64_t threadId;
+  int64_t time;         //!< microseconds since the epoch
+  std::string function; //!< optional function name from CLog::LogFunction
+  std::string message;
+};
+
+/*!
+ \brief Bounded lock-free queue of log entries with many producers and one consumer.
+
+ Producers never block or allocate: when all slots are in use or more than
+ the byte budget is queued, the entry is dropped and counted instead.
+ */
+class CLogQueue
+{
+public:
+  /*!
+   \param capacity number of slots, rounded up to a power of two
+   \param maxBytes upper limit for the message text held by the queue
+   */
+  CLogQueue(size_t capacity, size_t maxBytes);
+
+  /*!
+   \brief Move an entry into the queue.
+   \param ticket if not NULL receives the position of the entry, see GetPopped()
+   \return false if the entry was dropped
+   */
+  bool Push(LogEntry &entry, uint64_t *ticket = NULL);
+
+  /*!
+   \brief Take the oldest entry, must only be called from the consumer thread.
+   */
+  bool Pop(LogEntry &entry);
+
+  bool IsEmpty() const;
+
+  /*! \brief Number of entries taken out so far, an entry is out once this exceeds its ticket */
+  uint64_t GetPopped() const { return m_dequeuePos; }
+
+  /*! \brief Number of entries dropped since the last call */
+  unsigned int TakeDropped() { return m_dropped.exchange(0); }
+
+private:
+  CLogQueue(const CLogQueue&);
+  CLogQueue& operator=(const CLogQueue&);
+
+  struct Cell
+  {
+    std::atomic<uint64_t> sequence;
+    LogEntry entry;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  uint64_t m_mask;
+  size_t m_maxBytes;
+  std::atomic<uint64_t> m_enqueuePos;
+  std::atomic<uint64_t> m_dequeuePos;
+  std::atomic<size_t> m_bytes;
+  std::atomic<unsigned int> m_dropped;
+};
@@ -0,0 +1,102 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SIMDKernels.h"
+#include "utils/CPUInfo.h"
+
+const char* CSIMDKernels::GetImplementationName(Implementation impl)
+{
+  switch (impl)
+  {
+  case IMPL_SSE:
+    return "SSE";
+  case IMPL_SSE2:
+    return "SSE2";
+  case IMPL_AVX2:
+    return "AVX2";
+  case IMPL_NEON:
+    return "NEON";
+  default:
+    return "C";
+  }
+}
+
+CSIMDKernels::Implementation CSIMDDispatch::Get()
+{
+  int impl = m_implementation;
+  if (impl < 0)
+  {
+    impl = GetBest();
+    m_implementation = impl;
+  }
+  return (CSIMDKernels::Implementation)impl;
+}
+
+bool CSIMDDispatch::Set(CSIMDKernels::Implementation impl)
+{
+  if (!IsSupported(impl, g_cpuInfo.GetCPUFeatures()))
+    return false;
+
+  m_implementation = impl;
+  return true;
+}
+
+CSIMDKernels::Implementation CSIMDDispatch::GetBest() const
+{
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  if (IsSupported(CSIMDKernels::IMPL_AVX2, features))
+    return CSIMDKernels::IMPL_AVX2;
+  if (IsSupported(m_x86Level, features))
+    return m_x86Level;
+  if (IsSupported(CSIMDKernels::IMPL_NEON, features))
+    return CSIMDKernels::IMPL_NEON;
+  return CSIMDKernels::IMPL_C;
+}
+
+bool CSIMDDispatch::IsSupported(CSIMDKernels::Implementation impl, unsigned int features) const
+{
+  switch (impl)
+  {
+  case CSIMDKernels::IMPL_C:
+    return true;
+#if defined(HAS_SIMD_SSE)
+  case CSIMDKernels::IMPL_SSE:
+    return m_x86Level == CSIMDKernels::IMPL_SSE && (features & CPU_FEATURE_SSE);
+#endif
+#if defined(HAS_SIMD_SSE2)
+  case CSIMDKernels::IMPL_SSE2:
+    return m_x86Level == CSIMDKernels::IMPL_SSE2 && (features & CPU_FEATURE_SSE2);
+#endif
+#if defined(HAS_SIMD_AVX2)
+  case CSIMDKernels::IMPL_AVX2:
+    return (features & CPU_FEATURE_AVX2) != 0;
+#endif
+#if defined(HAS_SIMD_NEON)
+  case CSIMDKernels::IMPL_NEON:
+  #if defined(__aarch64__)
+    return true;
+  #else
+    return (features & CPU_FEATURE_NEON) != 0;
+  #endif
+#endif
+  default:
+    return false;
+  }
+}
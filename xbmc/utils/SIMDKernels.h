@@ -0,0 +1,98 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #define HAS_SIMD_SSE
+  #define HAS_SIMD_SSE2
+  #if defined(_MSC_VER) || defined(__clang__) || \
+      (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+    #define HAS_SIMD_AVX2
+  #endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+  #define HAS_SIMD_NEON
+#endif
+
+// the vectorised kernels are built without global compiler flags, the
+// function attribute allows the instructions just for the kernel itself
+#if defined(__GNUC__) || defined(__clang__)
+  #define SIMD_TARGET(x) __attribute__((target(x)))
+#else
+  #define SIMD_TARGET(x)
+#endif
+
+/*!
+ \brief Base of kernel classes with a C reference and vectorised implementations.
+ */
+class CSIMDKernels
+{
+public:
+  enum Implementation
+  {
+    IMPL_C = 0,
+    IMPL_SSE,
+    IMPL_SSE2,
+    IMPL_AVX2,
+    IMPL_NEON
+  };
+
+  static const char* GetImplementationName(Implementation impl);
+};
+
+/*!
+ \brief Picks the implementation of a set of kernels from the features reported by CCPUInfo.
+
+ On x86 a set of kernels has either SSE or SSE2 versions, next to AVX2 ones.
+ Until an implementation is forced the best one for this cpu is used.
+ */
+class CSIMDDispatch
+{
+public:
+  /*!
+   \param x86Level the SSE implementation the kernels have, IMPL_SSE or IMPL_SSE2
+   */
+  constexpr explicit CSIMDDispatch(CSIMDKernels::Implementation x86Level)
+    : m_x86Level(x86Level),
+      m_implementation(-1)
+  {
+  }
+
+  /*! \brief The implementation to use, the best one unless another was forced */
+  CSIMDKernels::Implementation Get();
+
+  /*!
+   \brief Force an implementation, for testing and benchmarking.
+   \return false if the cpu, the build or the kernels do not support it
+   */
+  bool Set(CSIMDKernels::Implementation impl);
+
+  /*! \brief Best implementation supported by this cpu */
+  CSIMDKernels::Implementation GetBest() const;
+
+private:
+  bool IsSupported(CSIMDKernels::Implementation impl, unsigned int features) const;
+
+  const CSIMDKernels::Implementation m_x86Level;
+  std::atomic<int> m_implementation;
+};
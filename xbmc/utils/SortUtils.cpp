@@ -28,6 +28,8 @@
 #include "utils/Variant.h"
 
 #include <algorithm>
+#include <locale>
+#include <unordered_map>
 
 std::string ArrayToString(SortAttribute attributes, const CVariant &variant, const std::string &seperator = " / ")
 {
@@ -416,130 +418,267 @@ std::string ByLastUsed(SortAttribute attributes, const SortItem &values)
   return values.at(FieldLastUsed).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+namespace
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
+
+/*!
+ \brief Sort order of a set of rows, computed from precomputed keys.
+
+ Instead of looking up FieldSort, FieldSortSpecial and FieldFolder and
+ collating through the locale in every comparison, this is done once per
+ row: labels are interned so
+ that rows with the same label share a key, and every character of a key is
+ replaced by its rank in the collation order of the system locale. Comparing
+ two keys is then StringUtils::AlphaNumericCompare on plain integers.
+ */
+class CSortKeys
+{
+public:
+  CSortKeys(SortUtils::SortPreparator preparator, const Fields &sortingFields, SortAttribute attributes, size_t rows)
+    : m_preparator(preparator),
+      m_sortingFields(sortingFields),
+      m_attributes(attributes),
+      m_descending(false),
+      m_handleFolder(true)
   {
-    result = false;
-    return true;
+    m_rows.reserve(rows);
   }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+
+  /*!
+   \brief Add the next row. Fields required for sorting that are missing
+          are added to the item as null values.
+   */
+  void Add(SortItem &item)
   {
-    result = true;
-    return true;
+    for (Fields::const_iterator field = m_sortingFields.begin(); field != m_sortingFields.end(); ++field)
+    {
+      if (item.find(*field) == item.end())
+        item.insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+    }
+
+    Row row;
+    SortItem::const_iterator it = item.find(FieldSort);
+    if (it != item.end())
+    {
+      row.label = m_labels.size();
+      m_labels.push_back(it->second.asWideString());
+    }
+    else
+    {
+      std::pair<std::unordered_map<std::string, size_t>::iterator, bool> label =
+        m_labelIds.insert(std::make_pair(m_preparator(m_attributes, item), m_labels.size()));
+      if (label.second)
+      {
+        std::wstring sortLabel;
+        g_charsetConverter.utf8ToW(label.first->first, sortLabel, false);
+        m_labels.push_back(sortLabel);
+      }
+      row.label = label.first->second;
+    }
+
+    row.special = SortSpecialNone;
+    if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+      row.special = (int)it->second.asInteger();
+
+    row.folder = -1;
+    if ((it = item.find(FieldFolder)) != item.end())
+      row.folder = it->second.asBoolean() ? 1 : 0;
+
+    m_rows.push_back(row);
   }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+  const std::wstring& GetLabel(size_t row) const { return m_labels[m_rows[row].label]; }
+
+  /*!
+   \brief Get the rows in sorted order.
+
+   Only the rows in the range [first, last) of the sorted order are returned,
+   and only those are fully sorted. Rows comparing equal keep their original
+   order.
+   */
+  void GetOrder(SortOrder sortOrder, size_t first, size_t last, std::vector<unsigned int> &order)
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    BuildKeys();
+
+    m_descending = sortOrder == SortOrderDescending;
+    m_handleFolder = !(m_attributes & SortAttributeIgnoreFolders);
+
+    order.resize(m_rows.size());
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+
+    if (first >= last)
     {
-      result = true;
-      return true;
+      order.clear();
+      return;
+    }
+
+    Comparator less(*this);
+    if (first == 0 && last == order.size())
+      std::sort(order.begin(), order.end(), less);
+    else
+    {
+      if (first > 0)
+        std::nth_element(order.begin(), order.begin() + first, order.end(), less);
+      std::partial_sort(order.begin() + first, order.begin() + last, order.end(), less);
+      order.erase(order.begin() + last, order.end());
+      order.erase(order.begin(), order.begin() + first);
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
   }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
+
+private:
+  struct Row
   {
-    result = false;
-    return true;
-  }
+    size_t label;
+    int special;
+    int folder;
+  };
+
+  // key values are the collation rank of a character shifted by KEY_SHIFT,
+  // digits are flagged and carry their value for the numerical comparison
+  static const uint32_t KEY_DIGIT = 0x10;
+  static const uint32_t KEY_DIGIT_VALUE = 0x0f;
+  static const int KEY_SHIFT = 5;
+
+  struct Comparator
+  {
+    explicit Comparator(const CSortKeys &keys) : m_keys(keys) { }
+    bool operator()(unsigned int left, unsigned int right) const { return m_keys.Less(left, right); }
+    const CSortKeys &m_keys;
+  };
 
-  if (handleFolder)
+  static wchar_t ToLower(wchar_t c)
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
-    {
-      result = itLeft->second.asBoolean();
-      return true;
-    }
+    if (c >= L'A' && c <= L'Z')
+      c += L'a' - L'A';
+    return c;
   }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+  void BuildKeys()
+  {
+    const std::collate<wchar_t>& coll = std::use_facet<std::collate<wchar_t> >(g_langInfo.GetSystemLocale());
 
-  return false;
-}
+    // rank every character used in the labels by the collation order
+    std::vector<wchar_t> chars;
+    for (std::vector<std::wstring>::const_iterator label = m_labels.begin(); label != m_labels.end(); ++label)
+    {
+      for (std::wstring::const_iterator c = label->begin(); c != label->end(); ++c)
+        chars.push_back(ToLower(*c));
+    }
+    std::sort(chars.begin(), chars.end());
+    chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+    std::stable_sort(chars.begin(), chars.end(), [&coll](wchar_t left, wchar_t right)
+    {
+      return coll.compare(&left, &left + 1, &right, &right + 1) < 0;
+    });
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+    std::unordered_map<wchar_t, uint32_t> ranks;
+    uint32_t rank = 1;
+    for (size_t i = 0; i < chars.size(); i++)
+    {
+      if (i > 0 && coll.compare(&chars[i - 1], &chars[i - 1] + 1, &chars[i], &chars[i] + 1) != 0)
+        rank++;
+      ranks[chars[i]] = rank;
+    }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+    // zero terminated keys, stored back to back
+    m_keyOffsets.resize(m_labels.size());
+    m_keys.clear();
+    for (size_t i = 0; i < m_labels.size(); i++)
+    {
+      m_keyOffsets[i] = m_keys.size();
+      const std::wstring &label = m_labels[i];
+      for (std::wstring::const_iterator c = label.begin(); c != label.end(); ++c)
+      {
+        if (*c == 0)
+          break;
+        uint32_t key = ranks[ToLower(*c)] << KEY_SHIFT;
+        if (*c >= L'0' && *c <= L'9')
+          key |= KEY_DIGIT | (*c - L'0');
+        m_keys.push_back(key);
+      }
+      m_keys.push_back(0);
+    }
+  }
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  int CompareKeys(size_t left, size_t right) const
+  {
+    if (left == right)
+      return 0;
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+    const uint32_t *l = &m_keys[m_keyOffsets[left]];
+    const uint32_t *r = &m_keys[m_keyOffsets[right]];
+    while (*l != 0 && *r != 0)
+    {
+      // check if we have a numerical value
+      if ((*l & KEY_DIGIT) && (*r & KEY_DIGIT))
+      {
+        const uint32_t *ld = l;
+        int64_t lnum = 0;
+        while ((*ld & KEY_DIGIT) && ld < l + 15)
+          lnum = lnum * 10 + (*ld++ & KEY_DIGIT_VALUE);
+        const uint32_t *rd = r;
+        int64_t rnum = 0;
+        while ((*rd & KEY_DIGIT) && rd < r + 15)
+          rnum = rnum * 10 + (*rd++ & KEY_DIGIT_VALUE);
+        if (lnum != rnum)
+          return lnum < rnum ? -1 : 1;
+        l = ld;
+        r = rd;
+        continue;
+      }
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+      uint32_t lc = *l >> KEY_SHIFT;
+      uint32_t rc = *r >> KEY_SHIFT;
+      if (lc != rc)
+        return lc < rc ? -1 : 1;
+      l++; r++;
+    }
+    if (*r)
+      return -1;
+    if (*l)
+      return 1;
+    return 0;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  bool Less(unsigned int left, unsigned int right) const
+  {
+    const Row &l = m_rows[left];
+    const Row &r = m_rows[right];
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+    // one has a special sort: left is sorted above right if it should be
+    // sorted on top or right should be sorted on bottom
+    if (l.special != r.special)
+      return l.special == SortSpecialOnTop || r.special == SortSpecialOnBottom;
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+    // both have either sort on top or sort on bottom -> leave as-is
+    if (l.special == SortSpecialNone)
+    {
+      if (m_handleFolder && l.folder >= 0 && r.folder >= 0 && l.folder != r.folder)
+        return l.folder > r.folder;
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterAscending(*left, *right);
-}
+      int result = CompareKeys(l.label, r.label);
+      if (result != 0)
+        return m_descending ? result > 0 : result < 0;
+    }
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterDescending(*left, *right);
-}
+    // keep the original order, like a stable sort
+    return left < right;
+  }
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersAscending(*left, *right);
-}
+  SortUtils::SortPreparator m_preparator;
+  const Fields &m_sortingFields;
+  SortAttribute m_attributes;
+  bool m_descending;
+  bool m_handleFolder;
+
+  std::vector<Row> m_rows;
+  std::vector<std::wstring> m_labels;
+  std::unordered_map<std::string, size_t> m_labelIds;
+  std::vector<size_t> m_keyOffsets;
+  std::vector<uint32_t> m_keys;
+};
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersDescending(*left, *right);
 }
 
 std::map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -691,80 +830,107 @@ std::map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
-  if (sortBy != SortByNone)
+  if (sortBy != SortByNone && getPreparator(sortBy) != NULL)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    CSortKeys keys(getPreparator(sortBy), GetFieldsForSorting(sortBy), attributes, items.size());
+    for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
+      keys.Add(*item);
+
+    size_t first, last;
+    GetLimits(items.size(), limitEnd, limitStart, first, last);
+    std::vector<unsigned int> order;
+    keys.GetOrder(sortOrder, first, last, order);
+
+    // store the string used for sorting under FieldSort, only for the rows left
+    DatabaseResults sorted;
+    sorted.reserve(order.size());
+    for (std::vector<unsigned int>::const_iterator row = order.begin(); row != order.end(); ++row)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+      items[*row].insert(std::pair<Field, CVariant>(FieldSort, CVariant(keys.GetLabel(*row))));
+      sorted.push_back(std::move(items[*row]));
     }
+    items.swap(sorted);
+    return;
   }
 
-  if (limitStart > 0 && (size_t)limitStart < items.size())
-  {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
-  }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
+  size_t first, last;
+  GetLimits(items.size(), limitEnd, limitStart, first, last);
+  items.erase(items.begin() + last, items.end());
+  items.erase(items.begin(), items.begin() + first);
 }
 
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
-  if (sortBy != SortByNone)
+  if (sortBy != SortByNone && getPreparator(sortBy) != NULL)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    CSortKeys keys(getPreparator(sortBy), GetFieldsForSorting(sortBy), attributes, items.size());
+    for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
+      keys.Add(**item);
+
+    size_t first, last;
+    GetLimits(items.size(), limitEnd, limitStart, first, last);
+    std::vector<unsigned int> order;
+    keys.GetOrder(sortOrder, first, last, order);
+
+    SortItems sorted;
+    sorted.reserve(order.size());
+    for (std::vector<unsigned int>::const_iterator row = order.begin(); row != order.end(); ++row)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      items[*row]->insert(std::pair<Field, CVariant>(FieldSort, CVariant(keys.GetLabel(*row))));
+      sorted.push_back(items[*row]);
+    }
+    items.swap(sorted);
+    return;
+  }
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
+  size_t first, last;
+  GetLimits(items.size(), limitEnd, limitStart, first, last);
+  items.erase(items.begin() + last, items.end());
+  items.erase(items.begin(), items.begin() + first);
+}
 
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-        (*item)->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
+void SortUtils::Sort(const SortDescription &sortDescription, const DatabaseResultColumns &columns, DatabaseResults& items)
+{
+  items.clear();
+
+  size_t first, last;
+  GetLimits(columns.GetRowCount(), sortDescription.limitEnd, sortDescription.limitStart, first, last);
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+  std::vector<unsigned int> order;
+  const Fields &sortingFields = GetFieldsForSorting(sortDescription.sortBy);
+  CSortKeys keys(getPreparator(sortDescription.sortBy), sortingFields, sortDescription.sortAttributes, columns.GetRowCount());
+  bool sort = sortDescription.sortBy != SortByNone && getPreparator(sortDescription.sortBy) != NULL;
+  if (sort)
+  {
+    // a single result is reused to prepare the sort labels of all rows
+    DatabaseResult item;
+    for (size_t row = 0; row < columns.GetRowCount(); row++)
+    {
+      columns.GetRow(row, item);
+      keys.Add(item);
     }
+
+    keys.GetOrder(sortDescription.sortOrder, first, last, order);
+  }
+  else
+  {
+    for (size_t row = first; row < last; row++)
+      order.push_back(row);
   }
 
-  if (limitStart > 0 && (size_t)limitStart < items.size())
+  // only the rows left after sorting are turned into a DatabaseResult
+  items.resize(order.size());
+  for (size_t i = 0; i < order.size(); i++)
   {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
+    DatabaseResult &item = items[i];
+    columns.GetRow(order[i], item);
+    if (sort)
+    {
+      for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
+        item.insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+      item.insert(std::pair<Field, CVariant>(FieldSort, CVariant(keys.GetLabel(order[i]))));
+    }
   }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
 }
 
 void SortUtils::Sort(const SortDescription &sortDescription, DatabaseResults& items)
@@ -783,7 +949,8 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const Me
   if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), mediaType, fields))
     fields.clear();
 
-  if (!DatabaseUtils::GetDatabaseResults(mediaType, fields, dataset, results))
+  DatabaseResultColumns columns;
+  if (!DatabaseUtils::GetDatabaseColumns(mediaType, fields, dataset, columns))
     return false;
 
   SortDescription sorting = sortDescription;
@@ -793,7 +960,7 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const Me
     sorting.limitEnd = -1;
   }
 
-  Sort(sorting, results);
+  Sort(sorting, columns, results);
 
   return true;
 }
@@ -807,20 +974,17 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
+void SortUtils::GetLimits(size_t count, int limitEnd, int limitStart, size_t &first, size_t &last)
 {
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
+  first = 0;
+  last = count;
+  if (limitStart > 0 && (size_t)limitStart < count)
+  {
+    first = limitStart;
+    limitEnd -= limitStart;
+  }
+  if (limitEnd > 0 && (size_t)limitEnd < last - first)
+    last = first + limitEnd;
 }
 
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
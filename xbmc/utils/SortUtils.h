@@ -210,19 +210,26 @@ public:
   static void Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd = -1, int limitStart = 0);
   static void Sort(const SortDescription &sortDescription, DatabaseResults& items);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
+  /*!
+   \brief Sort the rows of a library query and retrieve those between the limits.
+
+   Only the rows within the limits are sorted completely and turned into a
+   DatabaseResult, FieldRow holds the index of the row in columns.
+   \param items replaced by the sorted rows
+   */
+  static void Sort(const SortDescription &sortDescription, const DatabaseResultColumns &columns, DatabaseResults& items);
   static bool SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
   
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
   
   typedef std::string (*SortPreparator) (SortAttribute, const SortItem&);
-  typedef bool (*Sorter) (const DatabaseResult &, const DatabaseResult &);
-  typedef bool (*SorterIndirect) (const SortItemPtr &, const SortItemPtr &);
   
 private:
   static const SortPreparator& getPreparator(SortBy sortBy);
-  static Sorter getSorter(SortOrder sortOrder, SortAttribute attributes);
-  static SorterIndirect getSorterIndirect(SortOrder sortOrder, SortAttribute attributes);
+
+  /*! \brief Range [first, last) of count items left by the limits, as applied after sorting */
+  static void GetLimits(size_t count, int limitEnd, int limitStart, size_t &first, size_t &last);
 
   static std::map<SortBy, SortPreparator> m_preparators;
   static std::map<SortBy, Fields> m_sortingFields;
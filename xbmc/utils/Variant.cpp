@@ -20,6 +20,7 @@
 
 #include "Variant.h"
 
+#include <new>
 #include <stdlib.h>
 #include <string.h>
 #include <sstream>
@@ -150,19 +151,19 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new std::string();
+      new (&m_data.string) std::string();
       break;
     case VariantTypeWideString:
-      m_data.wstring = new std::wstring();
+      new (&m_data.wstring) std::wstring();
       break;
     case VariantTypeArray:
-      m_data.array = new VariantArray();
+      new (&m_data.array) VariantArray();
       break;
     case VariantTypeObject:
       m_data.map = new VariantMap();
       break;
     default:
-      memset(&m_data, 0, sizeof(m_data));
+      m_data.integer = 0;
       break;
   }
 }
@@ -212,58 +213,58 @@ CVariant::CVariant(bool boolean)
 CVariant::CVariant(const char *str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  new (&m_data.string) std::string(str);
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str, length);
+  new (&m_data.string) std::string(str, length);
 }
 
 CVariant::CVariant(const std::string &str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  new (&m_data.string) std::string(str);
 }
 
 CVariant::CVariant(std::string &&str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(std::move(str));
+  new (&m_data.string) std::string(std::move(str));
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str);
+  new (&m_data.wstring) std::wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str, length);
+  new (&m_data.wstring) std::wstring(str, length);
 }
 
 CVariant::CVariant(const std::wstring &str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str);
+  new (&m_data.wstring) std::wstring(str);
 }
 
 CVariant::CVariant(std::wstring &&str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(std::move(str));
+  new (&m_data.wstring) std::wstring(std::move(str));
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
 {
   m_type = VariantTypeArray;
-  m_data.array = new VariantArray;
-  m_data.array->reserve(strArray.size());
+  new (&m_data.array) VariantArray();
+  m_data.array.reserve(strArray.size());
   for (const auto& item : strArray)
-    m_data.array->push_back(CVariant(item));
+    m_data.array.push_back(CVariant(item));
 }
 
 CVariant::CVariant(const std::map<std::string, std::string> &strMap)
@@ -282,17 +283,12 @@ CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 
 CVariant::CVariant(const CVariant &variant)
 {
-  m_type = VariantTypeNull;
-  *this = variant;
+  construct(variant);
 }
 
-CVariant::CVariant(CVariant&& rhs)
+CVariant::CVariant(CVariant&& rhs) noexcept
 {
-  //Set this so that operator= don't try and run cleanup
-  //when we're not initialized.
-  m_type = VariantTypeNull;
-
-  *this = std::move(rhs);
+  construct(std::move(rhs));
 }
 
 CVariant::~CVariant()
@@ -303,16 +299,81 @@ CVariant::~CVariant()
 void CVariant::cleanup()
 {
   if (m_type == VariantTypeString)
-    delete m_data.string;
+    m_data.string.~basic_string();
   else if (m_type == VariantTypeWideString)
-    delete m_data.wstring;
+    m_data.wstring.~basic_string();
   else if (m_type == VariantTypeArray)
-    delete m_data.array;
+    m_data.array.~VariantArray();
   else if (m_type == VariantTypeObject)
     delete m_data.map;
   m_type = VariantTypeNull;
 }
 
+void CVariant::construct(const CVariant &rhs)
+{
+  m_type = rhs.m_type;
+
+  switch (m_type)
+  {
+  case VariantTypeInteger:
+    m_data.integer = rhs.m_data.integer;
+    break;
+  case VariantTypeUnsignedInteger:
+    m_data.unsignedinteger = rhs.m_data.unsignedinteger;
+    break;
+  case VariantTypeBoolean:
+    m_data.boolean = rhs.m_data.boolean;
+    break;
+  case VariantTypeDouble:
+    m_data.dvalue = rhs.m_data.dvalue;
+    break;
+  case VariantTypeString:
+    new (&m_data.string) std::string(rhs.m_data.string);
+    break;
+  case VariantTypeWideString:
+    new (&m_data.wstring) std::wstring(rhs.m_data.wstring);
+    break;
+  case VariantTypeArray:
+    new (&m_data.array) VariantArray(rhs.m_data.array);
+    break;
+  case VariantTypeObject:
+    m_data.map = new VariantMap(*rhs.m_data.map);
+    break;
+  default:
+    m_data.integer = 0;
+    break;
+  }
+}
+
+void CVariant::construct(CVariant &&rhs) noexcept
+{
+  m_type = rhs.m_type;
+
+  switch (m_type)
+  {
+  case VariantTypeString:
+    new (&m_data.string) std::string(std::move(rhs.m_data.string));
+    break;
+  case VariantTypeWideString:
+    new (&m_data.wstring) std::wstring(std::move(rhs.m_data.wstring));
+    break;
+  case VariantTypeArray:
+    new (&m_data.array) VariantArray(std::move(rhs.m_data.array));
+    break;
+  case VariantTypeObject:
+    m_data.map = rhs.m_data.map;
+    rhs.m_type = VariantTypeNull;
+    break;
+  default:
+    // all other types are plain values
+    m_data.dvalue = rhs.m_data.dvalue;
+    break;
+  }
+
+  if (rhs.m_type != VariantTypeConstNull)
+    rhs.cleanup();
+}
+
 bool CVariant::isInteger() const
 {
   return m_type == VariantTypeInteger;
@@ -374,9 +435,9 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2int64(*m_data.wstring, fallback);
+      return str2int64(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -395,9 +456,9 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2uint64(*m_data.wstring, fallback);
+      return str2uint64(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -416,9 +477,9 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2double(*m_data.wstring, fallback);
+      return str2double(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -437,9 +498,9 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(m_data.string, fallback);
     case VariantTypeWideString:
-      return (float)str2double(*m_data.wstring, fallback);
+      return (float)str2double(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -460,11 +521,11 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+      if (m_data.string.empty() || m_data.string.compare("0") == 0 || m_data.string.compare("false") == 0)
         return false;
       return true;
     case VariantTypeWideString:
-      if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
+      if (m_data.wstring.empty() || m_data.wstring.compare(L"0") == 0 || m_data.wstring.compare(L"false") == 0)
         return false;
       return true;
     default:
@@ -479,7 +540,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return m_data.string;
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -507,7 +568,7 @@ std::wstring CVariant::asWideString(const std::wstring &fallback /* = L"" */) co
   switch (m_type)
   {
     case VariantTypeWideString:
-      return *m_data.wstring;
+      return m_data.wstring;
     case VariantTypeBoolean:
       return m_data.boolean ? L"true" : L"false";
     case VariantTypeInteger:
@@ -556,7 +617,7 @@ const CVariant &CVariant::operator[](const std::string &key) const
 CVariant &CVariant::operator[](unsigned int position)
 {
   if (m_type == VariantTypeArray && size() > position)
-    return m_data.array->at(position);
+    return m_data.array.at(position);
   else
     return ConstNullVariant;
 }
@@ -564,7 +625,7 @@ CVariant &CVariant::operator[](unsigned int position)
 const CVariant &CVariant::operator[](unsigned int position) const
 {
   if (m_type == VariantTypeArray && size() > position)
-    return m_data.array->at(position);
+    return m_data.array.at(position);
   else
     return ConstNullVariant;
 }
@@ -574,67 +635,22 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
+  // rhs may be part of this variant, so it's copied before anything is released
+  CVariant copy(rhs);
   cleanup();
-
-  m_type = rhs.m_type;
-
-  switch (m_type)
-  {
-  case VariantTypeInteger:
-    m_data.integer = rhs.m_data.integer;
-    break;
-  case VariantTypeUnsignedInteger:
-    m_data.unsignedinteger = rhs.m_data.unsignedinteger;
-    break;
-  case VariantTypeBoolean:
-    m_data.boolean = rhs.m_data.boolean;
-    break;
-  case VariantTypeDouble:
-    m_data.dvalue = rhs.m_data.dvalue;
-    break;
-  case VariantTypeString:
-    m_data.string = new std::string(*rhs.m_data.string);
-    break;
-  case VariantTypeWideString:
-    m_data.wstring = new std::wstring(*rhs.m_data.wstring);
-    break;
-  case VariantTypeArray:
-    m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
-    break;
-  case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
-    break;
-  default:
-    break;
-  }
+  construct(std::move(copy));
 
   return *this;
 }
 
-CVariant& CVariant::operator=(CVariant&& rhs)
+CVariant& CVariant::operator=(CVariant&& rhs) noexcept
 {
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
-  //Make sure that if we're moved into we don't leak any pointers
-  if (m_type != VariantTypeNull)
-    cleanup();
-
-  m_type = rhs.m_type;
-  m_data = std::move(rhs.m_data);
-
-  //Should be enough to just set m_type here
-  //but better safe than sorry, could probably lead to coverity warnings
-  if (rhs.m_type == VariantTypeString)
-    rhs.m_data.string = nullptr;
-  else if (rhs.m_type == VariantTypeWideString)
-    rhs.m_data.wstring = nullptr;
-  else if (rhs.m_type == VariantTypeArray)
-    rhs.m_data.array = nullptr;
-  else if (rhs.m_type == VariantTypeObject)
-    rhs.m_data.map = nullptr;
-
-  rhs.m_type = VariantTypeNull;
+  CVariant moved(std::move(rhs));
+  cleanup();
+  construct(std::move(moved));
 
   return *this;
 }
@@ -654,11 +670,11 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return m_data.string == rhs.m_data.string;
     case VariantTypeWideString:
-      return *m_data.wstring == *rhs.m_data.wstring;
+      return m_data.wstring == rhs.m_data.wstring;
     case VariantTypeArray:
-      return *m_data.array == *rhs.m_data.array;
+      return m_data.array == rhs.m_data.array;
     case VariantTypeObject:
       return *m_data.map == *rhs.m_data.map;
     default:
@@ -674,11 +690,11 @@ void CVariant::push_back(const CVariant &variant)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray();
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(variant);
+    m_data.array.push_back(variant);
 }
 
 void CVariant::push_back(CVariant &&variant)
@@ -686,11 +702,11 @@ void CVariant::push_back(CVariant &&variant)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray();
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(std::move(variant));
+    m_data.array.push_back(std::move(variant));
 }
 
 void CVariant::append(const CVariant &variant)
@@ -706,27 +722,27 @@ void CVariant::append(CVariant&& variant)
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return m_data.string.c_str();
   else
     return NULL;
 }
 
-void CVariant::swap(CVariant &rhs)
+void CVariant::swap(CVariant &rhs) noexcept
 {
-  VariantType  temp_type = m_type;
-  VariantUnion temp_data = m_data;
+  if (this == &rhs)
+    return;
 
-  m_type = rhs.m_type;
-  m_data = rhs.m_data;
-
-  rhs.m_type = temp_type;
-  rhs.m_data = temp_data;
+  CVariant temp(std::move(rhs));
+  rhs.cleanup();
+  rhs.construct(std::move(*this));
+  cleanup();
+  construct(std::move(temp));
 }
 
 CVariant::iterator_array CVariant::begin_array()
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->begin();
+    return m_data.array.begin();
   else
     return iterator_array();
 }
@@ -734,7 +750,7 @@ CVariant::iterator_array CVariant::begin_array()
 CVariant::const_iterator_array CVariant::begin_array() const
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->begin();
+    return m_data.array.begin();
   else
     return const_iterator_array();
 }
@@ -742,7 +758,7 @@ CVariant::const_iterator_array CVariant::begin_array() const
 CVariant::iterator_array CVariant::end_array()
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->end();
+    return m_data.array.end();
   else
     return iterator_array();
 }
@@ -750,7 +766,7 @@ CVariant::iterator_array CVariant::end_array()
 CVariant::const_iterator_array CVariant::end_array() const
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->end();
+    return m_data.array.end();
   else
     return const_iterator_array();
 }
@@ -792,11 +808,11 @@ unsigned int CVariant::size() const
   if (m_type == VariantTypeObject)
     return m_data.map->size();
   else if (m_type == VariantTypeArray)
-    return m_data.array->size();
+    return m_data.array.size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return m_data.string.size();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->size();
+    return m_data.wstring.size();
   else
     return 0;
 }
@@ -806,11 +822,11 @@ bool CVariant::empty() const
   if (m_type == VariantTypeObject)
     return m_data.map->empty();
   else if (m_type == VariantTypeArray)
-    return m_data.array->empty();
+    return m_data.array.empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return m_data.string.empty();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->empty();
+    return m_data.wstring.empty();
   else if (m_type == VariantTypeNull)
     return true;
 
@@ -822,11 +838,11 @@ void CVariant::clear()
   if (m_type == VariantTypeObject)
     m_data.map->clear();
   else if (m_type == VariantTypeArray)
-    m_data.array->clear();
+    m_data.array.clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+    m_data.string.clear();
   else if (m_type == VariantTypeWideString)
-    m_data.wstring->clear();
+    m_data.wstring.clear();
 }
 
 void CVariant::erase(const std::string &key)
@@ -845,11 +861,11 @@ void CVariant::erase(unsigned int position)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray();
   }
 
   if (m_type == VariantTypeArray && position < size())
-    m_data.array->erase(m_data.array->begin() + position);
+    m_data.array.erase(m_data.array.begin() + position);
 }
 
 bool CVariant::isMember(const std::string &key) const
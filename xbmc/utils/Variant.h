@@ -68,7 +68,7 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
-  CVariant(CVariant &&rhs);
+  CVariant(CVariant &&rhs) noexcept;
   ~CVariant();
 
 
@@ -99,7 +99,7 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
-  CVariant &operator=(CVariant &&rhs);
+  CVariant &operator=(CVariant &&rhs) noexcept;
   bool operator==(const CVariant &rhs) const;
   bool operator!=(const CVariant &rhs) const { return !(*this == rhs); }
 
@@ -110,7 +110,7 @@ public:
 
   const char *c_str() const;
 
-  void swap(CVariant &rhs);
+  void swap(CVariant &rhs) noexcept;
 
 private:
   typedef std::vector<CVariant> VariantArray;
@@ -145,15 +145,28 @@ public:
 
 private:
   void cleanup();
+  void construct(const CVariant &rhs);
+  void construct(CVariant &&rhs) noexcept;
+
+  /*!
+   Strings and arrays live in the variant itself instead of being allocated
+   separately, so a string value costs no allocation of its own and short
+   strings none at all. Objects stay behind a pointer: their members must
+   keep their address when other members are added, which is relied upon
+   throughout (e.g. obj["a"] = obj["b"]["c"]).
+   */
   union VariantUnion
   {
+    VariantUnion() { }
+    ~VariantUnion() { }
+
     int64_t integer;
     uint64_t unsignedinteger;
     bool boolean;
     double dvalue;
-    std::string *string;
-    std::wstring *wstring;
-    VariantArray *array;
+    std::string string;
+    std::wstring wstring;
+    VariantArray array;
     VariantMap *map;
   };
 
@@ -20,11 +20,19 @@
 
 #include "log.h"
 #include "system.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
+#include "utils/LogQueue.h"
 #include "utils/StringUtils.h"
 #include "CompileInfo.h"
 
+#include <chrono>
+
+#ifdef TARGET_POSIX
+#include "linux/XTimeUtils.h"
+#endif
+
 static const char* const levelNames[] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
@@ -32,20 +40,126 @@ static const char* const levelNames[] =
 static const char* const logLevelNames[] =
 { "LOG_LEVEL_NONE" /*-1*/, "LOG_LEVEL_NORMAL" /*0*/, "LOG_LEVEL_DEBUG" /*1*/, "LOG_LEVEL_DEBUG_FREEMEM" /*2*/ };
 
+// names of the component bits above LOGMASKBIT, used as tags in JSON output
+static const char* const componentNames[] =
+{ "samba", "curl", "ffmpeg", NULL, "dbus", "jsonrpc", "audio", "airtunes", "upnp", "cec", "video", "webserver" };
+
+// the background writer holds at most this many lines and bytes of text,
+// anything beyond is dropped and counted rather than blocking the caller
+#define LOG_QUEUE_LINES 8192
+#define LOG_QUEUE_BYTES (4 * 1024 * 1024)
+
+// text is collected and handed to the platform in chunks of this size
+#define LOG_WRITE_CHUNK (64 * 1024)
+
 // s_globals is used as static global with CLog global variables
 #define s_globals XBMC_GLOBAL_USE(CLog).m_globalInstance
 
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter()
+    : CThread("LogWriter")
+    , m_queue(LOG_QUEUE_LINES, LOG_QUEUE_BYTES)
+    , m_sleeping(false)
+    , m_written(0)
+  {
+  }
+
+  bool Push(LogEntry& entry, uint64_t* ticket)
+  {
+    if (!m_queue.Push(entry, ticket))
+      return false;
+
+    // pairs with the fence in Process(), either we see the writer going to
+    // sleep or it sees the new entry
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed) && m_sleeping.exchange(false))
+      m_wake.Set();
+    return true;
+  }
+
+  /*!
+   \brief Wait until the entry with the given ticket is written, at most about a second.
+   */
+  void WaitWritten(uint64_t ticket)
+  {
+    for (int i = 0; i < 100 && m_written <= ticket && IsRunning(); i++)
+    {
+      m_wake.Set();
+      m_writtenEvent.WaitMSec(10);
+    }
+  }
+
+  uint64_t GetQueued() const { return m_queue.GetPopped(); }
+
+  /*!
+   \brief Write everything queued, must be called from the writer thread or
+   once it has stopped.
+   */
+  void Drain()
+  {
+    CSingleLock lock(s_globals.critSec);
+
+    unsigned int dropped = m_queue.TakeDropped();
+    if (dropped)
+    {
+      s_globals.m_dropped += dropped;
+      LogEntry entry;
+      entry.level = LOGWARNING;
+      entry.threadId = (uint64_t)CThread::GetCurrentThreadId();
+      entry.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+      entry.message = StringUtils::Format("Log queue full, %u lines dropped", dropped);
+      CLog::WriteEntry(entry);
+    }
+
+    while (m_queue.Pop(m_entry))
+      CLog::WriteEntry(m_entry);
+
+    CLog::WriteLogString(LogEntry()); // flush what WriteEntry collected
+    m_written = m_queue.GetPopped();
+    m_writtenEvent.Set();
+  }
+
+protected:
+  void Process() override
+  {
+    while (!m_bStop)
+    {
+      Drain();
+
+      m_sleeping = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_queue.IsEmpty())
+        AbortableWait(m_wake);
+      m_sleeping = false;
+    }
+  }
+
+  CLogQueue m_queue;
+  LogEntry m_entry;
+  std::atomic<bool> m_sleeping;
+  std::atomic<uint64_t> m_written;
+  CEvent m_wake;
+  CEvent m_writtenEvent;
+};
+
 CLog::CLog()
 {}
 
 CLog::~CLog()
-{}
+{
+  StopWriter();
+}
 
 void CLog::Close()
 {
+  StopWriter();
+
   CSingleLock waitLock(s_globals.critSec);
   s_globals.m_platform.CloseLogFile();
   s_globals.m_repeatLine.clear();
+  s_globals.m_open = false;
 }
 
 void CLog::Log(int loglevel, const char *format, ...)
@@ -54,8 +168,9 @@ void CLog::Log(int loglevel, const char *format, ...)
   {
     va_list va;
     va_start(va, format);
-    LogString(loglevel, StringUtils::FormatV(format, va));
+    std::string logString(StringUtils::FormatV(format, va));
     va_end(va);
+    LogString(loglevel, NULL, logString);
   }
 }
 
@@ -63,44 +178,76 @@ void CLog::LogFunction(int loglevel, const char* functionName, const char* forma
 {
   if (IsLogLevelLogged(loglevel))
   {
-    std::string fNameStr;
-    if (functionName && functionName[0])
-      fNameStr.assign(functionName).append(": ");
     va_list va;
     va_start(va, format);
-    LogString(loglevel, fNameStr + StringUtils::FormatV(format, va));
+    std::string logString(StringUtils::FormatV(format, va));
     va_end(va);
+    LogString(loglevel, functionName, logString);
   }
 }
 
-void CLog::LogString(int logLevel, const std::string& logString)
+void CLog::LogString(int logLevel, const char* functionName, std::string& logString)
 {
-  CSingleLock waitLock(s_globals.critSec);
-  std::string strData(logString);
-  StringUtils::TrimRight(strData);
-  if (!strData.empty())
+  LogEntry entry;
+  entry.level = logLevel;
+  entry.threadId = (uint64_t)CThread::GetCurrentThreadId();
+  entry.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  if (functionName && functionName[0])
+    entry.function = functionName;
+  entry.message.swap(logString);
+
+  // m_users keeps the writer alive until we are done with it, see StopWriter()
+  s_globals.m_users++;
+  CLogWriter* writer = s_globals.m_writer;
+  if (writer)
   {
-    if (s_globals.m_repeatLogLevel == logLevel && s_globals.m_repeatLine == strData)
-    {
-      s_globals.m_repeatCount++;
-      return;
-    }
-    else if (s_globals.m_repeatCount)
-    {
-      std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
-                                                s_globals.m_repeatCount);
-      PrintDebugString(strData2);
-      WriteLogString(s_globals.m_repeatLogLevel, strData2);
-      s_globals.m_repeatCount = 0;
-    }
-    
-    s_globals.m_repeatLine = strData;
-    s_globals.m_repeatLogLevel = logLevel;
+    uint64_t ticket;
+    // make sure the reason for a crash makes it to disk
+    if (writer->Push(entry, &ticket) && (logLevel & LOGMASK) >= LOGSEVERE && !writer->IsCurrentThread())
+      writer->WaitWritten(ticket);
+    s_globals.m_users--;
+    return;
+  }
+  s_globals.m_users--;
 
-    PrintDebugString(strData);
+  CSingleLock waitLock(s_globals.critSec);
+  WriteEntry(entry);
+  WriteLogString(LogEntry());
+}
+
+void CLog::WriteEntry(LogEntry& entry)
+{
+  StringUtils::TrimRight(entry.message);
+  if (entry.message.empty())
+    return;
 
-    WriteLogString(logLevel, strData);
+  std::string line(entry.message);
+  if (!entry.function.empty())
+    line.insert(0, entry.function + ": ");
+
+  if (s_globals.m_repeatLogLevel == entry.level && s_globals.m_repeatLine == line)
+  {
+    s_globals.m_repeatCount++;
+    return;
+  }
+  else if (s_globals.m_repeatCount)
+  {
+    LogEntry repeat;
+    repeat.level = s_globals.m_repeatLogLevel;
+    repeat.threadId = entry.threadId;
+    repeat.time = entry.time;
+    repeat.message = StringUtils::Format("Previous line repeats %d times.", s_globals.m_repeatCount);
+    PrintDebugString(repeat.message);
+    WriteLogString(repeat);
+    s_globals.m_repeatCount = 0;
   }
+
+  s_globals.m_repeatLine = line;
+  s_globals.m_repeatLogLevel = entry.level;
+
+  PrintDebugString(line);
+
+  WriteLogString(entry);
 }
 
 bool CLog::Init(const std::string& path)
@@ -112,7 +259,13 @@ bool CLog::Init(const std::string& path)
 
   std::string appName = CCompileInfo::GetAppName();
   StringUtils::ToLower(appName);
-  return s_globals.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log");
+  if (!s_globals.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log"))
+    return false;
+
+  s_globals.m_open = true;
+  if (s_globals.m_async)
+    StartWriter();
+  return true;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -188,6 +341,81 @@ bool CLog::IsLogLevelLogged(int loglevel)
 #endif
 }
 
+void CLog::SetLogFormat(LogFormat format)
+{
+  CSingleLock waitLock(s_globals.critSec);
+  if (s_globals.m_format == format)
+    return;
+
+  // lines still queued are written in the new format
+  s_globals.m_format = format;
+}
+
+void CLog::SetAsync(bool async)
+{
+  {
+    CSingleLock waitLock(s_globals.critSec);
+    if (s_globals.m_async == async)
+      return;
+    s_globals.m_async = async;
+    if (!s_globals.m_open)
+      return;
+  }
+
+  if (async)
+    StartWriter();
+  else
+    StopWriter();
+}
+
+void CLog::Flush()
+{
+  s_globals.m_users++;
+  CLogWriter* writer = s_globals.m_writer;
+  if (writer && !writer->IsCurrentThread())
+  {
+    uint64_t queued = writer->GetQueued();
+    // wait for everything that was pushed before this call
+    LogEntry marker;
+    uint64_t ticket;
+    if (writer->Push(marker, &ticket))
+      queued = ticket;
+    writer->WaitWritten(queued);
+  }
+  s_globals.m_users--;
+}
+
+uint64_t CLog::GetDroppedCount()
+{
+  CSingleLock waitLock(s_globals.critSec);
+  return s_globals.m_dropped;
+}
+
+void CLog::StartWriter()
+{
+  CSingleLock waitLock(s_globals.critSec);
+  if (s_globals.m_writer)
+    return;
+
+  CLogWriter* writer = new CLogWriter();
+  writer->Create();
+  s_globals.m_writer = writer;
+}
+
+void CLog::StopWriter()
+{
+  CLogWriter* writer = s_globals.m_writer.exchange(NULL);
+  if (!writer)
+    return;
+
+  // wait for the threads that picked up the writer before it was cleared
+  while (s_globals.m_users > 0)
+    Sleep(1);
+
+  writer->StopThread();
+  writer->Drain();
+  delete writer;
+}
 
 void CLog::PrintDebugString(const std::string& line)
 {
@@ -196,23 +424,109 @@ void CLog::PrintDebugString(const std::string& line)
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
 
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
+static void AppendJSONString(std::string& out, const std::string& str)
+{
+  out += '"';
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+  {
+    unsigned char c = *it;
+    switch (c)
+    {
+    case '"':  out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default:
+      if (c < 0x20)
+        out += StringUtils::Format("\\u%04x", c);
+      else
+        out += c;
+    }
+  }
+  out += '"';
+}
+
+bool CLog::WriteLogString(const LogEntry& entry)
 {
   static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
 
-  std::string strData(logString);
-  /* fixup newline alignment, number of spaces should equal prefix length */
-  StringUtils::Replace(strData, "\n", "\n                                            ");
-
-  int hour, minute, second;
-  s_globals.m_platform.GetCurrentLocalTime(hour, minute, second);
-  
-  strData = StringUtils::Format(prefixFormat,
-                                  hour,
-                                  minute,
-                                  second,
-                                  (uint64_t)CThread::GetCurrentThreadId(),
-                                  levelNames[logLevel]) + strData;
-
-  return s_globals.m_platform.WriteStringToLog(strData);
+  // lines are collected and written in one go, an entry without message
+  // writes out what has been collected so far
+  std::string& buffer = s_globals.m_buffer;
+  struct tm& localTime = s_globals.m_localTime;
+
+  if (entry.message.empty())
+  {
+    if (buffer.empty())
+      return true;
+    bool ret = s_globals.m_platform.WriteStringToLog(buffer);
+    buffer.clear();
+    return ret;
+  }
+
+  time_t second = (time_t)(entry.time / 1000000);
+  if (second != s_globals.m_lastSecond)
+  {
+    if (!PlatformInterfaceForCLog::ConvertToLocalTime(second, localTime))
+      memset(&localTime, 0, sizeof(localTime));
+    s_globals.m_lastSecond = second;
+  }
+
+  int level = entry.level & LOGMASK;
+  if (level > LOGNONE)
+    level = LOGNONE;
+
+  if (!buffer.empty())
+    buffer += '\n';
+
+  if (s_globals.m_format == LOG_FORMAT_JSON)
+  {
+    buffer += StringUtils::Format("{\"time\":\"%04d-%02d-%02dT%02d:%02d:%02d.%06d\",\"thread\":%" PRIu64",\"level\":\"%s\"",
+                                  localTime.tm_year + 1900, localTime.tm_mon + 1, localTime.tm_mday,
+                                  localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+                                  (int)(entry.time % 1000000), entry.threadId, levelNames[level]);
+    const int components = entry.level >> LOGMASKBIT;
+    for (size_t i = 0; i < sizeof(componentNames) / sizeof(componentNames[0]); i++)
+    {
+      if ((components & (1 << i)) && componentNames[i])
+      {
+        buffer += ",\"component\":\"";
+        buffer += componentNames[i];
+        buffer += '"';
+        break;
+      }
+    }
+    if (!entry.function.empty())
+    {
+      buffer += ",\"function\":";
+      AppendJSONString(buffer, entry.function);
+    }
+    buffer += ",\"message\":";
+    AppendJSONString(buffer, entry.message);
+    buffer += '}';
+  }
+  else
+  {
+    std::string strData(entry.message);
+    if (!entry.function.empty())
+      strData.insert(0, entry.function + ": ");
+    /* fixup newline alignment, number of spaces should equal prefix length */
+    StringUtils::Replace(strData, "\n", "\n                                            ");
+
+    buffer += StringUtils::Format(prefixFormat,
+                                  localTime.tm_hour,
+                                  localTime.tm_min,
+                                  localTime.tm_sec,
+                                  entry.threadId,
+                                  levelNames[level]);
+    buffer += strData;
+  }
+
+  if (buffer.size() < LOG_WRITE_CHUNK)
+    return true;
+
+  bool ret = s_globals.m_platform.WriteStringToLog(buffer);
+  buffer.clear();
+  return ret;
 }
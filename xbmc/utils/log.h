@@ -20,6 +20,8 @@
  *
  */
 
+#include <atomic>
+#include <stdint.h>
 #include <string>
 
 #if defined(TARGET_POSIX)
@@ -36,9 +38,18 @@ typedef class CWin32InterfaceForCLog PlatformInterfaceForCLog;
 
 #include "utils/params_check_macros.h"
 
+class CLogWriter;
+struct LogEntry;
+
 class CLog
 {
 public:
+  enum LogFormat
+  {
+    LOG_FORMAT_TEXT = 0, //!< the classic "hh:mm:ss T:thread LEVEL: message" lines
+    LOG_FORMAT_JSON      //!< one JSON object per line
+  };
+
   CLog();
   ~CLog(void);
   static void Close();
@@ -53,11 +64,34 @@ public:
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
 
+  /*!
+   \brief Select plain text or JSON lines output.
+   */
+  static void SetLogFormat(LogFormat format);
+
+  /*!
+   \brief Hand log lines to a background writer thread instead of writing
+   them on the calling thread. Disabled by default, as lines still queued
+   are lost when the process crashes.
+   */
+  static void SetAsync(bool async);
+
+  /*!
+   \brief Block until all lines logged so far are written to the log file.
+   */
+  static void Flush();
+
+  /*!
+   \brief Number of lines dropped because the log queue was full.
+   */
+  static uint64_t GetDroppedCount();
+
 protected:
   class CLogGlobals
   {
   public:
-    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
+    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0),
+                        m_format(LOG_FORMAT_TEXT), m_async(false), m_open(false), m_writer(NULL), m_users(0), m_dropped(0), m_lastSecond(-1) {}
     ~CLogGlobals() {}
     PlatformInterfaceForCLog m_platform;
     int         m_repeatCount;
@@ -65,11 +99,25 @@ protected:
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
+    LogFormat   m_format;
+    bool        m_async;
+    bool        m_open;
+    std::atomic<CLogWriter*> m_writer; // set while lines are written in the background
+    std::atomic<int>         m_users;  // threads currently handing a line to m_writer
+    uint64_t    m_dropped;
+    std::string m_buffer;     // formatted lines not yet handed to m_platform
+    time_t      m_lastSecond; // m_localTime caches the conversion of this time
+    struct tm   m_localTime;
     CCriticalSection critSec;
   };
   class CLogGlobals m_globalInstance; // used as static global variable
-  static void LogString(int logLevel, const std::string& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
+
+  friend class CLogWriter;
+  static void LogString(int logLevel, const char* functionName, std::string& logString);
+  static void WriteEntry(LogEntry& entry);
+  static bool WriteLogString(const LogEntry& entry);
+  static void StartWriter();
+  static void StopWriter();
 };
 
 
@@ -107,3 +107,8 @@ void CPosixInterfaceForCLog::GetCurrentLocalTime(int &hour, int &minute, int &se
   else
     hour = minute = second = 0;
 }
+
+bool CPosixInterfaceForCLog::ConvertToLocalTime(time_t time, struct tm& localTime)
+{
+  return localtime_r(&time, &localTime) != NULL;
+}
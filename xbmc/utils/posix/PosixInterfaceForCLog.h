@@ -20,6 +20,7 @@
  */
 
 #include <string>
+#include <time.h>
 
 struct FILEWRAP; // forward declaration, wrapper for FILE
 
@@ -33,6 +34,7 @@ public:
   bool WriteStringToLog(const std::string& logString);
   void PrintDebugString(const std::string& debugString);
   static void GetCurrentLocalTime(int& hour, int& minute, int& second);
+  static bool ConvertToLocalTime(time_t time, struct tm& localTime);
 private:
   FILEWRAP* m_file;
 };
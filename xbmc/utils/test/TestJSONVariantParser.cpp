@@ -18,7 +18,10 @@
  *
  */
 
+#include "utils/JSONStreamParser.h"
 #include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
@@ -32,3 +35,135 @@ TEST(TestJSONVariantParser, Parse)
   variant = CJSONVariantParser::Parse(buf, sizeof(buf));
   EXPECT_TRUE(variant.isNull());
 }
+
+namespace
+{
+const char *json = "{\"jsonrpc\": \"2.0\", /* comment */ \"id\": 1, \"result\": {\"movies\": ["
+                   "{\"movieid\": 1, \"label\": \"Movie \\\"1\\\"\", \"rating\": 7.5, \"watched\": true, \"set\": null},"
+                   "{\"movieid\": -2, \"label\": \"Movie \\u00e9\", \"rating\": 8, \"watched\": false, \"set\": []}"
+                   "], \"total\": 2}}";
+
+void CheckResponse(const CVariant &variant)
+{
+  ASSERT_TRUE(variant.isObject());
+  EXPECT_EQ("2.0", variant["jsonrpc"].asString());
+  EXPECT_EQ(1, variant["id"].asInteger());
+
+  const CVariant &movies = variant["result"]["movies"];
+  ASSERT_TRUE(movies.isArray());
+  ASSERT_EQ(2u, movies.size());
+  EXPECT_EQ(1, movies[0]["movieid"].asInteger());
+  EXPECT_EQ("Movie \"1\"", movies[0]["label"].asString());
+  EXPECT_DOUBLE_EQ(7.5, movies[0]["rating"].asDouble());
+  EXPECT_TRUE(movies[0]["watched"].asBoolean());
+  EXPECT_TRUE(movies[0]["set"].isNull());
+  EXPECT_EQ(-2, movies[1]["movieid"].asInteger());
+  EXPECT_EQ("Movie \xc3\xa9", movies[1]["label"].asString());
+  EXPECT_EQ(8, movies[1]["rating"].asInteger());
+  EXPECT_FALSE(movies[1]["watched"].asBoolean());
+  EXPECT_TRUE(movies[1]["set"].isArray());
+  EXPECT_EQ(2, variant["result"]["total"].asInteger());
+}
+
+class CEventCounter : public IJSONStreamHandler
+{
+public:
+  CEventCounter() : m_values(0), m_keys(0), m_containers(0), m_stopAt(-1) { }
+
+  virtual bool OnNull() { return OnValue(); }
+  virtual bool OnBoolean(bool value) { return OnValue(); }
+  virtual bool OnInteger(int64_t value) { return OnValue(); }
+  virtual bool OnDouble(double value) { return OnValue(); }
+  virtual bool OnString(const char *value, size_t length) { return OnValue(); }
+  virtual bool OnObjectStart() { m_containers++; return true; }
+  virtual bool OnKey(const char *key, size_t length) { m_keys++; return true; }
+  virtual bool OnObjectEnd() { return true; }
+  virtual bool OnArrayStart() { m_containers++; return true; }
+  virtual bool OnArrayEnd() { return true; }
+
+  int m_values;
+  int m_keys;
+  int m_containers;
+  int m_stopAt;
+
+private:
+  bool OnValue() { return ++m_values != m_stopAt; }
+};
+
+// a VideoLibrary.GetMovies response
+std::string GetMovies(unsigned int count)
+{
+  std::string str = "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":{\"movies\":[";
+  for (unsigned int i = 0; i < count; i++)
+  {
+    if (i > 0)
+      str += ",";
+    str += StringUtils::Format("{\"art\":{\"poster\":\"image://smb%%3a%%2f%%2fserver%%2fmovies%%2fMovie%%20%u%%2fposter.jpg/\"},"
+                               "\"file\":\"smb://server/movies/Movie %u (2016)/movie.mkv\",\"genre\":[\"Drama\",\"Thriller\"],"
+                               "\"label\":\"Movie %u\",\"movieid\":%u,\"playcount\":%u,\"rating\":7.25}", i, i, i, i, i % 3);
+  }
+  str += "]}}";
+  return str;
+}
+}
+
+TEST(TestJSONVariantParser, ParseDocument)
+{
+  CheckResponse(CJSONVariantParser::Parse(std::string(json)));
+
+  EXPECT_TRUE(CJSONVariantParser::Parse(std::string("{\"a\": ")).isNull());
+  EXPECT_TRUE(CJSONVariantParser::Parse(std::string("[1, 2,, 3]")).isNull());
+  EXPECT_EQ(42, CJSONVariantParser::Parse(std::string("42")).asInteger());
+}
+
+TEST(TestJSONVariantParser, ParseChunks)
+{
+  // the JSON can arrive in pieces of any size
+  CSimpleParseCallback callback;
+  {
+    CJSONVariantParser parser(&callback);
+    for (const char *c = json; *c != 0; c++)
+      parser.push_buffer((const unsigned char *)c, 1);
+  }
+  CheckResponse(callback.GetOutput());
+}
+
+TEST(TestJSONVariantParser, RoundTrip)
+{
+  CVariant variant = CJSONVariantParser::Parse(std::string(json));
+  CVariant parsed = CJSONVariantParser::Parse(CJSONVariantWriter::Write(variant, true));
+  CheckResponse(parsed);
+  EXPECT_EQ(CJSONVariantWriter::Write(variant, false), CJSONVariantWriter::Write(parsed, false));
+}
+
+TEST(TestJSONVariantParser, StreamEvents)
+{
+  CEventCounter counter;
+  EXPECT_TRUE(CJSONStreamParser::Parse(json, &counter));
+  EXPECT_EQ(12, counter.m_values);
+  EXPECT_EQ(15, counter.m_keys);
+  EXPECT_EQ(6, counter.m_containers);
+
+  // the handler can stop the parser early
+  CEventCounter stop;
+  stop.m_stopAt = 3;
+  EXPECT_FALSE(CJSONStreamParser::Parse(json, &stop));
+  EXPECT_EQ(3, stop.m_values);
+
+  CEventCounter invalid;
+  EXPECT_FALSE(CJSONStreamParser::Parse("{\"a\" 1}", &invalid));
+}
+
+// parsing a VideoLibrary.GetMovies response with 20000 movies into a CVariant,
+// and only scanning it with the stream parser
+TEST(TestJSONVariantParser, DISABLED_ThroughputParse)
+{
+  CVariant variant = CJSONVariantParser::Parse(GetMovies(20000));
+  EXPECT_EQ(20000u, variant["result"]["movies"].size());
+}
+
+TEST(TestJSONVariantParser, DISABLED_ThroughputScan)
+{
+  CEventCounter counter;
+  EXPECT_TRUE(CJSONStreamParser::Parse(GetMovies(20000), &counter));
+}
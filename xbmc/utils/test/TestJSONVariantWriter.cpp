@@ -18,9 +18,14 @@
  *
  */
 
+#include "utils/JSONStreamWriter.h"
 #include "utils/JSONVariantWriter.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <locale.h>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 TEST(TestJSONVariantWriter, Write)
@@ -31,3 +36,197 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+namespace
+{
+class CChunkCollector : public IJSONStreamOutput
+{
+public:
+  CChunkCollector() : m_limit(0) { }
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    m_chunks.push_back(std::string(data, length));
+    return m_limit == 0 || m_chunks.size() < m_limit;
+  }
+
+  std::string GetOutput() const
+  {
+    std::string output;
+    for (std::vector<std::string>::const_iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      output += *it;
+    return output;
+  }
+
+  std::vector<std::string> m_chunks;
+  size_t m_limit;
+};
+
+// a synthetic VideoLibrary.GetMovies result
+CVariant GetMovies(unsigned int count)
+{
+  CVariant result(CVariant::VariantTypeObject);
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = count;
+  result["limits"]["total"] = count;
+  result["movies"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = StringUtils::Format("Movie %u", i);
+    movie["file"] = StringUtils::Format("smb://server/movies/Movie %u (2016)/movie.mkv", i);
+    movie["rating"] = 7.25;
+    movie["playcount"] = i % 3;
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Thriller");
+    movie["plot"] = "Somebody does something \"special\" somewhere\nand then it ends.";
+    movie["art"]["poster"] = StringUtils::Format("image://smb%%3a%%2f%%2fserver%%2fmovies%%2fMovie%%20%u%%2fposter.jpg/", i);
+    result["movies"].push_back(std::move(movie));
+  }
+
+  return result;
+}
+}
+
+TEST(TestJSONVariantWriter, WriteCompact)
+{
+  CVariant variant;
+  variant["array"].push_back(1);
+  variant["array"].push_back(-2);
+  variant["array"].push_back(true);
+  variant["array"].push_back(CVariant(CVariant::VariantTypeNull));
+  variant["array"].push_back("string \"with\" quotes");
+  variant["double"] = 1.5;
+  variant["integral"] = 2.0;
+  variant["object"] = CVariant(CVariant::VariantTypeObject);
+
+  EXPECT_EQ("{\"array\":[1,-2,true,null,\"string \\\"with\\\" quotes\"],\"double\":1.5,\"integral\":2.0,\"object\":{}}",
+            CJSONVariantWriter::Write(variant, true));
+}
+
+TEST(TestJSONVariantWriter, WriteLocale)
+{
+  // the decimal point of the locale must not end up in the JSON
+  std::string locale = setlocale(LC_NUMERIC, NULL);
+  if (setlocale(LC_NUMERIC, "de_DE.UTF-8") == NULL && setlocale(LC_NUMERIC, "de_DE") == NULL)
+    return;
+
+  std::string str = CJSONVariantWriter::Write(CVariant(0.25), true);
+  setlocale(LC_NUMERIC, locale.c_str());
+  EXPECT_EQ("0.25", str);
+}
+
+TEST(TestJSONVariantWriter, StreamChunks)
+{
+  CVariant movies = GetMovies(100);
+  std::string expected = CJSONVariantWriter::Write(movies, true);
+
+  CChunkCollector output;
+  CJSONStreamWriter writer(true, &output, 1024);
+  EXPECT_TRUE(writer.Value(movies));
+  EXPECT_TRUE(writer.Flush());
+
+  // the output is passed on while it is written, not all at once
+  EXPECT_LT(expected.size() / 1024 - 1, output.m_chunks.size());
+  for (size_t i = 0; i + 1 < output.m_chunks.size(); i++)
+    EXPECT_LE(1024u, output.m_chunks[i].size());
+  EXPECT_EQ(expected, output.GetOutput());
+  EXPECT_TRUE(writer.GetOutput().empty());
+}
+
+TEST(TestJSONVariantWriter, StreamRelease)
+{
+  CVariant movies = GetMovies(10);
+  std::string expected = CJSONVariantWriter::Write(movies, false);
+
+  CJSONStreamWriter writer(false);
+  EXPECT_TRUE(writer.Value(std::move(movies)));
+  EXPECT_EQ(expected, writer.GetOutput());
+  EXPECT_TRUE(movies.isNull());
+}
+
+TEST(TestJSONVariantWriter, StreamEvents)
+{
+  CJSONStreamWriter writer(true);
+  EXPECT_TRUE(writer.BeginObject());
+  EXPECT_TRUE(writer.Key("id"));
+  EXPECT_TRUE(writer.UnsignedInteger(1));
+  EXPECT_TRUE(writer.Key("result"));
+  EXPECT_TRUE(writer.BeginArray());
+  EXPECT_TRUE(writer.String("a"));
+  EXPECT_TRUE(writer.Double(-0.5));
+  EXPECT_TRUE(writer.Null());
+  EXPECT_TRUE(writer.EndArray());
+  EXPECT_TRUE(writer.EndObject());
+  EXPECT_FALSE(writer.IsFailed());
+  EXPECT_EQ("{\"id\":1,\"result\":[\"a\",-0.5,null]}", writer.GetOutput());
+}
+
+TEST(TestJSONVariantWriter, StreamFailure)
+{
+  // a value where a key is expected
+  CJSONStreamWriter invalid(true);
+  EXPECT_TRUE(invalid.BeginObject());
+  EXPECT_FALSE(invalid.Integer(1));
+  EXPECT_TRUE(invalid.IsFailed());
+  EXPECT_FALSE(invalid.EndObject());
+
+  // an output that stops accepting data stops the writer
+  CChunkCollector output;
+  output.m_limit = 2;
+  CJSONStreamWriter writer(true, &output, 256);
+  EXPECT_FALSE(writer.Value(GetMovies(100)));
+  EXPECT_TRUE(writer.IsFailed());
+  EXPECT_EQ(2u, output.m_chunks.size());
+}
+
+TEST(TestJSONVariantWriter, StreamValue)
+{
+  CVariant movies = GetMovies(10);
+  std::string expected = CJSONVariantWriter::Write(movies, true);
+
+  // one element per call, the value is taken over by the stream
+  CJSONStreamValue value(std::move(movies));
+  CJSONStreamWriter writer(true);
+  EXPECT_TRUE(movies.isNull());
+  EXPECT_FALSE(value.IsFinished());
+
+  std::string output;
+  unsigned int calls = 0;
+  while (!value.IsFinished())
+  {
+    ASSERT_TRUE(value.WriteNext(writer));
+    output += writer.GetOutput();
+    calls++;
+  }
+  EXPECT_EQ(expected, output);
+  EXPECT_LT(100u, calls);
+
+  // nothing is left to write
+  EXPECT_TRUE(value.WriteNext(writer));
+  EXPECT_TRUE(writer.GetOutput().empty());
+
+  // a scalar is written at once
+  CJSONStreamValue scalar(CVariant("abc"));
+  CJSONStreamWriter scalarWriter(true);
+  EXPECT_TRUE(scalar.WriteNext(scalarWriter));
+  EXPECT_TRUE(scalar.IsFinished());
+  EXPECT_EQ("\"abc\"", scalarWriter.GetOutput());
+}
+
+// writing a VideoLibrary.GetMovies result with 20000 movies into one string,
+// and streaming it out in chunks
+TEST(TestJSONVariantWriter, DISABLED_ThroughputWrite)
+{
+  CVariant movies = GetMovies(20000);
+  EXPECT_FALSE(CJSONVariantWriter::Write(movies, true).empty());
+}
+
+TEST(TestJSONVariantWriter, DISABLED_ThroughputStream)
+{
+  CChunkCollector output;
+  CJSONStreamWriter writer(true, &output);
+  EXPECT_TRUE(writer.Value(GetMovies(20000)));
+  EXPECT_TRUE(writer.Flush());
+}
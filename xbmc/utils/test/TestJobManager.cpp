@@ -20,8 +20,12 @@
 
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
 #include "utils/SystemInfo.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
@@ -52,6 +56,7 @@ protected:
     /* Always cancel jobs test completion */
     CJobManager::GetInstance().CancelJobs();
     CJobManager::GetInstance().Restart();
+    CJobManager::GetInstance().SetMaxConcurrency(CJob::PRIORITY_LOW, 0);
     CSettings::GetInstance().Unload();
   }
 };
@@ -178,3 +183,167 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+class OrderedJob : public CJob
+{
+public:
+  OrderedJob(int index, std::vector<int> &order, CCriticalSection &section) :
+    m_index(index), m_order(order), m_section(section)
+  {
+  }
+
+  const char * GetType() const
+  {
+    return "OrderedJob";
+  }
+
+  bool DoWork()
+  {
+    CSingleLock lock(m_section);
+    m_order.push_back(m_index);
+    return true;
+  }
+
+private:
+  int m_index;
+  std::vector<int> &m_order;
+  CCriticalSection &m_section;
+};
+
+class CountingCallback : public IJobCallback
+{
+public:
+  CountingCallback(unsigned int expected) : m_expected(expected), m_completed(0) {}
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CSingleLock lock(m_section);
+    if (++m_completed == m_expected)
+      m_done.Set();
+  }
+
+  bool Wait(unsigned int timeoutMs)
+  {
+    bool done = m_done.WaitMSec(timeoutMs);
+    // wait for OnJobComplete() to be done with m_done before we go out of scope
+    CSingleLock lock(m_section);
+    return done;
+  }
+
+private:
+  unsigned int m_expected;
+  unsigned int m_completed;
+  CCriticalSection m_section;
+  CEvent m_done;
+};
+}
+
+TEST_F(TestJobManager, Throughput)
+{
+  static const unsigned int jobCount = 10000;
+  std::vector<int> order;
+  CCriticalSection section;
+  CountingCallback callback(jobCount);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < jobCount; i++)
+    CJobManager::GetInstance().AddJob(new OrderedJob(i, order, section), &callback);
+  ASSERT_TRUE(callback.Wait(30000));
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  EXPECT_EQ(jobCount, order.size());
+  RecordProperty("ElapsedMs", elapsed);
+}
+
+TEST_F(TestJobManager, FifoOrder)
+{
+  static const unsigned int jobCount = 100;
+  std::vector<int> order;
+  CCriticalSection section;
+  CountingCallback callback(jobCount);
+
+  // a single job at a time makes the processing order observable
+  CJobManager::GetInstance().SetMaxConcurrency(CJob::PRIORITY_LOW, 1);
+  for (unsigned int i = 0; i < jobCount; i++)
+    CJobManager::GetInstance().AddJob(new OrderedJob(i, order, section), &callback);
+  ASSERT_TRUE(callback.Wait(30000));
+
+  ASSERT_EQ(jobCount, order.size());
+  for (unsigned int i = 0; i < jobCount; i++)
+    EXPECT_EQ((int)i, order[i]);
+}
+
+TEST_F(TestJobManager, MaxConcurrency)
+{
+  JobControlPackage package;
+  CJobManager::GetInstance().SetMaxConcurrency(CJob::PRIORITY_LOW, 1);
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_LOW, package));
+
+  CJobManager::GetInstance().AddJob(new CSysInfoJob(), NULL, CJob::PRIORITY_LOW);
+  CJobManager::GetInstance().AddJob(new CSysInfoJob(), NULL, CJob::PRIORITY_LOW);
+
+  CJobManager::JobStats stats = CJobManager::GetInstance().GetStats(CJob::PRIORITY_LOW);
+  EXPECT_EQ(1U, stats.processing);
+  EXPECT_EQ(2U, stats.queued);
+
+  job->FinishAndStopBlocking();
+}
+
+namespace
+{
+class StartedJob : public CJob
+{
+public:
+  StartedJob(unsigned int &started, CCriticalSection &section, CEvent &allStarted, unsigned int expected) :
+    m_started(started), m_section(section), m_allStarted(allStarted), m_expected(expected)
+  {
+  }
+
+  const char * GetType() const
+  {
+    return "StartedJob";
+  }
+
+  bool DoWork()
+  {
+    {
+      CSingleLock lock(m_section);
+      if (++m_started == m_expected)
+        m_allStarted.Set();
+    }
+    // only returns once every job runs at the same time
+    return m_allStarted.WaitMSec(10000);
+  }
+
+private:
+  unsigned int &m_started;
+  CCriticalSection &m_section;
+  CEvent &m_allStarted;
+  unsigned int m_expected;
+};
+}
+
+TEST_F(TestJobManager, WakeWorkerPerJob)
+{
+  static const unsigned int jobCount = 4;
+  unsigned int started = 0;
+  CCriticalSection section;
+  CEvent allStarted(true);
+  CountingCallback callback(jobCount);
+
+  // leave some workers sleeping, then add jobs faster than they wake up
+  CountingCallback warmup(jobCount);
+  for (unsigned int i = 0; i < jobCount; i++)
+    CJobManager::GetInstance().AddJob(new CSysInfoJob(), &warmup, CJob::PRIORITY_HIGH);
+  ASSERT_TRUE(warmup.Wait(10000));
+
+  for (unsigned int i = 0; i < jobCount; i++)
+    CJobManager::GetInstance().AddJob(new StartedJob(started, section, allStarted, jobCount), &callback, CJob::PRIORITY_HIGH);
+
+  // every job gets a worker of its own
+  EXPECT_TRUE(allStarted.WaitMSec(10000));
+  ASSERT_TRUE(callback.Wait(30000));
+  EXPECT_EQ(jobCount, started);
+}
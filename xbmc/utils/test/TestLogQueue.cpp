@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/LogQueue.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(TestLogQueue, Order)
+{
+  CLogQueue queue(4, 1024);
+  LogEntry entry;
+
+  EXPECT_TRUE(queue.IsEmpty());
+  for (int i = 0; i < 4; i++)
+  {
+    entry.level = i;
+    entry.message = StringUtils::Format("line %d", i);
+    uint64_t ticket;
+    EXPECT_TRUE(queue.Push(entry, &ticket));
+    EXPECT_EQ((uint64_t)i, ticket);
+  }
+  EXPECT_FALSE(queue.IsEmpty());
+
+  for (int i = 0; i < 4; i++)
+  {
+    EXPECT_TRUE(queue.Pop(entry));
+    EXPECT_EQ(i, entry.level);
+    EXPECT_EQ(StringUtils::Format("line %d", i), entry.message);
+  }
+  EXPECT_FALSE(queue.Pop(entry));
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ((uint64_t)4, queue.GetPopped());
+}
+
+TEST(TestLogQueue, Drops)
+{
+  CLogQueue queue(2, 10);
+  LogEntry entry;
+
+  entry.message = "12345";
+  EXPECT_TRUE(queue.Push(entry));
+  entry.message = "12345";
+  EXPECT_TRUE(queue.Push(entry));
+  // no slot left
+  entry.message = "1";
+  EXPECT_FALSE(queue.Push(entry));
+  EXPECT_EQ(1u, queue.TakeDropped());
+  EXPECT_EQ(0u, queue.TakeDropped());
+
+  EXPECT_TRUE(queue.Pop(entry));
+  // a slot is free but the byte budget is used up
+  entry.message = "123456";
+  EXPECT_FALSE(queue.Push(entry));
+  entry.message = "12345";
+  EXPECT_TRUE(queue.Push(entry));
+  EXPECT_EQ(1u, queue.TakeDropped());
+}
+
+namespace
+{
+class CProducer : public IRunnable
+{
+public:
+  CProducer(CLogQueue &queue, int id, int count)
+    : m_queue(queue), m_id(id), m_count(count), m_dropped(0) {}
+
+  void Run() override
+  {
+    LogEntry entry;
+    for (int i = 0; i < m_count; i++)
+    {
+      entry.level = m_id;
+      entry.threadId = i;
+      entry.message = "message";
+      while (!m_queue.Push(entry))
+        m_dropped++;
+    }
+  }
+
+  CLogQueue &m_queue;
+  int m_id;
+  int m_count;
+  int m_dropped;
+};
+}
+
+TEST(TestLogQueue, Producers)
+{
+  const int producers = 4;
+  const int count = 20000;
+  CLogQueue queue(64, 64 * 1024);
+
+  std::vector<CProducer*> runnables;
+  std::vector<CThread*> threads;
+  for (int i = 0; i < producers; i++)
+  {
+    runnables.push_back(new CProducer(queue, i, count));
+    threads.push_back(new CThread(runnables.back(), "LogQueueProducer"));
+    threads.back()->Create();
+  }
+
+  // every producer's lines arrive complete and in order
+  std::vector<uint64_t> next(producers, 0);
+  int received = 0;
+  LogEntry entry;
+  while (received < producers * count)
+  {
+    if (!queue.Pop(entry))
+      continue;
+    ASSERT_GE(entry.level, 0);
+    ASSERT_LT(entry.level, producers);
+    EXPECT_EQ(next[entry.level], entry.threadId);
+    EXPECT_EQ("message", entry.message);
+    next[entry.level] = entry.threadId + 1;
+    received++;
+  }
+
+  int dropped = 0;
+  for (int i = 0; i < producers; i++)
+  {
+    threads[i]->StopThread();
+    dropped += runnables[i]->m_dropped;
+    delete threads[i];
+    delete runnables[i];
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ((unsigned int)dropped, queue.TakeDropped());
+}
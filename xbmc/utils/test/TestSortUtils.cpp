@@ -19,8 +19,11 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 
 TEST(TestSortUtils, Sort_SortBy)
@@ -131,3 +134,157 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+namespace
+{
+
+// titles of a synthetic library, with numbers, mixed case and duplicates
+std::string GetTitle(unsigned int index)
+{
+  static const char *words[] = { "the", "Movie", "Return", "of", "a", "night", "Zero", "Äpfel", "éclair", "day" };
+  std::string title = words[(index * 7) % 10];
+  title += " ";
+  title += words[(index / 10) % 10];
+  title += " " + StringUtils::Format("%u", (index * 2654435761u) % 5000);
+  return title;
+}
+
+void FillColumns(DatabaseResultColumns &columns, unsigned int rows)
+{
+  FieldList fields;
+  fields.push_back(FieldId);
+  fields.push_back(FieldTitle);
+  fields.push_back(FieldYear);
+  columns.Initialize(MediaTypeMovie, fields, rows);
+
+  std::vector<CVariant> values(3);
+  for (unsigned int i = 0; i < rows; i++)
+  {
+    values[0] = i;
+    values[1] = GetTitle(i);
+    values[2] = 1950 + i % 70;
+    columns.AddRow(values);
+  }
+}
+
+}
+
+TEST(TestSortUtils, Sort_Limits)
+{
+  const unsigned int count = 2000;
+  SortItems all;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = GetTitle(i);
+    (*item)[FieldRow] = i;
+    (*item)[FieldFolder] = i % 13 == 0;
+    if (i % 101 == 0)
+      (*item)[FieldSortSpecial] = i % 2 ? SortSpecialOnTop : SortSpecialOnBottom;
+    all.push_back(item);
+  }
+
+  const SortOrder orders[] = { SortOrderAscending, SortOrderDescending };
+  for (size_t o = 0; o < 2; o++)
+  {
+    SortItems sorted(all);
+    SortUtils::Sort(SortByLabel, orders[o], SortAttributeNone, sorted);
+    ASSERT_EQ(count, sorted.size());
+    for (unsigned int i = 1; i < count; i++)
+    {
+      const SortItem &prev = *sorted[i - 1];
+      const SortItem &cur = *sorted[i];
+      if (prev.find(FieldSortSpecial) != prev.end() || cur.find(FieldSortSpecial) != cur.end() ||
+          prev.at(FieldFolder).asBoolean() != cur.at(FieldFolder).asBoolean())
+        continue;
+      int64_t result = StringUtils::AlphaNumericCompare(prev.at(FieldSort).asWideString().c_str(), cur.at(FieldSort).asWideString().c_str());
+      EXPECT_TRUE(orders[o] == SortOrderAscending ? result <= 0 : result >= 0) << "item " << i;
+      // equal labels keep their original order
+      if (result == 0)
+      {
+        EXPECT_LT(prev.at(FieldRow).asInteger(), cur.at(FieldRow).asInteger());
+      }
+    }
+    EXPECT_EQ(SortSpecialOnTop, (*sorted.front())[FieldSortSpecial].asInteger());
+    EXPECT_EQ(SortSpecialOnBottom, (*sorted.back())[FieldSortSpecial].asInteger());
+
+    // a page must match the same range of the completely sorted items
+    const int limits[][2] = { { 0, 50 }, { 100, 150 }, { 1990, 2100 }, { 500, -1 } };
+    for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++)
+    {
+      SortItems page(all);
+      SortUtils::Sort(SortByLabel, orders[o], SortAttributeNone, page, limits[l][1], limits[l][0]);
+      size_t end = limits[l][1] < 0 ? count : std::min<size_t>(count, limits[l][1]);
+      ASSERT_EQ(end - limits[l][0], page.size());
+      for (size_t i = 0; i < page.size(); i++)
+        EXPECT_EQ(sorted[limits[l][0] + i], page[i]) << "limits " << limits[l][0] << "-" << limits[l][1];
+    }
+  }
+}
+
+TEST(TestSortUtils, Sort_Columns)
+{
+  DatabaseResultColumns columns;
+  FillColumns(columns, 1000);
+  ASSERT_EQ(1000u, columns.GetRowCount());
+
+  DatabaseResult row;
+  columns.GetRow(7, row);
+  EXPECT_EQ(7, row[FieldRow].asInteger());
+  EXPECT_EQ(7, row[FieldId].asInteger());
+  EXPECT_EQ(GetTitle(7), row[FieldTitle].asString());
+  EXPECT_EQ(GetTitle(7), row[FieldLabel].asString());
+  EXPECT_EQ(1957, row[FieldYear].asInteger());
+  EXPECT_EQ(MediaTypeMovie, row[FieldMediaType].asString());
+
+  // the same page as sorting all rows as DatabaseResults
+  DatabaseResults all;
+  for (size_t i = 0; i < columns.GetRowCount(); i++)
+  {
+    DatabaseResult result;
+    columns.GetRow(i, result);
+    all.push_back(result);
+  }
+
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.sortOrder = SortOrderDescending;
+  sorting.sortAttributes = SortAttributeIgnoreArticle;
+  sorting.limitStart = 10;
+  sorting.limitEnd = 30;
+  SortUtils::Sort(sorting, all);
+
+  DatabaseResults page;
+  SortUtils::Sort(sorting, columns, page);
+  ASSERT_EQ(20u, page.size());
+  ASSERT_EQ(all.size(), page.size());
+  for (size_t i = 0; i < page.size(); i++)
+  {
+    EXPECT_EQ(all[i].at(FieldRow).asInteger(), page[i].at(FieldRow).asInteger());
+    EXPECT_EQ(all[i].at(FieldSort).asWideString(), page[i].at(FieldSort).asWideString());
+  }
+
+  // without sorting the limits are applied to the rows as they are
+  sorting.sortBy = SortByNone;
+  SortUtils::Sort(sorting, columns, page);
+  ASSERT_EQ(20u, page.size());
+  EXPECT_EQ(10, page.front().at(FieldRow).asInteger());
+}
+
+// sorting a million movies by title to return one page from the middle, as
+// JSON-RPC clients paging through a large library do
+TEST(TestSortUtils, DISABLED_Benchmark)
+{
+  DatabaseResultColumns columns;
+  FillColumns(columns, 1000000);
+
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.sortAttributes = SortAttributeIgnoreArticle;
+  sorting.limitStart = 500000;
+  sorting.limitEnd = sorting.limitStart + 50;
+
+  DatabaseResults results;
+  SortUtils::Sort(sorting, columns, results);
+  EXPECT_EQ(50u, results.size());
+}
@@ -151,3 +151,96 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, JSONFormat)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  EXPECT_TRUE(XFILE::CFile::Exists(logfile));
+
+  CLog::SetLogFormat(CLog::LOG_FORMAT_JSON);
+  CLog::Log(LOGNOTICE, "json \"quoted\" message");
+  CLog::LogFunction(LOGERROR, "JSONFormat", "error message");
+  CLog::Close();
+  CLog::SetLogFormat(CLog::LOG_FORMAT_TEXT);
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  EXPECT_NE(std::string::npos, logstring.find("\"level\":\"NOTICE\",\"message\":\"json \\\"quoted\\\" message\"}"));
+  EXPECT_NE(std::string::npos, logstring.find("\"level\":\"ERROR\",\"function\":\"JSONFormat\",\"message\":\"error message\"}"));
+  EXPECT_NE(std::string::npos, logstring.find("{\"time\":\""));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, Synchronous)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  CLog::Log(LOGNOTICE, "synchronous message");
+
+  // by default written before returning, without Close()
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+  CLog::Close();
+
+  EXPECT_NE(std::string::npos, logstring.find("NOTICE: synchronous message"));
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, Asynchronous)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  CLog::SetAsync(true);
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  CLog::Log(LOGNOTICE, "asynchronous message");
+
+  // written by the writer thread once flushed
+  CLog::Flush();
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+  CLog::Close();
+  CLog::SetAsync(false);
+
+  EXPECT_NE(std::string::npos, logstring.find("NOTICE: asynchronous message"));
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
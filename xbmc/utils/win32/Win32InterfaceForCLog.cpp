@@ -118,3 +118,8 @@ void CWin32InterfaceForCLog::GetCurrentLocalTime(int& hour, int& minute, int& se
   minute = time.wMinute;
   second = time.wSecond;
 }
+
+bool CWin32InterfaceForCLog::ConvertToLocalTime(time_t time, struct tm& localTime)
+{
+  return localtime_s(&localTime, &time) == 0;
+}
@@ -65,6 +65,7 @@
 #include "utils/GroupUtils.h"
 #include "utils/LabelFormatter.h"
 #include "utils/log.h"
+#include "utils/md5.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
@@ -72,6 +73,7 @@
 #include "video/VideoDbUrl.h"
 #include "video/windows/GUIWindowVideoBase.h"
 #include "VideoInfoScanner.h"
+#include "VideoScanJournal.h"
 #include "XBDateTime.h"
 
 using namespace dbiplus;
@@ -137,6 +139,9 @@ void CVideoDatabase::CreateTables()
   CLog::Log(LOGINFO, "create path table");
   m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text, idParentPath integer)");
 
+  CLog::Log(LOGINFO, "create scanjournal table");
+  m_pDS->exec("CREATE TABLE scanjournal ( idJournal integer primary key, strPath text, strPathHash text, dirTime integer, entries integer, strHash text)");
+
   CLog::Log(LOGINFO, "create files table");
   m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
 
@@ -242,6 +247,8 @@ void CVideoDatabase::CreateAnalytics()
   m_pDS->exec("CREATE UNIQUE INDEX ix_stacktimes ON stacktimes ( idFile )\n");
   m_pDS->exec("CREATE INDEX ix_path ON path ( strPath(255) )");
   m_pDS->exec("CREATE INDEX ix_path2 ON path ( idParentPath )");
+  // keyed on a hash of the full path, paths sharing their first 255 characters would collide on MySQL
+  m_pDS->exec("CREATE UNIQUE INDEX ix_scanjournal ON scanjournal ( strPathHash(32) )");
   m_pDS->exec("CREATE INDEX ix_files ON files ( idPath, strFilename(255) )");
 
   m_pDS->exec("CREATE UNIQUE INDEX ix_movie_file_1 ON movie (idFile, idMovie)");
@@ -681,6 +688,20 @@ int CVideoDatabase::RunQuery(const std::string &sql)
   return rows;
 }
 
+int CVideoDatabase::StreamQuery(const std::string &sql)
+{
+  unsigned int time = XbmcThreads::SystemClockMillis();
+  int rows = -1;
+  if (m_pDS->prepare(sql) && m_pDS->query_prepared())
+  {
+    rows = m_pDS->eof() ? 0 : 1;
+    if (rows == 0)
+      m_pDS->close();
+  }
+  CLog::Log(LOGDEBUG, "%s took %d ms for the first row of query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, sql.c_str());
+  return rows;
+}
+
 bool CVideoDatabase::GetSubPaths(const std::string &basepath, std::vector<std::pair<int, std::string>>& subpaths)
 {
   std::string sql;
@@ -780,6 +801,121 @@ bool CVideoDatabase::GetPathHash(const std::string &path, std::string &hash)
   return false;
 }
 
+bool CVideoDatabase::GetScanJournal(CVideoScanJournal &journal)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    // a row per folder of the library, read one at a time
+    journal.Clear();
+    m_pDS->prepare("SELECT strPath, dirTime, entries, strHash FROM scanjournal");
+    m_pDS->query_prepared();
+    while (!m_pDS->eof())
+    {
+      journal.Add(m_pDS->fv(0).get_asString(), m_pDS->fv(1).get_asInt64(), m_pDS->fv(2).get_asInt(), m_pDS->fv(3).get_asString());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::SetScanJournal(CVideoScanJournal &journal)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CVideoScanJournal::Entries changed;
+    std::vector<std::string> removed;
+    journal.GetChanges(changed, removed);
+    if (changed.empty() && removed.empty())
+      return true;
+
+    BeginTransaction();
+    m_pDS->prepare("DELETE FROM scanjournal WHERE strPathHash=?");
+    for (std::vector<std::string>::const_iterator it = removed.begin(); it != removed.end(); ++it)
+    {
+      m_pDS->bind(1, XBMC::XBMC_MD5::GetMD5(*it));
+      m_pDS->exec_prepared();
+    }
+    m_pDS->prepare("REPLACE INTO scanjournal (strPath, strPathHash, dirTime, entries, strHash) VALUES (?, ?, ?, ?, ?)");
+    for (CVideoScanJournal::Entries::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    {
+      m_pDS->bind(1, it->first);
+      m_pDS->bind(2, XBMC::XBMC_MD5::GetMD5(it->first));
+      m_pDS->bind(3, it->second.time);
+      m_pDS->bind(4, it->second.entries);
+      m_pDS->bind(5, it->second.hash);
+      m_pDS->exec_prepared();
+    }
+    m_pDS->close();
+    CommitTransaction();
+
+    journal.ClearChanges();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+
+  return false;
+}
+
+void CVideoDatabase::InvalidateScanJournal(const std::string &path)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    // forget the state of the directory itself, so that it's listed again
+    m_pDS->exec(PrepareSQL("UPDATE scanjournal SET dirTime=0 WHERE strPathHash='%s'", XBMC::XBMC_MD5::GetMD5(path).c_str()));
+
+    // the hash of a directory covers its subdirectories, so all parents change as well
+    std::string current(path);
+    while (!current.empty())
+    {
+      m_pDS->exec(PrepareSQL("UPDATE scanjournal SET strHash='' WHERE strPathHash='%s'", XBMC::XBMC_MD5::GetMD5(current).c_str()));
+      std::string parent = URIUtils::GetParentPath(current);
+      if (parent == current)
+        break;
+      current = parent;
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+}
+
+void CVideoDatabase::DeleteScanJournal(const std::string &path)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    m_pDS->exec(PrepareSQL("DELETE FROM scanjournal WHERE strPath LIKE '%s%%'", path.c_str()));
+    InvalidateScanJournal(path);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+}
+
 bool CVideoDatabase::GetSourcePath(const std::string &path, std::string &sourcePath)
 {
   SScanSettings dummy;
@@ -959,6 +1095,10 @@ bool CVideoDatabase::SetPathHash(const std::string &path, const std::string &has
     std::string strSQL=PrepareSQL("update path set strHash='%s' where idPath=%ld", hash.c_str(), idPath);
     m_pDS->exec(strSQL);
 
+    // the journal is only valid for folders that were scanned
+    if (hash.empty())
+      DeleteScanJournal(path);
+
     return true;
   }
   catch (...)
@@ -4563,6 +4703,7 @@ void CVideoDatabase::RemoveContentForPath(const std::string& strPath, CGUIDialog
         m_pDS2->exec(PrepareSQL("update path set strContent='', strScraper='', strHash='',strSettings='',useFolderNames=0,scanRecursive=0 where idPath=%i", i.first));
       }
     }
+    DeleteScanJournal(strPath);
   }
   catch (...)
   {
@@ -5154,11 +5295,18 @@ void CVideoDatabase::UpdateTables(int iVersion)
       pDS->close();
     }
   }
+
+  if (iVersion < 109)
+  {
+    // the journal only saves listings, it's simply started over with the path hash column
+    m_pDS->exec("DROP TABLE IF EXISTS scanjournal");
+    m_pDS->exec("CREATE TABLE scanjournal ( idJournal integer primary key, strPath text, strPathHash text, dirTime integer, entries integer, strHash text)");
+  }
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 107;
+  return 109;
 }
 
 bool CVideoDatabase::LookupByFolders(const std::string &path, bool shows)
@@ -5585,14 +5733,14 @@ bool CVideoDatabase::GetNavCommon(const std::string& strBaseDir, CFileItemList&
     if (!BuildSQL(strBaseDir, strSQL, extFilter, strSQL, videoUrl))
       return false;
 
-    int iRowsFound = RunQuery(strSQL);
+    int iRowsFound = StreamQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
 
     if (countOnly)
     {
       CFileItemPtr pItem(new CFileItem());
-      pItem->SetProperty("total", iRowsFound == 1 ? m_pDS->fv(0).get_asInt() : iRowsFound);
+      pItem->SetProperty("total", m_pDS->fv(0).get_asInt());
       items.Add(pItem);
 
       m_pDS->close();
@@ -5767,14 +5915,14 @@ bool CVideoDatabase::GetMusicVideoAlbumsNav(const std::string& strBaseDir, CFile
     if (!BuildSQL(videoUrl.ToString(), strSQL, extFilter, strSQL, videoUrl))
       return false;
 
-    int iRowsFound = RunQuery(strSQL);
+    int iRowsFound = StreamQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
 
     if (countOnly)
     {
       CFileItemPtr pItem(new CFileItem());
-      pItem->SetProperty("total", iRowsFound == 1 ? m_pDS->fv(0).get_asInt() : iRowsFound);
+      pItem->SetProperty("total", m_pDS->fv(0).get_asInt());
       items.Add(pItem);
 
       m_pDS->close();
@@ -6183,7 +6331,7 @@ bool CVideoDatabase::GetYearsNav(const std::string& strBaseDir, CFileItemList& i
     if (!BuildSQL(strBaseDir, strSQL, extFilter, strSQL, videoUrl))
       return false;
 
-    int iRowsFound = RunQuery(strSQL);
+    int iRowsFound = StreamQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
 
@@ -8441,6 +8589,7 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
                    "AND (exclude IS NULL OR exclude != 1))";
     m_pDS->query(sql);
     std::string strIds;
+    std::vector<std::string> deletedPaths;
     while (!m_pDS->eof())
     {
       auto pathsDeleteDecision = pathsDeleteDecisions.find(m_pDS->fv(0).get_asInt());
@@ -8450,7 +8599,10 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
            (pathsDeleteDecision == pathsDeleteDecisions.end() && !CDirectory::Exists(m_pDS->fv(1).get_asString(), false))) &&
           ((pathsDeleteDecisionByParent != pathsDeleteDecisions.end() && pathsDeleteDecisionByParent->second) ||
            (pathsDeleteDecisionByParent == pathsDeleteDecisions.end())))
+      {
         strIds += m_pDS->fv(0).get_asString() + ",";
+        deletedPaths.push_back(m_pDS->fv(1).get_asString());
+      }
 
       m_pDS->next();
     }
@@ -8462,6 +8614,8 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
       m_pDS->exec(sql);
       sql = "DELETE FROM tvshowlinkpath WHERE NOT EXISTS (SELECT 1 FROM path WHERE path.idPath = tvshowlinkpath.idPath)";
       m_pDS->exec(sql);
+      for (std::vector<std::string>::const_iterator it = deletedPaths.begin(); it != deletedPaths.end(); ++it)
+        DeleteScanJournal(*it);
     }
 
     CLog::Log(LOGDEBUG, "%s: Cleaning tvshow table", __FUNCTION__);
@@ -8509,6 +8663,11 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
                 , VIDEODB_ID_PARENTPATHID, VIDEODB_ID_EPISODE_PARENTPATHID, VIDEODB_ID_MUSICVIDEO_PARENTPATHID );
     m_pDS->exec(sql);
 
+    CLog::Log(LOGDEBUG, "%s: Cleaning scanjournal table", __FUNCTION__);
+    sql = "DELETE FROM scanjournal "
+            "WHERE NOT EXISTS (SELECT 1 FROM path WHERE path.strPath = scanjournal.strPath AND path.strHash != '')";
+    m_pDS->exec(sql);
+
     CLog::Log(LOGDEBUG, "%s: Cleaning genre table", __FUNCTION__);
     sql = "DELETE FROM genre "
             "WHERE NOT EXISTS (SELECT 1 FROM genre_link WHERE genre_link.genre_id = genre.genre_id)";
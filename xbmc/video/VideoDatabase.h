@@ -64,6 +64,7 @@ typedef std::vector<CVideoInfoTag> VECMOVIES;
 
 namespace VIDEO
 {
+  class CVideoScanJournal;
   class IVideoInfoScannerObserver;
   struct SScanSettings;
 }
@@ -655,6 +656,24 @@ public:
   bool GetPaths(std::set<std::string> &paths);
   bool GetPathsForTvShow(int idShow, std::set<int>& paths);
 
+  /*! \brief Load the state of the scanned directories.
+   \param journal [out] the directories of all sources.
+   \return true on success, false otherwise.
+   */
+  bool GetScanJournal(VIDEO::CVideoScanJournal &journal);
+
+  /*! \brief Store the directories of a journal that changed since it was loaded.
+   \param journal the journal, its changes are cleared once stored.
+   \return true on success, false otherwise.
+   */
+  bool SetScanJournal(VIDEO::CVideoScanJournal &journal);
+
+  /*! \brief Mark a directory and its parents as changed in the scan journal */
+  void InvalidateScanJournal(const std::string &path);
+
+  /*! \brief Forget a directory and its subdirectories in the scan journal, and mark its parents as changed */
+  void DeleteScanJournal(const std::string &path);
+
   /*! \brief return the paths linked to a tvshow.
    \param idShow the id of the tvshow.
    \param paths [out] the list of paths associated with the show.
@@ -948,6 +967,14 @@ private:
    */
   int RunQuery(const std::string &sql);
 
+  /*! \brief Run a query on the main dataset as a prepared statement, fetching one row at a time
+   Only forward iteration with eof() and next() is possible, num_rows() counts the rows fetched so far.
+   If no rows are found we close the dataset and return 0.
+   \param sql the sql query to run
+   \return 1 if there are rows, 0 if there are none, -1 for an error.
+   */
+  int StreamQuery(const std::string &sql);
+
   void AppendIdLinkFilter(const char* field, const char *table, const MediaType& mediaType, const char *view, const char *viewKey, const CUrlOptions::UrlOptions& options, Filter &filter);
   void AppendLinkFilter(const char* field, const char *table, const MediaType& mediaType, const char *view, const char *viewKey, const CUrlOptions::UrlOptions& options, Filter &filter);
 
@@ -29,6 +29,7 @@
 #include "events/MediaLibraryEvent.h"
 #include "FileItem.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/DirectoryWatcher.h"
 #include "filesystem/File.h"
 #include "filesystem/MultiPathDirectory.h"
 #include "filesystem/StackDirectory.h"
@@ -76,6 +77,7 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_watchSources = false;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -114,6 +116,7 @@ namespace VIDEO
       unsigned int tick = XbmcThreads::SystemClockMillis();
 
       m_database.Open();
+      LoadScanJournal();
 
       m_bCanInterrupt = true;
 
@@ -159,6 +162,9 @@ namespace VIDEO
 
       if (!bCancelled)
       {
+        // a cancelled scan may not have visited all subfolders of the folders it recorded
+        SaveScanJournal();
+
         if (m_bClean)
           CVideoLibraryQueue::GetInstance().CleanLibrary(m_pathsToClean, false, m_handle);
         else
@@ -258,6 +264,7 @@ namespace VIDEO
 
     // load subfolder
     CFileItemList items;
+    std::vector<std::string> subdirs;
     bool foundDirectly = false;
     bool bSkip = false;
 
@@ -277,6 +284,8 @@ namespace VIDEO
       return true;
 
     std::string hash, dbHash;
+    int64_t time = 0;
+    bool listed = false;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
     {
       if (m_handle)
@@ -285,13 +294,38 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str).c_str(), info->Name().c_str()));
       }
 
+      // the journal is only trusted for folders that are in the library, their
+      // hash is cleared when the folder is removed or has to be scanned again
+      bool known = m_database.GetPathHash(strDirectory, dbHash) && !dbHash.empty();
+
+      if (m_watchSources && known && m_journal.IsSubtreeUnchanged(strDirectory))
+      { // nothing in this folder or below changed since it was last scanned
+        CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' and its subfolders due to no change (watched)", CURL::GetRedacted(strDirectory).c_str());
+        return true;
+      }
+
       std::string fastHash;
       if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        fastHash = GetFastHash(strDirectory, regexps);
+      {
+        // watch before looking at the folder so no change after it goes unnoticed
+        if (m_watchSources)
+          CDirectoryWatcher::GetInstance().Watch(strDirectory);
+        time = GetDirectoryTime(strDirectory);
+        fastHash = GetFastHash(time, regexps);
+      }
 
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+      bool unchanged = false;
+      if (known && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         hash = fastHash;
+        m_journal.Set(strDirectory, time);
+      }
+      else if (known && m_journal.IsUnchanged(strDirectory, time))
+      { // same entries as at the last scan - visit the known subfolders instead of fetching the folder
+        hash = dbHash;
+        unchanged = true;
+        m_journal.Set(strDirectory, time);
+        m_journal.GetSubdirectories(strDirectory, subdirs);
       }
       else
       { // need to fetch the folder
@@ -303,9 +337,16 @@ namespace VIDEO
           GetPathHash(items, hash);
         else
           hash = fastHash;
+
+        listed = true;
       }
 
-      if (hash == dbHash)
+      if (unchanged)
+      { // no files added, removed or renamed - skipping
+        CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (journal)", CURL::GetRedacted(strDirectory).c_str());
+        bSkip = true;
+      }
+      else if (hash == dbHash)
       { // hash matches - skipping
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change%s", CURL::GetRedacted(strDirectory).c_str(), !fastHash.empty() ? " (fasthash)" : "");
         bSkip = true;
@@ -352,12 +393,15 @@ namespace VIDEO
       }
     }
 
+    // whether the folder is done with, i.e. doesn't need to be fetched again unless it changes
+    bool done = bSkip;
     if (!bSkip)
     {
       if (RetrieveVideoInfo(items, settings.parent_name_root, content))
       {
         if (!m_bStop && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
         {
+          done = true;
           m_database.SetPathHash(strDirectory, hash);
           if (m_bClean)
             m_pathsToClean.insert(m_database.GetPathId(strDirectory));
@@ -376,6 +420,9 @@ namespace VIDEO
       m_database.SetPathHash(strDirectory, hash);
     }
 
+    if (listed)
+      UpdateScanJournal(strDirectory, time, hash, items, done);
+
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
@@ -396,6 +443,13 @@ namespace VIDEO
         }
       }
     }
+
+    // subfolders of a folder that wasn't fetched
+    for (std::vector<std::string>::const_iterator it = subdirs.begin(); it != subdirs.end() && !m_bStop; ++it)
+    {
+      if (settings.recurse > 0 && !DoScan(*it))
+        m_bStop = true;
+    }
     return !m_bStop;
   }
 
@@ -1799,27 +1853,109 @@ namespace VIDEO
     return true;
   }
 
-  std::string CVideoInfoScanner::GetFastHash(const std::string &directory,
+  int64_t CVideoInfoScanner::GetDirectoryTime(const std::string &directory) const
+  {
+    struct __stat64 buffer;
+    if (XFILE::CFile::Stat(directory, &buffer) == 0)
+    {
+      int64_t time = buffer.st_mtime;
+      if (!time)
+        time = buffer.st_ctime;
+      return time;
+    }
+    return 0;
+  }
+
+  std::string CVideoInfoScanner::GetFastHash(int64_t time,
       const std::vector<std::string> &excludes) const
   {
+    if (!time)
+      return "";
+
     XBMC::XBMC_MD5 md5state;
 
     if (excludes.size())
       md5state.append(StringUtils::Join(excludes, "|"));
 
-    struct __stat64 buffer;
-    if (XFILE::CFile::Stat(directory, &buffer) == 0)
+    md5state.append((unsigned char *)&time, sizeof(time));
+    return md5state.getDigest();
+  }
+
+  void CVideoInfoScanner::UpdateScanJournal(const std::string &directory, int64_t time, const std::string &hash, const CFileItemList &items, bool done)
+  {
+    std::set<std::string> folders;
+    int videos = 0;
+    for (int i = 0; i < items.Size(); ++i)
     {
-      int64_t time = buffer.st_mtime;
-      if (!time)
-        time = buffer.st_ctime;
-      if (time)
-      {
-        md5state.append((unsigned char *)&time, sizeof(time));
-        return md5state.getDigest();
-      }
+      const CFileItemPtr &item = items[i];
+      if (item->m_bIsFolder)
+        folders.insert(item->GetPath());
+      else if (item->IsVideo() && !item->IsPlayList() && !item->IsNFO())
+        videos++;
     }
-    return "";
+
+    // videos that failed to be added are retried on the next scan
+    if (!time || (!done && videos > 0))
+    {
+      m_journal.Invalidate(directory);
+      return;
+    }
+
+    // a folder with nothing but subfolders adds nothing itself, its hash
+    // marks it as scanned so the journal can be trusted for it
+    if (!done)
+    {
+      if (m_bStop)
+        return;
+      m_database.SetPathHash(directory, hash);
+    }
+
+    m_journal.Set(directory, time, items.Size());
+    m_journal.RemoveMissing(directory, folders);
+  }
+
+  void CVideoInfoScanner::LoadScanJournal()
+  {
+    m_journal.Clear();
+    m_watchSources = false;
+    if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
+      return;
+
+    m_database.GetScanJournal(m_journal);
+
+    if (!g_advancedSettings.m_bVideoLibraryWatchSources || !CDirectoryWatcher::IsSupported())
+      return;
+
+    m_watchSources = true;
+    CDirectoryWatcher &watcher = CDirectoryWatcher::GetInstance();
+    std::set<std::string> changed;
+    if (!watcher.GetChanges(changed))
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: Changes of watched folders were lost");
+
+    for (std::set<std::string>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+      m_journal.Invalidate(*it);
+
+    // only the subtrees watched since their last scan can be trusted
+    const CVideoScanJournal::Entries &entries = m_journal.GetEntries();
+    std::vector<std::string> unwatched;
+    for (CVideoScanJournal::Entries::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+      if (!it->second.hash.empty() && !watcher.IsWatched(it->first))
+        unwatched.push_back(it->first);
+    }
+    for (std::vector<std::string>::const_iterator it = unwatched.begin(); it != unwatched.end(); ++it)
+      m_journal.Invalidate(*it);
+
+    CLog::Log(LOGDEBUG, "VideoInfoScanner: %u folders changed, %u not watched", (unsigned int)changed.size(), (unsigned int)unwatched.size());
+  }
+
+  void CVideoInfoScanner::SaveScanJournal()
+  {
+    if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
+      return;
+
+    m_journal.UpdateHashes();
+    m_database.SetScanJournal(m_journal);
   }
 
   std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory,
@@ -26,6 +26,7 @@
 #include "InfoScanner.h"
 #include "NfoFile.h"
 #include "VideoDatabase.h"
+#include "VideoScanJournal.h"
 #include "addons/Scraper.h"
 
 class CRegExp;
@@ -187,17 +188,24 @@ namespace VIDEO
 
     static int GetPathHash(const CFileItemList &items, std::string &hash);
 
-    /*! \brief Retrieve a "fast" hash of the given directory (if available)
-     Performs a stat() on the directory, and uses modified time to create a "fast"
-     hash of the folder. If no modified time is available, the create time is used,
-     and if neither are available, an empty hash is returned.
+    /*! \brief Retrieve the time a directory was last changed
+     Performs a stat() on the directory and returns the modified time. If no modified
+     time is available, the create time is used.
+     \param directory folder to stat
+     \return the time of the folder, 0 if neither is available
+     */
+    int64_t GetDirectoryTime(const std::string &directory) const;
+
+    /*! \brief Retrieve a "fast" hash of a directory (if available)
+     Uses the modified time of the directory to create a "fast" hash of the folder.
+     If no time is available, an empty hash is returned.
      In case exclude from scan expressions are present, the string array will be appended
      to the md5 hash to ensure we're doing a re-scan whenever the user modifies those.
-     \param directory folder to hash
+     \param time the time of the folder as returned by GetDirectoryTime()
      \param excludes string array of exclude expressions
      \return the md5 hash of the folder"
      */
-    std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    std::string GetFastHash(int64_t time, const std::vector<std::string> &excludes) const;
 
     /*! \brief Retrieve a "fast" hash of the given directory recursively (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
@@ -221,6 +229,24 @@ namespace VIDEO
      */
     bool CanFastHash(const CFileItemList &items, const std::vector<std::string> &excludes) const;
 
+    /*! \brief Load the scan journal and apply the changes reported by the directory watcher
+     Directories that aren't watched may have changed in any way, so their subtrees
+     are never skipped as a whole.
+     */
+    void LoadScanJournal();
+
+    /*! \brief Record the state of a fetched folder in the scan journal
+     \param directory the folder
+     \param time its modified time
+     \param hash the hash of the listing
+     \param items the listing of the folder
+     \param done whether the videos of the folder were added to the library
+     */
+    void UpdateScanJournal(const std::string &directory, int64_t time, const std::string &hash, const CFileItemList &items, bool done);
+
+    /*! \brief Update the hashes of the scan journal and store it in the database */
+    void SaveScanJournal();
+
     /*! \brief Process a series folder, filling in episode details and adding them to the database.
      @todo Ideally we would return INFO_HAVE_ALREADY if we don't have to update any episodes
      and we should return INFO_NOT_FOUND only if no information is found for any of
@@ -248,12 +274,14 @@ namespace VIDEO
     bool m_bCanInterrupt;
     bool m_bClean;
     bool m_scanAll;
+    bool m_watchSources;
     std::string m_strStartDir;
     CVideoDatabase m_database;
     std::set<std::string> m_pathsToScan;
     std::set<std::string> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CVideoScanJournal m_journal;
   };
 }
 
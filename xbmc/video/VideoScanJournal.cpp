@@ -0,0 +1,181 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoScanJournal.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+namespace VIDEO
+{
+
+CVideoScanJournal::CVideoScanJournal()
+{
+}
+
+void CVideoScanJournal::Clear()
+{
+  m_entries.clear();
+  m_removed.clear();
+}
+
+void CVideoScanJournal::Add(const std::string &path, int64_t time, int entries, const std::string &hash)
+{
+  Entry &entry = m_entries[path];
+  entry.time = time;
+  entry.entries = entries;
+  entry.hash = hash;
+  entry.stored = hash;
+  entry.verified = false;
+  entry.changed = false;
+}
+
+void CVideoScanJournal::Set(const std::string &path, int64_t time, int entries /* = -1 */)
+{
+  std::pair<Entries::iterator, bool> result = m_entries.insert(std::make_pair(path, Entry()));
+  Entry &entry = result.first->second;
+  if (result.second || entry.time != time || (entries >= 0 && entry.entries != entries))
+    entry.changed = true;
+
+  entry.time = time;
+  if (entries >= 0)
+    entry.entries = entries;
+  entry.verified = true;
+  m_removed.erase(path);
+}
+
+void CVideoScanJournal::Remove(const std::string &path)
+{
+  Entries::iterator it = m_entries.lower_bound(path);
+  while (it != m_entries.end() && (it->first == path || IsSubdirectory(path, it->first)))
+  {
+    m_removed.insert(it->first);
+    it = m_entries.erase(it);
+  }
+}
+
+void CVideoScanJournal::RemoveMissing(const std::string &path, const std::set<std::string> &folders)
+{
+  std::vector<std::string> subdirs;
+  GetSubdirectories(path, subdirs);
+  for (std::vector<std::string>::const_iterator it = subdirs.begin(); it != subdirs.end(); ++it)
+  {
+    if (folders.find(*it) == folders.end())
+      Remove(*it);
+  }
+}
+
+void CVideoScanJournal::Invalidate(const std::string &path)
+{
+  std::string current(path);
+  while (!current.empty())
+  {
+    Entries::iterator it = m_entries.find(current);
+    if (it != m_entries.end())
+    {
+      it->second.hash.clear();
+      it->second.verified = false;
+    }
+
+    std::string parent = URIUtils::GetParentPath(current);
+    if (parent == current)
+      break;
+    current = parent;
+  }
+}
+
+bool CVideoScanJournal::IsUnchanged(const std::string &path, int64_t time) const
+{
+  Entries::const_iterator it = m_entries.find(path);
+  return time != 0 && it != m_entries.end() && it->second.time == time && it->second.entries > 0;
+}
+
+bool CVideoScanJournal::IsSubtreeUnchanged(const std::string &path) const
+{
+  Entries::const_iterator it = m_entries.find(path);
+  return it != m_entries.end() && !it->second.hash.empty();
+}
+
+void CVideoScanJournal::GetSubdirectories(const std::string &path, std::vector<std::string> &subdirs) const
+{
+  for (Entries::const_iterator it = m_entries.upper_bound(path); it != m_entries.end() && IsSubdirectory(path, it->first); ++it)
+  {
+    if (URIUtils::GetParentPath(it->first) == path)
+      subdirs.push_back(it->first);
+  }
+}
+
+void CVideoScanJournal::UpdateHashes()
+{
+  // subdirectories sort after their parent, so walking backwards visits
+  // every directory after all of its subdirectories
+  std::map<std::string, std::string> childHashes;
+  std::set<std::string> incomplete;
+  for (Entries::reverse_iterator it = m_entries.rbegin(); it != m_entries.rend(); ++it)
+  {
+    Entry &entry = it->second;
+    std::string hash;
+    if ((entry.verified || !entry.hash.empty()) && incomplete.find(it->first) == incomplete.end())
+    {
+      XBMC::XBMC_MD5 md5state;
+      md5state.append((unsigned char *)&entry.time, sizeof(entry.time));
+      md5state.append((unsigned char *)&entry.entries, sizeof(entry.entries));
+      std::map<std::string, std::string>::const_iterator children = childHashes.find(it->first);
+      if (children != childHashes.end())
+        md5state.append(children->second);
+      hash = md5state.getDigest();
+    }
+
+    entry.hash = hash;
+
+    std::string parent = URIUtils::GetParentPath(it->first);
+    if (hash.empty())
+      incomplete.insert(parent);
+    else
+      childHashes[parent] += hash;
+  }
+}
+
+void CVideoScanJournal::GetChanges(Entries &changed, std::vector<std::string> &removed) const
+{
+  for (Entries::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.changed || it->second.hash != it->second.stored)
+      changed.insert(*it);
+  }
+  removed.assign(m_removed.begin(), m_removed.end());
+}
+
+void CVideoScanJournal::ClearChanges()
+{
+  for (Entries::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    it->second.stored = it->second.hash;
+    it->second.changed = false;
+  }
+  m_removed.clear();
+}
+
+bool CVideoScanJournal::IsSubdirectory(const std::string &path, const std::string &subdir)
+{
+  return subdir.size() > path.size() && StringUtils::StartsWith(subdir, path);
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace VIDEO
+{
+  /*!
+   \brief State of the directories of the video sources at their last scan.
+
+   Every directory visited by the scanner is recorded with its modified time
+   and number of entries. Together with the entries of its subdirectories this
+   forms a hash tree: the hash of a directory covers its whole subtree and is
+   cleared (along with the hashes of all its parents) as soon as anything in
+   the subtree is known to have changed. A directory with a hash can therefore
+   be skipped along with all of its subdirectories, without listing them.
+   */
+  class CVideoScanJournal
+  {
+  public:
+    struct Entry
+    {
+      Entry() : time(0), entries(0), verified(false), changed(false) {}
+
+      int64_t time;         ///< modified (or created) time of the directory
+      int entries;          ///< number of entries at the last listing
+      std::string hash;     ///< hash of the subtree, empty if it may have changed
+      std::string stored;   ///< hash in the database
+      bool verified;        ///< the state was confirmed during this scan
+      bool changed;         ///< time or entries differ from the database
+    };
+    typedef std::map<std::string, Entry> Entries;
+
+    CVideoScanJournal();
+
+    void Clear();
+
+    /*! \brief Add a directory as read from the database */
+    void Add(const std::string &path, int64_t time, int entries, const std::string &hash);
+
+    /*!
+     \brief Record the current state of a directory.
+     \param path the directory
+     \param time its modified time, 0 if unknown
+     \param entries number of entries if it was listed, -1 to keep the previous count
+     */
+    void Set(const std::string &path, int64_t time, int entries = -1);
+
+    /*! \brief Remove a directory and all its subdirectories */
+    void Remove(const std::string &path);
+
+    /*!
+     \brief Remove the subdirectories of a directory that are no longer in its listing.
+     \param path the directory
+     \param folders the subdirectories found in the listing
+     */
+    void RemoveMissing(const std::string &path, const std::set<std::string> &folders);
+
+    /*! \brief Mark a directory as changed, clearing the hashes up to the root */
+    void Invalidate(const std::string &path);
+
+    /*!
+     \brief Whether the entries of a directory are unchanged since it was listed.
+     Relies on the modified time of a directory changing whenever entries are
+     added, removed or renamed, the same as the "fast" hash. Empty directories
+     are always reported as changed, they are cheap to list and have to stay
+     on the clean list of the scanner.
+     */
+    bool IsUnchanged(const std::string &path, int64_t time) const;
+
+    /*! \brief Whether nothing in the subtree of a directory changed since it was scanned */
+    bool IsSubtreeUnchanged(const std::string &path) const;
+
+    /*! \brief Get the recorded subdirectories of a directory */
+    void GetSubdirectories(const std::string &path, std::vector<std::string> &subdirs) const;
+
+    /*!
+     \brief Recalculate the hashes of all verified subtrees.
+     A directory gets a hash if its own state is known and all of its
+     subdirectories have a hash.
+     */
+    void UpdateHashes();
+
+    /*! \brief Get the directories that need to be written to the database */
+    void GetChanges(Entries &changed, std::vector<std::string> &removed) const;
+
+    /*! \brief Mark the state as written to the database */
+    void ClearChanges();
+
+    const Entries& GetEntries() const { return m_entries; }
+
+  private:
+    static bool IsSubdirectory(const std::string &path, const std::string &subdir);
+
+    Entries m_entries;
+    std::set<std::string> m_removed;
+  };
+}
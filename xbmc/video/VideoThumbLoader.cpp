@@ -111,7 +111,12 @@ bool CThumbExtractor::DoWork()
     // construct the thumb cache file
     CTextureDetails details;
     details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, m_fillStreamDetails ? &m_item.GetVideoInfoTag()->m_streamDetails : NULL, (int) m_pos);
+    bool cancelled = false;
+    result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, m_fillStreamDetails ? &m_item.GetVideoInfoTag()->m_streamDetails : NULL, (int) m_pos,
+                                        m_codecs.get(), this, &cancelled);
+    if (cancelled)
+      return false;
+
     if(result)
     {
       CTextureCache::GetInstance().AddCachedTexture(m_target, details);
@@ -130,6 +135,12 @@ bool CThumbExtractor::DoWork()
         }
       }
     }
+    else if (m_fillStreamDetails && m_item.GetVideoInfoTag()->HasStreamDetails())
+    {
+      // the stream details were read along with the thumb, store them even
+      // without a thumb so the file isn't probed again for them
+      result = true;
+    }
   }
   else if (!m_item.IsPlugin() &&
            (!m_item.HasVideoInfoTag() ||
@@ -180,7 +191,8 @@ bool CThumbExtractor::DoWork()
 }
 
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(), CJobQueue(true, 1, CJob::PRIORITY_LOW_PAUSABLE)
+  CThumbLoader(), CJobQueue(true, g_advancedSettings.m_videoExtractionJobs, CJob::PRIORITY_LOW_PAUSABLE),
+  m_codecs(new CDVDThumbCodecCache(g_advancedSettings.m_videoExtractionJobs))
 {
   m_videoDatabase = new CVideoDatabase();
 }
@@ -397,6 +409,7 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
           SetupRarOptions(item,path);
 
         CThumbExtractor* extract = new CThumbExtractor(item, path, true, thumbURL);
+        extract->m_codecs = m_codecs;
         AddJob(extract);
 
         m_videoDatabase->Close();
@@ -422,6 +435,11 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
   return true;
 }
 
+void CVideoThumbLoader::CancelExtraction()
+{
+  CancelJobs();
+}
+
 void CVideoThumbLoader::SetArt(CFileItem &item, const std::map<std::string, std::string> &artwork)
 {
   item.SetArt(artwork);
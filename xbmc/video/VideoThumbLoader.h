@@ -20,11 +20,13 @@
  */
 
 #include <map>
+#include <memory>
 #include <vector>
 #include "ThumbLoader.h"
 #include "utils/JobManager.h"
 #include "FileItem.h"
 
+class CDVDThumbCodecCache;
 class CStreamDetails;
 class CVideoDatabase;
 
@@ -60,6 +62,7 @@ public:
   bool       m_thumb; ///< extract thumb?
   int64_t    m_pos; ///< position to extract thumb from
   bool m_fillStreamDetails; ///< fill in stream details? 
+  std::shared_ptr<CDVDThumbCodecCache> m_codecs; ///< decoders shared between the jobs, may be empty
 };
 
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
@@ -83,6 +86,12 @@ public:
    */
   virtual bool FillThumb(CFileItem &item);
 
+  /*! \brief Cancel the extraction of thumbs and stream details for the items loaded so far
+   Running extractions stop at the next packet, items that were not done
+   are extracted again the next time they are loaded.
+   */
+  void CancelExtraction();
+
   /*! \brief Find a particular art type for a given item, optionally checking at the folder level
    \param item the CFileItem to search.
    \param type the type of art to look for.
@@ -131,6 +140,7 @@ protected:
   typedef std::map<int, std::map<std::string, std::string> > ArtCache;
   ArtCache m_showArt;
   ArtCache m_seasonArt;
+  std::shared_ptr<CDVDThumbCodecCache> m_codecs;
 
   /*! \brief Tries to detect missing data/info from a file and adds those
    \param item The CFileItem to process
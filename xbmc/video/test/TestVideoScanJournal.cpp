@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoScanJournal.h"
+
+#include "gtest/gtest.h"
+
+using namespace VIDEO;
+
+namespace
+{
+
+// smb://server/movies/
+//   a/
+//     a1/
+//     a2/
+//   b/
+void Scan(CVideoScanJournal &journal, int64_t time = 100)
+{
+  journal.Set("smb://server/movies/", time, 2);
+  journal.Set("smb://server/movies/a/", time, 2);
+  journal.Set("smb://server/movies/a/a1/", time, 3);
+  journal.Set("smb://server/movies/a/a2/", time, 3);
+  journal.Set("smb://server/movies/b/", time, 1);
+  journal.UpdateHashes();
+}
+
+}
+
+TEST(TestVideoScanJournal, Unchanged)
+{
+  CVideoScanJournal journal;
+  Scan(journal);
+
+  EXPECT_TRUE(journal.IsUnchanged("smb://server/movies/a/", 100));
+  EXPECT_FALSE(journal.IsUnchanged("smb://server/movies/a/", 101));
+  EXPECT_FALSE(journal.IsUnchanged("smb://server/movies/a/", 0));
+  EXPECT_FALSE(journal.IsUnchanged("smb://server/movies/c/", 100));
+
+  // empty folders are always listed
+  journal.Set("smb://server/movies/c/", 100, 0);
+  EXPECT_FALSE(journal.IsUnchanged("smb://server/movies/c/", 100));
+
+  std::vector<std::string> subdirs;
+  journal.GetSubdirectories("smb://server/movies/", subdirs);
+  ASSERT_EQ(3u, subdirs.size());
+  EXPECT_EQ("smb://server/movies/a/", subdirs[0]);
+  EXPECT_EQ("smb://server/movies/b/", subdirs[1]);
+  EXPECT_EQ("smb://server/movies/c/", subdirs[2]);
+}
+
+TEST(TestVideoScanJournal, Hashes)
+{
+  CVideoScanJournal journal;
+  Scan(journal);
+  const CVideoScanJournal::Entries &entries = journal.GetEntries();
+  std::string root = entries.find("smb://server/movies/")->second.hash;
+  std::string a = entries.find("smb://server/movies/a/")->second.hash;
+  std::string b = entries.find("smb://server/movies/b/")->second.hash;
+  EXPECT_FALSE(root.empty());
+  EXPECT_NE(a, b);
+
+  // a change deep down changes all hashes up to the root
+  journal.Set("smb://server/movies/a/a2/", 200, 4);
+  journal.UpdateHashes();
+  EXPECT_NE(root, entries.find("smb://server/movies/")->second.hash);
+  EXPECT_NE(a, entries.find("smb://server/movies/a/")->second.hash);
+  EXPECT_EQ(b, entries.find("smb://server/movies/b/")->second.hash);
+
+  // and back
+  journal.Set("smb://server/movies/a/a2/", 100, 3);
+  journal.UpdateHashes();
+  EXPECT_EQ(root, entries.find("smb://server/movies/")->second.hash);
+}
+
+TEST(TestVideoScanJournal, Invalidate)
+{
+  CVideoScanJournal journal;
+  Scan(journal);
+  EXPECT_TRUE(journal.IsSubtreeUnchanged("smb://server/movies/"));
+
+  journal.Invalidate("smb://server/movies/a/a1/");
+  EXPECT_FALSE(journal.IsSubtreeUnchanged("smb://server/movies/a/a1/"));
+  EXPECT_FALSE(journal.IsSubtreeUnchanged("smb://server/movies/a/"));
+  EXPECT_FALSE(journal.IsSubtreeUnchanged("smb://server/movies/"));
+  EXPECT_TRUE(journal.IsSubtreeUnchanged("smb://server/movies/a/a2/"));
+  EXPECT_TRUE(journal.IsSubtreeUnchanged("smb://server/movies/b/"));
+
+  // not scanned again yet, so the hashes stay cleared
+  journal.UpdateHashes();
+  EXPECT_FALSE(journal.IsSubtreeUnchanged("smb://server/movies/a/"));
+  EXPECT_TRUE(journal.IsSubtreeUnchanged("smb://server/movies/a/a2/"));
+
+  // the state of the parents is still known, only the changed folder needs a scan
+  journal.Set("smb://server/movies/a/a1/", 100);
+  journal.UpdateHashes();
+  EXPECT_FALSE(journal.IsSubtreeUnchanged("smb://server/movies/a/"));
+  journal.Set("smb://server/movies/a/", 100);
+  journal.Set("smb://server/movies/", 100);
+  journal.UpdateHashes();
+  EXPECT_TRUE(journal.IsSubtreeUnchanged("smb://server/movies/"));
+}
+
+TEST(TestVideoScanJournal, RemoveMissing)
+{
+  CVideoScanJournal journal;
+  Scan(journal);
+
+  std::set<std::string> folders;
+  folders.insert("smb://server/movies/b/");
+  journal.RemoveMissing("smb://server/movies/", folders);
+
+  EXPECT_EQ(2u, journal.GetEntries().size());
+  CVideoScanJournal::Entries changed;
+  std::vector<std::string> removed;
+  journal.GetChanges(changed, removed);
+  EXPECT_EQ(3u, removed.size());
+}
+
+TEST(TestVideoScanJournal, Changes)
+{
+  CVideoScanJournal journal;
+  journal.Add("smb://server/movies/", 100, 2, "");
+  journal.Add("smb://server/movies/a/", 100, 2, "");
+
+  CVideoScanJournal::Entries changed;
+  std::vector<std::string> removed;
+  journal.GetChanges(changed, removed);
+  EXPECT_TRUE(changed.empty());
+
+  // confirming the state only changes the hashes
+  Scan(journal);
+  journal.GetChanges(changed, removed);
+  EXPECT_EQ(5u, changed.size());
+  journal.ClearChanges();
+
+  changed.clear();
+  Scan(journal);
+  journal.GetChanges(changed, removed);
+  EXPECT_TRUE(changed.empty());
+  EXPECT_TRUE(removed.empty());
+
+  // a directory that's scanned again after a change ends up with the same hash
+  journal.Invalidate("smb://server/movies/b/");
+  Scan(journal);
+  journal.GetChanges(changed, removed);
+  EXPECT_TRUE(changed.empty());
+}
@@ -0,0 +1,57 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "FileItem.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "video/VideoThumbLoader.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+TEST(TestVideoThumbLoader, CancelQueuedExtraction)
+{
+  CJobManager &jobs = CJobManager::GetInstance();
+
+  // keep the extractions queued
+  jobs.PauseJobs();
+  unsigned int queued = jobs.GetStats(CJob::PRIORITY_LOW_PAUSABLE).queued;
+
+  // two files are opened at once, the third waits in the loader
+  CVideoThumbLoader loader;
+  loader.SetJobsAtOnce(2);
+  for (int i = 0; i < 3; i++)
+  {
+    std::string path = "special://temp/TestVideoThumbLoader" + std::to_string(i) + ".mkv";
+    CFileItem item(path, false);
+    loader.AddJob(new CThumbExtractor(item, path, true, path));
+  }
+  EXPECT_TRUE(loader.IsProcessing());
+  EXPECT_EQ(queued + 2, jobs.GetStats(CJob::PRIORITY_LOW_PAUSABLE).queued);
+
+  // leaving the list drops what wasn't extracted yet
+  loader.CancelExtraction();
+  EXPECT_FALSE(loader.IsProcessing());
+  EXPECT_EQ(queued, jobs.GetStats(CJob::PRIORITY_LOW_PAUSABLE).queued);
+
+  jobs.UnPauseJobs();
+}
@@ -120,6 +120,7 @@ bool CGUIWindowVideoBase::OnMessage(CGUIMessage& message)
   case GUI_MSG_WINDOW_DEINIT:
     if (m_thumbLoader.IsLoading())
       m_thumbLoader.StopThread();
+    m_thumbLoader.CancelExtraction();
     m_database.Close();
     break;
 
@@ -1300,6 +1301,7 @@ bool CGUIWindowVideoBase::Update(const std::string &strDirectory, bool updateFil
 {
   if (m_thumbLoader.IsLoading())
     m_thumbLoader.StopThread();
+  m_thumbLoader.CancelExtraction();
 
   if (!CGUIMediaWindow::Update(strDirectory, updateFilterPath))
     return false;
@@ -122,6 +122,9 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
                                 stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(),
                                 strCores.c_str(), ucAppName.c_str(), dCPU, profiling.c_str());
 #endif
+    unsigned int evaluated, skipped;
+    g_infoManager.GetBoolCacheStats(evaluated, skipped);
+    info += StringUtils::Format("\nINFO: %u evaluated / %u cached conditions", evaluated, skipped);
   }
 
   // render the skin debug info